@@ -1,6 +1,7 @@
 #pragma once
 
 #include "svgb2ddriver.h"
+#include "svgdamage.h"
 #include "viewport.h"
 #include "uievent.h"
 #include "svgcamera.h"
@@ -125,12 +126,28 @@ namespace waavs {
 }
 
 namespace waavs {
+    //
+    // SVGCachedView
+    //
+    // Draws its content into a cached image, which is what gets 
+    // drawn to the screen.  The cached image is only drawn again
+    // when something changes.  When that something is known to be
+    // a few small parts of the view, only those parts are redrawn,
+    // and the rest of the cached image is left alone.
+    //
     struct SVGCachedView : public GraphicView
     {
+        // Redrawing a damaged area can show that changed content
+        // landed somewhere else, which then needs to be redrawn too.
+        // After this many passes, just redraw everything.
+        static constexpr int kMaxDamagePasses = 3;
+
         Surface fCachedImage{};
         std::unique_ptr<SVGB2DDriver> fCacheContext{ nullptr };
         int fDrawingThreads{ 0 };
         bool fNeedsRedraw{ true };
+        SVGDamageRegion fDamage{};      // in pixels of the cached image
+        SurfacePool fSurfacePool{};     // offscreen surfaces, kept from one frame to the next
 
         SVGCachedView(const WGRectD& aframe, int drawingThreads=0)
             :GraphicView(aframe)
@@ -148,13 +165,44 @@ namespace waavs {
                 fCacheContext = std::make_unique<SVGB2DDriver>();
                 fCacheContext->attach(fCachedImage, fDrawingThreads);
                 fCacheContext->setViewport(frame());
+                fCacheContext->trackDamage(true);
+                fCacheContext->setSurfacePool(&fSurfacePool);
             }
 
             return fCacheContext.get(); 
         }
 
         void setNeedsRedraw(const bool needsIt) { fNeedsRedraw = needsIt; }
-        bool needsRedraw() const { return fNeedsRedraw; }
+        bool needsRedraw() const { return fNeedsRedraw || fDamage.isFull(); }
+
+        // invalidateRect()
+        //
+        // Redraw part of the view, in pixels of the cached image
+        void invalidateRect(const WGRectD& r) { fDamage.add(r); }
+
+        // invalidateAll()
+        //
+        // Redraw the whole view.  For changes the content doesn't
+        // report as damage, a new document, or a new size, say.
+        // Otherwise, a frame with no damage draws nothing new.
+        void invalidateAll() { setNeedsRedraw(true); }
+
+        // collectDamage()
+        //
+        // Add whatever the content says has been damaged since the
+        // last time it was asked.  Called after every redraw, as the
+        // content might only find out where it landed while drawing.
+        virtual void collectDamage(SVGDamageRegion&) {}
+
+        // onFrameEvent()
+        //
+        // Once the content has been updated for a frame, pick up what
+        // it damaged.  With none, and nothing invalidated, the cached
+        // image is shown as it is.
+        void onFrameEvent(const FrameCountEvent&)
+        {
+            collectDamage(fDamage);
+        }
 
         void setFrame(const WGRectD& arect) override
         {
@@ -166,50 +214,148 @@ namespace waavs {
             //fCacheContext.attach(fCachedImage, fDrawingThreads);
             //fCacheContext.setViewport(arect);
             
-            setNeedsRedraw(true);
+            invalidateAll();
         }
 
 
-        void draw(IRenderSVG* ctx) override
+        void drawLayers(SVGB2DDriver* ctx)
         {
-            if (needsRedraw())
-            {
-                auto ctx = cacheContext();
-                if (!ctx)
-                    return;
+            //ctx->push();
+            //ctx->translate(-frame().x, -frame().y);
+            drawBackground(ctx);
+            //ctx->pop();
+
+            // Apply viewport transformation
+            ctx->push();
+            //ctx->translate(frame().x, frame().y);
+            ctx->transform(sceneToSurfaceTransform());
+            drawSelf(ctx);
+            ctx->pop();
+
+            //ctx->push();
+            //ctx->translate(frame().x, frame().y);
+            drawForeground(ctx);
+            //ctx->pop();
+        }
+
+        void redrawAll(SVGB2DDriver* ctx)
+        {
+            ctx->renew();
+            //fCacheContext.clear();
+
+            //ctx->clipToRect(fr);
+            drawLayers(ctx);
+            //ctx->noClip();
+
+            // Make sure to flush the drawing operations
+            // or the bitmap won't be updated
+            // this is particularly acute when using multiple threads
+            ctx->flush();
+
+            // Whatever was damaged has been drawn
+            fDamage.clear();
+            collectDamage(fDamage);
+            fDamage.clear();
+
+            setNeedsRedraw(false);
+        }
 
-                ctx->renew();
-                //fCacheContext.clear();
+        // redrawRect()
+        //
+        // Clear and redraw one part of the cached image, leaving the
+        // rest alone.  Content outside of it is skipped.
+        void redrawRect(SVGB2DDriver* ctx, const WGRectI& r)
+        {
+            ctx->setCullRect(r);
+            ctx->initState();
+            ctx->blendMode(BL_COMP_OP_SRC_OVER);
+
+            ctx->push();
+            ctx->transform(WGMatrix3x3::makeIdentity());
+            ctx->clipRect(WGRectD(r.x, r.y, r.w, r.h));
+            ctx->clear();
+
+            drawLayers(ctx);
+
+            ctx->noClip();
+            ctx->pop();
 
-                WGRectD fr = frame();
-                
-                //ctx->clipToRect(fr);
+            ctx->clearCullRect();
+        }
+
+        // redrawDamage()
+        //
+        // Redraw only what's been damaged.  Where changed content 
+        // lands now is reported while it's being drawn, so once the
+        // damaged areas are redrawn, whatever new areas turned up,
+        // and haven't been covered already, are redrawn as well.
+        void redrawDamage(SVGB2DDriver* ctx)
+        {
+            const int w = int(fCachedImage.width());
+            const int h = int(fCachedImage.height());
 
-                //ctx->push();
-                //ctx->translate(-frame().x, -frame().y);
-                drawBackground(ctx);
-                //ctx->pop();
+            std::vector<WGRectI> drawn{};
 
-                // Apply viewport transformation
-                ctx->push();
-                //ctx->translate(frame().x, frame().y);
-                ctx->transform(sceneToSurfaceTransform());
-                drawSelf(ctx);
-                ctx->pop();
+            for (int pass = 0; pass < kMaxDamagePasses && !fDamage.empty(); pass++)
+            {
+                if (fDamage.isFull())
+                    break;
+
+                SVGDamageRegion todo = std::move(fDamage);
+                fDamage.clear();
+
+                for (const auto& r : todo.rects())
+                {
+                    WGRectI px{};
+                    if (!SVGDamageRegion::pixelRect(r, w, h, px))
+                        continue;
+
+                    bool covered = false;
+                    for (const auto& d : drawn)
+                    {
+                        if (px.x >= d.x && px.y >= d.y && px.x + px.w <= d.x + d.w && px.y + px.h <= d.y + d.h)
+                        {
+                            covered = true;
+                            break;
+                        }
+                    }
+
+                    if (covered)
+                        continue;
+
+                    redrawRect(ctx, px);
+                    drawn.push_back(px);
+                }
+
+                collectDamage(fDamage);
+            }
+
+            if (!fDamage.empty())
+            {
+                redrawAll(ctx);
+                return;
+            }
 
-                //ctx->push();
-                //ctx->translate(frame().x, frame().y);
-                drawForeground(ctx);
-                //ctx->pop();
+            ctx->flush();
+        }
 
-                //ctx->noClip();
+        void draw(IRenderSVG* ctx) override
+        {
+            if (needsRedraw())
+            {
+                auto ctx = cacheContext();
+                if (!ctx)
+                    return;
 
-                // Make sure to flush the drawing operations
-                // or the bitmap won't be updated
-                // this is particularly acute when using multiple threads
-                ctx->flush();
+                redrawAll(ctx);
+            }
+            else if (!fDamage.empty())
+            {
+                auto ctx = cacheContext();
+                if (!ctx)
+                    return;
 
-                setNeedsRedraw(false);
+                redrawDamage(ctx);
             }
 
             // just do a blt of the cached image
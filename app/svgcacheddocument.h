@@ -31,14 +31,27 @@ namespace waavs {
         }
 
 
+        // Elements that changed report what they damaged while
+        // updating, so only that much of the view is redrawn.  When
+        // none did, nothing is.
         virtual void onFrameEvent(const FrameCountEvent& fe)
         {
             if (fDocument != nullptr)
             {
-                setNeedsRedraw(true);
                 fDocument->update(fDocument.get());
+                SVGCachedView::onFrameEvent(fe);
             }
         }
+
+        void collectDamage(SVGDamageRegion& damage) override
+        {
+            if (fDocument == nullptr)
+                return;
+
+            SVGDamageRegion docDamage{};
+            fDocument->takeDamage(docDamage);
+            damage.add(docDamage);
+        }
         
         virtual void onDocumentLoad()
         {
@@ -55,6 +68,7 @@ namespace waavs {
 
             fDocument = doc;
             fDocument->setNeedsBinding(true);
+            fDamage.clear();
 
             WGRectD sFrame{};
             auto rootElem = doc->documentElement();
@@ -65,7 +79,7 @@ namespace waavs {
 
 
             setBounds(sFrame);
-            setNeedsRedraw(true);
+            invalidateAll();
             onDocumentLoad();
         }
 
@@ -117,6 +117,19 @@ namespace waavs
 
 
 
+    // 64-bit FNV-1a hash over characters
+    // Usable in constant expressions, so compile time tables
+    // can be built with the same hash used at runtime
+    INLINE constexpr uint64_t fnv1a_64_chars(const char* s, const size_t size) noexcept
+    {
+        uint64_t hash = FNV1A_64_INIT;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= static_cast<uint8_t>(s[i]);
+            hash *= FNV1A_64_PRIME;
+        }
+        return hash;
+    }
+
     // 32-bit case-insensitive FNV-1a hash
     INLINE uint32_t fnv1a_32_case_insensitive(const void* data, const size_t size) noexcept
     {
@@ -13,6 +13,7 @@
 #include "bspan_utils.h"
 
 #include "maths.h"
+#include "fast_double_parser.h"
 
 namespace waavs
 {
@@ -174,6 +175,72 @@ namespace waavs
     }
 
 
+    // SWAR digit handling
+    //
+    // Long runs of digits are common enough in coordinate data
+    // (fractions like 0.12345678) that it's worth consuming them
+    // 8 at a time.  The 8 bytes are loaded into a single 64-bit
+    // word, checked to be all digits, then combined with three
+    // multiplies rather than eight.
+    // This relies on a little endian load, so big endian targets
+    // just use the byte at a time loops.
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    #define WAAVS_SWAR_DIGITS 0
+#else
+    #define WAAVS_SWAR_DIGITS 1
+#endif
+
+    static INLINE uint64_t swar_load8(const unsigned char* p) noexcept
+    {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    // true if all 8 bytes are in the range '0'..'9'
+    static INLINE bool swar_is_eight_digits(uint64_t v) noexcept
+    {
+        return (((v & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+            0x3333333333333333ULL);
+    }
+
+    // Value of 8 ascii digits, first digit in the lowest byte
+    static INLINE uint32_t swar_parse_eight_digits(uint64_t v) noexcept
+    {
+        v = (v & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+        v = (v & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+        return uint32_t((v & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32);
+    }
+
+    // read_digits()
+    //
+    // Accumulate a run of decimal digits into 'v', returning a pointer
+    // to the first non-digit.  'v' is not checked for overflow, the
+    // caller can tell from the length of the run whether that happened.
+    static INLINE const unsigned char* read_digits(const unsigned char* p, const unsigned char* pEnd, uint64_t& v) noexcept
+    {
+#if WAAVS_SWAR_DIGITS
+        while ((pEnd - p) >= 8)
+        {
+            const uint64_t chunk = swar_load8(p);
+            if (!swar_is_eight_digits(chunk))
+                break;
+
+            v = (v * 100000000ULL) + swar_parse_eight_digits(chunk);
+            p += 8;
+        }
+#endif
+
+        while ((p < pEnd) && is_digit(*p))
+        {
+            v = (v * 10) + (uint64_t)(*p - '0');
+            ++p;
+        }
+
+        return p;
+    }
+
     // read_u64
     //
     // Read a 64-bit unsigned integer from the input span
@@ -192,13 +259,9 @@ namespace waavs
 
 
         v = 0;
-
-        while ((sStart < sEnd) && is_digit(*sStart))
-        {
-            v = (v * 10) + (uint64_t)(*sStart - '0');
-            ++sStart;
-            ++digitsRead;
-        }
+        const unsigned char* digitsEnd = read_digits(sStart, sEnd, v);
+        digitsRead = size_t(digitsEnd - sStart);
+        sStart = digitsEnd;
 
         s.resetStart(sStart);
 
@@ -311,6 +374,36 @@ namespace waavs
     //}
     //return outNumber;
     
+    // readNumberSlow()
+    //
+    // Fallback for the rare numbers the fast path can't handle exactly,
+    // more than 19 significant digits, or an extreme exponent.
+    // 'start' to 'end' is known to hold a well formed number, which is
+    // copied so it can be null terminated for strtod.
+    static bool readNumberSlow(const unsigned char* start, const unsigned char* end, double& value) noexcept
+    {
+        const size_t len = size_t(end - start);
+
+        char buff[128];
+        if (len < sizeof(buff))
+        {
+            memcpy(buff, start, len);
+            buff[len] = 0;
+            fast_double_parser::parse_float_strtod(buff, &value);
+        }
+        else
+        {
+            std::string str((const char*)start, len);
+            fast_double_parser::parse_float_strtod(str.c_str(), &value);
+        }
+
+        // Zero is always +0.0, see readNumber()
+        if (value == 0.0)
+            value = 0.0;
+
+        return true;
+    }
+
     // 
     // readNumber()
     //
@@ -324,6 +417,15 @@ namespace waavs
     // Construction:
     // number ::= integer ([Ee] integer)?
     //    | [+-] ? [0 - 9] * "."[0 - 9] + ([Ee] integer) ?
+    //
+    // All the digits, integer and fraction, are gathered into a single
+    // 64-bit mantissa, with a decimal exponent, and the two are turned
+    // into a correctly rounded double by fast_double_parser (Clinger's
+    // fast path, then Eisel-Lemire).  Only when that can't give an exact
+    // answer do we fall back to strtod.
+    //
+    // A zero comes back as +0.0, even when written "-0", so it can't 
+    // flip the sign of whatever is later divided by it.
 
     // Assumption:  We're sitting at beginning of a number, all whitespace handling
     // has already occured.
@@ -332,24 +434,11 @@ namespace waavs
         if (s.empty())
             return false;
 
+        const unsigned char* numStart = s.begin();
         const unsigned char* startAt = s.begin();
         const unsigned char* endAt = s.end();
 
         bool isNegative = false;
-        double res = 0.0;
-
-        // integer part
-        uint64_t intPart = 0;
-
-        // fractional part
-        uint64_t fracPart = 0;
-        uint64_t fracBase = 1;
-
-
-        bool hasIntPart = false;
-        bool hasFracPart = false;
-
-
 
         // Parse optional sign
         if (*startAt == '+' || *startAt == '-')
@@ -357,44 +446,32 @@ namespace waavs
             isNegative = (*startAt == '-');
             startAt++;
             if (startAt >= endAt) return false;
-
         }
 
+        const unsigned char* digitsStart = startAt;
+
+        uint64_t mantissa = 0;
+        int64_t exponent = 0;
+
         // Parse integer part
-        size_t digitsRead = 0;
-        unsigned char c = *startAt;
-        if (is_digit(c))
-        {
-            hasIntPart = true;
-            s.resetStart(startAt);
-            read_u64(s, intPart, digitsRead);
-            startAt = s.begin();
-            res = static_cast<double>(intPart);
-        }
+        startAt = read_digits(startAt, endAt, mantissa);
+        size_t digitCount = size_t(startAt - digitsStart);
+        const bool hasIntPart = digitCount > 0;
 
-        // Parse fractional part.
-        bool fracHasDigits = false;
+        // Parse fractional part.  The fraction digits just continue
+        // the mantissa, and each one lowers the exponent
+        bool hasFracPart = false;
         if ((startAt < endAt) && (*startAt == '.'))
         {
             startAt++; // Skip '.'
 
-            fracBase = 1;
-
-            // Add the fraction portion without calling out to powd
-            while ((startAt < endAt) && is_digit(*startAt)) 
-            {
-                fracHasDigits = true;
-                fracPart = fracPart * 10 + static_cast<uint64_t>(*startAt - '0');
-                fracBase *= 10;
-                startAt++;
-            }
-
-            if (fracHasDigits) 
-            {
-                hasFracPart = true;
-                res += (static_cast<double>(fracPart) / static_cast<double>(fracBase));
-            }
+            const unsigned char* fracStart = startAt;
+            startAt = read_digits(startAt, endAt, mantissa);
 
+            const size_t fracDigits = size_t(startAt - fracStart);
+            hasFracPart = fracDigits > 0;
+            digitCount += fracDigits;
+            exponent = -(int64_t)fracDigits;
         }
 
         // If we don't have an integer or fractional
@@ -403,36 +480,85 @@ namespace waavs
             return false;
 
         // Parse optional exponent
-        // mostly we don't see this, so we won't bother trying
-        // to optimize it beyond using powd
-        if ((startAt < endAt) && 
-            (((*startAt == 'e') || (*startAt == 'E')) && 
-            ((startAt[1] != 'm') && (startAt[1] != 'x'))))
+        // The 'e' is only taken if digits follow it, so the 'em' and 'ex'
+        // units are left for the caller
+        if ((startAt < endAt) && ((*startAt == 'e') || (*startAt == 'E')))
         {
-            // exponent parts
-            uint64_t expPart = 0;
-            double expSign = 1.0;
+            const unsigned char* expAt = startAt + 1;
+            bool expNegative = false;
 
-            startAt++; // skip 'E'
-            if (*startAt == '+') {
-                startAt++;
+            if ((expAt < endAt) && ((*expAt == '+') || (*expAt == '-')))
+            {
+                expNegative = (*expAt == '-');
+                expAt++;
             }
-            else if (*startAt == '-') {
-                expSign = -1.0;
-                startAt++;
+
+            if ((expAt < endAt) && is_digit(*expAt))
+            {
+                int64_t expPart = 0;
+                while ((expAt < endAt) && is_digit(*expAt))
+                {
+                    // clamp, anything this big is out of range anyway
+                    if (expPart < 0x100000000)
+                        expPart = (expPart * 10) + (*expAt - '0');
+                    expAt++;
+                }
+
+                exponent += expNegative ? -expPart : expPart;
+                startAt = expAt;
             }
+        }
 
+        s.resetStart(startAt);
 
-            if (is_digit(*startAt)) {
-                s.resetStart(startAt);
-                read_u64(s, expPart, digitsRead);
-                startAt = s.begin();
-                res = res * POW(10, double(expSign * double(expPart)));
+        // More than 19 digits may have overflowed the mantissa.  Leading
+        // zeros don't count, so check again without them before giving up
+        if (digitCount > 19)
+        {
+            const unsigned char* p = digitsStart;
+            while ((p < startAt) && ((*p == '0') || (*p == '.')))
+            {
+                if (*p == '0')
+                    digitCount--;
+                p++;
             }
+
+            if (digitCount > 19)
+                return readNumberSlow(numStart, startAt, value);
         }
-        s.resetStart(startAt);
 
-        value = (!isNegative)? res : -res;
+        if (mantissa == 0)
+        {
+            value = 0.0;
+            return true;
+        }
+
+        if ((exponent < FASTFLOAT_SMALLEST_POWER) || (exponent > FASTFLOAT_LARGEST_POWER))
+            return readNumberSlow(numStart, startAt, value);
+
+        // Clinger's fast path, both the mantissa and the power of ten are
+        // exact doubles, so a single multiply or divide is correctly rounded.
+        // This covers nearly every coordinate found in practice.
+        if ((exponent >= -22) && (exponent <= 22) && (mantissa <= (1ULL << 53)))
+        {
+            static constexpr double kPow10[] = {
+                1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+            double d = (double)mantissa;
+            d = (exponent < 0) ? (d / kPow10[-exponent]) : (d * kPow10[exponent]);
+            value = isNegative ? -d : d;
+
+            return true;
+        }
+
+        bool success = true;
+        value = fast_double_parser::compute_float_64(exponent, mantissa, isNegative, &success);
+        if (!success)
+            return readNumberSlow(numStart, startAt, value);
+
+        if (value == 0.0)
+            value = 0.0;
 
         return true;
     }
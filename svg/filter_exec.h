@@ -5,6 +5,7 @@
 #include "filter_types.h"
 #include "svgenums.h"   // BUGBUG - for SpaceUnitsKind
 #include "surface.h"
+#include "surfacepool.h"
 
 #include <memory>
 
@@ -279,6 +280,9 @@ namespace waavs
 
         FilterColorInterpolation defaultColorInterp;
 
+        // Where output surfaces come from, if anywhere
+        SurfacePool* pool{ nullptr };
+
 
         Surface getImage(InternedKey key) noexcept
         {
@@ -434,8 +438,7 @@ namespace waavs
         if (model.empty())
             return false;
 
-        rio.out = createLikeSurfaceHolder(model);
-        if (rio.out.empty())
+        if (!acquireSurface(ctx.pool, model.info().width, model.info().height, rio.out))
             return false;
 
         switch (policy.outsidePolicy)
@@ -27,7 +27,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName(filter::feDistantLight(), [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeDistantLightElement>();
+                auto node = makeNode<SVGFeDistantLightElement>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -37,7 +37,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName(filter::feDistantLight(), [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeDistantLightElement>();
+                auto node = makeNode<SVGFeDistantLightElement>();
                 node->loadFromXmlPull(iter, groot);
 
                 return node;
@@ -64,7 +64,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName(filter::fePointLight(), [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFePointLightElement>();
+                auto node = makeNode<SVGFePointLightElement>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -74,7 +74,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName(filter::fePointLight(), [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFePointLightElement>();
+                auto node = makeNode<SVGFePointLightElement>();
                 node->loadFromXmlPull(iter, groot);
 
                 return node;
@@ -101,7 +101,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feSpotLight", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeSpotLightElement>();
+                auto node = makeNode<SVGFeSpotLightElement>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -111,7 +111,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feSpotLight", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeSpotLightElement>();
+                auto node = makeNode<SVGFeSpotLightElement>();
                 node->loadFromXmlPull(iter, groot);
 
                 return node;
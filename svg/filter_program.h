@@ -2,9 +2,11 @@
 
 #pragma once
 
+#include <utility>
 #include <vector>
 
 #include "definitions.h"
+#include "filter_types.h"
 
 
 // Here we have only the FilterProgramStream, 
@@ -153,6 +155,11 @@ namespace waavs
         std::vector<FilterOpType>  ops;   // packed opcode+flags
         std::vector<FilterMemWord> mem;   // 64-bit words (numbers, pointers, packed pairs)
 
+        // The data: URI images feImage primitives draw, by their href
+        // key, decoded once when the program is built, rather than
+        // every time it's run
+        std::vector<std::pair<InternedKey, BLImage>> images;
+
         // Filter-level coordinate system controls:
         SpaceUnitsKind filterUnits{ SpaceUnitsKind::SVG_SPACE_OBJECT }; // default objectBoundingBox
         SpaceUnitsKind primitiveUnits{ SpaceUnitsKind::SVG_SPACE_USER }; // default userSpaceOnUse
@@ -161,6 +168,7 @@ namespace waavs
         void clear() { 
             ops.clear(); 
             mem.clear(); 
+            images.clear();
             filterUnits = SpaceUnitsKind::SVG_SPACE_OBJECT;
             primitiveUnits = SpaceUnitsKind::SVG_SPACE_USER;
         }
@@ -168,6 +176,17 @@ namespace waavs
         bool empty() const { 
             return ops.empty() && mem.empty(); 
         }
+
+        const BLImage* findImage(InternedKey key) const noexcept
+        {
+            for (const auto& entry : images)
+            {
+                if (entry.first == key)
+                    return &entry.second;
+            }
+
+            return nullptr;
+        }
     };
 
     struct FilterProgramCursor
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <memory>
+#include <cmath>
 
 #include "filter_exec.h"
 #include "filter_types.h"
@@ -27,6 +28,117 @@ namespace waavs
     };
 
 
+    // resolveFilterSubregionUS()
+    //
+    // A primitive's subregion, in user space, padded by (padUserX, padUserY)
+    // on each side.  Without a subregion of its own, a primitive covers
+    // the whole filter region.
+    static INLINE WGRectD resolveFilterSubregionUS(
+        const FilterRunState& run,
+        const FilterPrimitiveSubregion& subr,
+        double padUserX = 0.0,
+        double padUserY = 0.0) noexcept
+    {
+        WGRectD ur{};
+
+        if (!subr.isValid)
+        {
+            ur = run.filterRectUS;
+        }
+        else
+        {
+            const auto& x = subr.x;
+            const auto& y = subr.y;
+            const auto& w = subr.w;
+            const auto& h = subr.h;
+
+            switch (run.primitiveUnits)
+            {
+            default:
+            case SpaceUnitsKind::SVG_SPACE_USER:
+            {
+                const double fx = x.isPercent()
+                    ? run.filterRectUS.x + x.calculatedValue() * run.filterRectUS.w
+                    : x.value();
+
+                const double fy = y.isPercent()
+                    ? run.filterRectUS.y + y.calculatedValue() * run.filterRectUS.h
+                    : y.value();
+
+                const double fw = w.isPercent()
+                    ? w.calculatedValue() * run.filterRectUS.w
+                    : w.value();
+
+                const double fh = h.isPercent()
+                    ? h.calculatedValue() * run.filterRectUS.h
+                    : h.value();
+
+                ur = WGRectD(fx, fy, fw, fh);
+                break;
+            }
+
+            case SpaceUnitsKind::SVG_SPACE_OBJECT:
+            {
+                const double bx = run.objectBBoxUS.x;
+                const double by = run.objectBBoxUS.y;
+                const double bw = run.objectBBoxUS.w;
+                const double bh = run.objectBBoxUS.h;
+
+                const double fx = bx + x.calculatedValue() * bw;
+                const double fy = by + y.calculatedValue() * bh;
+                const double fw = w.calculatedValue() * bw;
+                const double fh = h.calculatedValue() * bh;
+
+                ur = WGRectD(fx, fy, fw, fh);
+                break;
+            }
+
+            case SpaceUnitsKind::SVG_SPACE_STROKEWIDTH:
+            {
+                ur = WGRectD(
+                    x.calculatedValue(),
+                    y.calculatedValue(),
+                    w.calculatedValue(),
+                    h.calculatedValue());
+                break;
+            }
+            }
+        }
+
+        if (!(ur.w > 0.0) || !(ur.h > 0.0))
+            return WGRectD{};
+
+        if (padUserX > 0.0 || padUserY > 0.0)
+        {
+            ur.x -= padUserX;
+            ur.y -= padUserY;
+            ur.w += 2.0 * padUserX;
+            ur.h += 2.0 * padUserY;
+        }
+
+        return ur;
+    }
+
+    // filterUserRectToPixels()
+    //
+    // The pixels a user space rectangle covers, relative to the
+    // corner of the filter's surfaces.  Not clipped to them.
+    static INLINE WGRectI filterUserRectToPixels(const FilterSpace& space, const WGRectD& ur) noexcept
+    {
+        if (!(ur.w > 0.0) || !(ur.h > 0.0))
+            return WGRectI{};
+
+        const WGRectD px = mapRectAABB(space.ctm, ur);
+
+        const int ix0 = int(std::floor(px.x - space.filterRectPX.x));
+        const int iy0 = int(std::floor(px.y - space.filterRectPX.y));
+        const int ix1 = int(std::ceil((px.x + px.w) - space.filterRectPX.x));
+        const int iy1 = int(std::ceil((px.y + px.h) - space.filterRectPX.y));
+
+        return WGRectI{ ix0, iy0, ix1 - ix0, iy1 - iy0 };
+    }
+
+
     static INLINE WGFilterColorSpace to_WGFilterColorSpace(FilterColorInterpolation colorInterpolation) noexcept
     {
             // Adjust these enum names to match your actual ColorInterpolation enum.
@@ -130,7 +242,7 @@ namespace waavs
             // Resolve empty / "__last__" sentinel to concrete key.
             InternedKey resolveKey(InternedKey k) const noexcept override
             {
-                static InternedKey kLast = PSNameTable::INTERN("__last__");
+                static constexpr InternedKey kLast = svgStaticAtom("__last__");
 
                 if (!k)
                     return lastKey();
@@ -280,6 +392,10 @@ namespace waavs
         virtual bool onBeginProgram(const FilterProgramStream&) noexcept { return true; }
         virtual void onEndProgram(const FilterProgramStream&) noexcept {}
 
+        // Every primitive's inputs and output, as they're decoded,
+        // before the primitive's own hook
+        virtual void onPrimitiveIO(const FilterIO&) noexcept {}
+
         virtual bool onGaussianBlur(const FilterIO&, const FilterPrimitiveSubregion &, float sx, float sy) noexcept
         {
             return true;
@@ -489,6 +605,7 @@ namespace waavs
         INLINE void decodeCommon(uint8_t flags, FilterIO& io, FilterPrimitiveSubregion& subr) noexcept
         {
             decodeCommonPrefix(flags, cur(), io, subr);
+            onPrimitiveIO(io);
         }
 
         // Convert a mem list (f32 stored via u64_from_f32) to a scratch float buffer.
@@ -984,4 +1101,82 @@ namespace waavs
             return ok;
         }
     };
+
+    // -----------------------------------------------------------------------------
+    // collectFilterImageRefs()
+    //
+    // The image keys of a program's feImage primitives, in program
+    // order.  Only the operands are decoded, nothing is run.
+    // -----------------------------------------------------------------------------
+    struct FilterImageRefCollector final : FilterProgramExecutor, IAmFrootBase
+    {
+        std::vector<InternedKey>* fOut{ nullptr };
+        InternedKey fLast{};
+
+        InternedKey lastKey() const noexcept override { return fLast; }
+        void setLastKey(InternedKey k) noexcept override { fLast = k; }
+        InternedKey resolveKey(InternedKey k) const noexcept override { return k; }
+
+        bool onImage(const FilterIO&, const FilterPrimitiveSubregion&,
+            InternedKey imageKey,
+            AspectRatioAlignKind,
+            AspectRatioMeetOrSliceKind) noexcept override
+        {
+            if (fOut && imageKey)
+                fOut->push_back(imageKey);
+            return true;
+        }
+    };
+
+    static INLINE void collectFilterImageRefs(const FilterProgramStream& prog, std::vector<InternedKey>& out) noexcept
+    {
+        FilterImageRefCollector collector{};
+        collector.fOut = &out;
+        collector.execute(prog, collector);
+    }
+
+    // -----------------------------------------------------------------------------
+    // filterReadsBackground()
+    //
+    // Whether any primitive of a program reads BackgroundImage or
+    // BackgroundAlpha, which come from whatever target the filter is
+    // run against.  Only the operands are decoded, nothing is run.
+    // -----------------------------------------------------------------------------
+    struct FilterBackgroundReader final : FilterProgramExecutor, IAmFrootBase
+    {
+        bool fReads{ false };
+        InternedKey fLast{};
+
+        InternedKey lastKey() const noexcept override { return fLast; }
+        void setLastKey(InternedKey k) noexcept override { fLast = k; }
+        InternedKey resolveKey(InternedKey k) const noexcept override { return k; }
+
+        static bool isBackground(InternedKey k) noexcept
+        {
+            return k && (k == filter::BackgroundImage() || k == filter::BackgroundAlpha());
+        }
+
+        void onPrimitiveIO(const FilterIO& io) noexcept override
+        {
+            if (isBackground(io.in1) || isBackground(io.in2))
+                fReads = true;
+        }
+
+        bool onMerge(const FilterIO&, const FilterPrimitiveSubregion&, KeySpan inputs) noexcept override
+        {
+            for (size_t i = 0; i < inputs.n; i++)
+            {
+                if (isBackground(inputs.p[i]))
+                    fReads = true;
+            }
+            return true;
+        }
+    };
+
+    static INLINE bool filterReadsBackground(const FilterProgramStream& prog) noexcept
+    {
+        FilterBackgroundReader reader{};
+        reader.execute(prog, reader);
+        return reader.fReads;
+    }
 }
@@ -14,8 +14,10 @@
 
 #include "filter_types.h"
 #include "filter_program_exec.h"   
+#include "filter_region_analysis.h"
 #include "filter_noise.h"
 #include "viewport.h"
+#include "imagecache.h"
 
 
 #include "filter_feblend.h"
@@ -61,6 +63,18 @@ namespace waavs
 
 namespace waavs
 {
+    // IFilterReferenceSource
+    //
+    // Draws what an feImage refers to, when that doesn't come from a
+    // document, as when a display list is replayed.  'ctx' has the
+    // transform from the referenced content's user space already set.
+    struct IFilterReferenceSource
+    {
+        virtual ~IFilterReferenceSource() = default;
+
+        virtual bool drawFilterReference(InternedKey href, IRenderSVG& ctx) noexcept = 0;
+    };
+
     template<class SurfaceT>
     struct B2DFilterResourceResolver : public IFilterResourceResolver<SurfaceT>
     {
@@ -70,15 +84,18 @@ namespace waavs
         IAmGroot* fGroot{ nullptr };
         IRenderSVG* fRender{ nullptr };
         IAmFroot<SurfaceT>* fFroot{ nullptr };
+        IFilterReferenceSource* fReferences{ nullptr };
 
 
         B2DFilterResourceResolver(
             IAmGroot* groot,
             IRenderSVG* render,
-            IAmFroot<SurfaceT>* froot) noexcept
+            IAmFroot<SurfaceT>* froot,
+            IFilterReferenceSource* references = nullptr) noexcept
             : fGroot(groot)
             , fRender(render)
             , fFroot(froot)
+            , fReferences(references)
         {
         }
 
@@ -135,6 +152,64 @@ namespace waavs
             return true;
         }
 
+        // resolveEmbeddedImage()
+        //
+        // Draw a data: URI image into the primitive subregion,
+        // fitted according to preserveAspectRatio.  Programs carry
+        // their embedded images already decoded; the href is only
+        // decoded for one that doesn't.
+        Surface resolveEmbeddedImage(
+            const ByteSpan& href,
+            const FilterRunState& runState,
+            const WGRectD& subr,
+            AspectRatioAlignKind align,
+            AspectRatioMeetOrSliceKind meetOrSlice) noexcept
+        {
+            BLImage img{};
+            if (!parseImage(href, img))
+                return {};
+
+            return resolveEmbeddedImage(img, runState, subr, align, meetOrSlice);
+        }
+
+        Surface resolveEmbeddedImage(
+            const BLImage& img,
+            const FilterRunState& runState,
+            const WGRectD& subr,
+            AspectRatioAlignKind align,
+            AspectRatioMeetOrSliceKind meetOrSlice) noexcept
+        {
+            if (!wg_rectD_is_valid(runState.filterRectUS) || !wg_rectD_is_valid(subr))
+                return {};
+
+            if (img.is_empty())
+                return {};
+
+            const WGRectD viewBox{ 0, 0, double(img.width()), double(img.height()) };
+
+            WGMatrix3x3 fit = WGMatrix3x3::makeIdentity();
+            if (!computeViewBoxToViewport(subr, viewBox, makePAR(align, meetOrSlice), fit))
+                return {};
+
+            auto out = createFilterSurface(runState);
+            if (out.empty())
+                return {};
+            out.clearAll();
+
+            SVGB2DDriver ctx{};
+            ctx.attach(out, 1);
+            ctx.renew();
+
+            ctx.push();
+            ctx.transform(makeUserToSurfaceMatrix(runState));
+            ctx.transform(fit);
+            ctx.image(surfaceFromBLImage(img), 0, 0);
+            ctx.pop();
+            ctx.detach();
+
+            return out;
+        }
+
         Surface resolveFeImage(
             InternedKey imageKey,
             const FilterRunState& runState,
@@ -142,7 +217,7 @@ namespace waavs
             AspectRatioAlignKind align,
             AspectRatioMeetOrSliceKind meetOrSlice) noexcept override
         {
-            if (!fGroot || !fRender || !fFroot)
+            if (!fRender || !fFroot)
                 return {};
 
             if (!imageKey)
@@ -150,18 +225,24 @@ namespace waavs
 
             ByteSpan href = imageKey;
 
+            // Embedded images come from the shared image cache
+            if (bspan_starts_with(href, "data:"))
+                return resolveEmbeddedImage(href, runState, subr, align, meetOrSlice);
 
-            // First-pass implementation: local fragment refs only.
+            // Otherwise, local fragment refs only.
             if (href[0] != '#')
                 return {};
 
-            auto node = fGroot->findNodeByHref(href);
-            if (!node)
-                return {};
+            std::shared_ptr<IViewable> elem{};
+            if (!fReferences)
+            {
+                if (!fGroot)
+                    return {};
 
-            auto elem = std::dynamic_pointer_cast<IViewable>(node);
-            if (!elem)
-                return {};
+                elem = std::dynamic_pointer_cast<IViewable>(fGroot->findNodeByHref(href));
+                if (!elem)
+                    return {};
+            }
 
             if (!wg_rectD_is_valid(runState.filterRectUS))
                 return {};
@@ -197,7 +278,11 @@ namespace waavs
             // Fit referenced content into the destination viewport.
             ctx.transform(fit);
 
-            if (!renderReferencedSubtree(ctx, elem.get()))
+            const bool drawn = fReferences ?
+                fReferences->drawFilterReference(imageKey, ctx) :
+                renderReferencedSubtree(ctx, elem.get());
+
+            if (!drawn)
             {
                 ctx.pop();
                 ctx.detach();
@@ -240,6 +325,19 @@ namespace waavs {
         // ----------------------------------------------
         FilterSpace fSpace{};
 
+        // Where intermediate surfaces come from, the drawing
+        // context's pool, if it has one
+        SurfacePool* fPool{ nullptr };
+
+        // Which part of the filter region a program is run over
+        FilterRegionAnalysis fRegions{};
+
+        // Where feImage references are drawn from, instead of the
+        // document, if set.  Not owned.
+        IFilterReferenceSource* fReferences{ nullptr };
+
+        void setReferenceSource(IFilterReferenceSource* refs) noexcept { fReferences = refs; }
+
 
         // --------------------------------------------------------
         // IAmFrootBase / IAmFroot<PixelArray>
@@ -338,7 +436,7 @@ namespace waavs {
         {
             Surface img{};
 
-            if (!img.reset((int)w, (int)h))
+            if (!acquireSurface(fPool, (int)w, (int)h, img))
                 return {};
 
             return img;
@@ -370,84 +468,7 @@ namespace waavs {
             double padUserX = 0.0,
             double padUserY = 0.0) const noexcept
         {
-            WGRectD ur{};
-
-            if (!subr.isValid)
-            {
-                ur = fRunState.filterRectUS;
-            }
-            else
-            {
-                const auto& x = subr.x;
-                const auto& y = subr.y;
-                const auto& w = subr.w;
-                const auto& h = subr.h;
-
-                switch (fRunState.primitiveUnits)
-                {
-                default:
-                case SpaceUnitsKind::SVG_SPACE_USER:
-                {
-                    const double fx = x.isPercent()
-                        ? fRunState.filterRectUS.x + x.calculatedValue() * fRunState.filterRectUS.w
-                        : x.value();
-
-                    const double fy = y.isPercent()
-                        ? fRunState.filterRectUS.y + y.calculatedValue() * fRunState.filterRectUS.h
-                        : y.value();
-
-                    const double fw = w.isPercent()
-                        ? w.calculatedValue() * fRunState.filterRectUS.w
-                        : w.value();
-
-                    const double fh = h.isPercent()
-                        ? h.calculatedValue() * fRunState.filterRectUS.h
-                        : h.value();
-
-                    ur = WGRectD(fx, fy, fw, fh);
-                    break;
-                }
-
-                case SpaceUnitsKind::SVG_SPACE_OBJECT:
-                {
-                    const double bx = fRunState.objectBBoxUS.x;
-                    const double by = fRunState.objectBBoxUS.y;
-                    const double bw = fRunState.objectBBoxUS.w;
-                    const double bh = fRunState.objectBBoxUS.h;
-
-                    const double fx = bx + x.calculatedValue() * bw;
-                    const double fy = by + y.calculatedValue() * bh;
-                    const double fw = w.calculatedValue() * bw;
-                    const double fh = h.calculatedValue() * bh;
-
-                    ur = WGRectD(fx, fy, fw, fh);
-                    break;
-                }
-
-                case SpaceUnitsKind::SVG_SPACE_STROKEWIDTH:
-                {
-                    ur = WGRectD(
-                        x.calculatedValue(),
-                        y.calculatedValue(),
-                        w.calculatedValue(),
-                        h.calculatedValue());
-                    break;
-                }
-                }
-            }
-
-            if (!(ur.w > 0.0) || !(ur.h > 0.0))
-                return WGRectD{};
-
-            if (padUserX > 0.0 || padUserY > 0.0)
-            {
-                ur.x -= padUserX;
-                ur.y -= padUserY;
-                ur.w += 2.0 * padUserX;
-                ur.h += 2.0 * padUserY;
-            }
-
-            return ur;
+            return resolveFilterSubregionUS(fRunState, subr, padUserX, padUserY);
         }
 
         WGRectI resolveSubregionPx(
@@ -456,26 +477,12 @@ namespace waavs {
             double padUserX = 0.0,
             double padUserY = 0.0) const noexcept
         {
-            const int W = int(like.width());
-            const int H = int(like.height());
-
-            const WGRectI surfArea{ 0, 0, W, H };
-
-            const WGRectD ur =
-                resolveSubregionUS(subr, padUserX, padUserY);
+            const WGRectI surfArea{ 0, 0, int(like.width()), int(like.height()) };
 
-            if (!(ur.w > 0.0) || !(ur.h > 0.0))
+            const WGRectI subArea = filterUserRectToPixels(fSpace, resolveSubregionUS(subr, padUserX, padUserY));
+            if (subArea.w <= 0 || subArea.h <= 0)
                 return WGRectI{};
 
-            const WGRectD subrPX = mapRectAABB(fSpace.ctm, ur);
-
-            const int ix0 = int(std::floor(subrPX.x - fSpace.filterRectPX.x));
-            const int iy0 = int(std::floor(subrPX.y - fSpace.filterRectPX.y));
-            const int ix1 = int(std::ceil((subrPX.x + subrPX.w) - fSpace.filterRectPX.x));
-            const int iy1 = int(std::ceil((subrPX.y + subrPX.h) - fSpace.filterRectPX.y));
-
-            const WGRectI subArea{ ix0, iy0, ix1 - ix0, iy1 - iy0 };
-
             return intersection(subArea, surfArea);
         }
 
@@ -577,7 +584,7 @@ namespace waavs {
             if (filterRectPX.w <= 0 || filterRectPX.h <= 0)
                 return false;
 
-            if (!out.reset(filterRectPX.w, filterRectPX.h))
+            if (!acquireSurface(fPool, filterRectPX.w, filterRectPX.h, out))
                 return false;
 
             out.clearAll();
@@ -593,8 +600,13 @@ namespace waavs {
             if (bkgSurf.empty())
                 return true; // Valid transparent background.
 
+            // The target might be one tile of the canvas, in which 
+            // case the filter region is moved into its coordinates
+            const WGPointI& origin = ctx->targetOrigin();
+            const WGRectI regionInTarget{ filterRectPX.x - origin.x, filterRectPX.y - origin.y, filterRectPX.w, filterRectPX.h };
+
             const WGRectI srcBounds = bkgSurf.boundsI();
-            const WGRectI clippedSrc = intersection(srcBounds, filterRectPX);
+            const WGRectI clippedSrc = intersection(srcBounds, regionInTarget);
 
             if (clippedSrc.w <= 0 || clippedSrc.h <= 0)
                 return true; // Filter tile lies outside current target.
@@ -603,8 +615,8 @@ namespace waavs {
             if (bkgSurf.getSubSurface(clippedSrc, srcView) != WG_SUCCESS)
                 return true;
 
-            const int dstX = clippedSrc.x - filterRectPX.x;
-            const int dstY = clippedSrc.y - filterRectPX.y;
+            const int dstX = clippedSrc.x - regionInTarget.x;
+            const int dstY = clippedSrc.y - regionInTarget.y;
 
             out.blit(srcView, dstX, dstY);
 
@@ -615,10 +627,20 @@ namespace waavs {
         // --------------------------------------------------------
         // applyFilter()
         //
+        // Only the part of the filter region that can make a
+        // difference is computed, see filter_region_analysis.h.
+        // 'resultRectPX' gets where the result landed, the part of
+        // 'filterRectPX' it covers, empty if there's nothing to show.
+        //
+        // 'groot' may be null when there's a reference source, as
+        // long as 'subtree' doesn't need it.
+        //
+        // 'contentBoundsUS', when known, is where the subtree draws in
+        // user space.  Only that much of the drawn source is searched
+        // for what's in it.
         //
         // SubtreeT requirements:
-        //   WGRectD objectBoundingBox() const noexcept;
-        //   void draw(IRenderSVG*, IAmGroot*);
+        //   void drawContent(IRenderSVG*, IAmGroot*);
         // --------------------------------------------------------
         
         template<class SubtreeT>
@@ -631,9 +653,11 @@ namespace waavs {
             const WGRectI& filterRectPX,
             const FilterProgramStream& program,
             Surface & srcGraphic,
-            RenderFlags rFlags = RenderFeature::RF_All) noexcept
+            RenderFlags rFlags = RenderFeature::RF_All,
+            WGRectI* resultRectPX = nullptr,
+            const WGRectD* contentBoundsUS = nullptr) noexcept
         {
-            if (!ctx || !groot || !subtree)
+            if (!ctx || !subtree || (!groot && !fReferences))
                 return WGErrorCode::WG_ERROR_Invalid_Argument;
 
             if (!(objectBBoxUS.w > 0.0) || !(objectBBoxUS.h > 0.0))
@@ -653,6 +677,7 @@ namespace waavs {
 
             clearSurfaces();
             setLastKey({});
+            fPool = ctx->surfacePool();
 
             // --------------------------------------------------
             // Setup run state
@@ -705,13 +730,32 @@ namespace waavs {
             fResolver = std::make_unique<B2DFilterResourceResolver<Surface>>(
                 groot,
                 ctx,
-                this);
+                this,
+                fReferences);
 
             // --------------------------------------------------
-            // Render SourceGraphic into tile-local surface
+            // Work out which part of the filter region the
+            // program needs to run over
             // --------------------------------------------------
 
-            //Surface srcGraphic{};
+            WGRectI visiblePX = filterRectPX;
+            {
+                WGRectI visible{};
+                if (ctx->getVisibleRect(visible))
+                    visiblePX = intersection(visible, filterRectPX);
+            }
+
+            const WGRectI visibleLocal{
+                visiblePX.x - filterRectPX.x,
+                visiblePX.y - filterRectPX.y,
+                visiblePX.w,
+                visiblePX.h };
+
+            const bool cropped = fRegions.analyze(program, fRunState, fSpace, visibleLocal);
+
+            // --------------------------------------------------
+            // Render SourceGraphic into tile-local surface
+            // --------------------------------------------------
 
             IsolatedSubtreeRequest req{};
             SVGDrawingState* ds = ctx->getDrawingState();
@@ -722,13 +766,96 @@ namespace waavs {
             req.ctm = ctm;
             req.objectBBoxUS = objectBBoxUS;
             req.renderMode = RF_Content;
+            req.pool = fPool;
 
-            renderSubtreeToSurface(groot, subtree, req, srcGraphic);
+            WGRectI workPX = filterRectPX;
+            Surface source{};
 
-            if (srcGraphic.empty())
+            if (!cropped)
+            {
+                renderSubtreeToSurface(groot, subtree, req, source);
+            }
+            else
+            {
+                // Only draw the part of the source that's needed, and
+                // see how much of that has anything in it
+                const WGRectI& srcNeeded = fRegions.sourceNeeded();
+
+                Surface rendered{};
+                WGRectI srcExtent{};
+
+                if (wg_rectI_is_valid(srcNeeded))
+                {
+                    req.pixelRect = WGRectI{ filterRectPX.x + srcNeeded.x, filterRectPX.y + srcNeeded.y, srcNeeded.w, srcNeeded.h };
+                    renderSubtreeToSurface(groot, subtree, req, rendered);
+
+                    // Nothing is drawn outside the content, so that's
+                    // all that needs looking at
+                    WGRectI searchLocal{ 0, 0, srcNeeded.w, srcNeeded.h };
+                    if (contentBoundsUS)
+                    {
+                        const WGRectD contentPX = mapRectAABB(ctm, *contentBoundsUS);
+                        const int x0 = (int)std::floor(contentPX.x) - 1;
+                        const int y0 = (int)std::floor(contentPX.y) - 1;
+                        const int x1 = (int)std::ceil(contentPX.x + contentPX.w) + 1;
+                        const int y1 = (int)std::ceil(contentPX.y + contentPX.h) + 1;
+
+                        searchLocal = intersection(searchLocal,
+                            WGRectI{ x0 - req.pixelRect.x, y0 - req.pixelRect.y, x1 - x0, y1 - y0 });
+                    }
+
+                    if (!rendered.empty() && wg_rectI_is_valid(searchLocal) &&
+                        filterAlphaBounds(rendered, srcExtent, &searchLocal))
+                    {
+                        srcExtent.x += srcNeeded.x;
+                        srcExtent.y += srcNeeded.y;
+                    }
+                }
+
+                const WGRectI workLocal = fRegions.workingRect(srcExtent);
+                if (!wg_rectI_is_valid(workLocal))
+                {
+                    // Nothing the filter makes can be seen
+                    srcGraphic = {};
+                    if (resultRectPX)
+                        *resultRectPX = WGRectI{};
+
+                    return WG_SUCCESS;
+                }
+
+                workPX = WGRectI{ filterRectPX.x + workLocal.x, filterRectPX.y + workLocal.y, workLocal.w, workLocal.h };
+
+                // Move the source into the working rectangle, a view of
+                // it if it covers the whole of it
+                if (!rendered.empty() && wg_rectI_contains(workPX, req.pixelRect))
+                {
+                    const WGRectI view{ workPX.x - req.pixelRect.x, workPX.y - req.pixelRect.y, workPX.w, workPX.h };
+                    if (rendered.getSubSurface(view, source) != WG_SUCCESS)
+                        return WGErrorCode::WG_ERROR_Invalid_Argument;
+                }
+                else
+                {
+                    if (!acquireSurface(fPool, workPX.w, workPX.h, source))
+                        return WGErrorCode::WG_ERROR_Invalid_Argument;
+
+                    source.clearAll();
+
+                    const WGRectI overlap = intersection(req.pixelRect, workPX);
+                    Surface part{};
+                    if (!rendered.empty() && wg_rectI_is_valid(overlap) &&
+                        rendered.getSubSurface(WGRectI{ overlap.x - req.pixelRect.x, overlap.y - req.pixelRect.y, overlap.w, overlap.h }, part) == WG_SUCCESS)
+                    {
+                        source.blit(part, overlap.x - workPX.x, overlap.y - workPX.y);
+                    }
+                }
+
+                fSpace.filterRectPX = workPX;
+            }
+
+            if (source.empty())
                 return WGErrorCode::WG_ERROR_Invalid_Argument;
 
-            if (!putImage(filter::SourceGraphic(), srcGraphic))
+            if (!putImage(filter::SourceGraphic(), source))
                 return WGErrorCode::WG_ERROR_Invalid_Argument;
 
             // --------------------------------------------------
@@ -737,7 +864,7 @@ namespace waavs {
 
             Surface backgroundLocal{};
 
-            if (!getBackgroundLocal(ctx, filterRectPX, backgroundLocal))
+            if (!getBackgroundLocal(ctx, workPX, backgroundLocal))
                 return WGErrorCode::WG_ERROR_Invalid_Argument;
 
             if (!backgroundLocal.empty()) {
@@ -766,6 +893,9 @@ namespace waavs {
             if (srcGraphic.empty())
                 srcGraphic = getImage(filter::SourceGraphic());
 
+            if (resultRectPX)
+                *resultRectPX = workPX;
+
             return WG_SUCCESS;
         }
 
@@ -880,9 +1010,12 @@ namespace waavs {
             // Preserve behavior: copy full input first
             //if (wg_blit_copy(outInfo, inInfo, 0, 0) != WG_SUCCESS)
             //  return false;
-            out.clearAll();
 
+            // Every pixel of the subregion gets written, so only
+            // what's outside it needs clearing
             const WGRectI area = resolveSubregionPx(subr, in);
+            out.clearOutside(area);
+
             if (area.w <= 0 || area.h <= 0)
             {
                 if (!putImage(outKey, out))
@@ -945,10 +1078,11 @@ namespace waavs {
             // Preserve input, modify only the primitive subregion.
             //if (wg_blit_copy(outInfo, inInfo, 0, 0) != WG_SUCCESS)
             //    return false;
-            out.clearAll();
-
 
+            // Every pixel of the subregion gets written
             const WGRectI area = resolveSubregionPx(subr, in);
+            out.clearOutside(area);
+
             if (area.w <= 0 || area.h <= 0)
             {
                 if (!putImage(outKey, out))
@@ -2056,13 +2190,10 @@ namespace waavs {
                 return true;
             }
 
-            Surface tmp0;
-            Surface tmp1;
-
-            if (!tmp0.reset(in.width(), in.height()))
-                return false;
+            Surface tmp0 = createLikeSurfaceHandle(in);
+            Surface tmp1 = createLikeSurfaceHandle(in);
 
-            if (!tmp1.reset(in.width(), in.height()))
+            if (tmp0.empty() || tmp1.empty())
                 return false;
 
             tmp0.clearAll();
@@ -2141,12 +2272,12 @@ namespace waavs {
             if (!(dstRectUS.w > 0.0) || !(dstRectUS.h > 0.0))
                 return false;
 
-            Surface out = fResolver->resolveFeImage(
-                imageKey,
-                fRunState,
-                dstRectUS,
-                align,
-                mos);
+            // Decoded when the program was built
+            const BLImage* embedded = fProg ? fProg->findImage(imageKey) : nullptr;
+
+            Surface out = embedded ?
+                fResolver->resolveEmbeddedImage(*embedded, fRunState, dstRectUS, align, mos) :
+                fResolver->resolveFeImage(imageKey, fRunState, dstRectUS, align, mos);
 
             if (out.empty())
                 return false;
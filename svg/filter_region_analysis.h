@@ -0,0 +1,569 @@
+// filter_region_analysis.h
+#pragma once
+
+//
+// Filter region analysis
+//
+// A filter's surfaces cover the whole filter region, which is usually
+// a good deal larger than what the filter is applied to, 10% more on
+// every side by default, and may be mostly off screen.  Much of the
+// work is transparent pixels being blurred, offset and composited
+// into more transparent pixels.
+//
+// Before a program is run, this works out which pixels of each
+// result can make any difference.  Two things decide it:
+//  - What's needed.  Going backward from the final result, which is
+//    only needed where it can be seen, each primitive needs its
+//    inputs over what it writes, grown by how far it reaches, and
+//    shifted by how far it moves them; a blur's radius, a morphology
+//    radius, a convolution kernel, an offset.  Nothing outside a
+//    primitive's subregion is needed from it.
+//  - What's there.  Going forward from the source graphic, whose
+//    pixels are measured, a result can only be non-transparent where
+//    its inputs were, grown and shifted the same way.  Flood, and the
+//    few others that make something out of nothing, fill their whole
+//    subregion.
+// A program is run over one rectangle, holding what's both needed
+// and there, for every result.  Outside of it, every result is either
+// transparent, or doesn't matter.
+//
+// Lighting, turbulence, feImage and feTile place what they make by
+// the whole filter region, and a convolution that duplicates or wraps
+// its edges reads the edges of it.  A program with any of those isn't
+// cropped, and runs over the whole region, as before.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <unordered_map>
+
+#include "filter_program_exec.h"
+#include "filter_fegaussian.h"
+
+
+namespace waavs
+{
+    // filterAlphaBounds()
+    //
+    // The smallest rectangle holding every pixel of 'img' that isn't
+    // fully transparent.  Returns false if there are none.  When
+    // 'within' is given, only that part of 'img' is looked at; it's
+    // for when it's already known nothing was drawn outside of it.
+    static INLINE bool filterAlphaBounds(const Surface& img, WGRectI& out, const WGRectI* within = nullptr) noexcept
+    {
+        out = {};
+
+        int left = 0;
+        int top = 0;
+        int right = int(img.width());
+        int bottom = int(img.height());
+
+        if (within)
+        {
+            left = std::max(left, within->x);
+            top = std::max(top, within->y);
+            right = std::min(right, within->x + within->w);
+            bottom = std::min(bottom, within->y + within->h);
+        }
+
+        if (right <= left || bottom <= top)
+            return false;
+
+        int x0 = right;
+        int y0 = bottom;
+        int x1 = left - 1;
+        int y1 = top - 1;
+
+        for (int y = top; y < bottom; ++y)
+        {
+            const uint32_t* row = (const uint32_t*)img.rowPointer((size_t)y);
+
+            int first = -1;
+            for (int x = left; x < right; ++x)
+            {
+                if (row[x] & 0xFF000000u)
+                {
+                    first = x;
+                    break;
+                }
+            }
+
+            if (first < 0)
+                continue;
+
+            // Only what's past the right edge so far can move it
+            int last = first;
+            for (int x = right - 1; x > first && x > x1; --x)
+            {
+                if (row[x] & 0xFF000000u)
+                {
+                    last = x;
+                    break;
+                }
+            }
+
+            if (first < x0) x0 = first;
+            if (last > x1) x1 = last;
+            if (y < y0) y0 = y;
+            y1 = y;
+        }
+
+        if (x1 < left)
+            return false;
+
+        out = WGRectI{ x0, y0, x1 - x0 + 1, y1 - y0 + 1 };
+        return true;
+    }
+
+
+    //
+    // FilterRegionAnalysis
+    //
+    // Walks a program without running it, building a graph of its
+    // results, which inputs each one reads, and how.  Rectangles are in
+    // pixels, relative to the corner of the whole filter region.
+    //
+    struct FilterRegionAnalysis : FilterProgramExecutor
+    {
+        static constexpr size_t kSourceNode = 0;        // SourceGraphic, SourceAlpha
+        static constexpr size_t kBackgroundNode = 1;    // BackgroundImage, BackgroundAlpha
+
+        // How a result reads one of its inputs.  Pixel (x, y) of the
+        // result reads the input around (x - fShiftX, y - fShiftY), up
+        // to (fHaloX, fHaloY) away.
+        struct Edge
+        {
+            size_t fNode{ 0 };
+            int fShiftX{ 0 };
+            int fShiftY{ 0 };
+            int fHaloX{ 0 };
+            int fHaloY{ 0 };
+            bool fCarriesExtent{ true };    // false when the input only steers, like a displacement map
+        };
+
+        struct Node
+        {
+            WGRectI fArea{};                // what the primitive writes
+            bool fGenerates{ false };       // fills its area, whatever its inputs
+            uint32_t fFirstEdge{ 0 };
+            uint32_t fEdgeCount{ 0 };
+
+            WGRectI fNeeded{};              // where the result can make a difference
+            WGRectI fExtent{};              // where the result can be non-transparent
+        };
+
+        FilterSpace fSpace{};
+        WGRectI fFullPX{};
+
+        std::vector<Node> fNodes{};
+        std::vector<Edge> fEdges{};
+        std::unordered_map<InternedKey, size_t, InternedKeyHash, InternedKeyEquivalent> fKeyNodes{};
+        size_t fLastNode{ kSourceNode };
+        bool fCroppable{ true };
+
+
+        // analyze()
+        //
+        // Build the graph for 'program', and work out what's needed of
+        // each result, for the final one to be right over 'visiblePX'.
+        // Returns false if the program can't be cropped.
+        bool analyze(const FilterProgramStream& program,
+            const FilterRunState& run,
+            const FilterSpace& space,
+            const WGRectI& visiblePX) noexcept
+        {
+            fRunState = run;
+            fSpace = space;
+            fFullPX = WGRectI{ 0, 0, space.filterRectPX.w, space.filterRectPX.h };
+
+            fNodes.clear();
+            fEdges.clear();
+            fKeyNodes.clear();
+            fCroppable = true;
+
+            Node whole{};
+            whole.fArea = fFullPX;
+            fNodes.push_back(whole);
+            fNodes.push_back(whole);
+            fLastNode = kSourceNode;
+
+            if (!executeImpl(program))
+                fCroppable = false;
+
+            if (!fCroppable)
+                return false;
+
+            fNodes[fLastNode].fNeeded = intersection(visiblePX, fFullPX);
+
+            for (size_t i = fNodes.size(); i-- > 2; )
+            {
+                const Node& node = fNodes[i];
+
+                const WGRectI out = intersection(node.fNeeded, node.fArea);
+                if (!wg_rectI_is_valid(out))
+                    continue;
+
+                for (uint32_t e = 0; e < node.fEdgeCount; ++e)
+                {
+                    const Edge& edge = fEdges[node.fFirstEdge + e];
+                    Node& in = fNodes[edge.fNode];
+
+                    in.fNeeded = wg_rectI_union(in.fNeeded, intersection(readRect(out, edge), fFullPX));
+                }
+            }
+
+            return true;
+        }
+
+        // sourceNeeded()
+        //
+        // Where the source graphic is needed, which is all of it that
+        // needs drawing
+        const WGRectI& sourceNeeded() const noexcept { return fNodes[kSourceNode].fNeeded; }
+
+        // workingRect()
+        //
+        // Given where the source graphic has anything, the rectangle
+        // the program needs to be run over.  Empty if nothing it
+        // makes can be seen.
+        WGRectI workingRect(const WGRectI& sourceExtentPX) noexcept
+        {
+            fNodes[kSourceNode].fExtent = intersection(sourceExtentPX, fFullPX);
+            fNodes[kBackgroundNode].fExtent = fFullPX;
+
+            WGRectI work{};
+
+            for (size_t i = 2; i < fNodes.size(); ++i)
+            {
+                Node& node = fNodes[i];
+
+                const WGRectI out = intersection(node.fNeeded, node.fArea);
+                WGRectI extent{};
+
+                for (uint32_t e = 0; e < node.fEdgeCount; ++e)
+                {
+                    const Edge& edge = fEdges[node.fFirstEdge + e];
+                    const WGRectI reach = wg_rectI_inflate(fNodes[edge.fNode].fExtent, edge.fHaloX, edge.fHaloY);
+
+                    if (edge.fCarriesExtent && wg_rectI_is_valid(fNodes[edge.fNode].fExtent))
+                        extent = wg_rectI_union(extent, WGRectI{ reach.x + edge.fShiftX, reach.y + edge.fShiftY, reach.w, reach.h });
+
+                    // What a blur, or morphology, keeps between passes
+                    if (wg_rectI_is_valid(out))
+                        work = wg_rectI_union(work, intersection(readRect(out, edge), reach));
+                }
+
+                node.fExtent = node.fGenerates ? node.fArea : intersection(extent, node.fArea);
+            }
+
+            for (const Node& node : fNodes)
+                work = wg_rectI_union(work, intersection(node.fNeeded, node.fExtent));
+
+            if (!wg_rectI_is_valid(work))
+                return WGRectI{};
+
+            // Box blurs, and morphology, clamp to the edge of a surface.
+            // A ring of transparent pixels around the working rectangle
+            // has them see what they would have in the whole region.
+            return intersection(wg_rectI_inflate(work, 1, 1), fFullPX);
+        }
+
+
+        // --------------------------------------------------------
+        // Helpers
+        // --------------------------------------------------------
+
+        static WGRectI readRect(const WGRectI& out, const Edge& edge) noexcept
+        {
+            return WGRectI{
+                out.x - edge.fShiftX - edge.fHaloX,
+                out.y - edge.fShiftY - edge.fHaloY,
+                out.w + 2 * edge.fHaloX,
+                out.h + 2 * edge.fHaloY };
+        }
+
+        // Which result a key reads, the same way the executor finds images
+        size_t inputNode(InternedKey key) const noexcept
+        {
+            if (!key || key == filter::Filter_Last())
+                return fLastNode;
+
+            auto it = fKeyNodes.find(key);
+            if (it != fKeyNodes.end())
+                return it->second;
+
+            if (key == filter::SourceGraphic() || key == filter::SourceAlpha())
+                return kSourceNode;
+
+            if (key == filter::BackgroundImage() || key == filter::BackgroundAlpha())
+                return kBackgroundNode;
+
+            return fLastNode;
+        }
+
+        double primitiveLengthToUser(double v, double range) const noexcept
+        {
+            return (fRunState.primitiveUnits == SpaceUnitsKind::SVG_SPACE_OBJECT) ? v * range : v;
+        }
+
+        // The combined radius of the box blurs approximating a gaussian
+        static int gaussSpread(double sigmaPx) noexcept
+        {
+            int boxes[3] = { 1, 1, 1 };
+            boxesForGauss(sigmaPx, 3, boxes);
+
+            int spread = 0;
+            for (int i = 0; i < 3; ++i)
+                spread += (boxes[i] - 1) / 2;
+
+            return spread > 0 ? spread : 0;
+        }
+
+        void beginNode(const WGRectI& area, bool generates = false)
+        {
+            Node node{};
+            node.fArea = intersection(area, fFullPX);
+            node.fGenerates = generates;
+            node.fFirstEdge = uint32_t(fEdges.size());
+
+            fNodes.push_back(node);
+        }
+
+        void beginNode(const FilterPrimitiveSubregion& subr, bool generates = false)
+        {
+            beginNode(filterUserRectToPixels(fSpace, resolveFilterSubregionUS(fRunState, subr)), generates);
+        }
+
+        void addEdge(InternedKey in, int shiftX = 0, int shiftY = 0, int haloX = 0, int haloY = 0, bool carriesExtent = true)
+        {
+            Edge edge{};
+            edge.fNode = inputNode(in);
+            edge.fShiftX = shiftX;
+            edge.fShiftY = shiftY;
+            edge.fHaloX = haloX;
+            edge.fHaloY = haloY;
+            edge.fCarriesExtent = carriesExtent;
+
+            fEdges.push_back(edge);
+            fNodes.back().fEdgeCount++;
+        }
+
+        bool endNode(const FilterIO& io)
+        {
+            const size_t node = fNodes.size() - 1;
+            const InternedKey outKey = (io.hasOut && io.out) ? io.out : filter::Filter_Last();
+
+            fKeyNodes[outKey] = node;
+            fLastNode = node;
+
+            return true;
+        }
+
+        // Can't be cropped, but keep walking, so the program is still
+        // checked through to the end
+        bool uncroppable() noexcept
+        {
+            fCroppable = false;
+            return true;
+        }
+
+
+        // --------------------------------------------------------
+        // FilterProgramExecutor hooks
+        // --------------------------------------------------------
+
+        bool onGaussianBlur(const FilterIO& io, const FilterPrimitiveSubregion& subr, float sx, float sy) noexcept override
+        {
+            const double sxPx = primitiveLengthToUser(sx > 0.0f ? sx : 0.0, fRunState.objectBBoxUS.w) * std::abs(fSpace.sx);
+            const double syPx = primitiveLengthToUser(sy > 0.0f ? sy : 0.0, fRunState.objectBBoxUS.h) * std::abs(fSpace.sy);
+
+            const int rx = gaussSpread(sxPx);
+            const int ry = gaussSpread(syPx);
+
+            beginNode(subr);
+            addEdge(io.in1, 0, 0, rx, ry);
+            return endNode(io);
+        }
+
+        bool onOffset(const FilterIO& io, const FilterPrimitiveSubregion& subr, float dx, float dy) noexcept override
+        {
+            const double dxUS = primitiveLengthToUser(dx, fRunState.objectBBoxUS.w);
+            const double dyUS = primitiveLengthToUser(dy, fRunState.objectBBoxUS.h);
+
+            const WGMatrix3x3& m = fSpace.ctm;
+            const int offX = int(std::lround(dxUS * m.m00 + dyUS * m.m10));
+            const int offY = int(std::lround(dxUS * m.m01 + dyUS * m.m11));
+
+            beginNode(subr);
+            addEdge(io.in1, offX, offY);
+            return endNode(io);
+        }
+
+        bool onBlend(const FilterIO& io, const FilterPrimitiveSubregion& subr, FilterBlendMode) noexcept override
+        {
+            beginNode(subr);
+            addEdge(io.in1);
+            addEdge(io.in2);
+            return endNode(io);
+        }
+
+        bool onComposite(const FilterIO& io, const FilterPrimitiveSubregion& subr,
+            FilterCompositeOp op, float, float, float, float k4) noexcept override
+        {
+            beginNode(subr, op == FILTER_COMPOSITE_ARITHMETIC && k4 > 0.0f);
+            addEdge(io.in1);
+            addEdge(io.in2);
+            return endNode(io);
+        }
+
+        bool onColorMatrix(const FilterIO& io, const FilterPrimitiveSubregion& subr,
+            FilterColorMatrixType type, float, F32Span matrix) noexcept override
+        {
+            // Only a full matrix can add alpha where there was none
+            const bool generates = (type == FILTER_COLOR_MATRIX_MATRIX) &&
+                (!matrix.p || matrix.n < 20 || matrix.p[19] > 0.0f);
+
+            beginNode(subr, generates);
+            addEdge(io.in1);
+            return endNode(io);
+        }
+
+        bool onComponentTransfer(const FilterIO& io, const FilterPrimitiveSubregion& subr,
+            const ComponentFunc&, const ComponentFunc&, const ComponentFunc&,
+            const ComponentFunc& a) noexcept override
+        {
+            beginNode(subr, a.type != FILTER_TRANSFER_IDENTITY);
+            addEdge(io.in1);
+            return endNode(io);
+        }
+
+        bool onConvolveMatrix(const FilterIO& io, const FilterPrimitiveSubregion& subr,
+            uint32_t orderX, uint32_t orderY, F32Span, float, float bias,
+            uint32_t targetX, uint32_t targetY, FilterEdgeMode edgeMode,
+            float, float, bool preserveAlpha) noexcept override
+        {
+            if (edgeMode != FILTER_EDGE_NONE)
+                return uncroppable();
+
+            // The kernel reaches from target - (order - 1) to target
+            const int haloX = std::max(int(targetX), int(orderX) - 1 - int(targetX));
+            const int haloY = std::max(int(targetY), int(orderY) - 1 - int(targetY));
+
+            beginNode(subr, bias > 0.0f && !preserveAlpha);
+            addEdge(io.in1, 0, 0, haloX, haloY);
+            return endNode(io);
+        }
+
+        bool onDisplacementMap(const FilterIO& io, const FilterPrimitiveSubregion& subr,
+            float scale, FilterChannelSelector, FilterChannelSelector) noexcept override
+        {
+            double scaleUS = double(scale);
+            if (fRunState.primitiveUnits == SpaceUnitsKind::SVG_SPACE_OBJECT)
+                scaleUS *= 0.5 * (fRunState.objectBBoxUS.w + fRunState.objectBBoxUS.h);
+
+            // Displaced by up to half the scale, and sampled between pixels
+            const int haloX = int(std::ceil(std::abs(scaleUS * fSpace.sx) * 0.5)) + 1;
+            const int haloY = int(std::ceil(std::abs(scaleUS * fSpace.sy) * 0.5)) + 1;
+
+            beginNode(subr);
+            addEdge(io.in1, 0, 0, haloX, haloY);
+            addEdge(io.in2, 0, 0, 0, 0, false);
+            return endNode(io);
+        }
+
+        bool onFlood(const FilterIO& io, const FilterPrimitiveSubregion& subr, const ColorSRGB&) noexcept override
+        {
+            beginNode(subr, true);
+            return endNode(io);
+        }
+
+        bool onMerge(const FilterIO& io, const FilterPrimitiveSubregion& subr, KeySpan inputs) noexcept override
+        {
+            if (!inputs.n)
+                return true;
+
+            beginNode(subr);
+            for (uint32_t i = 0; i < inputs.n; ++i)
+                addEdge(inputs.p[i]);
+
+            return endNode(io);
+        }
+
+        bool onMorphology(const FilterIO& io, const FilterPrimitiveSubregion& subr,
+            FilterMorphologyOp, float rx, float ry) noexcept override
+        {
+            const double rxUS = primitiveLengthToUser(rx, fRunState.objectBBoxUS.w);
+            const double ryUS = primitiveLengthToUser(ry, fRunState.objectBBoxUS.h);
+
+            int rpx = (int)std::floor(rxUS * fSpace.sx + 0.5);
+            int rpy = (int)std::floor(ryUS * fSpace.sy + 0.5);
+
+            if (rpx < 0) rpx = 0;
+            if (rpy < 0) rpy = 0;
+
+            beginNode(subr);
+            addEdge(io.in1, 0, 0, rpx, rpy);
+            return endNode(io);
+        }
+
+        bool onDropShadow(const FilterIO& io, const FilterPrimitiveSubregion&,
+            float dx, float dy, float sx, float sy, ColorSRGB) noexcept override
+        {
+            const double stdXPx = primitiveLengthToUser(sx, fRunState.objectBBoxUS.w) * fSpace.sx;
+            const double stdYPx = primitiveLengthToUser(sy, fRunState.objectBBoxUS.h) * fSpace.sy;
+
+            int spreadX = 0;
+            int spreadY = 0;
+            if (stdXPx > 0.0 || stdYPx > 0.0)
+            {
+                spreadX = gaussSpread(stdXPx);
+                spreadY = gaussSpread(stdYPx);
+            }
+
+            const double dxUS = primitiveLengthToUser(dx, fRunState.objectBBoxUS.w);
+            const double dyUS = primitiveLengthToUser(dy, fRunState.objectBBoxUS.h);
+
+            const WGMatrix3x3& m = fSpace.ctm;
+            const int offX = int(std::floor(dxUS * m.m00 + dyUS * m.m10 + 0.5));
+            const int offY = int(std::floor(dxUS * m.m01 + dyUS * m.m11 + 0.5));
+
+            // The shadow, and the input over it, land outside the
+            // subregion too
+            beginNode(fFullPX);
+            addEdge(io.in1);
+            addEdge(io.in1, offX, offY, spreadX, spreadY);
+            return endNode(io);
+        }
+
+        bool onImage(const FilterIO&, const FilterPrimitiveSubregion&,
+            InternedKey, AspectRatioAlignKind, AspectRatioMeetOrSliceKind) noexcept override
+        {
+            return uncroppable();
+        }
+
+        bool onTile(const FilterIO&, const FilterPrimitiveSubregion&) noexcept override
+        {
+            return uncroppable();
+        }
+
+        bool onTurbulence(const FilterIO&, const FilterPrimitiveSubregion&,
+            FilterTurbulenceType, float, float, uint32_t, float, bool) noexcept override
+        {
+            return uncroppable();
+        }
+
+        bool onDiffuseLighting(const FilterIO&, const FilterPrimitiveSubregion&,
+            const ColorSRGB&, float, float, float, float, uint32_t, const LightPayload&) noexcept override
+        {
+            return uncroppable();
+        }
+
+        bool onSpecularLighting(const FilterIO&, const FilterPrimitiveSubregion&,
+            const ColorSRGB&, float, float, float, float, float, uint32_t, const LightPayload&) noexcept override
+        {
+            return uncroppable();
+        }
+    };
+}
@@ -116,54 +116,54 @@ namespace waavs::filter
     // --------------------------------------------------------
     // Common filter keys
     // --------------------------------------------------------
-    INLINE InternedKey color_interpolation_filters() noexcept { static InternedKey k = PSNameTable::INTERN("color-interpolation-filters"); return k; }
-    INLINE InternedKey kColorInterp_linearRGB() noexcept { static InternedKey k = PSNameTable::INTERN("linearRGB"); return k; }
-    INLINE InternedKey kColorInterp_sRGB()      noexcept { static InternedKey k = PSNameTable::INTERN("sRGB");      return k; }
+    INLINE InternedKey color_interpolation_filters() noexcept { static constexpr InternedKey k = svgStaticAtom("color-interpolation-filters"); return k; }
+    INLINE InternedKey kColorInterp_linearRGB() noexcept { static constexpr InternedKey k = svgStaticAtom("linearRGB"); return k; }
+    INLINE InternedKey kColorInterp_sRGB()      noexcept { static constexpr InternedKey k = svgStaticAtom("sRGB");      return k; }
 
 
     // Common filter primitive keys
-    INLINE InternedKey SourceGraphic() noexcept { static InternedKey k = PSNameTable::INTERN("SourceGraphic"); return k; }
-    INLINE InternedKey SourceAlpha() noexcept { static InternedKey k = PSNameTable::INTERN("SourceAlpha"); return k; }
-    INLINE InternedKey BackgroundImage() noexcept { static InternedKey k = PSNameTable::INTERN("BackgroundImage"); return k; }
-    INLINE InternedKey BackgroundAlpha() noexcept { static InternedKey k = PSNameTable::INTERN("BackgroundAlpha"); return k; }
-    INLINE InternedKey Filter_Last() noexcept { static InternedKey k = PSNameTable::INTERN("__last__"); return k; }
+    INLINE InternedKey SourceGraphic() noexcept { static constexpr InternedKey k = svgStaticAtom("SourceGraphic"); return k; }
+    INLINE InternedKey SourceAlpha() noexcept { static constexpr InternedKey k = svgStaticAtom("SourceAlpha"); return k; }
+    INLINE InternedKey BackgroundImage() noexcept { static constexpr InternedKey k = svgStaticAtom("BackgroundImage"); return k; }
+    INLINE InternedKey BackgroundAlpha() noexcept { static constexpr InternedKey k = svgStaticAtom("BackgroundAlpha"); return k; }
+    INLINE InternedKey Filter_Last() noexcept { static constexpr InternedKey k = svgStaticAtom("__last__"); return k; }
 
 
     // all filter primitives have these common attributes
-    inline InternedKey in() { static InternedKey k = PSNameTable::INTERN("in"); return k; }
-    inline InternedKey in2() { static InternedKey k = PSNameTable::INTERN("in2"); return k; }
-    inline InternedKey result() { static InternedKey k = PSNameTable::INTERN("result"); return k; }
+    inline InternedKey in() { static constexpr InternedKey k = svgStaticAtom("in"); return k; }
+    inline InternedKey in2() { static constexpr InternedKey k = svgStaticAtom("in2"); return k; }
+    inline InternedKey result() { static constexpr InternedKey k = svgStaticAtom("result"); return k; }
 
     // feGaussianBlur
-    inline InternedKey stdDeviation() { static InternedKey k = PSNameTable::INTERN("stdDeviation"); return k; }
+    inline InternedKey stdDeviation() { static constexpr InternedKey k = svgStaticAtom("stdDeviation"); return k; }
 
-    inline InternedKey flood_color() { static InternedKey k = PSNameTable::INTERN("flood-color"); return k; }
-    inline InternedKey flood_opacity() { static InternedKey k = PSNameTable::INTERN("flood-opacity"); return k; }
+    inline InternedKey flood_color() { static constexpr InternedKey k = svgStaticAtom("flood-color"); return k; }
+    inline InternedKey flood_opacity() { static constexpr InternedKey k = svgStaticAtom("flood-opacity"); return k; }
 
     // feOffset
-    inline InternedKey feOffset_dx() { static InternedKey k = PSNameTable::INTERN("dx"); return k; }
-    inline InternedKey feOffset_dy() { static InternedKey k = PSNameTable::INTERN("dy"); return k; }
+    inline InternedKey feOffset_dx() { static constexpr InternedKey k = svgStaticAtom("dx"); return k; }
+    inline InternedKey feOffset_dy() { static constexpr InternedKey k = svgStaticAtom("dy"); return k; }
 
     // feColorMatrix
-    inline InternedKey type_() { static InternedKey k = PSNameTable::INTERN("type"); return k; }
-    inline InternedKey values() { static InternedKey k = PSNameTable::INTERN("values"); return k; }
+    inline InternedKey type_() { static constexpr InternedKey k = svgStaticAtom("type"); return k; }
+    inline InternedKey values() { static constexpr InternedKey k = svgStaticAtom("values"); return k; }
 
     // feBlend
-    inline InternedKey mode() { static InternedKey k = PSNameTable::INTERN("mode"); return k; }
+    inline InternedKey mode() { static constexpr InternedKey k = svgStaticAtom("mode"); return k; }
     
     // feBlend modes 
-    INLINE InternedKey kBlend_normal()   noexcept { static InternedKey k = PSNameTable::INTERN("normal");   return k; }
-    INLINE InternedKey kBlend_multiply() noexcept { static InternedKey k = PSNameTable::INTERN("multiply"); return k; }
-    INLINE InternedKey kBlend_screen()   noexcept { static InternedKey k = PSNameTable::INTERN("screen");   return k; }
-    INLINE InternedKey kBlend_overlay()  noexcept { static InternedKey k = PSNameTable::INTERN("overlay");  return k; }
-    INLINE InternedKey kBlend_darken()   noexcept { static InternedKey k = PSNameTable::INTERN("darken");   return k; }
-    INLINE InternedKey kBlend_lighten()  noexcept { static InternedKey k = PSNameTable::INTERN("lighten");  return k; }
-    INLINE InternedKey kBlend_color_dodge() noexcept { static InternedKey k = PSNameTable::INTERN("color-dodge"); return k; }
-    INLINE InternedKey kBlend_color_burn()   noexcept { static InternedKey k = PSNameTable::INTERN("color-burn");   return k; }
-    INLINE InternedKey kBlend_hard_light()  noexcept { static InternedKey k = PSNameTable::INTERN("hard-light");  return k; }
-    INLINE InternedKey kBlend_soft_light()  noexcept { static InternedKey k = PSNameTable::INTERN("soft-light");  return k; }
-    INLINE InternedKey kBlend_difference()  noexcept { static InternedKey k = PSNameTable::INTERN("difference");  return k; }
-    INLINE InternedKey kBlend_exclusion()   noexcept { static InternedKey k = PSNameTable::INTERN("exclusion");   return k; }
+    INLINE InternedKey kBlend_normal()   noexcept { static constexpr InternedKey k = svgStaticAtom("normal");   return k; }
+    INLINE InternedKey kBlend_multiply() noexcept { static constexpr InternedKey k = svgStaticAtom("multiply"); return k; }
+    INLINE InternedKey kBlend_screen()   noexcept { static constexpr InternedKey k = svgStaticAtom("screen");   return k; }
+    INLINE InternedKey kBlend_overlay()  noexcept { static constexpr InternedKey k = svgStaticAtom("overlay");  return k; }
+    INLINE InternedKey kBlend_darken()   noexcept { static constexpr InternedKey k = svgStaticAtom("darken");   return k; }
+    INLINE InternedKey kBlend_lighten()  noexcept { static constexpr InternedKey k = svgStaticAtom("lighten");  return k; }
+    INLINE InternedKey kBlend_color_dodge() noexcept { static constexpr InternedKey k = svgStaticAtom("color-dodge"); return k; }
+    INLINE InternedKey kBlend_color_burn()   noexcept { static constexpr InternedKey k = svgStaticAtom("color-burn");   return k; }
+    INLINE InternedKey kBlend_hard_light()  noexcept { static constexpr InternedKey k = svgStaticAtom("hard-light");  return k; }
+    INLINE InternedKey kBlend_soft_light()  noexcept { static constexpr InternedKey k = svgStaticAtom("soft-light");  return k; }
+    INLINE InternedKey kBlend_difference()  noexcept { static constexpr InternedKey k = svgStaticAtom("difference");  return k; }
+    INLINE InternedKey kBlend_exclusion()   noexcept { static constexpr InternedKey k = svgStaticAtom("exclusion");   return k; }
 
 
 
@@ -182,95 +182,95 @@ namespace waavs::filter
 
 
     // feComposite
-    inline InternedKey operator_() { static InternedKey k = PSNameTable::INTERN("operator"); return k; }
-    inline InternedKey k1() { static InternedKey k = PSNameTable::INTERN("k1"); return k; }
-    inline InternedKey k2() { static InternedKey k = PSNameTable::INTERN("k2"); return k; }
-    inline InternedKey k3() { static InternedKey k = PSNameTable::INTERN("k3"); return k; }
-    inline InternedKey k4() { static InternedKey k = PSNameTable::INTERN("k4"); return k; }
+    inline InternedKey operator_() { static constexpr InternedKey k = svgStaticAtom("operator"); return k; }
+    inline InternedKey k1() { static constexpr InternedKey k = svgStaticAtom("k1"); return k; }
+    inline InternedKey k2() { static constexpr InternedKey k = svgStaticAtom("k2"); return k; }
+    inline InternedKey k3() { static constexpr InternedKey k = svgStaticAtom("k3"); return k; }
+    inline InternedKey k4() { static constexpr InternedKey k = svgStaticAtom("k4"); return k; }
 
     // feComposite operator values
-    INLINE InternedKey kCompOp_over()       noexcept { static InternedKey k = PSNameTable::INTERN("over");       return k; }
-    INLINE InternedKey kCompOp_in()         noexcept { static InternedKey k = PSNameTable::INTERN("in");         return k; }
-    INLINE InternedKey kCompOp_out()        noexcept { static InternedKey k = PSNameTable::INTERN("out");        return k; }
-    INLINE InternedKey kCompOp_atop()       noexcept { static InternedKey k = PSNameTable::INTERN("atop");       return k; }
-    INLINE InternedKey kCompOp_xor()        noexcept { static InternedKey k = PSNameTable::INTERN("xor");        return k; }
-    INLINE InternedKey kCompOp_arithmetic() noexcept { static InternedKey k = PSNameTable::INTERN("arithmetic"); return k; }
+    INLINE InternedKey kCompOp_over()       noexcept { static constexpr InternedKey k = svgStaticAtom("over");       return k; }
+    INLINE InternedKey kCompOp_in()         noexcept { static constexpr InternedKey k = svgStaticAtom("in");         return k; }
+    INLINE InternedKey kCompOp_out()        noexcept { static constexpr InternedKey k = svgStaticAtom("out");        return k; }
+    INLINE InternedKey kCompOp_atop()       noexcept { static constexpr InternedKey k = svgStaticAtom("atop");       return k; }
+    INLINE InternedKey kCompOp_xor()        noexcept { static constexpr InternedKey k = svgStaticAtom("xor");        return k; }
+    INLINE InternedKey kCompOp_arithmetic() noexcept { static constexpr InternedKey k = svgStaticAtom("arithmetic"); return k; }
 
     // feComponentTransfer / feFunc*
-    inline InternedKey tableValues() { static InternedKey k = PSNameTable::INTERN("tableValues"); return k; }
-    inline InternedKey slope() { static InternedKey k = PSNameTable::INTERN("slope"); return k; }
-    inline InternedKey intercept() { static InternedKey k = PSNameTable::INTERN("intercept"); return k; }
-    inline InternedKey amplitude() { static InternedKey k = PSNameTable::INTERN("amplitude"); return k; }
-    inline InternedKey exponent() { static InternedKey k = PSNameTable::INTERN("exponent"); return k; }
-    inline InternedKey offset() { static InternedKey k = PSNameTable::INTERN("offset"); return k; }
-
-    inline InternedKey feFuncR() { static InternedKey k = PSNameTable::INTERN("feFuncR"); return k; }
-    inline InternedKey feFuncG() { static InternedKey k = PSNameTable::INTERN("feFuncG"); return k; }
-    inline InternedKey feFuncB() { static InternedKey k = PSNameTable::INTERN("feFuncB"); return k; }
-    inline InternedKey feFuncA() { static InternedKey k = PSNameTable::INTERN("feFuncA"); return k; }
+    inline InternedKey tableValues() { static constexpr InternedKey k = svgStaticAtom("tableValues"); return k; }
+    inline InternedKey slope() { static constexpr InternedKey k = svgStaticAtom("slope"); return k; }
+    inline InternedKey intercept() { static constexpr InternedKey k = svgStaticAtom("intercept"); return k; }
+    inline InternedKey amplitude() { static constexpr InternedKey k = svgStaticAtom("amplitude"); return k; }
+    inline InternedKey exponent() { static constexpr InternedKey k = svgStaticAtom("exponent"); return k; }
+    inline InternedKey offset() { static constexpr InternedKey k = svgStaticAtom("offset"); return k; }
+
+    inline InternedKey feFuncR() { static constexpr InternedKey k = svgStaticAtom("feFuncR"); return k; }
+    inline InternedKey feFuncG() { static constexpr InternedKey k = svgStaticAtom("feFuncG"); return k; }
+    inline InternedKey feFuncB() { static constexpr InternedKey k = svgStaticAtom("feFuncB"); return k; }
+    inline InternedKey feFuncA() { static constexpr InternedKey k = svgStaticAtom("feFuncA"); return k; }
     
     
-    static InternedKey kIdentity = PSNameTable::INTERN("identity");
-    static InternedKey kTable = PSNameTable::INTERN("table");
-    static InternedKey kDiscrete = PSNameTable::INTERN("discrete");
-    static InternedKey kLinear = PSNameTable::INTERN("linear");
-    static InternedKey kGamma = PSNameTable::INTERN("gamma");
+    static constexpr InternedKey kIdentity = svgStaticAtom("identity");
+    static constexpr InternedKey kTable = svgStaticAtom("table");
+    static constexpr InternedKey kDiscrete = svgStaticAtom("discrete");
+    static constexpr InternedKey kLinear = svgStaticAtom("linear");
+    static constexpr InternedKey kGamma = svgStaticAtom("gamma");
 
     // feConvolveMatrix
-    inline InternedKey order() { static InternedKey k = PSNameTable::INTERN("order"); return k; }
-    inline InternedKey kernelMatrix() { static InternedKey k = PSNameTable::INTERN("kernelMatrix"); return k; }
-    inline InternedKey divisor() { static InternedKey k = PSNameTable::INTERN("divisor"); return k; }
-    inline InternedKey bias() { static InternedKey k = PSNameTable::INTERN("bias"); return k; }
-    inline InternedKey targetX() { static InternedKey k = PSNameTable::INTERN("targetX"); return k; }
-    inline InternedKey targetY() { static InternedKey k = PSNameTable::INTERN("targetY"); return k; }
-    inline InternedKey edgeMode() { static InternedKey k = PSNameTable::INTERN("edgeMode"); return k; }
-    inline InternedKey kernelUnitLength() { static InternedKey k = PSNameTable::INTERN("kernelUnitLength"); return k; }
-    inline InternedKey preserveAlpha() { static InternedKey k = PSNameTable::INTERN("preserveAlpha"); return k; }
+    inline InternedKey order() { static constexpr InternedKey k = svgStaticAtom("order"); return k; }
+    inline InternedKey kernelMatrix() { static constexpr InternedKey k = svgStaticAtom("kernelMatrix"); return k; }
+    inline InternedKey divisor() { static constexpr InternedKey k = svgStaticAtom("divisor"); return k; }
+    inline InternedKey bias() { static constexpr InternedKey k = svgStaticAtom("bias"); return k; }
+    inline InternedKey targetX() { static constexpr InternedKey k = svgStaticAtom("targetX"); return k; }
+    inline InternedKey targetY() { static constexpr InternedKey k = svgStaticAtom("targetY"); return k; }
+    inline InternedKey edgeMode() { static constexpr InternedKey k = svgStaticAtom("edgeMode"); return k; }
+    inline InternedKey kernelUnitLength() { static constexpr InternedKey k = svgStaticAtom("kernelUnitLength"); return k; }
+    inline InternedKey preserveAlpha() { static constexpr InternedKey k = svgStaticAtom("preserveAlpha"); return k; }
 
     // feDisplacementMap
-    inline InternedKey scale() { static InternedKey k = PSNameTable::INTERN("scale"); return k; }
-    inline InternedKey xChannelSelector() { static InternedKey k = PSNameTable::INTERN("xChannelSelector"); return k; }
-    inline InternedKey yChannelSelector() { static InternedKey k = PSNameTable::INTERN("yChannelSelector"); return k; }
+    inline InternedKey scale() { static constexpr InternedKey k = svgStaticAtom("scale"); return k; }
+    inline InternedKey xChannelSelector() { static constexpr InternedKey k = svgStaticAtom("xChannelSelector"); return k; }
+    inline InternedKey yChannelSelector() { static constexpr InternedKey k = svgStaticAtom("yChannelSelector"); return k; }
 
     // feTurbulence
-    inline InternedKey baseFrequency() { static InternedKey k = PSNameTable::INTERN("baseFrequency"); return k; }
-    inline InternedKey numOctaves() { static InternedKey k = PSNameTable::INTERN("numOctaves"); return k; }
-    inline InternedKey seed() { static InternedKey k = PSNameTable::INTERN("seed"); return k; }
-    inline InternedKey stitchTiles() { static InternedKey k = PSNameTable::INTERN("stitchTiles"); return k; }
+    inline InternedKey baseFrequency() { static constexpr InternedKey k = svgStaticAtom("baseFrequency"); return k; }
+    inline InternedKey numOctaves() { static constexpr InternedKey k = svgStaticAtom("numOctaves"); return k; }
+    inline InternedKey seed() { static constexpr InternedKey k = svgStaticAtom("seed"); return k; }
+    inline InternedKey stitchTiles() { static constexpr InternedKey k = svgStaticAtom("stitchTiles"); return k; }
 
     // lighting
-    inline InternedKey surfaceScale() { static InternedKey k = PSNameTable::INTERN("surfaceScale"); return k; }
-    inline InternedKey diffuseConstant() { static InternedKey k = PSNameTable::INTERN("diffuseConstant"); return k; }
-    inline InternedKey specularConstant() { static InternedKey k = PSNameTable::INTERN("specularConstant"); return k; }
-    inline InternedKey specularExponent() { static InternedKey k = PSNameTable::INTERN("specularExponent"); return k; }
-    inline InternedKey lighting_color() { static InternedKey k = PSNameTable::INTERN("lighting-color"); return k; }
-
-    inline InternedKey azimuth() { static InternedKey k = PSNameTable::INTERN("azimuth"); return k; }
-    inline InternedKey elevation() { static InternedKey k = PSNameTable::INTERN("elevation"); return k; }
-    inline InternedKey pointsAtX() { static InternedKey k = PSNameTable::INTERN("pointsAtX"); return k; }
-    inline InternedKey pointsAtY() { static InternedKey k = PSNameTable::INTERN("pointsAtY"); return k; }
-    inline InternedKey pointsAtZ() { static InternedKey k = PSNameTable::INTERN("pointsAtZ"); return k; }
-    inline InternedKey limitingConeAngle() { static InternedKey k = PSNameTable::INTERN("limitingConeAngle"); return k; }
+    inline InternedKey surfaceScale() { static constexpr InternedKey k = svgStaticAtom("surfaceScale"); return k; }
+    inline InternedKey diffuseConstant() { static constexpr InternedKey k = svgStaticAtom("diffuseConstant"); return k; }
+    inline InternedKey specularConstant() { static constexpr InternedKey k = svgStaticAtom("specularConstant"); return k; }
+    inline InternedKey specularExponent() { static constexpr InternedKey k = svgStaticAtom("specularExponent"); return k; }
+    inline InternedKey lighting_color() { static constexpr InternedKey k = svgStaticAtom("lighting-color"); return k; }
+
+    inline InternedKey azimuth() { static constexpr InternedKey k = svgStaticAtom("azimuth"); return k; }
+    inline InternedKey elevation() { static constexpr InternedKey k = svgStaticAtom("elevation"); return k; }
+    inline InternedKey pointsAtX() { static constexpr InternedKey k = svgStaticAtom("pointsAtX"); return k; }
+    inline InternedKey pointsAtY() { static constexpr InternedKey k = svgStaticAtom("pointsAtY"); return k; }
+    inline InternedKey pointsAtZ() { static constexpr InternedKey k = svgStaticAtom("pointsAtZ"); return k; }
+    inline InternedKey limitingConeAngle() { static constexpr InternedKey k = svgStaticAtom("limitingConeAngle"); return k; }
 
     // feDistantLight
-    inline InternedKey feDistantLight() { static InternedKey k = PSNameTable::INTERN("feDistantLight"); return k; }
-    inline InternedKey fePointLight() { static InternedKey k = PSNameTable::INTERN("fePointLight"); return k; }
-    inline InternedKey feSpotLight() { static InternedKey k = PSNameTable::INTERN("feSpotLight"); return k; }
+    inline InternedKey feDistantLight() { static constexpr InternedKey k = svgStaticAtom("feDistantLight"); return k; }
+    inline InternedKey fePointLight() { static constexpr InternedKey k = svgStaticAtom("fePointLight"); return k; }
+    inline InternedKey feSpotLight() { static constexpr InternedKey k = svgStaticAtom("feSpotLight"); return k; }
 
     // diffuse/specular lighting common
-    inline InternedKey x() { static InternedKey k = PSNameTable::INTERN("x"); return k; }
-    inline InternedKey y() { static InternedKey k = PSNameTable::INTERN("y"); return k; }
-    inline InternedKey z() { static InternedKey k = PSNameTable::INTERN("z"); return k; }
+    inline InternedKey x() { static constexpr InternedKey k = svgStaticAtom("x"); return k; }
+    inline InternedKey y() { static constexpr InternedKey k = svgStaticAtom("y"); return k; }
+    inline InternedKey z() { static constexpr InternedKey k = svgStaticAtom("z"); return k; }
 
     // feMorphology
-    inline InternedKey radius() { static InternedKey k = PSNameTable::INTERN("radius"); return k; }
+    inline InternedKey radius() { static constexpr InternedKey k = svgStaticAtom("radius"); return k; }
 
     // feMerge / feMergeNode
-    inline InternedKey feMergeNode_in() { static InternedKey k = PSNameTable::INTERN("in"); return k; }
+    inline InternedKey feMergeNode_in() { static constexpr InternedKey k = svgStaticAtom("in"); return k; }
 
     // feImage
-    inline InternedKey href() { static InternedKey k = PSNameTable::INTERN("href"); return k; }
-    inline InternedKey xlink_href() { static InternedKey k = PSNameTable::INTERN("xlink:href"); return k; }
+    inline InternedKey href() { static constexpr InternedKey k = svgStaticAtom("href"); return k; }
+    inline InternedKey xlink_href() { static constexpr InternedKey k = svgStaticAtom("xlink:href"); return k; }
 
 }
 
@@ -438,9 +438,9 @@ namespace waavs
         if (!s)
             return false;
 
-        static InternedKey kTrue = PSNameTable::INTERN("true");
-        static InternedKey kFalse = PSNameTable::INTERN("false");
-        InternedKey k = PSNameTable::INTERN(s);
+        static constexpr InternedKey kTrue = svgStaticAtom("true");
+        static constexpr InternedKey kFalse = svgStaticAtom("false");
+        InternedKey k = PSNameScope::LOOKUP(s);
 
         if (k == kTrue) {
             out = true;
@@ -465,9 +465,9 @@ namespace waavs
         if (!s)
             return false;
 
-        static InternedKey kStitch = PSNameTable::INTERN("stitch");
-        static InternedKey kNoStitch = PSNameTable::INTERN("noStitch");
-        InternedKey k = PSNameTable::INTERN(s);
+        static constexpr InternedKey kStitch = svgStaticAtom("stitch");
+        static constexpr InternedKey kNoStitch = svgStaticAtom("noStitch");
+        InternedKey k = PSNameScope::LOOKUP(s);
 
         if (k == kStitch) {
             out = true;
@@ -537,10 +537,10 @@ namespace waavs
     {
         if (!k) return FILTER_COLOR_MATRIX_MATRIX;
 
-        static InternedKey kMatrix = PSNameTable::INTERN("matrix");
-        static InternedKey kSaturate = PSNameTable::INTERN("saturate");
-        static InternedKey kHueRotate = PSNameTable::INTERN("hueRotate");
-        static InternedKey kLuminanceToAlpha = PSNameTable::INTERN("luminanceToAlpha");
+        static constexpr InternedKey kMatrix = svgStaticAtom("matrix");
+        static constexpr InternedKey kSaturate = svgStaticAtom("saturate");
+        static constexpr InternedKey kHueRotate = svgStaticAtom("hueRotate");
+        static constexpr InternedKey kLuminanceToAlpha = svgStaticAtom("luminanceToAlpha");
 
         if (k == kMatrix)           return FILTER_COLOR_MATRIX_MATRIX;
         if (k == kSaturate)         return FILTER_COLOR_MATRIX_SATURATE;
@@ -554,11 +554,11 @@ namespace waavs
     {
         if (!k) return FILTER_TRANSFER_IDENTITY;
 
-        static InternedKey kIdentity = PSNameTable::INTERN("identity");
-        static InternedKey kTable = PSNameTable::INTERN("table");
-        static InternedKey kDiscrete = PSNameTable::INTERN("discrete");
-        static InternedKey kLinear = PSNameTable::INTERN("linear");
-        static InternedKey kGamma = PSNameTable::INTERN("gamma");
+        static constexpr InternedKey kIdentity = svgStaticAtom("identity");
+        static constexpr InternedKey kTable = svgStaticAtom("table");
+        static constexpr InternedKey kDiscrete = svgStaticAtom("discrete");
+        static constexpr InternedKey kLinear = svgStaticAtom("linear");
+        static constexpr InternedKey kGamma = svgStaticAtom("gamma");
 
         if (k == kIdentity) return FILTER_TRANSFER_IDENTITY;
         if (k == kTable)    return FILTER_TRANSFER_TABLE;
@@ -573,8 +573,8 @@ namespace waavs
     {
         if (!k) return FILTER_MORPHOLOGY_ERODE;
 
-        static InternedKey kErode = PSNameTable::INTERN("erode");
-        static InternedKey kDilate = PSNameTable::INTERN("dilate");
+        static constexpr InternedKey kErode = svgStaticAtom("erode");
+        static constexpr InternedKey kDilate = svgStaticAtom("dilate");
 
         if (k == kErode)  return FILTER_MORPHOLOGY_ERODE;
         if (k == kDilate) return FILTER_MORPHOLOGY_DILATE;
@@ -586,9 +586,9 @@ namespace waavs
     {
         if (!k) return FILTER_EDGE_DUPLICATE;
 
-        static InternedKey kDuplicate = PSNameTable::INTERN("duplicate");
-        static InternedKey kWrap = PSNameTable::INTERN("wrap");
-        static InternedKey kNone = PSNameTable::INTERN("none");
+        static constexpr InternedKey kDuplicate = svgStaticAtom("duplicate");
+        static constexpr InternedKey kWrap = svgStaticAtom("wrap");
+        static constexpr InternedKey kNone = svgStaticAtom("none");
 
         if (k == kDuplicate) return FILTER_EDGE_DUPLICATE;
         if (k == kWrap)      return FILTER_EDGE_WRAP;
@@ -601,10 +601,10 @@ namespace waavs
     {
         if (!k) return FILTER_CHANNEL_A;
 
-        static InternedKey kR = PSNameTable::INTERN("R");
-        static InternedKey kG = PSNameTable::INTERN("G");
-        static InternedKey kB = PSNameTable::INTERN("B");
-        static InternedKey kA = PSNameTable::INTERN("A");
+        static constexpr InternedKey kR = svgStaticAtom("R");
+        static constexpr InternedKey kG = svgStaticAtom("G");
+        static constexpr InternedKey kB = svgStaticAtom("B");
+        static constexpr InternedKey kA = svgStaticAtom("A");
 
         if (k == kR) return FILTER_CHANNEL_R;
         if (k == kG) return FILTER_CHANNEL_G;
@@ -618,8 +618,8 @@ namespace waavs
     {
         if (!k) return FILTER_TURBULENCE_TURBULENCE;
 
-        static InternedKey kTurbulence = PSNameTable::INTERN("turbulence");
-        static InternedKey kFractalNoise = PSNameTable::INTERN("fractalNoise");
+        static constexpr InternedKey kTurbulence = svgStaticAtom("turbulence");
+        static constexpr InternedKey kFractalNoise = svgStaticAtom("fractalNoise");
 
         if (k == kTurbulence)   return FILTER_TURBULENCE_TURBULENCE;
         if (k == kFractalNoise) return FILTER_TURBULENCE_FRACTAL_NOISE;
@@ -0,0 +1,386 @@
+#pragma once
+
+//
+// Decoded image cache
+//
+// Documents very often embed the same images, logos, textures and the
+// like, as data: URIs.  Decoding those, base64 and then the image
+// format, is expensive, and doing it again for every document that
+// carries the same payload is a waste.
+//
+// The DecodedImageCache is shared by the whole process.  Decoded images
+// are looked up by a hash of their encoded payload, so identical payloads
+// in different documents decode once.  A hash is not proof, so each
+// entry keeps a copy of its payload, and a lookup only hits when the
+// bytes are the same.  The cache holds on to at most a budgeted number
+// of bytes, pixels and payloads, and lets go of the least recently used
+// images first when it's over.
+//
+// BLImage is reference counted, so what comes out of the cache is a
+// cheap shared reference to the pixels, which are never modified.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "blend2d_connect.h"
+#include "base64.h"
+#include "bspan_utils.h"
+#include "membuff.h"
+#include "workerpool.h"
+
+
+namespace waavs
+{
+    // image_payload_hash()
+    //
+    // Hash of an encoded image payload.  These run to megabytes, so
+    // this goes 8 bytes at a time, rather than FNV's one.
+    static INLINE uint64_t image_payload_hash(const uint8_t* data, size_t size) noexcept
+    {
+        static constexpr uint64_t kMul = 0x9E3779B97F4A7C15ull;
+
+        uint64_t h = 0xCBF29CE484222325ull ^ (size * kMul);
+
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t v;
+            memcpy(&v, data + i, 8);
+            h = (h ^ v) * kMul;
+            h ^= h >> 29;
+        }
+
+        uint64_t tail = 0;
+        if (i < size)
+            memcpy(&tail, data + i, size - i);
+        h = (h ^ tail) * kMul;
+
+        // final avalanche (from MurmurHash3's fmix64)
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+
+        return h;
+    }
+
+
+    struct DecodedImageKey
+    {
+        uint64_t fHash{ 0 };
+        uint64_t fSize{ 0 };
+
+        bool operator==(const DecodedImageKey& other) const noexcept
+        {
+            return fHash == other.fHash && fSize == other.fSize;
+        }
+    };
+
+    struct DecodedImageKeyHash
+    {
+        size_t operator()(const DecodedImageKey& k) const noexcept { return size_t(k.fHash); }
+    };
+
+    static INLINE DecodedImageKey makeDecodedImageKey(const ByteSpan& payload) noexcept
+    {
+        return { image_payload_hash(payload.data(), payload.size()), payload.size() };
+    }
+
+
+    struct DecodedImageCache
+    {
+        static constexpr size_t kDefaultBudget = 256 * 1024 * 1024;
+
+    private:
+        struct Entry
+        {
+            DecodedImageKey fKey{};
+            std::vector<uint8_t> fPayload{};
+            BLImage fImage{};
+            size_t fBytes{ 0 };         // pixels, and the payload copy
+
+            bool samePayload(const ByteSpan& payload) const noexcept
+            {
+                return fPayload.size() == payload.size() &&
+                    (payload.size() == 0 || memcmp(fPayload.data(), payload.data(), payload.size()) == 0);
+            }
+        };
+
+        using EntryList = std::list<Entry>;
+
+        mutable std::mutex fLock{};
+        EntryList fEntries{};           // most recently used first
+        std::unordered_map<DecodedImageKey, EntryList::iterator, DecodedImageKeyHash> fIndex{};
+        size_t fBudget{ kDefaultBudget };
+        size_t fBytesUsed{ 0 };
+
+        std::atomic<size_t> fHits{ 0 };
+        std::atomic<size_t> fMisses{ 0 };
+
+        static size_t imageBytes(const BLImage& img) noexcept
+        {
+            return size_t(img.width()) * size_t(img.height()) * 4;
+        }
+
+        // Caller holds the lock
+        void evictToBudget() noexcept
+        {
+            while (fBytesUsed > fBudget && !fEntries.empty())
+            {
+                Entry& victim = fEntries.back();
+                fBytesUsed -= victim.fBytes;
+                fIndex.erase(victim.fKey);
+                fEntries.pop_back();
+            }
+        }
+
+    public:
+        DecodedImageCache() = default;
+        DecodedImageCache(const DecodedImageCache&) = delete;
+        DecodedImageCache& operator=(const DecodedImageCache&) = delete;
+
+        // The cache shared by the whole process
+        static DecodedImageCache& global()
+        {
+            static DecodedImageCache sCache{};
+            return sCache;
+        }
+
+        size_t budget() const noexcept { std::lock_guard<std::mutex> guard(fLock); return fBudget; }
+        size_t bytesUsed() const noexcept { std::lock_guard<std::mutex> guard(fLock); return fBytesUsed; }
+        size_t size() const noexcept { std::lock_guard<std::mutex> guard(fLock); return fEntries.size(); }
+        size_t hits() const noexcept { return fHits.load(std::memory_order_relaxed); }
+        size_t misses() const noexcept { return fMisses.load(std::memory_order_relaxed); }
+
+        // Setting a budget of 0 turns the cache off
+        void setBudget(size_t bytes) noexcept
+        {
+            std::lock_guard<std::mutex> guard(fLock);
+            fBudget = bytes;
+            evictToBudget();
+        }
+
+        void clear() noexcept
+        {
+            std::lock_guard<std::mutex> guard(fLock);
+            fEntries.clear();
+            fIndex.clear();
+            fBytesUsed = 0;
+        }
+
+        // contains(), find(), insert()
+        //
+        // 'key' is makeDecodedImageKey(payload).  An entry with the same
+        // key, but different bytes, is a hash collision, and is treated
+        // as though it weren't there.
+        bool contains(const DecodedImageKey& key, const ByteSpan& payload) const noexcept
+        {
+            std::lock_guard<std::mutex> guard(fLock);
+
+            auto it = fIndex.find(key);
+            return it != fIndex.end() && it->second->samePayload(payload);
+        }
+
+        bool find(const DecodedImageKey& key, const ByteSpan& payload, BLImage& out) noexcept
+        {
+            std::lock_guard<std::mutex> guard(fLock);
+
+            auto it = fIndex.find(key);
+            if (it == fIndex.end() || !it->second->samePayload(payload))
+            {
+                fMisses.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            // Move it to the front, as the most recently used
+            fEntries.splice(fEntries.begin(), fEntries, it->second);
+            out = it->second->fImage;
+            fHits.fetch_add(1, std::memory_order_relaxed);
+
+            return true;
+        }
+
+        // Add a decoded image.  If another thread got there first,
+        // 'img' is replaced by the one already in the cache, so
+        // everyone shares the same pixels.  On a collision, the entry
+        // that's there stays, and 'img' simply isn't cached.
+        void insert(const DecodedImageKey& key, const ByteSpan& payload, BLImage& img)
+        {
+            const size_t bytes = imageBytes(img) + payload.size();
+
+            std::lock_guard<std::mutex> guard(fLock);
+
+            auto it = fIndex.find(key);
+            if (it != fIndex.end())
+            {
+                if (it->second->samePayload(payload))
+                    img = it->second->fImage;
+                return;
+            }
+
+            // Something that would push everything else out isn't kept
+            if (bytes > fBudget)
+                return;
+
+            fEntries.push_front(Entry{ key, std::vector<uint8_t>(payload.begin(), payload.end()), img, bytes });
+            fIndex.emplace(key, fEntries.begin());
+            fBytesUsed += bytes;
+
+            evictToBudget();
+        }
+    };
+
+
+    //
+    // decodeImageData()
+    //
+    // Decode a base64 encoded image payload, without the cache.
+    //
+    static bool decodeImageData(const ByteSpan& mime, const ByteSpan& payload, BLImage& img)
+    {
+        bool success{ false };
+
+        // allocate some memory to decode into
+        size_t outBuffSize = base64::getDecodeOutputSize(payload.size());
+        MemBuff outBuff(outBuffSize);
+
+        size_t decodedSize = base64::decode(payload.data(), payload.size(), outBuff.data(), outBuffSize);
+
+        if (decodedSize < 1 || decodedSize > outBuffSize) {
+            printf("parseImage: Error in base64::decode, decodedSize: %zu \n", decodedSize);
+            return false;
+        }
+
+        // See if it's a format that blend2d can deal with using its
+        // own codecs
+        BLResult res = img.read_from_data(outBuff.data(), decodedSize);
+
+        success = (res == BL_SUCCESS);
+
+        // If we didn't succeed in decoding, then try any specilized methods of decoding
+        // we might have.
+        if (!success) {
+            if (mime == "image/gif")
+            {
+                printf("parseImage:: trying to decode GIF\n");
+                // try to decode it as a gif
+                //BLResult res = img.readFromData(outBuff.data(), outBuff.size());
+                //success = (res == BL_SUCCESS);
+            }
+        }
+
+        return success;
+    }
+
+    // splitImageDataUri()
+    //
+    // Take apart 'data:image/png;base64,<base64 encoded image>'
+    // Returns false if it's not base64 encoded.
+    static INLINE bool splitImageDataUri(const ByteSpan& inChunk, ByteSpan& mime, ByteSpan& payload) noexcept
+    {
+        ByteSpan value = chunk_trim(inChunk, chrWspChars);
+
+        ByteSpan data = chunk_token(value, ":");
+        mime = chunk_token(value, ";");
+        auto encoding = chunk_token(value, ",");
+
+        payload = value;
+
+        return encoding == "base64";
+    }
+
+    //
+    // parseImage()
+    //
+    // Turn a base64 encoded inlined image into a BLImage
+    // We are handed the attribute, typically coming from a
+    // href of an <image> tag, or as a lookup for a fill, or stroke,
+    // paint attribute.
+    // What we're passed are the contents of the 'url()'.
+    //
+    // Example: <image id="image_textures" x="0" y="0" width="1024" height="768" xlink:href="data:image/jpeg;base64,/9j/...
+    //
+    // Decoded images are shared through the DecodedImageCache.
+    //
+    static bool parseImage(const ByteSpan& inChunk, BLImage& img)
+    {
+        ByteSpan mime{};
+        ByteSpan payload{};
+        if (!splitImageDataUri(inChunk, mime, payload))
+            return false;
+
+        DecodedImageCache& cache = DecodedImageCache::global();
+        const DecodedImageKey key = makeDecodedImageKey(payload);
+
+        if (cache.find(key, payload, img))
+            return true;
+
+        if (!decodeImageData(mime, payload, img))
+            return false;
+
+        cache.insert(key, payload, img);
+
+        return true;
+    }
+
+
+    //
+    // prefetchImages()
+    //
+    // Decode a set of data: URIs into the cache, using up to
+    // 'threadCount' threads of the shared WorkerPool (0 == all of them),
+    // so they're ready by the time they're drawn.  Duplicates, and
+    // anything already cached, cost only a lookup.
+    //
+    static INLINE void prefetchImages(const std::vector<ByteSpan>& hrefs, size_t threadCount)
+    {
+        struct Pending
+        {
+            DecodedImageKey fKey;
+            ByteSpan fMime;
+            ByteSpan fPayload;
+        };
+
+        DecodedImageCache& cache = DecodedImageCache::global();
+
+        // Each distinct payload is decoded once
+        std::vector<Pending> pending{};
+        std::unordered_set<DecodedImageKey, DecodedImageKeyHash> seen{};
+
+        for (const ByteSpan& href : hrefs)
+        {
+            Pending p{};
+            if (!splitImageDataUri(href, p.fMime, p.fPayload))
+                continue;
+
+            // A payload whose key collides with one already pending
+            // is left for parseImage() to decode when it's drawn.
+            p.fKey = makeDecodedImageKey(p.fPayload);
+            if (!seen.insert(p.fKey).second || cache.contains(p.fKey, p.fPayload))
+                continue;
+
+            pending.push_back(p);
+        }
+
+        if (pending.empty())
+            return;
+
+        WorkerPool::shared().parallelFor(pending.size(), threadCount, [&](size_t idx) {
+            const Pending& p = pending[idx];
+
+            BLImage img{};
+            if (decodeImageData(p.fMime, p.fPayload, img))
+                cache.insert(p.fKey, p.fPayload, img);
+            });
+    }
+}
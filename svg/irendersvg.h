@@ -3,6 +3,7 @@
 #pragma comment(lib, "blend2d.lib") // Link with Blend2D static library, on Windows
 
 #include <functional>
+#include <memory>
 
 
 #include "blend2d_connect.h"
@@ -11,6 +12,7 @@
 #include "svgenums.h"
 #include "imanagesvgstate.h"
 #include "surface.h"
+#include "surfacepool.h"
 
 namespace waavs
 {
@@ -66,6 +68,31 @@ namespace waavs
 
 namespace waavs
 {
+    struct FilterProgramStream;
+
+    // The parts that make up an effect, see IRenderSVG::beginEffect()
+    enum SVGEffectPartKind : uint32_t
+    {
+        SVG_EFFECT_CONTENT = 0,         // what the effect is applied to
+        SVG_EFFECT_MASK_LUMINANCE,      // a mask's content
+        SVG_EFFECT_MASK_ALPHA,
+        SVG_EFFECT_CLIP,                // a clip path's content
+        SVG_EFFECT_IMAGE,               // what an feImage refers to
+    };
+
+    // SVGEffectDesc
+    //
+    // An element drawn through a filter, a mask, or a clip path that
+    // has to be drawn offscreen.  Everything in it is in the element's
+    // user space, so it holds at any resolution.  Masks and clips are
+    // applied in the order their parts come in.
+    struct SVGEffectDesc
+    {
+        WGRectD fEffectRect{};          // what's drawn offscreen, the filter region if there is one
+        WGRectD fObjectBBox{};
+        double fOpacity{ 1.0 };
+        std::shared_ptr<const FilterProgramStream> fFilter{};
+    };
     
     // A specialization of state management, connected to a BLContext
     // This is used when rendering a tree of SVG elements
@@ -77,6 +104,29 @@ namespace waavs
         // Text position management
         std::vector<waavs::SVGTextPosFrame> fTextPosStack;
 
+        // When the attached surface is one tile of a larger canvas,
+        // where that tile sits on the canvas.  Drawing is still done
+        // in canvas coordinates, and elements entirely outside the
+        // tile can be skipped.
+        WGPointI fTargetOrigin{};
+        WGRectI fCullRect{};
+        bool fHasCullRect{ false };
+
+        // While non-zero, bounds remembered from earlier draws aren't
+        // trusted for culling.  Content drawn through a <use> can be
+        // drawn in more than one context.
+        int fCullSuspended{ 0 };
+
+        // Whether elements note where they land on the target, so
+        // changes can be redrawn in place.  Only meaningful for a
+        // driver that draws the whole canvas, not an offscreen one.
+        bool fTracksDamage{ false };
+
+        // Where offscreen surfaces come from, for isolation, masks,
+        // clips and filters.  Not owned.  Without one, each is
+        // allocated fresh.
+        SurfacePool* fSurfacePool{ nullptr };
+
 
     public:
         IRenderSVG()
@@ -119,8 +169,79 @@ namespace waavs
 
         void attach(Surface& surf, int threadCount, const SVGDrawingState *state = nullptr) noexcept
         {
+            fTargetOrigin = WGPointI{ 0, 0 };
+            fHasCullRect = false;
+            fCullSuspended = 0;
+
             onAttach(surf, threadCount, state);
         }
+
+        // attachTile()
+        //
+        // Attach to one tile of a larger canvas.  'tile' is the 
+        // tile's own pixels, typically a sub-surface of the canvas, 
+        // and (originX, originY) is where it sits on the canvas.
+        void attachTile(Surface& tile, int originX, int originY, int threadCount) noexcept
+        {
+            fTargetOrigin = WGPointI{ originX, originY };
+            fCullRect = WGRectI{ originX, originY, int(tile.width()), int(tile.height()) };
+            fHasCullRect = true;
+            fCullSuspended = 0;
+
+            onAttach(tile, threadCount, nullptr);
+        }
+
+        const WGPointI& targetOrigin() const noexcept { return fTargetOrigin; }
+
+        // Limit drawing to part of the canvas, as when redrawing
+        // what's changed.  Elements entirely outside are skipped.
+        void setCullRect(const WGRectI& r) noexcept
+        {
+            fCullRect = r;
+            fHasCullRect = true;
+        }
+
+        void clearCullRect() noexcept { fHasCullRect = false; }
+
+        void trackDamage(bool tracks) noexcept { fTracksDamage = tracks; }
+        bool tracksDamage() const noexcept { return fTracksDamage; }
+
+        void setSurfacePool(SurfacePool* pool) noexcept { fSurfacePool = pool; }
+        SurfacePool* surfacePool() const noexcept { return fSurfacePool; }
+
+        // The part of the canvas, in device pixels, that's being
+        // drawn.  False if it's all of it, so nothing is culled.
+        bool getCullRect(WGRectI& r) const noexcept
+        {
+            if (!fHasCullRect)
+                return false;
+
+            r = fCullRect;
+            return true;
+        }
+
+        // getVisibleRect()
+        //
+        // The part of the canvas that can actually be drawn on, in
+        // device pixels.  The cull rect when drawing a tile, otherwise
+        // the bounds of the target.  False if there's no telling, as
+        // when there's no target.
+        bool getVisibleRect(WGRectI& r) const noexcept
+        {
+            if (getCullRect(r))
+                return true;
+
+            const BLImage* target = currentTarget();
+            if (!target || target->empty())
+                return false;
+
+            r = WGRectI{ 0, 0, int(target->width()), int(target->height()) };
+            return true;
+        }
+
+        void suspendCulling() noexcept { fCullSuspended++; }
+        void resumeCulling() noexcept { if (fCullSuspended > 0) fCullSuspended--; }
+        bool cullingSuspended() const noexcept { return fCullSuspended > 0; }
         
         virtual void onDetach() {}
 
@@ -554,6 +675,82 @@ namespace waavs
             onNoClip();
         }
 
+        // Isolation groups
+        // An element drawn with opacity is normally rendered offscreen,
+        // and the pixels composited.  A driver that can keep the group
+        // itself, such as a recorder, returns true from onBeginGroup(),
+        // and the content is then drawn to it directly, up to endGroup().
+        // 'userRect' is the group's extent in the current user space.
+        virtual bool onBeginGroup(const WGRectD& userRect, double opacity) { return false; }
+        bool beginGroup(const WGRectD& userRect, double opacity)
+        {
+            return onBeginGroup(userRect, opacity);
+        }
+
+        virtual void onEndGroup() {}
+        void endGroup()
+        {
+            onEndGroup();
+        }
+
+        // Cull ranges
+        // Everything drawn between beginCullRange() and endCullRange()
+        // lands within 'userBounds', in the user space that was current
+        // at beginCullRange().  The bounds of a container are often only
+        // known once its children have been drawn, so they're given at
+        // the end.  A driver that draws culls as it goes, and ignores
+        // these.  A recorder keeps them, so the range can be skipped when
+        // it's replayed onto a part of the canvas it doesn't reach.
+        virtual void onBeginCullRange() {}
+        void beginCullRange()
+        {
+            onBeginCullRange();
+        }
+
+        virtual void onEndCullRange(const WGRectD& userBounds, bool hasBounds) {}
+        void endCullRange(const WGRectD& userBounds, bool hasBounds)
+        {
+            onEndCullRange(userBounds, hasBounds);
+        }
+
+        // Effects
+        // Filters, masks and clip paths are normally drawn offscreen,
+        // at the resolution of the target, and the pixels composited.
+        // A driver that doesn't have a resolution yet, such as a
+        // recorder, returns true from recordsEffects(), and is handed
+        // the effect instead.  Between beginEffect() and endEffect(),
+        // each input is drawn between beginEffectPart() and
+        // endEffectPart(), the content first.  A mask or clip part is
+        // drawn from an identity transform, and replayed with 'units'
+        // mapping it into the element's user space, ahead of the
+        // element's transform.  An image part is found by its 'href',
+        // and placed by the filter.
+        virtual bool recordsEffects() const noexcept { return false; }
+
+        virtual void onBeginEffect(const SVGEffectDesc& desc) {}
+        void beginEffect(const SVGEffectDesc& desc)
+        {
+            onBeginEffect(desc);
+        }
+
+        virtual void onBeginEffectPart(SVGEffectPartKind kind, const WGMatrix3x3& units, InternedKey href) {}
+        void beginEffectPart(SVGEffectPartKind kind, const WGMatrix3x3& units = WGMatrix3x3::makeIdentity(), InternedKey href = nullptr)
+        {
+            onBeginEffectPart(kind, units, href);
+        }
+
+        virtual void onEndEffectPart() {}
+        void endEffectPart()
+        {
+            onEndEffectPart();
+        }
+
+        virtual void onEndEffect() {}
+        void endEffect()
+        {
+            onEndEffect();
+        }
+
         // Path handling
 		virtual void onBeginDrawShape(const BLPath& apath) {}
         void beginDrawShape(const BLPath& apath)
@@ -1,12 +1,15 @@
 #pragma once
 
-#include <set>
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "bspan.h"
+#include "svgatomtable.h"
 
 
 namespace waavs {
@@ -29,42 +32,419 @@ namespace waavs {
 
 namespace waavs {
 
+    // AtomArena
+    //
+    // Storage for the bytes of interned strings.  Strings are packed
+    // one after the other, null terminated, into large blocks.  Nothing
+    // is ever freed individually, the blocks go away with the arena.
+    // Blocks start small, and double up to kBlockSize, so an arena
+    // that only ever sees a handful of names stays small.
+    // Not thread safe on its own, the owner serializes allocation.
+    struct AtomArena
+    {
+        static constexpr size_t kMinBlockSize = 4 * 1024;
+        static constexpr size_t kBlockSize = 64 * 1024;
+
+        std::vector<std::unique_ptr<char[]>> fBlocks{};
+        char* fCursor{ nullptr };
+        size_t fRemaining{ 0 };
+        size_t fNextBlockSize{ kMinBlockSize };
+
+        const char* store(const char* s, size_t n)
+        {
+            const size_t needed = n + 1;
+
+            if (needed > fRemaining)
+            {
+                // Very long names get a block of their own, so they don't
+                // waste the tail of the current block
+                if (needed > fNextBlockSize)
+                {
+                    fBlocks.emplace_back(new char[needed]);
+                    char* dst = fBlocks.back().get();
+                    memcpy(dst, s, n);
+                    dst[n] = 0;
+                    return dst;
+                }
+
+                fBlocks.emplace_back(new char[fNextBlockSize]);
+                fCursor = fBlocks.back().get();
+                fRemaining = fNextBlockSize;
+
+                if (fNextBlockSize < kBlockSize)
+                    fNextBlockSize *= 2;
+            }
+
+            char* dst = fCursor;
+            memcpy(dst, s, n);
+            dst[n] = 0;
+
+            fCursor += needed;
+            fRemaining -= needed;
+
+            return dst;
+        }
+    };
+
+
     // PSNameTable
     //
-    // A global name table for interned strings.
-    struct PSNameTable 
+    // A name table for interned strings.
+    //
+    // Each distinct string maps to a single stable 'const char *', so
+    // atoms can be compared, and hashed, by pointer.
+    //
+    // The table is an open addressed hash table.  Looking up a name that
+    // is already in the table is lock free, so any number of threads can
+    // intern concurrently.  Only adding a new name takes a lock.
+    // When the table grows, a new one is published, and the old one is kept
+    // around until the table is destroyed, as there might be readers still
+    // probing it.  A reader that misses on an old table simply falls into
+    // the locked path, where it will find the name in the current table.
+    //
+    // The string bytes themselves live in an AtomArena.
+    //
+    // The global table is seeded with the well known SVG names
+    // (svgatomtable.h), which resolve to their static atom without
+    // ever touching the dynamic table.
+    //
+    // Names interned here live as long as the table.  For the global
+    // table that's the life of the process, so names that come from
+    // document content should go through a PSNameScope instead.
+    struct PSNameScope;
+
+    struct PSNameTable
     {
+        friend struct PSNameScope;
+
     private:
-        std::set<std::string, std::less<> > pool;
+        struct Slot
+        {
+            std::atomic<const char*> fName{ nullptr };  // published last
+            uint64_t fHash{ 0 };
+            size_t fLength{ 0 };
+        };
+
+        struct Table
+        {
+            size_t fMask{ 0 };
+            std::unique_ptr<Slot[]> fSlots{};
+
+            explicit Table(size_t capacity)
+                : fMask(capacity - 1)
+                , fSlots(new Slot[capacity])
+            {}
+
+            size_t capacity() const noexcept { return fMask + 1; }
+
+            const char* find(const char* s, size_t n, uint64_t hash) const noexcept
+            {
+                size_t idx = hash & fMask;
+                for (;;)
+                {
+                    const Slot& slot = fSlots[idx];
+                    const char* name = slot.fName.load(std::memory_order_acquire);
+                    if (!name)
+                        return nullptr;
+
+                    if (slot.fHash == hash && slot.fLength == n && memcmp(name, s, n) == 0)
+                        return name;
+
+                    idx = (idx + 1) & fMask;
+                }
+            }
+
+            // Only called with the write lock held
+            void insert(const char* name, size_t n, uint64_t hash) noexcept
+            {
+                size_t idx = hash & fMask;
+                while (fSlots[idx].fName.load(std::memory_order_relaxed))
+                    idx = (idx + 1) & fMask;
+
+                Slot& slot = fSlots[idx];
+                slot.fHash = hash;
+                slot.fLength = n;
+                slot.fName.store(name, std::memory_order_release);
+            }
+        };
+
+        static constexpr size_t kDefaultCapacity = 1024;
+
+        std::atomic<Table*> fTable{ nullptr };
+        std::vector<std::unique_ptr<Table>> fTables{};  // current, and retired tables
+        std::mutex fWriteLock{};
+        AtomArena fArena{};
+        size_t fCount{ 0 };
+        size_t fInitialCapacity{ kDefaultCapacity };
+        bool fUseStaticAtoms{ false };
+
+        static uint64_t hashOf(const char* s, size_t n) noexcept
+        {
+            return fnv1a_64_chars(s, n);
+        }
+
+        const char* findDynamic(const char* s, size_t n, uint64_t hash) const noexcept
+        {
+            const Table* t = fTable.load(std::memory_order_acquire);
+            return t ? t->find(s, n, hash) : nullptr;
+        }
+
+        // Called with the write lock held
+        void grow()
+        {
+            Table* current = fTable.load(std::memory_order_relaxed);
+            const size_t newCapacity = current ? current->capacity() * 2 : fInitialCapacity;
+
+            auto bigger = std::make_unique<Table>(newCapacity);
+            if (current)
+            {
+                for (size_t i = 0; i < current->capacity(); i++)
+                {
+                    const Slot& slot = current->fSlots[i];
+                    const char* name = slot.fName.load(std::memory_order_relaxed);
+                    if (name)
+                        bigger->insert(name, slot.fLength, slot.fHash);
+                }
+            }
+
+            fTable.store(bigger.get(), std::memory_order_release);
+            fTables.push_back(std::move(bigger));
+        }
+
+        const char* internSlow(const char* s, size_t n, uint64_t hash)
+        {
+            std::lock_guard<std::mutex> guard(fWriteLock);
+
+            // Someone might have added it while we were waiting
+            if (const char* existing = findDynamic(s, n, hash))
+                return existing;
+
+            Table* t = fTable.load(std::memory_order_relaxed);
+            if (!t || (fCount + 1) * 2 > t->capacity())
+            {
+                grow();
+                t = fTable.load(std::memory_order_relaxed);
+            }
+
+            const char* name = fArena.store(s, n);
+            t->insert(name, n, hash);
+            fCount++;
+
+            return name;
+        }
+
+        const char* findChars(const char* s, size_t n, uint64_t hash) const noexcept
+        {
+            if (fUseStaticAtoms)
+            {
+                if (const char* atom = kSVGStaticAtoms.find(s, n, hash))
+                    return atom;
+            }
+
+            return findDynamic(s, n, hash);
+        }
+
+        const char* internChars(const char* s, size_t n)
+        {
+            const uint64_t hash = hashOf(s, n);
+
+            if (const char* existing = findChars(s, n, hash))
+                return existing;
+
+            return internSlow(s, n, hash);
+        }
 
     public:
+        PSNameTable() = default;
+        explicit PSNameTable(bool useStaticAtoms, size_t initialCapacity = kDefaultCapacity)
+            : fInitialCapacity(initialCapacity)
+            , fUseStaticAtoms(useStaticAtoms)
+        {}
+
+        PSNameTable(const PSNameTable&) = delete;
+        PSNameTable& operator=(const PSNameTable&) = delete;
+
+        // Number of names added to the dynamic part of the table
+        size_t size() const noexcept { return fCount; }
+
         bool hasName(const char * name) const
         {
-            return pool.find(name) != pool.end();
+            return name && find(name) != nullptr;
+        }
+
+        // find()
+        //
+        // Return the atom for a name that's already in the table, 
+        // or nullptr if it isn't.  Never adds anything to the table, so 
+        // it's the thing to use when all you want to know is whether
+        // a name matches one of the names you already have.
+        const char* find(std::string_view sv) const noexcept
+        {
+            return findChars(sv.data(), sv.size(), hashOf(sv.data(), sv.size()));
+        }
+
+        const char* find(const ByteSpan& span) const noexcept
+        {
+            return find(std::string_view(reinterpret_cast<const char*>(span.data()), span.size()));
         }
+        const char* find(const char* cstr) const noexcept { return find(std::string_view(cstr)); }
 
         const char* intern(std::string_view sv)
         {
-            // emplace does the lookup; constructs std::string only on insertion
-            auto [it, inserted] = pool.emplace(sv);
-            return it->c_str();
+            return internChars(sv.data(), sv.size());
         }
 
-        const char* intern(const ByteSpan& span) 
-        { 
-            return intern(std::string_view(reinterpret_cast<const char*>(span.data()), 
-                span.size())); 
+        const char* intern(const ByteSpan& span)
+        {
+            return internChars(reinterpret_cast<const char*>(span.data()), span.size());
         }
         const char* intern(const char* cstr) { return intern(std::string_view(cstr)); }
 
         static PSNameTable* getSingletonTable() {
-            static PSNameTable gTable;
+            static PSNameTable gTable(true);
             return &gTable;
         }
 
     public:
         static const char* INTERN(const ByteSpan& span) { return getSingletonTable()->intern(span); }
         static const char* INTERN(const char* cstr) { return getSingletonTable()->intern(cstr); }
+
+        static const char* FIND(const ByteSpan& span) { return getSingletonTable()->find(span); }
+        static const char* FIND(const char* cstr) { return getSingletonTable()->find(cstr); }
+    };
+
+
+    // PSNameScope
+    //
+    // A layer of interned names with a shorter life than the process,
+    // typically that of a single SVGDocument.
+    //
+    // A name is resolved in this order:
+    //  - the well known static atoms
+    //  - names this scope has already interned
+    //  - names already in the global table
+    // Only if none of those has it, is the name added to the scope.
+    // Well known names keep their global atom, so they compare equal to
+    // the svgatoms.h constants, while the one off element names, attribute 
+    // names and identifiers that a document brings along are freed with 
+    // the scope, rather than accumulating in the global table.
+    //
+    // Atoms from a scope are only valid as long as the scope.  Anything 
+    // that needs to outlive it, such as a function local static, must use 
+    // PSNameTable::INTERN().
+    //
+    // The parser doesn't know which document it's working for, so the
+    // scope is made 'current' on a thread with a PSNameScopeGuard, and 
+    // the scope aware PSNameScope::INTERN()/LOOKUP() use whichever scope
+    // is current.  With no current scope, they go to the global table.
+    struct PSNameScope
+    {
+    private:
+        static constexpr size_t kScopeCapacity = 128;
+
+        PSNameTable fLocal{ false, kScopeCapacity };
+        PSNameTable* fGlobal{ nullptr };
+
+        static PSNameScope*& currentSlot() noexcept
+        {
+            static thread_local PSNameScope* gCurrent = nullptr;
+            return gCurrent;
+        }
+
+        const char* findChars(const char* s, size_t n, uint64_t hash) const noexcept
+        {
+            if (const char* atom = kSVGStaticAtoms.find(s, n, hash))
+                return atom;
+
+            // Check our own names before the global ones.  If the global 
+            // table picks up a name after we've added it here, we keep
+            // handing out the atom we already gave out.
+            if (const char* existing = fLocal.findDynamic(s, n, hash))
+                return existing;
+
+            return fGlobal->findDynamic(s, n, hash);
+        }
+
+        const char* internChars(const char* s, size_t n)
+        {
+            const uint64_t hash = PSNameTable::hashOf(s, n);
+
+            if (const char* existing = findChars(s, n, hash))
+                return existing;
+
+            return fLocal.internSlow(s, n, hash);
+        }
+
+    public:
+        PSNameScope()
+            : fGlobal(PSNameTable::getSingletonTable())
+        {}
+
+        PSNameScope(const PSNameScope&) = delete;
+        PSNameScope& operator=(const PSNameScope&) = delete;
+
+        // Number of names that are private to this scope
+        size_t size() const noexcept { return fLocal.size(); }
+
+        const char* intern(const ByteSpan& span)
+        {
+            return internChars(reinterpret_cast<const char*>(span.data()), span.size());
+        }
+        const char* intern(const char* cstr) { return internChars(cstr, strlen(cstr)); }
+
+        const char* find(const ByteSpan& span) const noexcept
+        {
+            const char* s = reinterpret_cast<const char*>(span.data());
+            return findChars(s, span.size(), PSNameTable::hashOf(s, span.size()));
+        }
+        const char* find(const char* cstr) const noexcept { return find(ByteSpan(cstr)); }
+
+        static PSNameScope* current() noexcept { return currentSlot(); }
+
+        static PSNameScope* setCurrent(PSNameScope* scope) noexcept
+        {
+            PSNameScope* prev = currentSlot();
+            currentSlot() = scope;
+            return prev;
+        }
+
+    public:
+        // Intern a name in the current scope, or the global table
+        // if there is no current scope.
+        static const char* INTERN(const ByteSpan& span)
+        {
+            PSNameScope* scope = current();
+            return scope ? scope->intern(span) : PSNameTable::INTERN(span);
+        }
+        static const char* INTERN(const char* cstr) { return INTERN(ByteSpan(cstr)); }
+
+        // Find the atom for a name, without interning it.
+        // nullptr means no atom by that name exists, so it can't match
+        // any key we already have.
+        static const char* LOOKUP(const ByteSpan& span)
+        {
+            PSNameScope* scope = current();
+            return scope ? scope->find(span) : PSNameTable::FIND(span);
+        }
+        static const char* LOOKUP(const char* cstr) { return LOOKUP(ByteSpan(cstr)); }
+    };
+
+    // PSNameScopeGuard
+    //
+    // Make a scope current on this thread, for the life of the guard.
+    // Guards nest, the previous scope is restored on the way out.
+    struct PSNameScopeGuard
+    {
+        PSNameScope* fPrevious{ nullptr };
+
+        explicit PSNameScopeGuard(PSNameScope* scope) noexcept
+            : fPrevious(PSNameScope::setCurrent(scope))
+        {}
+
+        ~PSNameScopeGuard() { PSNameScope::setCurrent(fPrevious); }
+
+        PSNameScopeGuard(const PSNameScopeGuard&) = delete;
+        PSNameScopeGuard& operator=(const PSNameScopeGuard&) = delete;
     };
 
 
@@ -0,0 +1,247 @@
+#pragma once
+
+//
+// NodeArena
+//
+// A document holds on to a large number of small objects: the
+// element nodes, their visual properties, text runs, and so on.
+// Those are all created while the document loads, and are all
+// released together when the document goes away.  Allocating them
+// one at a time from the general heap means a malloc/free pair per
+// object, and a long teardown walking all of them back to the heap.
+//
+// The NodeArena is a monotonic allocator for those objects.  Memory
+// is carved out of large blocks, and individual frees do nothing.
+// All the blocks are released at once when the arena goes away.
+//
+// Nodes are still handed out as std::shared_ptr, so none of the code
+// that works with them has to change.  makeNode<T>() uses
+// std::allocate_shared, so the object and its control block sit
+// together in the arena.  The allocator each control block holds
+// keeps a share of the arena, so a node kept after its document is
+// gone, one found with getElementById() say, is still good.  The
+// arena goes when the document and the last of its nodes have.  For
+// that, an arena has to be owned by a std::shared_ptr for makeNode()
+// to allocate from it.
+//
+// As with the name scope, the code creating nodes doesn't know which
+// document it's working for, so an arena is made current on a
+// thread with a NodeArenaGuard.  With no current arena, makeNode<T>()
+// is just std::make_shared<T>().
+//
+// The nodes hold atoms from their document's name scope, so the
+// arena holds a share of that scope.  Names stay valid for as long
+// as any node that might refer to them.
+//
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "nametable.h"
+
+namespace waavs
+{
+    struct NodeArena : std::enable_shared_from_this<NodeArena>
+    {
+        static constexpr size_t kMinBlockSize = 16 * 1024;
+        static constexpr size_t kMaxBlockSize = 1024 * 1024;
+
+    private:
+        // Guards the blocks and the cursor.  Blocks are allocated
+        // outside of it, so a thread waiting here waits for a few
+        // pointer updates, never for the heap.
+        std::mutex fLock{};
+        std::vector<std::unique_ptr<uint8_t[]>> fBlocks{};
+        uint8_t* fCursor{ nullptr };
+        size_t fRemaining{ 0 };
+        size_t fNextBlockSize{ kMinBlockSize };
+
+        std::atomic<size_t> fBytesAllocated{ 0 };
+        std::atomic<size_t> fBytesReserved{ 0 };
+
+        // The names the nodes in here were created with
+        std::shared_ptr<PSNameScope> fNames{};
+
+        static NodeArena*& currentSlot() noexcept
+        {
+            static thread_local NodeArena* gCurrent = nullptr;
+            return gCurrent;
+        }
+
+        static uintptr_t alignUp(uintptr_t p, size_t align) noexcept
+        {
+            return (p + align - 1) & ~(uintptr_t)(align - 1);
+        }
+
+        // Take from the current block, if it fits.
+        // Called with the lock held.
+        void* carve(size_t size, size_t align) noexcept
+        {
+            if (!fCursor)
+                return nullptr;
+
+            const uintptr_t cur = (uintptr_t)fCursor;
+            const uintptr_t aligned = alignUp(cur, align);
+            const size_t padding = size_t(aligned - cur);
+
+            if (padding + size > fRemaining)
+                return nullptr;
+
+            fCursor += padding + size;
+            fRemaining -= padding + size;
+
+            return (void*)aligned;
+        }
+
+    public:
+        NodeArena() = default;
+        explicit NodeArena(std::shared_ptr<PSNameScope> names) noexcept
+            : fNames(std::move(names))
+        {}
+        NodeArena(const NodeArena&) = delete;
+        NodeArena& operator=(const NodeArena&) = delete;
+
+        PSNameScope* nameScope() const noexcept { return fNames.get(); }
+
+        // Bytes handed out, and bytes held in blocks
+        size_t bytesAllocated() const noexcept { return fBytesAllocated.load(std::memory_order_relaxed); }
+        size_t bytesReserved() const noexcept { return fBytesReserved.load(std::memory_order_relaxed); }
+
+        void* allocate(size_t size, size_t align = alignof(std::max_align_t))
+        {
+            fBytesAllocated.fetch_add(size, std::memory_order_relaxed);
+
+            size_t blockSize{};
+            {
+                std::lock_guard<std::mutex> guard(fLock);
+                if (void* p = carve(size, align))
+                    return p;
+
+                blockSize = fNextBlockSize;
+            }
+
+            // Something that won't fit a regular block gets
+            // one of its own, leaving the current block alone
+            const size_t worstCase = size + align;
+            const bool ownBlock = worstCase > blockSize;
+            if (ownBlock)
+                blockSize = worstCase;
+
+            std::unique_ptr<uint8_t[]> block(new uint8_t[blockSize]);
+            uint8_t* mem = block.get();
+
+            fBytesReserved.fetch_add(blockSize, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> guard(fLock);
+            fBlocks.push_back(std::move(block));
+
+            if (ownBlock)
+                return (void*)alignUp((uintptr_t)mem, align);
+
+            // Whatever is left of the block we're replacing is let go.
+            // Another thread may have replaced it in the meantime, 
+            // which only costs the rest of that one.
+            fCursor = mem;
+            fRemaining = blockSize;
+
+            if (fNextBlockSize == blockSize && fNextBlockSize < kMaxBlockSize)
+                fNextBlockSize *= 2;
+
+            return carve(size, align);
+        }
+
+        // Individual objects are never returned to the arena
+        void deallocate(void*, size_t) noexcept {}
+
+
+        static NodeArena* current() noexcept { return currentSlot(); }
+
+        static NodeArena* setCurrent(NodeArena* arena) noexcept
+        {
+            NodeArena* prev = currentSlot();
+            currentSlot() = arena;
+            return prev;
+        }
+    };
+
+
+    // NodeArenaAllocator
+    //
+    // A standard allocator that draws from a NodeArena.  It holds a
+    // share of the arena, so the arena lasts as long as anything
+    // still holding the allocator, a control block from
+    // std::allocate_shared() in particular.
+    template <typename T>
+    struct NodeArenaAllocator
+    {
+        using value_type = T;
+
+        std::shared_ptr<NodeArena> fArena{};
+
+        explicit NodeArenaAllocator(std::shared_ptr<NodeArena> arena) noexcept
+            : fArena(std::move(arena))
+        {}
+
+        template <typename U>
+        NodeArenaAllocator(const NodeArenaAllocator<U>& other) noexcept
+            : fArena(other.fArena)
+        {}
+
+        T* allocate(size_t n)
+        {
+            return static_cast<T*>(fArena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, size_t n) noexcept
+        {
+            fArena->deallocate(p, n * sizeof(T));
+        }
+
+        template <typename U>
+        bool operator==(const NodeArenaAllocator<U>& other) const noexcept { return fArena == other.fArena; }
+        template <typename U>
+        bool operator!=(const NodeArenaAllocator<U>& other) const noexcept { return fArena != other.fArena; }
+    };
+
+
+    // NodeArenaGuard
+    //
+    // Make an arena current on this thread for the life of the guard.
+    // Guards nest, the previous arena is restored on the way out.
+    struct NodeArenaGuard
+    {
+        NodeArena* fPrevious{ nullptr };
+
+        explicit NodeArenaGuard(NodeArena* arena) noexcept
+            : fPrevious(NodeArena::setCurrent(arena))
+        {}
+
+        ~NodeArenaGuard() { NodeArena::setCurrent(fPrevious); }
+
+        NodeArenaGuard(const NodeArenaGuard&) = delete;
+        NodeArenaGuard& operator=(const NodeArenaGuard&) = delete;
+    };
+
+
+    // makeNode()
+    //
+    // Drop in replacement for std::make_shared(), for anything that
+    // becomes part of a document.  An arena that isn't owned by a
+    // std::shared_ptr can't be shared with the node, so the node
+    // comes from the heap instead.
+    template <typename T, typename... Args>
+    std::shared_ptr<T> makeNode(Args&&... args)
+    {
+        NodeArena* arena = NodeArena::current();
+        std::shared_ptr<NodeArena> owner = arena ? arena->weak_from_this().lock() : nullptr;
+        if (!owner)
+            return std::make_shared<T>(std::forward<Args>(args)...);
+
+        return std::allocate_shared<T>(NodeArenaAllocator<T>(std::move(owner)), std::forward<Args>(args)...);
+    }
+}
@@ -3,33 +3,503 @@
 #include "pathattribute_parser.h"
 #include "pathprogram_builder.h"
 #include "pathsegment_normalizer.h"
+#include "scanning.h"
+
+//
+// Bulk path data parsing
+//
+// The 'd' attribute of a path can easily run to megabytes in
+// cartographic data, so turning it into a PathProgram is one of
+// the hottest things done while loading a document.
+//
+// The general machinery (SVGSegmentIterator -> PathSegment ->
+// PathSegmentNormalizer -> PathProgramBuilder) hands each segment
+// through several layers.  parsePathProgram() fuses all of that
+// into a single loop which reads the numbers, does the relative to
+// absolute and shorthand expansion, and writes the normalized ops
+// and args straight into the PathProgram.
+//
+// Before parsing, the data is classified 64 bytes at a time, finding
+// the command letters and where each number starts, so the program
+// can be sized once up front, instead of growing as it goes.  The same
+// classification is used to skip over long runs of separators, such
+// as the indentation of pretty printed path data.
+//
 
 namespace waavs
 {
+    static constexpr size_t kPathBlockSize = 64;
+
+    struct PathBlockMasks
+    {
+        uint64_t num{ 0 };      // '0'..'9', '.'
+        uint64_t sign{ 0 };     // '+', '-'
+        uint64_t expo{ 0 };     // 'e', 'E'
+        uint64_t alpha{ 0 };    // 'a'..'z', 'A'..'Z'
+        uint64_t sep{ 0 };      // whitespace, ','
+    };
+
+    static INLINE bool path_is_separator(uint8_t c) noexcept
+    {
+        return (c == ' ') || (c == ',') || ((c >= '\t') && (c <= '\r'));
+    }
+
+    static INLINE void path_classify_block_scalar(const uint8_t* p, PathBlockMasks& m) noexcept
+    {
+        for (size_t i = 0; i < kPathBlockSize; ++i)
+        {
+            const uint64_t bit = uint64_t(1) << i;
+            const uint8_t c = p[i];
+
+            if (((c >= '0') && (c <= '9')) || (c == '.'))
+                m.num |= bit;
+            else if ((c == '+') || (c == '-'))
+                m.sign |= bit;
+            else if (((c | 0x20) >= 'a') && ((c | 0x20) <= 'z'))
+            {
+                m.alpha |= bit;
+                if ((c | 0x20) == 'e')
+                    m.expo |= bit;
+            }
+            else if (path_is_separator(c))
+                m.sep |= bit;
+        }
+    }
+
+#if defined(__SSE2__)
+    // Lanes where lo <= v <= hi, unsigned
+    static INLINE __m128i sse2_range_u8(__m128i v, uint8_t lo, uint8_t hi) noexcept
+    {
+        const __m128i geLo = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8((char)lo)), v);
+        const __m128i leHi = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8((char)hi)), v);
+        return _mm_and_si128(geLo, leHi);
+    }
+
+    static INLINE void path_classify_block_sse2(const uint8_t* p, PathBlockMasks& m) noexcept
+    {
+        for (size_t i = 0; i < 4; ++i)
+        {
+            const __m128i v = _mm_loadu_si128((const __m128i*)(p + i * 16));
+            const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+
+            const __m128i num = _mm_or_si128(sse2_range_u8(v, '0', '9'), _mm_cmpeq_epi8(v, _mm_set1_epi8('.')));
+            const __m128i sign = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('+')), _mm_cmpeq_epi8(v, _mm_set1_epi8('-')));
+            const __m128i alpha = sse2_range_u8(lower, 'a', 'z');
+            const __m128i expo = _mm_cmpeq_epi8(lower, _mm_set1_epi8('e'));
+            const __m128i sep = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))),
+                sse2_range_u8(v, '\t', '\r'));
+
+            const size_t shift = i * 16;
+            m.num |= uint64_t((uint32_t)_mm_movemask_epi8(num)) << shift;
+            m.sign |= uint64_t((uint32_t)_mm_movemask_epi8(sign)) << shift;
+            m.alpha |= uint64_t((uint32_t)_mm_movemask_epi8(alpha)) << shift;
+            m.expo |= uint64_t((uint32_t)_mm_movemask_epi8(expo)) << shift;
+            m.sep |= uint64_t((uint32_t)_mm_movemask_epi8(sep)) << shift;
+        }
+    }
+#endif
+
+#if WAAVS_HAS_NEON
+    static INLINE uint8x16_t neon_range_u8(uint8x16_t v, uint8_t lo, uint8_t hi) noexcept
+    {
+        return vandq_u8(vcgeq_u8(v, vdupq_n_u8(lo)), vcleq_u8(v, vdupq_n_u8(hi)));
+    }
+
+    static INLINE void path_classify_block_neon(const uint8_t* p, PathBlockMasks& m) noexcept
+    {
+        for (size_t i = 0; i < 4; ++i)
+        {
+            const uint8x16_t v = vld1q_u8(p + i * 16);
+            const uint8x16_t lower = vorrq_u8(v, vdupq_n_u8(0x20));
+
+            const uint8x16_t num = vorrq_u8(neon_range_u8(v, '0', '9'), vceqq_u8(v, vdupq_n_u8('.')));
+            const uint8x16_t sign = vorrq_u8(vceqq_u8(v, vdupq_n_u8('+')), vceqq_u8(v, vdupq_n_u8('-')));
+            const uint8x16_t alpha = neon_range_u8(lower, 'a', 'z');
+            const uint8x16_t expo = vceqq_u8(lower, vdupq_n_u8('e'));
+            const uint8x16_t sep = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8(','))),
+                neon_range_u8(v, '\t', '\r'));
+
+            const size_t shift = i * 16;
+            m.num |= uint64_t(neon_movemask_u8(num)) << shift;
+            m.sign |= uint64_t(neon_movemask_u8(sign)) << shift;
+            m.alpha |= uint64_t(neon_movemask_u8(alpha)) << shift;
+            m.expo |= uint64_t(neon_movemask_u8(expo)) << shift;
+            m.sep |= uint64_t(neon_movemask_u8(sep)) << shift;
+        }
+    }
+#endif
+
+    // path_classify_block()
+    //
+    // Classify up to 64 bytes starting at 'p'.  As with the xml
+    // classifier, a short tail is copied into a zero padded buffer,
+    // and zero doesn't belong to any of the classes.
+    static INLINE void path_classify_block(const uint8_t* p, size_t n, PathBlockMasks& m) noexcept
+    {
+        m = {};
+
+        alignas(64) uint8_t tail[kPathBlockSize];
+        const uint8_t* src = p;
+
+        if (n < kPathBlockSize)
+        {
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, p, n);
+            src = tail;
+        }
+
+#if defined(__SSE2__)
+        path_classify_block_sse2(src, m);
+#elif WAAVS_HAS_NEON
+        path_classify_block_neon(src, m);
+#else
+        path_classify_block_scalar(src, m);
+#endif
+    }
+
+    // pathdata_estimate()
+    //
+    // Count the commands, and the places where a number starts, to
+    // size the program before parsing.  A number starts at a digit
+    // or '.' that doesn't continue a number, or at a sign that
+    // doesn't follow an exponent marker.  Things like "1.5.5" or
+    // packed arc flags make this an estimate rather than exact.
+    static INLINE void pathdata_estimate(const ByteSpan& s, size_t& outOps, size_t& outArgs) noexcept
+    {
+        size_t commands = 0;
+        size_t numbers = 0;
+
+        // carry the last byte's classes into the next block
+        uint64_t prevInNumber = 0;
+        uint64_t prevExpo = 0;
+
+        const uint8_t* p = s.begin();
+        const uint8_t* end = s.end();
+
+        while (p < end)
+        {
+            const size_t n = std::min<size_t>(size_t(end - p), kPathBlockSize);
+
+            PathBlockMasks m;
+            path_classify_block(p, n, m);
+
+            const uint64_t inNumber = m.num | m.sign | m.expo;
+            const uint64_t afterInNumber = (inNumber << 1) | prevInNumber;
+            const uint64_t afterExpo = (m.expo << 1) | prevExpo;
+
+            const uint64_t starts = (m.num & ~afterInNumber) | (m.sign & ~afterExpo);
+
+            commands += scan_popcount_u64(m.alpha & ~m.expo);
+            numbers += scan_popcount_u64(starts);
+
+            prevInNumber = inNumber >> 63;
+            prevExpo = m.expo >> 63;
+
+            p += n;
+        }
+
+        // Repeated commands add an op per set of arguments, and
+        // H, V, S, T expand to more arguments than they were given
+        outOps = commands + (numbers / 2) + 1;
+        outArgs = numbers + (numbers / 2);
+    }
+
+    // pathdata_skip_separators()
+    //
+    // Most of the time there's a single space or comma between
+    // numbers, so look at a couple of bytes directly, and only
+    // classify whole blocks when there's a longer run.
+    static INLINE const uint8_t* pathdata_skip_separators(const uint8_t* p, const uint8_t* end) noexcept
+    {
+        if ((p < end) && !path_is_separator(*p))
+            return p;
+        if ((++p < end) && !path_is_separator(*p))
+            return p;
+
+        while (p < end)
+        {
+            const size_t n = std::min<size_t>(size_t(end - p), kPathBlockSize);
+
+            PathBlockMasks m;
+            path_classify_block(p, n, m);
+
+            const uint64_t valid = (n < kPathBlockSize) ? (~uint64_t(0) >> (kPathBlockSize - n)) : ~uint64_t(0);
+            const uint64_t notSep = ~m.sep & valid;
+            if (notSep)
+                return p + scan_ctz_u64(notSep);
+
+            p += n;
+        }
+
+        return end;
+    }
+
+    static INLINE bool pathdata_read_number(const uint8_t*& p, const uint8_t* end, float& out) noexcept
+    {
+        p = pathdata_skip_separators(p, end);
+        if (p >= end)
+            return false;
+
+        ByteSpan s = ByteSpan::fromPointers(p, end);
+        double value{ 0 };
+        if (!readNumber(s, value))
+            return false;
+
+        p = s.begin();
+        out = (float)value;
+
+        return true;
+    }
+
+    static INLINE bool pathdata_read_flag(const uint8_t*& p, const uint8_t* end, float& out) noexcept
+    {
+        p = pathdata_skip_separators(p, end);
+        if ((p >= end) || ((*p != '0') && (*p != '1')))
+            return false;
+
+        out = (float)(*p - '0');
+        p++;
+
+        return true;
+    }
+
     // ------------------------------------------------------------
     // parsePathProgram()
-    // 
-    // build a PathProgram from path data, 
+    //
+    // build a PathProgram from path data,
     // represented by SVG <path> 'd' attribute.
     // The program is a canonicalized, normalized representation of the path data,
-    // so, there are no relative commands, no implicit lineto after moveto, 
+    // so, there are no relative commands, no implicit lineto after moveto,
     // arcs are in endpoint form, etc.
+    //
+    // As per the SVG error handling rules, parsing stops at the first
+    // thing that's in error, and the program holds everything up to there.
     // ------------------------------------------------------------
 
     static INLINE bool parsePathProgram(const ByteSpan& inSpan, PathProgram& outProg) noexcept
     {
-        PathProgramBuilder builder;
-        PathSegmentNormalizer normalizer(builder);
+        outProg.clear();
+
+        size_t opEstimate = 0;
+        size_t argEstimate = 0;
+        pathdata_estimate(inSpan, opEstimate, argEstimate);
+        outProg.ops.reserve(opEstimate);
+        outProg.args.reserve(argEstimate);
+
+        std::vector<uint8_t>& ops = outProg.ops;
+        std::vector<float>& args = outProg.args;
+
+        // Current point, and subpath start
+        float cx = 0.0f, cy = 0.0f;
+        float sx = 0.0f, sy = 0.0f;
+        bool hasCP = false;
+        bool subpathOpen = false;
+
+        // Last control point, for the smooth commands
+        bool hasLastCubicCtrl = false;
+        bool hasLastQuadCtrl = false;
+        float lastCtrlX = 0.0f, lastCtrlY = 0.0f;
+
+        uint8_t cmd = 0;
+        const char* argTypes = nullptr;
+        size_t iteration = 0;
+
+        const uint8_t* p = inSpan.begin();
+        const uint8_t* end = inSpan.end();
 
-        SVGSegmentIterator iter(inSpan);
-        PathSegment seg{};
+        while (true)
+        {
+            p = pathdata_skip_separators(p, end);
+            if (p >= end)
+                break;
 
-        while (readNextSegmentCommand(iter, seg)) {
-            normalizer.consume(seg);
+            const uint8_t c = *p;
+            const bool isNumberLead = ((c >= '0') && (c <= '9')) || (c == '.') || (c == '+') || (c == '-');
+
+            if (!isNumberLead)
+            {
+                argTypes = getSegmentArgTypes(c);
+                if (!argTypes)
+                    break;
+
+                cmd = c;
+                iteration = 0;
+                p++;
+            }
+            else
+            {
+                // More arguments for the previous command, which
+                // must have taken some
+                if (!argTypes || !argTypes[0])
+                    break;
+
+                iteration++;
+            }
+
+            float a[kMaxPathArgs];
+            bool argsOk = true;
+            for (size_t i = 0; argsOk && argTypes[i]; i++)
+            {
+                argsOk = (argTypes[i] == 'f') ? pathdata_read_flag(p, end, a[i]) : pathdata_read_number(p, end, a[i]);
+            }
+
+            if (!argsOk)
+                break;
+
+            // An initial relative moveto is relative to (0,0).  Anything
+            // else before the first moveto is ignored.
+            if (!hasCP)
+            {
+                if (cmd == 'm')
+                {
+                    cx = 0.0f; cy = 0.0f;
+                    hasCP = true;
+                }
+                else if (cmd != 'M')
+                    continue;
+            }
+
+            // Relative commands are offset from the current point
+            const float ox = (cmd >= 'a') ? cx : 0.0f;
+            const float oy = (cmd >= 'a') ? cy : 0.0f;
+
+            switch (cmd)
+            {
+            case 'M': case 'm':
+            {
+                const float x = ox + a[0], y = oy + a[1];
+                if (iteration == 0)
+                {
+                    ops.push_back(OP_MOVETO);
+                    sx = x; sy = y;
+                }
+                else
+                {
+                    ops.push_back(OP_LINETO);
+                }
+                args.push_back(x); args.push_back(y);
+
+                cx = x; cy = y;
+                hasCP = true;
+                subpathOpen = true;
+                hasLastCubicCtrl = hasLastQuadCtrl = false;
+            } break;
+
+            case 'L': case 'l':
+            case 'H': case 'h':
+            case 'V': case 'v':
+            {
+                float x = cx, y = cy;
+                if ((cmd | 0x20) == 'l') { x = ox + a[0]; y = oy + a[1]; }
+                else if ((cmd | 0x20) == 'h') { x = ox + a[0]; }
+                else { y = oy + a[0]; }
+
+                ops.push_back(OP_LINETO);
+                args.push_back(x); args.push_back(y);
+
+                cx = x; cy = y;
+                subpathOpen = true;
+                hasLastCubicCtrl = hasLastQuadCtrl = false;
+            } break;
+
+            case 'C': case 'c':
+            case 'S': case 's':
+            {
+                float x1, y1;
+                const float* pa = a;
+                if ((cmd | 0x20) == 'c')
+                {
+                    x1 = ox + a[0]; y1 = oy + a[1];
+                    pa += 2;
+                }
+                else if (hasLastCubicCtrl)
+                {
+                    x1 = 2.0f * cx - lastCtrlX;
+                    y1 = 2.0f * cy - lastCtrlY;
+                }
+                else
+                {
+                    x1 = cx; y1 = cy;
+                }
+
+                const float x2 = ox + pa[0], y2 = oy + pa[1];
+                const float x = ox + pa[2], y = oy + pa[3];
+
+                ops.push_back(OP_CUBICTO);
+                args.push_back(x1); args.push_back(y1);
+                args.push_back(x2); args.push_back(y2);
+                args.push_back(x); args.push_back(y);
+
+                cx = x; cy = y;
+                subpathOpen = true;
+                hasLastCubicCtrl = true;
+                hasLastQuadCtrl = false;
+                lastCtrlX = x2; lastCtrlY = y2;
+            } break;
+
+            case 'Q': case 'q':
+            case 'T': case 't':
+            {
+                float x1, y1;
+                const float* pa = a;
+                if ((cmd | 0x20) == 'q')
+                {
+                    x1 = ox + a[0]; y1 = oy + a[1];
+                    pa += 2;
+                }
+                else if (hasLastQuadCtrl)
+                {
+                    x1 = 2.0f * cx - lastCtrlX;
+                    y1 = 2.0f * cy - lastCtrlY;
+                }
+                else
+                {
+                    x1 = cx; y1 = cy;
+                }
+
+                const float x = ox + pa[0], y = oy + pa[1];
+
+                ops.push_back(OP_QUADTO);
+                args.push_back(x1); args.push_back(y1);
+                args.push_back(x); args.push_back(y);
+
+                cx = x; cy = y;
+                subpathOpen = true;
+                hasLastQuadCtrl = true;
+                hasLastCubicCtrl = false;
+                lastCtrlX = x1; lastCtrlY = y1;
+            } break;
+
+            case 'A': case 'a':
+            {
+                const float x = ox + a[5], y = oy + a[6];
+
+                ops.push_back(OP_ARCTO);
+                args.push_back(a[0]); args.push_back(a[1]); args.push_back(a[2]);
+                args.push_back(a[3]); args.push_back(a[4]);
+                args.push_back(x); args.push_back(y);
+
+                cx = x; cy = y;
+                subpathOpen = true;
+                hasLastCubicCtrl = hasLastQuadCtrl = false;
+            } break;
+
+            case 'Z': case 'z':
+            {
+                // Closing something that isn't open emits nothing, but
+                // the current point still goes back to the subpath start
+                if (subpathOpen)
+                    ops.push_back(OP_CLOSE);
+
+                cx = sx; cy = sy;
+                subpathOpen = false;
+                hasLastCubicCtrl = hasLastQuadCtrl = false;
+            } break;
+            }
         }
 
-        builder.end();
-        outProg = std::move(builder.prog);
+        ops.push_back(OP_END);
+
         return true;
     }
 }
@@ -499,4 +499,366 @@ static INLINE const uint8_t* find_first_not_namestart_ascii(
 #else
     return find_first_not_namestart_ascii_scalar(p, end);
 #endif
-}
\ No newline at end of file
+}
+
+// ------------------------------------------------------------
+// Structural indexing
+//
+// Rather than looking at the XML a byte at a time, we classify
+// a 64-byte block in one go, producing a bitmask per class of
+// character the tokenizer cares about.  Bit 'i' of a mask is
+// set when byte 'i' of the block belongs to that class.
+//
+// The tokenizer then jumps from one interesting byte to the next
+// by counting trailing zeros, instead of testing every byte.
+// ------------------------------------------------------------
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static constexpr size_t kXmlBlockSize = 64;
+
+struct XmlBlockMasks
+{
+    uint64_t lt{ 0 };       // '<'
+    uint64_t gt{ 0 };       // '>'
+    uint64_t dquote{ 0 };   // '"'
+    uint64_t squote{ 0 };   // '\''
+    uint64_t eq{ 0 };       // '='
+    uint64_t wsp{ 0 };      // ' ', '\t', '\r', '\n'
+    uint64_t valid{ 0 };    // bytes of the block that are actually part of the input
+};
+
+// Index of lowest set bit.  Caller guarantees v != 0
+static INLINE uint32_t scan_ctz_u64(uint64_t v) noexcept
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long idx;
+    _BitScanForward64(&idx, v);
+    return (uint32_t)idx;
+#elif defined(_MSC_VER)
+    unsigned long idx;
+    if (_BitScanForward(&idx, (uint32_t)v))
+        return (uint32_t)idx;
+    _BitScanForward(&idx, (uint32_t)(v >> 32));
+    return (uint32_t)idx + 32;
+#else
+    return (uint32_t)__builtin_ctzll(v);
+#endif
+}
+
+// Number of set bits
+static INLINE uint32_t scan_popcount_u64(uint64_t v) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_popcountll(v);
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (uint32_t)((v * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+static INLINE void xml_classify_block_scalar(const uint8_t* p, XmlBlockMasks& m) noexcept
+{
+    for (size_t i = 0; i < kXmlBlockSize; ++i)
+    {
+        const uint64_t bit = uint64_t(1) << i;
+        switch (p[i])
+        {
+        case '<': m.lt |= bit; break;
+        case '>': m.gt |= bit; break;
+        case '"': m.dquote |= bit; break;
+        case '\'': m.squote |= bit; break;
+        case '=': m.eq |= bit; break;
+        case ' ': case '\t': case '\r': case '\n': m.wsp |= bit; break;
+        default: break;
+        }
+    }
+}
+
+#if defined(__AVX2__)
+static INLINE uint64_t avx2_eq_mask64(__m256i lo, __m256i hi, char c) noexcept
+{
+    const __m256i vc = _mm256_set1_epi8(c);
+    const uint32_t a = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, vc));
+    const uint32_t b = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, vc));
+    return uint64_t(a) | (uint64_t(b) << 32);
+}
+
+static INLINE void xml_classify_block_avx2(const uint8_t* p, XmlBlockMasks& m) noexcept
+{
+    const __m256i lo = _mm256_loadu_si256((const __m256i*)p);
+    const __m256i hi = _mm256_loadu_si256((const __m256i*)(p + 32));
+
+    m.lt = avx2_eq_mask64(lo, hi, '<');
+    m.gt = avx2_eq_mask64(lo, hi, '>');
+    m.dquote = avx2_eq_mask64(lo, hi, '"');
+    m.squote = avx2_eq_mask64(lo, hi, '\'');
+    m.eq = avx2_eq_mask64(lo, hi, '=');
+
+    m.wsp = avx2_eq_mask64(lo, hi, ' ') |
+        avx2_eq_mask64(lo, hi, '\t') |
+        avx2_eq_mask64(lo, hi, '\r') |
+        avx2_eq_mask64(lo, hi, '\n');
+}
+#endif
+
+#if defined(__SSE2__)
+static INLINE uint64_t sse2_eq_mask64(const __m128i v[4], char c) noexcept
+{
+    const __m128i vc = _mm_set1_epi8(c);
+    const uint64_t a = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v[0], vc));
+    const uint64_t b = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v[1], vc));
+    const uint64_t cc = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v[2], vc));
+    const uint64_t d = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v[3], vc));
+    return a | (b << 16) | (cc << 32) | (d << 48);
+}
+
+static INLINE void xml_classify_block_sse2(const uint8_t* p, XmlBlockMasks& m) noexcept
+{
+    __m128i v[4];
+    v[0] = _mm_loadu_si128((const __m128i*)(p));
+    v[1] = _mm_loadu_si128((const __m128i*)(p + 16));
+    v[2] = _mm_loadu_si128((const __m128i*)(p + 32));
+    v[3] = _mm_loadu_si128((const __m128i*)(p + 48));
+
+    m.lt = sse2_eq_mask64(v, '<');
+    m.gt = sse2_eq_mask64(v, '>');
+    m.dquote = sse2_eq_mask64(v, '"');
+    m.squote = sse2_eq_mask64(v, '\'');
+    m.eq = sse2_eq_mask64(v, '=');
+    m.wsp = sse2_eq_mask64(v, ' ') |
+        sse2_eq_mask64(v, '\t') |
+        sse2_eq_mask64(v, '\r') |
+        sse2_eq_mask64(v, '\n');
+}
+#endif
+
+#if WAAVS_HAS_NEON
+// Turn a 0xFF/0x00 lane mask into a 16-bit integer mask, one bit per lane.
+// Only uses pairwise adds, so it works on both ARMv7 NEON and AArch64
+static INLINE uint16_t neon_movemask_u8(uint8x16_t mask) noexcept
+{
+    static const uint8_t kWeights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    const uint8x16_t m = vandq_u8(mask, vld1q_u8(kWeights));
+
+    uint8x8_t t = vpadd_u8(vget_low_u8(m), vget_high_u8(m));
+    t = vpadd_u8(t, t);
+    t = vpadd_u8(t, t);
+
+    return vget_lane_u16(vreinterpret_u16_u8(t), 0);
+}
+
+static INLINE uint64_t neon_eq_mask64(const uint8x16_t v[4], uint8_t c) noexcept
+{
+    const uint8x16_t vc = vdupq_n_u8(c);
+    const uint64_t a = neon_movemask_u8(vceqq_u8(v[0], vc));
+    const uint64_t b = neon_movemask_u8(vceqq_u8(v[1], vc));
+    const uint64_t cc = neon_movemask_u8(vceqq_u8(v[2], vc));
+    const uint64_t d = neon_movemask_u8(vceqq_u8(v[3], vc));
+    return a | (b << 16) | (cc << 32) | (d << 48);
+}
+
+static INLINE void xml_classify_block_neon(const uint8_t* p, XmlBlockMasks& m) noexcept
+{
+    uint8x16_t v[4];
+    v[0] = vld1q_u8(p);
+    v[1] = vld1q_u8(p + 16);
+    v[2] = vld1q_u8(p + 32);
+    v[3] = vld1q_u8(p + 48);
+
+    m.lt = neon_eq_mask64(v, '<');
+    m.gt = neon_eq_mask64(v, '>');
+    m.dquote = neon_eq_mask64(v, '"');
+    m.squote = neon_eq_mask64(v, '\'');
+    m.eq = neon_eq_mask64(v, '=');
+    m.wsp = neon_eq_mask64(v, ' ') |
+        neon_eq_mask64(v, '\t') |
+        neon_eq_mask64(v, '\r') |
+        neon_eq_mask64(v, '\n');
+}
+#endif
+
+// xml_classify_block()
+//
+// Classify up to 64 bytes starting at 'p'.  When fewer than 64 bytes
+// remain, the tail is copied into a zero padded buffer so the vector
+// loads never read past the end of the input.  Zero is not a structural
+// character, so the padding never produces spurious bits, and 'valid'
+// tells the caller where the real input stops.
+static INLINE void xml_classify_block(const uint8_t* p, size_t n, XmlBlockMasks& m) noexcept
+{
+    m = {};
+
+    alignas(64) uint8_t tail[kXmlBlockSize];
+    const uint8_t* src = p;
+
+    if (n < kXmlBlockSize)
+    {
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, p, n);
+        src = tail;
+        m.valid = n ? (~uint64_t(0) >> (kXmlBlockSize - n)) : 0;
+    }
+    else
+    {
+        m.valid = ~uint64_t(0);
+    }
+
+#if defined(__AVX2__)
+    xml_classify_block_avx2(src, m);
+#elif defined(__SSE2__)
+    xml_classify_block_sse2(src, m);
+#elif WAAVS_HAS_NEON
+    xml_classify_block_neon(src, m);
+#else
+    xml_classify_block_scalar(src, m);
+#endif
+
+    m.lt &= m.valid;
+    m.gt &= m.valid;
+    m.dquote &= m.valid;
+    m.squote &= m.valid;
+    m.eq &= m.valid;
+    m.wsp &= m.valid;
+}
+
+// XmlStructuralIndex
+//
+// Holds the classification of the most recently visited block.  
+// The tokenizer asks for the masks covering a pointer, and the 
+// block is only re-classified once the cursor has moved beyond it.
+// Consecutive tokens within the same 64 bytes share one classification.
+struct XmlStructuralIndex
+{
+    const uint8_t* fBase{ nullptr };
+    size_t fLength{ 0 };
+    XmlBlockMasks fMasks{};
+
+    void reset() noexcept
+    {
+        fBase = nullptr;
+        fLength = 0;
+        fMasks = {};
+    }
+
+    // Return the masks of a block containing 'p', along with the bit
+    // offset of 'p' within that block.
+    INLINE const XmlBlockMasks& at(const uint8_t* p, const uint8_t* end, uint32_t& offset) noexcept
+    {
+        if (!(fBase && p >= fBase && p < fBase + fLength))
+        {
+            const size_t remaining = (size_t)(end - p);
+            fBase = p;
+            fLength = remaining < kXmlBlockSize ? remaining : kXmlBlockSize;
+            xml_classify_block(p, fLength, fMasks);
+        }
+
+        offset = (uint32_t)(p - fBase);
+        return fMasks;
+    }
+};
+
+// Select the bits of 'mask' at or above 'offset'
+static INLINE uint64_t xml_mask_from(uint64_t mask, uint32_t offset) noexcept
+{
+    return (offset < kXmlBlockSize) ? (mask & (~uint64_t(0) << offset)) : 0;
+}
+
+// xml_index_find_lt()
+//
+// Find the next '<', or end if there is none
+static INLINE const uint8_t* xml_index_find_lt(XmlStructuralIndex& idx, const uint8_t* p, const uint8_t* end) noexcept
+{
+    while (p < end)
+    {
+        uint32_t off = 0;
+        const XmlBlockMasks& m = idx.at(p, end, off);
+
+        const uint64_t bits = xml_mask_from(m.lt, off);
+        if (bits)
+            return idx.fBase + scan_ctz_u64(bits);
+
+        p = idx.fBase + idx.fLength;
+    }
+
+    return end;
+}
+
+// xml_index_skip_wsp()
+//
+// Return the first byte that is not XML whitespace, or end
+static INLINE const uint8_t* xml_index_skip_wsp(XmlStructuralIndex& idx, const uint8_t* p, const uint8_t* end) noexcept
+{
+    while (p < end)
+    {
+        uint32_t off = 0;
+        const XmlBlockMasks& m = idx.at(p, end, off);
+
+        const uint64_t bits = xml_mask_from(~m.wsp & m.valid, off);
+        if (bits)
+            return idx.fBase + scan_ctz_u64(bits);
+
+        p = idx.fBase + idx.fLength;
+    }
+
+    return end;
+}
+
+// xml_index_find_tag_end()
+//
+// Starting inside a tag, find the '>' that closes it, skipping any
+// '>' that appear within quoted attribute values.  Only the quote 
+// and '>' positions are visited, everything else is skipped in bulk.
+// Returns end if the tag is not closed.
+static INLINE const uint8_t* xml_index_find_tag_end(XmlStructuralIndex& idx, const uint8_t* p, const uint8_t* end) noexcept
+{
+    uint8_t quote = 0;
+
+    while (p < end)
+    {
+        uint32_t off = 0;
+        const XmlBlockMasks& m = idx.at(p, end, off);
+
+        uint64_t bits = 0;
+        if (quote == '"')
+            bits = m.dquote;
+        else if (quote == '\'')
+            bits = m.squote;
+        else
+            bits = m.gt | m.dquote | m.squote;
+
+        bits = xml_mask_from(bits, off);
+
+        while (bits)
+        {
+            const uint8_t* q = idx.fBase + scan_ctz_u64(bits);
+            const uint8_t c = *q;
+
+            if (quote)
+            {
+                // The only bits we're looking at are the matching quote
+                quote = 0;
+                bits = xml_mask_from(m.gt | m.dquote | m.squote, (uint32_t)(q - idx.fBase) + 1);
+                continue;
+            }
+
+            if (c == '>')
+                return q;
+
+            // opening a quoted section
+            quote = c;
+            bits = xml_mask_from((c == '"') ? m.dquote : m.squote, (uint32_t)(q - idx.fBase) + 1);
+        }
+
+        p = idx.fBase + idx.fLength;
+    }
+
+    return end;
+}
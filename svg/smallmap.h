@@ -0,0 +1,266 @@
+#pragma once
+
+//
+// SmallFlatMap
+//
+// A key/value map for the very common case where there are only a
+// handful of entries, such as the attributes of a single element.
+//
+// The first few entries live inline, in a pair of flat arrays, one
+// for the keys, and one for the values.  Finding a key is a linear
+// scan of the key array, which for pointer keys (interned names) is
+// a straight pointer compare, done a few at a time with SIMD where
+// it's available.  No allocation happens at all until the inline
+// capacity is exceeded.
+//
+// Past the inline capacity, the entries spill into heap allocated
+// arrays, and a hash index is built over them, so an element with
+// a large number of attributes doesn't degrade into long scans.
+//
+// Entries are kept in insertion order, and iteration yields
+// pair like values, with '.first' being the key, and '.second' the value.
+// Since those are proxies, iterate with 'const auto&' or 'auto'.
+//
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "scanning.h"
+
+
+namespace waavs
+{
+    // small_find_ptr()
+    //
+    // Return the index of 'key' within an array of 'n' pointers,
+    // or 'n' if it's not there.
+    static INLINE size_t small_find_ptr(const void* const* keys, size_t n, const void* key) noexcept
+    {
+        size_t i = 0;
+
+#if defined(__AVX2__) && (defined(__x86_64__) || defined(_M_X64))
+        const __m256i needle = _mm256_set1_epi64x((long long)(uintptr_t)key);
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m256i v = _mm256_loadu_si256((const __m256i*)(keys + i));
+            const int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, needle)));
+            if (mask)
+                return i + scan_ctz_u64((uint64_t)mask);
+        }
+#endif
+
+        for (; i < n; ++i)
+        {
+            if (keys[i] == key)
+                return i;
+        }
+
+        return n;
+    }
+
+
+    template <typename K, typename V, size_t N = 8, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+    struct SmallFlatMap
+    {
+        static constexpr size_t kInlineCapacity = N;
+
+        using IndexMap = std::unordered_map<K, uint32_t, Hash, Eq>;
+
+    private:
+        K fInlineKeys[N]{};
+        V fInlineValues[N]{};
+
+        // Only used once we've spilled past the inline capacity
+        std::vector<K> fHeapKeys{};
+        std::vector<V> fHeapValues{};
+        std::unique_ptr<IndexMap> fIndex{};
+
+        uint32_t fCount{ 0 };
+
+    public:
+        // Iteration yields a (key, value) pair of references
+        template <bool IsConst>
+        struct Iter
+        {
+            using ValuePtr = std::conditional_t<IsConst, const V*, V*>;
+            using ValueRef = std::conditional_t<IsConst, const V&, V&>;
+
+            const K* fKey{ nullptr };
+            ValuePtr fValue{ nullptr };
+
+            std::pair<const K&, ValueRef> operator*() const noexcept { return { *fKey, *fValue }; }
+            Iter& operator++() noexcept { ++fKey; ++fValue; return *this; }
+            bool operator==(const Iter& other) const noexcept { return fKey == other.fKey; }
+            bool operator!=(const Iter& other) const noexcept { return fKey != other.fKey; }
+        };
+
+        using iterator = Iter<false>;
+        using const_iterator = Iter<true>;
+
+        SmallFlatMap() = default;
+
+        SmallFlatMap(const SmallFlatMap& other)
+        {
+            *this = other;
+        }
+
+        SmallFlatMap(SmallFlatMap&& other) noexcept
+        {
+            *this = std::move(other);
+        }
+
+        SmallFlatMap& operator=(const SmallFlatMap& other)
+        {
+            if (this == &other)
+                return *this;
+
+            for (size_t i = 0; i < N; i++)
+            {
+                fInlineKeys[i] = other.fInlineKeys[i];
+                fInlineValues[i] = other.fInlineValues[i];
+            }
+            fHeapKeys = other.fHeapKeys;
+            fHeapValues = other.fHeapValues;
+            fIndex = other.fIndex ? std::make_unique<IndexMap>(*other.fIndex) : nullptr;
+            fCount = other.fCount;
+
+            return *this;
+        }
+
+        SmallFlatMap& operator=(SmallFlatMap&& other) noexcept
+        {
+            if (this == &other)
+                return *this;
+
+            for (size_t i = 0; i < N; i++)
+            {
+                fInlineKeys[i] = std::move(other.fInlineKeys[i]);
+                fInlineValues[i] = std::move(other.fInlineValues[i]);
+            }
+            fHeapKeys = std::move(other.fHeapKeys);
+            fHeapValues = std::move(other.fHeapValues);
+            fIndex = std::move(other.fIndex);
+            fCount = other.fCount;
+
+            other.fCount = 0;
+
+            return *this;
+        }
+
+        size_t size() const noexcept { return fCount; }
+        bool empty() const noexcept { return fCount == 0; }
+        bool spilled() const noexcept { return fIndex != nullptr; }
+
+        void clear() noexcept
+        {
+            fCount = 0;
+            fIndex.reset();
+            std::vector<K>().swap(fHeapKeys);
+            std::vector<V>().swap(fHeapValues);
+        }
+
+        const K* keys() const noexcept { return spilled() ? fHeapKeys.data() : fInlineKeys; }
+        const V* values() const noexcept { return spilled() ? fHeapValues.data() : fInlineValues; }
+        V* values() noexcept { return spilled() ? fHeapValues.data() : fInlineValues; }
+
+        iterator begin() noexcept { return { keys(), values() }; }
+        iterator end() noexcept { return { keys() + fCount, values() + fCount }; }
+        const_iterator begin() const noexcept { return { keys(), values() }; }
+        const_iterator end() const noexcept { return { keys() + fCount, values() + fCount }; }
+
+        // indexOf()
+        //
+        // Position of the key within keys()/values(), or size() if
+        // the key is not in the map
+        size_t indexOf(const K& key) const noexcept
+        {
+            if (spilled())
+            {
+                auto it = fIndex->find(key);
+                return it != fIndex->end() ? it->second : fCount;
+            }
+
+            if constexpr (std::is_pointer<K>::value)
+            {
+                return small_find_ptr(reinterpret_cast<const void* const*>(fInlineKeys), fCount, key);
+            }
+            else
+            {
+                Eq eq{};
+                for (size_t i = 0; i < fCount; i++)
+                {
+                    if (eq(fInlineKeys[i], key))
+                        return i;
+                }
+                return fCount;
+            }
+        }
+
+        bool contains(const K& key) const noexcept { return indexOf(key) < fCount; }
+
+        const V* find(const K& key) const noexcept
+        {
+            const size_t idx = indexOf(key);
+            return idx < fCount ? values() + idx : nullptr;
+        }
+
+        V* find(const K& key) noexcept
+        {
+            const size_t idx = indexOf(key);
+            return idx < fCount ? values() + idx : nullptr;
+        }
+
+        // set()
+        //
+        // Add the key, or replace its value if it's already there
+        void set(const K& key, const V& value)
+        {
+            (*this)[key] = value;
+        }
+
+        V& operator[](const K& key)
+        {
+            const size_t idx = indexOf(key);
+            if (idx < fCount)
+                return values()[idx];
+
+            if (fCount < N)
+            {
+                fInlineKeys[fCount] = key;
+                fInlineValues[fCount] = V{};
+                return fInlineValues[fCount++];
+            }
+
+            if (!spilled())
+                spill();
+
+            fHeapKeys.push_back(key);
+            fHeapValues.push_back(V{});
+            fIndex->emplace(key, fCount);
+            fCount++;
+
+            return fHeapValues.back();
+        }
+
+    private:
+        // Move the inline entries to the heap, and start indexing
+        void spill()
+        {
+            fHeapKeys.reserve(N * 2);
+            fHeapValues.reserve(N * 2);
+            fIndex = std::make_unique<IndexMap>();
+            fIndex->reserve(N * 2);
+
+            for (uint32_t i = 0; i < fCount; i++)
+            {
+                fHeapKeys.push_back(std::move(fInlineKeys[i]));
+                fHeapValues.push_back(std::move(fInlineValues[i]));
+                fIndex->emplace(fHeapKeys.back(), i);
+            }
+        }
+    };
+}
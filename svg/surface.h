@@ -1,6 +1,8 @@
 // surface.h
 #pragma once
 
+#include <algorithm>
+
 #include "membuff.h"
 
 #include "surface_draw.h"
@@ -219,6 +221,12 @@ namespace waavs
             return fMemory != nullptr && fInfo.data != fMemory->data();
         }
 
+        // Whether anything else, a view or a copy, holds the same memory
+        bool isShared() const noexcept
+        {
+            return fMemory != nullptr && fMemory->refCount.load(std::memory_order_acquire) > 1;
+        }
+
         WGRectI boundsI() const noexcept
         {
             return WGRectI{ 0, 0, fInfo.width, fInfo.height };
@@ -256,6 +264,32 @@ namespace waavs
             (void)wg_surface_clear(fInfo);
         }
 
+        // clearOutside()
+        //
+        // Clear everything but 'keep', for when whatever is in 'keep'
+        // is about to be written anyway.
+        void clearOutside(const WGRectI& keep) noexcept
+        {
+            const int w = fInfo.width;
+            const int h = fInfo.height;
+
+            const int x0 = std::clamp(keep.x, 0, w);
+            const int y0 = std::clamp(keep.y, 0, h);
+            const int x1 = std::clamp(keep.x + keep.w, x0, w);
+            const int y1 = std::clamp(keep.y + keep.h, y0, h);
+
+            if (x1 <= x0 || y1 <= y0)
+            {
+                clearAll();
+                return;
+            }
+
+            fillRect(WGRectI{ 0, 0, w, y0 }, Pixel_ARGB32(0));
+            fillRect(WGRectI{ 0, y1, w, h - y1 }, Pixel_ARGB32(0));
+            fillRect(WGRectI{ 0, y0, x0, y1 - y0 }, Pixel_ARGB32(0));
+            fillRect(WGRectI{ x1, y0, w - x1, y1 - y0 }, Pixel_ARGB32(0));
+        }
+
         void fillAll(Pixel_ARGB32 rgbaPremul) noexcept
         {
             wg_surface_fill(fInfo, rgbaPremul);
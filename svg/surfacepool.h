@@ -0,0 +1,188 @@
+// surfacepool.h
+#pragma once
+
+//
+// SurfacePool
+//
+// Offscreen surfaces come and go constantly while drawing.  Every
+// element with opacity, a mask, a clip or a filter gets one, as does
+// every filter primitive, and they're all about the same few sizes.
+// Rather than allocate each one fresh, a pool keeps the memory of
+// ones that are done with, and hands it out again.
+//
+// Sizes are rounded up to a bucket, so a surface of a slightly
+// different size can still reuse memory.  What's handed out is a view
+// of the pooled memory, the exact size asked for.  A surface is back
+// in the pool as soon as nothing else holds it, there's no need to
+// give it back.
+//
+// Pooled memory isn't cleared.  Neither is freshly allocated memory,
+// so whoever acquires a surface clears the parts they'll read, as
+// before.
+//
+// The pool keeps to a memory limit.  When a new surface would go over
+// it, the surfaces unused the longest are let go.  If it still won't
+// fit, the surface is allocated outside the pool, and freed as usual.
+//
+// A pool isn't thread safe, each thread drawing keeps its own.
+//
+
+#include <cstdint>
+#include <vector>
+
+#include "surface.h"
+
+
+namespace waavs
+{
+    struct SurfacePool
+    {
+        static constexpr int kGranularity = 64;     // bucket size, in pixels, each way
+        static constexpr size_t kDefaultMaxBytes = size_t(256) * 1024 * 1024;
+
+        struct Entry
+        {
+            Surface fBacking{};
+            uint64_t fLastUsed{ 0 };
+        };
+
+        std::vector<Entry> fEntries{};
+        size_t fMaxBytes{ kDefaultMaxBytes };
+        size_t fPooledBytes{ 0 };
+        uint64_t fClock{ 0 };
+
+        size_t fHits{ 0 };
+        size_t fMisses{ 0 };
+
+    private:
+        static int bucketSize(int n) noexcept
+        {
+            return ((n + kGranularity - 1) / kGranularity) * kGranularity;
+        }
+
+        static size_t entryBytes(const Entry& e) noexcept
+        {
+            return e.fBacking.stride() * e.fBacking.height();
+        }
+
+        // Let go of idle surfaces, the longest unused first, until
+        // 'needed' more bytes fit under the limit
+        bool makeRoom(size_t needed) noexcept
+        {
+            while (fPooledBytes + needed > fMaxBytes)
+            {
+                size_t oldest = fEntries.size();
+                for (size_t i = 0; i < fEntries.size(); i++)
+                {
+                    if (fEntries[i].fBacking.isShared())
+                        continue;
+
+                    if (oldest == fEntries.size() || fEntries[i].fLastUsed < fEntries[oldest].fLastUsed)
+                        oldest = i;
+                }
+
+                if (oldest == fEntries.size())
+                    return false;
+
+                fPooledBytes -= entryBytes(fEntries[oldest]);
+                fEntries[oldest] = std::move(fEntries.back());
+                fEntries.pop_back();
+            }
+
+            return true;
+        }
+
+    public:
+        SurfacePool() = default;
+        explicit SurfacePool(size_t maxBytes) noexcept : fMaxBytes(maxBytes) {}
+
+        SurfacePool(const SurfacePool&) = delete;
+        SurfacePool& operator=(const SurfacePool&) = delete;
+
+        size_t pooledBytes() const noexcept { return fPooledBytes; }
+        size_t maxBytes() const noexcept { return fMaxBytes; }
+
+        void setMaxBytes(size_t maxBytes) noexcept
+        {
+            fMaxBytes = maxBytes;
+            makeRoom(0);
+        }
+
+        // acquire()
+        //
+        // A w x h surface, with whatever was in it before
+        bool acquire(int w, int h, Surface& out) noexcept
+        {
+            out = {};
+
+            if (w <= 0 || h <= 0)
+                return false;
+
+            const int bw = bucketSize(w);
+            const int bh = bucketSize(h);
+
+            fClock++;
+
+            for (auto& e : fEntries)
+            {
+                if (int(e.fBacking.width()) != bw || int(e.fBacking.height()) != bh || e.fBacking.isShared())
+                    continue;
+
+                e.fLastUsed = fClock;
+                fHits++;
+
+                return e.fBacking.getSubSurface(WGRectI{ 0, 0, w, h }, out) == WG_SUCCESS;
+            }
+
+            fMisses++;
+
+            const size_t bytes = size_t(bw) * size_t(bh) * Surface::kBytesPerPixel;
+            if (bytes <= fMaxBytes && makeRoom(bytes))
+            {
+                Entry e{};
+                if (e.fBacking.reset(bw, bh))
+                {
+                    e.fLastUsed = fClock;
+                    fPooledBytes += bytes;
+                    fEntries.push_back(std::move(e));
+
+                    return fEntries.back().fBacking.getSubSurface(WGRectI{ 0, 0, w, h }, out) == WG_SUCCESS;
+                }
+            }
+
+            // Too big for the pool
+            return out.reset(w, h);
+        }
+
+        // trim()
+        //
+        // Let go of everything not in use
+        void trim() noexcept
+        {
+            size_t i = 0;
+            while (i < fEntries.size())
+            {
+                if (fEntries[i].fBacking.isShared())
+                {
+                    i++;
+                    continue;
+                }
+
+                fPooledBytes -= entryBytes(fEntries[i]);
+                fEntries[i] = std::move(fEntries.back());
+                fEntries.pop_back();
+            }
+        }
+    };
+
+    // acquireSurface()
+    //
+    // From 'pool' if there is one, otherwise freshly allocated
+    static INLINE bool acquireSurface(SurfacePool* pool, int w, int h, Surface& out) noexcept
+    {
+        if (pool)
+            return pool->acquire(w, h, out);
+
+        return out.reset(w, h);
+    }
+}
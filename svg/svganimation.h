@@ -87,7 +87,7 @@ namespace waavs {
 		static void registerSingularNode()
 		{
 			registerSVGSingularNode("animate", [](IAmGroot* groot, const XmlElement& elem) {
-				auto node = std::make_shared<SVGAnimateElement>(groot);
+				auto node = makeNode<SVGAnimateElement>(groot);
 				node->loadFromXmlElement(elem, groot);
 
 				return node;
@@ -97,7 +97,7 @@ namespace waavs {
 		static void registerFactory()
 		{
 			registerContainerNode("animate", [](IAmGroot* groot, XmlPull& iter) {
-				auto node = std::make_shared<SVGAnimateElement>(groot);
+				auto node = makeNode<SVGAnimateElement>(groot);
 				node->loadFromXmlPull(iter, groot);
 				node->visible(false);
 
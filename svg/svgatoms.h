@@ -12,6 +12,9 @@
 // The element names are taken care of within the registration
 // of those factory methods.  They can be placed here as well though
 // so there's no ambiguity.
+//
+// All of these names are in the static atom table (svgatomtable.h)
+// so they are resolved at compile time.
 
 
 namespace waavs::svgattr
@@ -21,153 +24,153 @@ namespace waavs::svgattr
     // ============================================================
 
     // Core identity & structure
-    inline InternedKey id() { static InternedKey k = PSNameTable::INTERN("id");            return k; }
-    inline InternedKey klass() { static InternedKey k = PSNameTable::INTERN("class");         return k; }
-    inline InternedKey style() { static InternedKey k = PSNameTable::INTERN("style");         return k; }
-    inline InternedKey display() { static InternedKey k = PSNameTable::INTERN("display");       return k; }
-    inline InternedKey visibility() { static InternedKey k = PSNameTable::INTERN("visibility");    return k; }
-    inline InternedKey systemLanguage() { static InternedKey k = PSNameTable::INTERN("systemLanguage"); return k; }
-    inline InternedKey opacity() { static InternedKey k = PSNameTable::INTERN("opacity");       return k; }
+    inline InternedKey id() { static constexpr InternedKey k = svgStaticAtom("id");            return k; }
+    inline InternedKey klass() { static constexpr InternedKey k = svgStaticAtom("class");         return k; }
+    inline InternedKey style() { static constexpr InternedKey k = svgStaticAtom("style");         return k; }
+    inline InternedKey display() { static constexpr InternedKey k = svgStaticAtom("display");       return k; }
+    inline InternedKey visibility() { static constexpr InternedKey k = svgStaticAtom("visibility");    return k; }
+    inline InternedKey systemLanguage() { static constexpr InternedKey k = svgStaticAtom("systemLanguage"); return k; }
+    inline InternedKey opacity() { static constexpr InternedKey k = svgStaticAtom("opacity");       return k; }
 
     // Geometry / positioning
-    inline InternedKey x() { static InternedKey k = PSNameTable::INTERN("x");             return k; }
-    inline InternedKey y() { static InternedKey k = PSNameTable::INTERN("y");             return k; }
-    inline InternedKey x1() { static InternedKey k = PSNameTable::INTERN("x1");            return k; }
-    inline InternedKey y1() { static InternedKey k = PSNameTable::INTERN("y1");            return k; }
-    inline InternedKey x2() { static InternedKey k = PSNameTable::INTERN("x2");            return k; }
-    inline InternedKey y2() { static InternedKey k = PSNameTable::INTERN("y2");            return k; }
-    inline InternedKey cx() { static InternedKey k = PSNameTable::INTERN("cx");            return k; }
-    inline InternedKey cy() { static InternedKey k = PSNameTable::INTERN("cy");            return k; }
-    inline InternedKey r() { static InternedKey k = PSNameTable::INTERN("r");             return k; }
-    inline InternedKey rx() { static InternedKey k = PSNameTable::INTERN("rx");            return k; }
-    inline InternedKey ry() { static InternedKey k = PSNameTable::INTERN("ry");            return k; }
-    inline InternedKey width() { static InternedKey k = PSNameTable::INTERN("width");         return k; }
-    inline InternedKey height() { static InternedKey k = PSNameTable::INTERN("height");        return k; }
+    inline InternedKey x() { static constexpr InternedKey k = svgStaticAtom("x");             return k; }
+    inline InternedKey y() { static constexpr InternedKey k = svgStaticAtom("y");             return k; }
+    inline InternedKey x1() { static constexpr InternedKey k = svgStaticAtom("x1");            return k; }
+    inline InternedKey y1() { static constexpr InternedKey k = svgStaticAtom("y1");            return k; }
+    inline InternedKey x2() { static constexpr InternedKey k = svgStaticAtom("x2");            return k; }
+    inline InternedKey y2() { static constexpr InternedKey k = svgStaticAtom("y2");            return k; }
+    inline InternedKey cx() { static constexpr InternedKey k = svgStaticAtom("cx");            return k; }
+    inline InternedKey cy() { static constexpr InternedKey k = svgStaticAtom("cy");            return k; }
+    inline InternedKey r() { static constexpr InternedKey k = svgStaticAtom("r");             return k; }
+    inline InternedKey rx() { static constexpr InternedKey k = svgStaticAtom("rx");            return k; }
+    inline InternedKey ry() { static constexpr InternedKey k = svgStaticAtom("ry");            return k; }
+    inline InternedKey width() { static constexpr InternedKey k = svgStaticAtom("width");         return k; }
+    inline InternedKey height() { static constexpr InternedKey k = svgStaticAtom("height");        return k; }
     
     // Text positioning
-    inline InternedKey dx() { static InternedKey k = PSNameTable::INTERN("dx"); return k; }
-    inline InternedKey dy() { static InternedKey k = PSNameTable::INTERN("dy"); return k; }
-    inline InternedKey rotate() { static InternedKey k = PSNameTable::INTERN("rotate"); return k; }
+    inline InternedKey dx() { static constexpr InternedKey k = svgStaticAtom("dx"); return k; }
+    inline InternedKey dy() { static constexpr InternedKey k = svgStaticAtom("dy"); return k; }
+    inline InternedKey rotate() { static constexpr InternedKey k = svgStaticAtom("rotate"); return k; }
 
     // Paths & shapes
-    inline InternedKey d() { static InternedKey k = PSNameTable::INTERN("d");             return k; }
-    inline InternedKey points() { static InternedKey k = PSNameTable::INTERN("points");        return k; }
+    inline InternedKey d() { static constexpr InternedKey k = svgStaticAtom("d");             return k; }
+    inline InternedKey points() { static constexpr InternedKey k = svgStaticAtom("points");        return k; }
 
     // Viewport & aspect
-    inline InternedKey viewBox() { static InternedKey k = PSNameTable::INTERN("viewBox");       return k; }
+    inline InternedKey viewBox() { static constexpr InternedKey k = svgStaticAtom("viewBox");       return k; }
     inline InternedKey preserveAspectRatio()
     {
-        static InternedKey k = PSNameTable::INTERN("preserveAspectRatio"); return k;
+        static constexpr InternedKey k = svgStaticAtom("preserveAspectRatio"); return k;
     }
 
     // Transforms
-    inline InternedKey transform() { static InternedKey k = PSNameTable::INTERN("transform");     return k; }
+    inline InternedKey transform() { static constexpr InternedKey k = svgStaticAtom("transform");     return k; }
 
     // Paint & stroke
-    inline InternedKey color() { static InternedKey k = PSNameTable::INTERN("color");    return k; }
-    inline InternedKey solid_color() { static InternedKey k = PSNameTable::INTERN("solid-color");    return k; }
-    inline InternedKey solid_opacity() { static InternedKey k = PSNameTable::INTERN("solid-opacity");    return k; }
-
-    inline InternedKey fill() { static InternedKey k = PSNameTable::INTERN("fill");          return k; }
-    inline InternedKey fill_opacity() { static InternedKey k = PSNameTable::INTERN("fill-opacity");  return k; }
-    inline InternedKey fill_rule() { static InternedKey k = PSNameTable::INTERN("fill-rule");     return k; }
-
-    inline InternedKey stroke() { static InternedKey k = PSNameTable::INTERN("stroke");        return k; }
-    inline InternedKey stroke_opacity() { static InternedKey k = PSNameTable::INTERN("stroke-opacity"); return k; }
-    inline InternedKey stroke_width() { static InternedKey k = PSNameTable::INTERN("stroke-width");  return k; }
-    inline InternedKey stroke_linecap() { static InternedKey k = PSNameTable::INTERN("stroke-linecap"); return k; }
-    inline InternedKey stroke_linecap_start() { static InternedKey k = PSNameTable::INTERN("stroke-linecap-start"); return k; }
-    inline InternedKey stroke_linecap_end() { static InternedKey k = PSNameTable::INTERN("stroke-linecap-end"); return k; }
-    inline InternedKey stroke_linejoin(){static InternedKey k = PSNameTable::INTERN("stroke-linejoin"); return k;}
-    inline InternedKey stroke_miterlimit(){static InternedKey k = PSNameTable::INTERN("stroke-miterlimit"); return k;}
+    inline InternedKey color() { static constexpr InternedKey k = svgStaticAtom("color");    return k; }
+    inline InternedKey solid_color() { static constexpr InternedKey k = svgStaticAtom("solid-color");    return k; }
+    inline InternedKey solid_opacity() { static constexpr InternedKey k = svgStaticAtom("solid-opacity");    return k; }
+
+    inline InternedKey fill() { static constexpr InternedKey k = svgStaticAtom("fill");          return k; }
+    inline InternedKey fill_opacity() { static constexpr InternedKey k = svgStaticAtom("fill-opacity");  return k; }
+    inline InternedKey fill_rule() { static constexpr InternedKey k = svgStaticAtom("fill-rule");     return k; }
+
+    inline InternedKey stroke() { static constexpr InternedKey k = svgStaticAtom("stroke");        return k; }
+    inline InternedKey stroke_opacity() { static constexpr InternedKey k = svgStaticAtom("stroke-opacity"); return k; }
+    inline InternedKey stroke_width() { static constexpr InternedKey k = svgStaticAtom("stroke-width");  return k; }
+    inline InternedKey stroke_linecap() { static constexpr InternedKey k = svgStaticAtom("stroke-linecap"); return k; }
+    inline InternedKey stroke_linecap_start() { static constexpr InternedKey k = svgStaticAtom("stroke-linecap-start"); return k; }
+    inline InternedKey stroke_linecap_end() { static constexpr InternedKey k = svgStaticAtom("stroke-linecap-end"); return k; }
+    inline InternedKey stroke_linejoin(){static constexpr InternedKey k = svgStaticAtom("stroke-linejoin"); return k;}
+    inline InternedKey stroke_miterlimit(){static constexpr InternedKey k = svgStaticAtom("stroke-miterlimit"); return k;}
 
     // Stroke dashing
-    inline InternedKey stroke_dasharray(){static InternedKey k = PSNameTable::INTERN("stroke-dasharray"); return k;}
-    inline InternedKey stroke_dashoffset(){static InternedKey k = PSNameTable::INTERN("stroke-dashoffset"); return k;}
+    inline InternedKey stroke_dasharray(){static constexpr InternedKey k = svgStaticAtom("stroke-dasharray"); return k;}
+    inline InternedKey stroke_dashoffset(){static constexpr InternedKey k = svgStaticAtom("stroke-dashoffset"); return k;}
 
     // flowRoot
-    inline InternedKey line_height() { static InternedKey k = PSNameTable::INTERN("line-height"); return k; }
+    inline InternedKey line_height() { static constexpr InternedKey k = svgStaticAtom("line-height"); return k; }
 
     // Text
-    inline InternedKey font_family() { static InternedKey k = PSNameTable::INTERN("font-family");   return k; }
-    inline InternedKey font_size() { static InternedKey k = PSNameTable::INTERN("font-size");     return k; }
-    inline InternedKey font_weight() { static InternedKey k = PSNameTable::INTERN("font-weight");   return k; }
-    inline InternedKey font_stretch() { static InternedKey k = PSNameTable::INTERN("font_stretch"); return k; }
-    inline InternedKey font_style() { static InternedKey k = PSNameTable::INTERN("font-style");    return k; }
-    inline InternedKey text_anchor() { static InternedKey k = PSNameTable::INTERN("text-anchor");   return k; }
-    inline InternedKey text_align() { static InternedKey k = PSNameTable::INTERN("text-align");   return k; }
+    inline InternedKey font_family() { static constexpr InternedKey k = svgStaticAtom("font-family");   return k; }
+    inline InternedKey font_size() { static constexpr InternedKey k = svgStaticAtom("font-size");     return k; }
+    inline InternedKey font_weight() { static constexpr InternedKey k = svgStaticAtom("font-weight");   return k; }
+    inline InternedKey font_stretch() { static constexpr InternedKey k = svgStaticAtom("font_stretch"); return k; }
+    inline InternedKey font_style() { static constexpr InternedKey k = svgStaticAtom("font-style");    return k; }
+    inline InternedKey text_anchor() { static constexpr InternedKey k = svgStaticAtom("text-anchor");   return k; }
+    inline InternedKey text_align() { static constexpr InternedKey k = svgStaticAtom("text-align");   return k; }
     inline InternedKey dominant_baseline()
     {
-        static InternedKey k = PSNameTable::INTERN("dominant-baseline"); return k;
+        static constexpr InternedKey k = svgStaticAtom("dominant-baseline"); return k;
     }
     inline InternedKey alignment_baseline()
     {
-        static InternedKey k = PSNameTable::INTERN("alignment-baseline"); return k;
+        static constexpr InternedKey k = svgStaticAtom("alignment-baseline"); return k;
     }
 
     // Linking / reuse
-    inline InternedKey href() { static InternedKey k = PSNameTable::INTERN("href");          return k; }
-    inline InternedKey xlink_href() { static InternedKey k = PSNameTable::INTERN("xlink:href");    return k; }
+    inline InternedKey href() { static constexpr InternedKey k = svgStaticAtom("href");          return k; }
+    inline InternedKey xlink_href() { static constexpr InternedKey k = svgStaticAtom("xlink:href");    return k; }
 
     // Clipping / masking
-    inline InternedKey clip_path() { static InternedKey k = PSNameTable::INTERN("clip-path");     return k; }
-    inline InternedKey clipPathUnits() { static InternedKey k = PSNameTable::INTERN("clipPathUnits");     return k; }
+    inline InternedKey clip_path() { static constexpr InternedKey k = svgStaticAtom("clip-path");     return k; }
+    inline InternedKey clipPathUnits() { static constexpr InternedKey k = svgStaticAtom("clipPathUnits");     return k; }
 
     // Masking
-    INLINE InternedKey mask_units() { static InternedKey k = PSNameTable::INTERN("maskUnits");     return k; }
-    INLINE InternedKey mask_content_units() { static InternedKey k = PSNameTable::INTERN("maskContentUnits");     return k; }
-    INLINE InternedKey mask_type() { static InternedKey k = PSNameTable::INTERN("mask-type");     return k; }
-    inline InternedKey mask() { static InternedKey k = PSNameTable::INTERN("mask");          return k; }
+    INLINE InternedKey mask_units() { static constexpr InternedKey k = svgStaticAtom("maskUnits");     return k; }
+    INLINE InternedKey mask_content_units() { static constexpr InternedKey k = svgStaticAtom("maskContentUnits");     return k; }
+    INLINE InternedKey mask_type() { static constexpr InternedKey k = svgStaticAtom("mask-type");     return k; }
+    inline InternedKey mask() { static constexpr InternedKey k = svgStaticAtom("mask");          return k; }
 
     // Filters / effects
-    inline InternedKey filter() { static InternedKey k = PSNameTable::INTERN("filter");        return k; }
+    inline InternedKey filter() { static constexpr InternedKey k = svgStaticAtom("filter");        return k; }
 
     // Gradients / patterns
-    inline InternedKey stop_color() { static InternedKey k = PSNameTable::INTERN("stop-color");    return k; }
-    inline InternedKey stop_opacity() { static InternedKey k = PSNameTable::INTERN("stop-opacity");  return k; }
-    inline InternedKey offset() { static InternedKey k = PSNameTable::INTERN("offset");         return k; }
-
-    inline InternedKey gradientUnits() { static InternedKey k = PSNameTable::INTERN("gradientUnits"); return k; }
-    inline InternedKey gradientTransform(){static InternedKey k = PSNameTable::INTERN("gradientTransform"); return k;}
-    inline InternedKey spreadMethod() { static InternedKey k = PSNameTable::INTERN("spreadMethod");  return k; }
-    inline InternedKey extendMode() { static InternedKey k = PSNameTable::INTERN("extendMode");    return k; }
-    inline InternedKey angle() { static InternedKey k = PSNameTable::INTERN("angle");  return k; }
-    inline InternedKey repeat() { static InternedKey k = PSNameTable::INTERN("repeat");  return k; }
-    inline InternedKey fx() { static InternedKey k = PSNameTable::INTERN("fx");  return k; }
-    inline InternedKey fy() { static InternedKey k = PSNameTable::INTERN("fy");  return k; }
-    inline InternedKey fr() { static InternedKey k = PSNameTable::INTERN("fr");  return k; }
+    inline InternedKey stop_color() { static constexpr InternedKey k = svgStaticAtom("stop-color");    return k; }
+    inline InternedKey stop_opacity() { static constexpr InternedKey k = svgStaticAtom("stop-opacity");  return k; }
+    inline InternedKey offset() { static constexpr InternedKey k = svgStaticAtom("offset");         return k; }
+
+    inline InternedKey gradientUnits() { static constexpr InternedKey k = svgStaticAtom("gradientUnits"); return k; }
+    inline InternedKey gradientTransform(){static constexpr InternedKey k = svgStaticAtom("gradientTransform"); return k;}
+    inline InternedKey spreadMethod() { static constexpr InternedKey k = svgStaticAtom("spreadMethod");  return k; }
+    inline InternedKey extendMode() { static constexpr InternedKey k = svgStaticAtom("extendMode");    return k; }
+    inline InternedKey angle() { static constexpr InternedKey k = svgStaticAtom("angle");  return k; }
+    inline InternedKey repeat() { static constexpr InternedKey k = svgStaticAtom("repeat");  return k; }
+    inline InternedKey fx() { static constexpr InternedKey k = svgStaticAtom("fx");  return k; }
+    inline InternedKey fy() { static constexpr InternedKey k = svgStaticAtom("fy");  return k; }
+    inline InternedKey fr() { static constexpr InternedKey k = svgStaticAtom("fr");  return k; }
 
     // Pattern attributes
-    inline InternedKey patternUnits() { static InternedKey k = PSNameTable::INTERN("patternUnits");  return k; }
-    inline InternedKey patternContentUnits() { static InternedKey k = PSNameTable::INTERN("patternContentUnits");  return k; }
-    inline InternedKey patternTransform(){static InternedKey k = PSNameTable::INTERN("patternTransform"); return k;}
+    inline InternedKey patternUnits() { static constexpr InternedKey k = svgStaticAtom("patternUnits");  return k; }
+    inline InternedKey patternContentUnits() { static constexpr InternedKey k = svgStaticAtom("patternContentUnits");  return k; }
+    inline InternedKey patternTransform(){static constexpr InternedKey k = svgStaticAtom("patternTransform"); return k;}
 
     // Markers
-    inline InternedKey marker() { static InternedKey k = PSNameTable::INTERN("marker");  return k; }
-    inline InternedKey marker_start() { static InternedKey k = PSNameTable::INTERN("marker-start");  return k; }
-    inline InternedKey marker_mid() { static InternedKey k = PSNameTable::INTERN("marker-mid");    return k; }
-    inline InternedKey marker_end() { static InternedKey k = PSNameTable::INTERN("marker-end");    return k; }
-    inline InternedKey markerUnits() { static InternedKey k = PSNameTable::INTERN("markerUnits");  return k; }
-    inline InternedKey markerWidth() { static InternedKey k = PSNameTable::INTERN("markerWidth");  return k; }
-    inline InternedKey markerHeight() { static InternedKey k = PSNameTable::INTERN("markerHeight");  return k; }
-    inline InternedKey refX() { static InternedKey k = PSNameTable::INTERN("refX");  return k; }
-    inline InternedKey refY() { static InternedKey k = PSNameTable::INTERN("refY");  return k; }
-    inline InternedKey orient() { static InternedKey k = PSNameTable::INTERN("orient");  return k; }
+    inline InternedKey marker() { static constexpr InternedKey k = svgStaticAtom("marker");  return k; }
+    inline InternedKey marker_start() { static constexpr InternedKey k = svgStaticAtom("marker-start");  return k; }
+    inline InternedKey marker_mid() { static constexpr InternedKey k = svgStaticAtom("marker-mid");    return k; }
+    inline InternedKey marker_end() { static constexpr InternedKey k = svgStaticAtom("marker-end");    return k; }
+    inline InternedKey markerUnits() { static constexpr InternedKey k = svgStaticAtom("markerUnits");  return k; }
+    inline InternedKey markerWidth() { static constexpr InternedKey k = svgStaticAtom("markerWidth");  return k; }
+    inline InternedKey markerHeight() { static constexpr InternedKey k = svgStaticAtom("markerHeight");  return k; }
+    inline InternedKey refX() { static constexpr InternedKey k = svgStaticAtom("refX");  return k; }
+    inline InternedKey refY() { static constexpr InternedKey k = svgStaticAtom("refY");  return k; }
+    inline InternedKey orient() { static constexpr InternedKey k = svgStaticAtom("orient");  return k; }
 
     // ------------------------------------------------------------
     // SVG2 / modern additions you may see
     // ------------------------------------------------------------
-    inline InternedKey vector_effect() { static InternedKey k = PSNameTable::INTERN("vector-effect"); return k; }
-    inline InternedKey paint_order() { static InternedKey k = PSNameTable::INTERN("paint-order");   return k; }
-    inline InternedKey shape_rendering() { static InternedKey k = PSNameTable::INTERN("shape-rendering"); return k; }
-    inline InternedKey text_rendering() { static InternedKey k = PSNameTable::INTERN("text-rendering"); return k; }
-    inline InternedKey image_rendering() {static InternedKey k = PSNameTable::INTERN("image-rendering"); return k; }
+    inline InternedKey vector_effect() { static constexpr InternedKey k = svgStaticAtom("vector-effect"); return k; }
+    inline InternedKey paint_order() { static constexpr InternedKey k = svgStaticAtom("paint-order");   return k; }
+    inline InternedKey shape_rendering() { static constexpr InternedKey k = svgStaticAtom("shape-rendering"); return k; }
+    inline InternedKey text_rendering() { static constexpr InternedKey k = svgStaticAtom("text-rendering"); return k; }
+    inline InternedKey image_rendering() {static constexpr InternedKey k = svgStaticAtom("image-rendering"); return k; }
 
     // ------------------------------------------------------------
     // Filters & effects
     // -------------------------------------------------------------
-    inline InternedKey filterUnits() { static InternedKey k = PSNameTable::INTERN("filterUnits"); return k; }
-    inline InternedKey primitiveUnits() { static InternedKey k = PSNameTable::INTERN("primitiveUnits"); return k; }
+    inline InternedKey filterUnits() { static constexpr InternedKey k = svgStaticAtom("filterUnits"); return k; }
+    inline InternedKey primitiveUnits() { static constexpr InternedKey k = svgStaticAtom("primitiveUnits"); return k; }
 
 
     
@@ -175,27 +178,27 @@ namespace waavs::svgattr
     // -------------------------------------------
     // Screen Capture
     // -------------------------------------------
-    inline InternedKey src() { static InternedKey k = PSNameTable::INTERN("src"); return k; }
-    inline InternedKey frame_rate() { static InternedKey k = PSNameTable::INTERN("frame-rate"); return k; }
+    inline InternedKey src() { static constexpr InternedKey k = svgStaticAtom("src"); return k; }
+    inline InternedKey frame_rate() { static constexpr InternedKey k = svgStaticAtom("frame-rate"); return k; }
 
-    inline InternedKey cropX() { static InternedKey k = PSNameTable::INTERN("cropX"); return k; }
-    inline InternedKey cropY() { static InternedKey k = PSNameTable::INTERN("cropY"); return k; }
-    inline InternedKey cropWidth() { static InternedKey k = PSNameTable::INTERN("cropWidth"); return k; }
-    inline InternedKey cropHeight() { static InternedKey k = PSNameTable::INTERN("cropHeight"); return k; }
+    inline InternedKey cropX() { static constexpr InternedKey k = svgStaticAtom("cropX"); return k; }
+    inline InternedKey cropY() { static constexpr InternedKey k = svgStaticAtom("cropY"); return k; }
+    inline InternedKey cropWidth() { static constexpr InternedKey k = svgStaticAtom("cropWidth"); return k; }
+    inline InternedKey cropHeight() { static constexpr InternedKey k = svgStaticAtom("cropHeight"); return k; }
 
-    inline InternedKey capX() { static InternedKey k = PSNameTable::INTERN("capX"); return k; }
-    inline InternedKey capY() { static InternedKey k = PSNameTable::INTERN("capY"); return k; }
-    inline InternedKey capWidth() { static InternedKey k = PSNameTable::INTERN("capWidth"); return k; }
-    inline InternedKey capHeight() { static InternedKey k = PSNameTable::INTERN("capHeight"); return k; }
+    inline InternedKey capX() { static constexpr InternedKey k = svgStaticAtom("capX"); return k; }
+    inline InternedKey capY() { static constexpr InternedKey k = svgStaticAtom("capY"); return k; }
+    inline InternedKey capWidth() { static constexpr InternedKey k = svgStaticAtom("capWidth"); return k; }
+    inline InternedKey capHeight() { static constexpr InternedKey k = svgStaticAtom("capHeight"); return k; }
 
-    inline InternedKey displayUnits() { static InternedKey k = PSNameTable::INTERN("displayUnits"); return k; }
+    inline InternedKey displayUnits() { static constexpr InternedKey k = svgStaticAtom("displayUnits"); return k; }
 
     // ------------------------------------------------------------
     // Event / interactivity attributes (still appear)
     // ------------------------------------------------------------
-    inline InternedKey onclick() { static InternedKey k = PSNameTable::INTERN("onclick");      return k; }
-    inline InternedKey onmouseover() { static InternedKey k = PSNameTable::INTERN("onmouseover");  return k; }
-    inline InternedKey onmouseout() { static InternedKey k = PSNameTable::INTERN("onmouseout");   return k; }
+    inline InternedKey onclick() { static constexpr InternedKey k = svgStaticAtom("onclick");      return k; }
+    inline InternedKey onmouseover() { static constexpr InternedKey k = svgStaticAtom("onmouseover");  return k; }
+    inline InternedKey onmouseout() { static constexpr InternedKey k = svgStaticAtom("onmouseout");   return k; }
 
 }
 
@@ -208,125 +211,125 @@ namespace waavs::svgval
     // ============================================================
 
     // Generic / global
-    inline InternedKey none() { static InternedKey k = PSNameTable::INTERN("none");            return k; }
-    inline InternedKey inherit() { static InternedKey k = PSNameTable::INTERN("inherit");         return k; }
-    inline InternedKey initial() { static InternedKey k = PSNameTable::INTERN("initial");         return k; }
-    inline InternedKey unset() { static InternedKey k = PSNameTable::INTERN("unset");           return k; }
+    inline InternedKey none() { static constexpr InternedKey k = svgStaticAtom("none");            return k; }
+    inline InternedKey inherit() { static constexpr InternedKey k = svgStaticAtom("inherit");         return k; }
+    inline InternedKey initial() { static constexpr InternedKey k = svgStaticAtom("initial");         return k; }
+    inline InternedKey unset() { static constexpr InternedKey k = svgStaticAtom("unset");           return k; }
 
     // Paint keywords
-    inline InternedKey currentColor() { static InternedKey k = PSNameTable::INTERN("currentColor");    return k; }
-    inline InternedKey context_fill() { static InternedKey k = PSNameTable::INTERN("context-fill");    return k; }
-    inline InternedKey context_stroke() { static InternedKey k = PSNameTable::INTERN("context-stroke");  return k; }
+    inline InternedKey currentColor() { static constexpr InternedKey k = svgStaticAtom("currentColor");    return k; }
+    inline InternedKey context_fill() { static constexpr InternedKey k = svgStaticAtom("context-fill");    return k; }
+    inline InternedKey context_stroke() { static constexpr InternedKey k = svgStaticAtom("context-stroke");  return k; }
 
     // Display / visibility
-    inline InternedKey inline_() { static InternedKey k = PSNameTable::INTERN("inline");          return k; }
-    inline InternedKey block() { static InternedKey k = PSNameTable::INTERN("block");           return k; }
-    inline InternedKey visible() { static InternedKey k = PSNameTable::INTERN("visible");         return k; }
-    inline InternedKey hidden() { static InternedKey k = PSNameTable::INTERN("hidden");          return k; }
-    inline InternedKey collapse() { static InternedKey k = PSNameTable::INTERN("collapse");        return k; }
+    inline InternedKey inline_() { static constexpr InternedKey k = svgStaticAtom("inline");          return k; }
+    inline InternedKey block() { static constexpr InternedKey k = svgStaticAtom("block");           return k; }
+    inline InternedKey visible() { static constexpr InternedKey k = svgStaticAtom("visible");         return k; }
+    inline InternedKey hidden() { static constexpr InternedKey k = svgStaticAtom("hidden");          return k; }
+    inline InternedKey collapse() { static constexpr InternedKey k = svgStaticAtom("collapse");        return k; }
 
     // Fill / stroke rules
-    inline InternedKey nonzero() { static InternedKey k = PSNameTable::INTERN("nonzero");         return k; }
-    inline InternedKey evenodd() { static InternedKey k = PSNameTable::INTERN("evenodd");         return k; }
+    inline InternedKey nonzero() { static constexpr InternedKey k = svgStaticAtom("nonzero");         return k; }
+    inline InternedKey evenodd() { static constexpr InternedKey k = svgStaticAtom("evenodd");         return k; }
 
     // Stroke linecap
-    inline InternedKey butt() { static InternedKey k = PSNameTable::INTERN("butt");            return k; }
-    inline InternedKey round() { static InternedKey k = PSNameTable::INTERN("round");           return k; }
-    inline InternedKey square() { static InternedKey k = PSNameTable::INTERN("square");          return k; }
+    inline InternedKey butt() { static constexpr InternedKey k = svgStaticAtom("butt");            return k; }
+    inline InternedKey round() { static constexpr InternedKey k = svgStaticAtom("round");           return k; }
+    inline InternedKey square() { static constexpr InternedKey k = svgStaticAtom("square");          return k; }
 
     // Stroke linejoin
-    inline InternedKey miter() { static InternedKey k = PSNameTable::INTERN("miter");           return k; }
-    inline InternedKey bevel() { static InternedKey k = PSNameTable::INTERN("bevel");           return k; }
+    inline InternedKey miter() { static constexpr InternedKey k = svgStaticAtom("miter");           return k; }
+    inline InternedKey bevel() { static constexpr InternedKey k = svgStaticAtom("bevel");           return k; }
 
     // Marker placement
-    inline InternedKey auto_() { static InternedKey k = PSNameTable::INTERN("auto");            return k; }
+    inline InternedKey auto_() { static constexpr InternedKey k = svgStaticAtom("auto");            return k; }
 
     // Units
-    inline InternedKey userSpaceOnUse() { static InternedKey k = PSNameTable::INTERN("userSpaceOnUse");  return k; }
+    inline InternedKey userSpaceOnUse() { static constexpr InternedKey k = svgStaticAtom("userSpaceOnUse");  return k; }
     inline InternedKey objectBoundingBox()
     {
-        static InternedKey k = PSNameTable::INTERN("objectBoundingBox"); return k;
+        static constexpr InternedKey k = svgStaticAtom("objectBoundingBox"); return k;
     }
 
     // PreserveAspectRatio
-    inline InternedKey meet() { static InternedKey k = PSNameTable::INTERN("meet");            return k; }
-    inline InternedKey slice() { static InternedKey k = PSNameTable::INTERN("slice");           return k; }
+    inline InternedKey meet() { static constexpr InternedKey k = svgStaticAtom("meet");            return k; }
+    inline InternedKey slice() { static constexpr InternedKey k = svgStaticAtom("slice");           return k; }
 
-    inline InternedKey xMinYMin() { static InternedKey k = PSNameTable::INTERN("xMinYMin");        return k; }
-    inline InternedKey xMidYMin() { static InternedKey k = PSNameTable::INTERN("xMidYMin");        return k; }
-    inline InternedKey xMaxYMin() { static InternedKey k = PSNameTable::INTERN("xMaxYMin");        return k; }
+    inline InternedKey xMinYMin() { static constexpr InternedKey k = svgStaticAtom("xMinYMin");        return k; }
+    inline InternedKey xMidYMin() { static constexpr InternedKey k = svgStaticAtom("xMidYMin");        return k; }
+    inline InternedKey xMaxYMin() { static constexpr InternedKey k = svgStaticAtom("xMaxYMin");        return k; }
 
-    inline InternedKey xMinYMid() { static InternedKey k = PSNameTable::INTERN("xMinYMid");        return k; }
-    inline InternedKey xMidYMid() { static InternedKey k = PSNameTable::INTERN("xMidYMid");        return k; }
-    inline InternedKey xMaxYMid() { static InternedKey k = PSNameTable::INTERN("xMaxYMid");        return k; }
+    inline InternedKey xMinYMid() { static constexpr InternedKey k = svgStaticAtom("xMinYMid");        return k; }
+    inline InternedKey xMidYMid() { static constexpr InternedKey k = svgStaticAtom("xMidYMid");        return k; }
+    inline InternedKey xMaxYMid() { static constexpr InternedKey k = svgStaticAtom("xMaxYMid");        return k; }
 
-    inline InternedKey xMinYMax() { static InternedKey k = PSNameTable::INTERN("xMinYMax");        return k; }
-    inline InternedKey xMidYMax() { static InternedKey k = PSNameTable::INTERN("xMidYMax");        return k; }
-    inline InternedKey xMaxYMax() { static InternedKey k = PSNameTable::INTERN("xMaxYMax");        return k; }
+    inline InternedKey xMinYMax() { static constexpr InternedKey k = svgStaticAtom("xMinYMax");        return k; }
+    inline InternedKey xMidYMax() { static constexpr InternedKey k = svgStaticAtom("xMidYMax");        return k; }
+    inline InternedKey xMaxYMax() { static constexpr InternedKey k = svgStaticAtom("xMaxYMax");        return k; }
 
     // Vector effects
-    inline InternedKey non_scaling_stroke() { static InternedKey k = PSNameTable::INTERN("non-scaling-stroke"); return k;}
+    inline InternedKey non_scaling_stroke() { static constexpr InternedKey k = svgStaticAtom("non-scaling-stroke"); return k;}
 
 
 
 
     // Text align
-    inline InternedKey center() { static InternedKey k = PSNameTable::INTERN("center");         return k; }
-    inline InternedKey right() { static InternedKey k = PSNameTable::INTERN("right");          return k; }
-    inline InternedKey left() { static InternedKey k = PSNameTable::INTERN("left");           return k; }
+    inline InternedKey center() { static constexpr InternedKey k = svgStaticAtom("center");         return k; }
+    inline InternedKey right() { static constexpr InternedKey k = svgStaticAtom("right");          return k; }
+    inline InternedKey left() { static constexpr InternedKey k = svgStaticAtom("left");           return k; }
 
     // Text anchor
-    inline InternedKey start() { static InternedKey k = PSNameTable::INTERN("start");           return k; }
-    inline InternedKey middle() { static InternedKey k = PSNameTable::INTERN("middle");          return k; }
-    inline InternedKey end() { static InternedKey k = PSNameTable::INTERN("end");             return k; }
+    inline InternedKey start() { static constexpr InternedKey k = svgStaticAtom("start");           return k; }
+    inline InternedKey middle() { static constexpr InternedKey k = svgStaticAtom("middle");          return k; }
+    inline InternedKey end() { static constexpr InternedKey k = svgStaticAtom("end");             return k; }
 
     // Font weight
-    inline InternedKey normal() { static InternedKey k = PSNameTable::INTERN("normal");          return k; }
-    inline InternedKey bold() { static InternedKey k = PSNameTable::INTERN("bold");            return k; }
-    inline InternedKey bolder() { static InternedKey k = PSNameTable::INTERN("bolder");          return k; }
-    inline InternedKey lighter() { static InternedKey k = PSNameTable::INTERN("lighter");         return k; }
+    inline InternedKey normal() { static constexpr InternedKey k = svgStaticAtom("normal");          return k; }
+    inline InternedKey bold() { static constexpr InternedKey k = svgStaticAtom("bold");            return k; }
+    inline InternedKey bolder() { static constexpr InternedKey k = svgStaticAtom("bolder");          return k; }
+    inline InternedKey lighter() { static constexpr InternedKey k = svgStaticAtom("lighter");         return k; }
 
     // Font style
-    inline InternedKey italic() { static InternedKey k = PSNameTable::INTERN("italic");          return k; }
-    inline InternedKey oblique() { static InternedKey k = PSNameTable::INTERN("oblique");         return k; }
+    inline InternedKey italic() { static constexpr InternedKey k = svgStaticAtom("italic");          return k; }
+    inline InternedKey oblique() { static constexpr InternedKey k = svgStaticAtom("oblique");         return k; }
 
     // Shape rendering
-    inline InternedKey auto_rendering() { static InternedKey k = PSNameTable::INTERN("auto");             return k; }
-    inline InternedKey optimizeSpeed() { static InternedKey k = PSNameTable::INTERN("optimizeSpeed");   return k; }
-    inline InternedKey crispEdges() { static InternedKey k = PSNameTable::INTERN("crispEdges");      return k; }
+    inline InternedKey auto_rendering() { static constexpr InternedKey k = svgStaticAtom("auto");             return k; }
+    inline InternedKey optimizeSpeed() { static constexpr InternedKey k = svgStaticAtom("optimizeSpeed");   return k; }
+    inline InternedKey crispEdges() { static constexpr InternedKey k = svgStaticAtom("crispEdges");      return k; }
     inline InternedKey geometricPrecision()
     {
-        static InternedKey k = PSNameTable::INTERN("geometricPrecision"); return k;
+        static constexpr InternedKey k = svgStaticAtom("geometricPrecision"); return k;
     }
 
     // Image rendering
-    inline InternedKey pixelated() { static InternedKey k = PSNameTable::INTERN("pixelated");       return k; }
+    inline InternedKey pixelated() { static constexpr InternedKey k = svgStaticAtom("pixelated");       return k; }
 
     // Spread methods (gradients)
-    inline InternedKey pad() { static InternedKey k = PSNameTable::INTERN("pad");             return k; }
-    inline InternedKey reflect() { static InternedKey k = PSNameTable::INTERN("reflect");         return k; }
-    inline InternedKey repeat() { static InternedKey k = PSNameTable::INTERN("repeat");          return k; }
+    inline InternedKey pad() { static constexpr InternedKey k = svgStaticAtom("pad");             return k; }
+    inline InternedKey reflect() { static constexpr InternedKey k = svgStaticAtom("reflect");         return k; }
+    inline InternedKey repeat() { static constexpr InternedKey k = svgStaticAtom("repeat");          return k; }
 
     // Mask / clip
-    inline InternedKey luminance() { static InternedKey k = PSNameTable::INTERN("luminance");       return k; }
-    inline InternedKey alpha() { static InternedKey k = PSNameTable::INTERN("alpha");           return k; }
+    inline InternedKey luminance() { static constexpr InternedKey k = svgStaticAtom("luminance");       return k; }
+    inline InternedKey alpha() { static constexpr InternedKey k = svgStaticAtom("alpha");           return k; }
 
     // Pointer events (still emitted)
-    inline InternedKey visiblePainted() { static InternedKey k = PSNameTable::INTERN("visiblePainted");  return k; }
-    inline InternedKey visibleFill() { static InternedKey k = PSNameTable::INTERN("visibleFill");     return k; }
-    inline InternedKey visibleStroke() { static InternedKey k = PSNameTable::INTERN("visibleStroke");   return k; }
-    inline InternedKey visibleAll() { static InternedKey k = PSNameTable::INTERN("visible");         return k; }
+    inline InternedKey visiblePainted() { static constexpr InternedKey k = svgStaticAtom("visiblePainted");  return k; }
+    inline InternedKey visibleFill() { static constexpr InternedKey k = svgStaticAtom("visibleFill");     return k; }
+    inline InternedKey visibleStroke() { static constexpr InternedKey k = svgStaticAtom("visibleStroke");   return k; }
+    inline InternedKey visibleAll() { static constexpr InternedKey k = svgStaticAtom("visible");         return k; }
 
-    inline InternedKey painted() { static InternedKey k = PSNameTable::INTERN("painted");         return k; }
-    inline InternedKey fill_kw() { static InternedKey k = PSNameTable::INTERN("fill");             return k; }
-    inline InternedKey stroke_kw() { static InternedKey k = PSNameTable::INTERN("stroke");           return k; }
-    inline InternedKey all() { static InternedKey k = PSNameTable::INTERN("all");              return k; }
-    inline InternedKey none_events() { static InternedKey k = PSNameTable::INTERN("none");             return k; }
+    inline InternedKey painted() { static constexpr InternedKey k = svgStaticAtom("painted");         return k; }
+    inline InternedKey fill_kw() { static constexpr InternedKey k = svgStaticAtom("fill");             return k; }
+    inline InternedKey stroke_kw() { static constexpr InternedKey k = svgStaticAtom("stroke");           return k; }
+    inline InternedKey all() { static constexpr InternedKey k = svgStaticAtom("all");              return k; }
+    inline InternedKey none_events() { static constexpr InternedKey k = svgStaticAtom("none");             return k; }
 
     // ------------------------------------------------------------
     // SVG2 additions commonly seen
     // ------------------------------------------------------------
-    inline InternedKey context_value() { static InternedKey k = PSNameTable::INTERN("context-value");    return k; }
+    inline InternedKey context_value() { static constexpr InternedKey k = svgStaticAtom("context-value");    return k; }
 }
 
 
@@ -339,55 +342,55 @@ namespace waavs::svgval_legacy
     // Deprecated / legacy paint & text keywords
     // ============================================================
 
-    inline InternedKey freeze() { static InternedKey k = PSNameTable::INTERN("freeze");          return k; }
-    inline InternedKey remove() { static InternedKey k = PSNameTable::INTERN("remove");          return k; }
+    inline InternedKey freeze() { static constexpr InternedKey k = svgStaticAtom("freeze");          return k; }
+    inline InternedKey remove() { static constexpr InternedKey k = svgStaticAtom("remove");          return k; }
 
     // Text layout (SMIL / old text-flow)
-    inline InternedKey spacing() { static InternedKey k = PSNameTable::INTERN("spacing");         return k; }
-    inline InternedKey spacingAndGlyphs() { static InternedKey k = PSNameTable::INTERN("spacingAndGlyphs"); return k; }
+    inline InternedKey spacing() { static constexpr InternedKey k = svgStaticAtom("spacing");         return k; }
+    inline InternedKey spacingAndGlyphs() { static constexpr InternedKey k = svgStaticAtom("spacingAndGlyphs"); return k; }
 
     // Alignment baseline legacy values
-    inline InternedKey auto_baseline() { static InternedKey k = PSNameTable::INTERN("auto");             return k; }
-    inline InternedKey baseline() { static InternedKey k = PSNameTable::INTERN("baseline");        return k; }
-    inline InternedKey before_edge() { static InternedKey k = PSNameTable::INTERN("before-edge");     return k; }
-    inline InternedKey text_before_edge(){static InternedKey k = PSNameTable::INTERN("text-before-edge"); return k;}
-    inline InternedKey middle_baseline() { static InternedKey k = PSNameTable::INTERN("middle");          return k; }
-    inline InternedKey central() { static InternedKey k = PSNameTable::INTERN("central");         return k; }
-    inline InternedKey after_edge() { static InternedKey k = PSNameTable::INTERN("after-edge");      return k; }
-    inline InternedKey text_after_edge(){static InternedKey k = PSNameTable::INTERN("text-after-edge"); return k;}
-    inline InternedKey ideographic_baseline(){static InternedKey k = PSNameTable::INTERN("ideographic");     return k;}
-    inline InternedKey alphabetic_baseline(){static InternedKey k = PSNameTable::INTERN("alphabetic");      return k;}
-    inline InternedKey hanging_baseline(){static InternedKey k = PSNameTable::INTERN("hanging");         return k;}
-    inline InternedKey mathematical_baseline(){static InternedKey k = PSNameTable::INTERN("mathematical");    return k;}
+    inline InternedKey auto_baseline() { static constexpr InternedKey k = svgStaticAtom("auto");             return k; }
+    inline InternedKey baseline() { static constexpr InternedKey k = svgStaticAtom("baseline");        return k; }
+    inline InternedKey before_edge() { static constexpr InternedKey k = svgStaticAtom("before-edge");     return k; }
+    inline InternedKey text_before_edge(){static constexpr InternedKey k = svgStaticAtom("text-before-edge"); return k;}
+    inline InternedKey middle_baseline() { static constexpr InternedKey k = svgStaticAtom("middle");          return k; }
+    inline InternedKey central() { static constexpr InternedKey k = svgStaticAtom("central");         return k; }
+    inline InternedKey after_edge() { static constexpr InternedKey k = svgStaticAtom("after-edge");      return k; }
+    inline InternedKey text_after_edge(){static constexpr InternedKey k = svgStaticAtom("text-after-edge"); return k;}
+    inline InternedKey ideographic_baseline(){static constexpr InternedKey k = svgStaticAtom("ideographic");     return k;}
+    inline InternedKey alphabetic_baseline(){static constexpr InternedKey k = svgStaticAtom("alphabetic");      return k;}
+    inline InternedKey hanging_baseline(){static constexpr InternedKey k = svgStaticAtom("hanging");         return k;}
+    inline InternedKey mathematical_baseline(){static constexpr InternedKey k = svgStaticAtom("mathematical");    return k;}
 
     // Writing mode legacy
-    inline InternedKey lr_tb() { static InternedKey k = PSNameTable::INTERN("lr-tb");            return k; }
-    inline InternedKey rl_tb() { static InternedKey k = PSNameTable::INTERN("rl-tb");            return k; }
-    inline InternedKey tb_rl() { static InternedKey k = PSNameTable::INTERN("tb-rl");            return k; }
+    inline InternedKey lr_tb() { static constexpr InternedKey k = svgStaticAtom("lr-tb");            return k; }
+    inline InternedKey rl_tb() { static constexpr InternedKey k = svgStaticAtom("rl-tb");            return k; }
+    inline InternedKey tb_rl() { static constexpr InternedKey k = svgStaticAtom("tb-rl");            return k; }
 
     // Glyph orientation legacy
-    inline InternedKey auto_glyph() { static InternedKey k = PSNameTable::INTERN("auto");             return k; }
-    inline InternedKey deg0() { static InternedKey k = PSNameTable::INTERN("0deg");             return k; }
-    inline InternedKey deg90() { static InternedKey k = PSNameTable::INTERN("90deg");            return k; }
-    inline InternedKey deg180() { static InternedKey k = PSNameTable::INTERN("180deg");           return k; }
-    inline InternedKey deg270() { static InternedKey k = PSNameTable::INTERN("270deg");           return k; }
+    inline InternedKey auto_glyph() { static constexpr InternedKey k = svgStaticAtom("auto");             return k; }
+    inline InternedKey deg0() { static constexpr InternedKey k = svgStaticAtom("0deg");             return k; }
+    inline InternedKey deg90() { static constexpr InternedKey k = svgStaticAtom("90deg");            return k; }
+    inline InternedKey deg180() { static constexpr InternedKey k = svgStaticAtom("180deg");           return k; }
+    inline InternedKey deg270() { static constexpr InternedKey k = svgStaticAtom("270deg");           return k; }
 
     // Legacy filter units
-    inline InternedKey userSpace() { static InternedKey k = PSNameTable::INTERN("userSpace");        return k; }
-    inline InternedKey objectBBox() { static InternedKey k = PSNameTable::INTERN("objectBoundingBox"); return k; }
+    inline InternedKey userSpace() { static constexpr InternedKey k = svgStaticAtom("userSpace");        return k; }
+    inline InternedKey objectBBox() { static constexpr InternedKey k = svgStaticAtom("objectBoundingBox"); return k; }
 
     // Legacy cursor keywords
-    inline InternedKey crosshair() { static InternedKey k = PSNameTable::INTERN("crosshair");        return k; }
-    inline InternedKey pointer() { static InternedKey k = PSNameTable::INTERN("pointer");          return k; }
-    inline InternedKey move() { static InternedKey k = PSNameTable::INTERN("move");             return k; }
-    inline InternedKey e_resize() { static InternedKey k = PSNameTable::INTERN("e-resize");         return k; }
-    inline InternedKey ne_resize() { static InternedKey k = PSNameTable::INTERN("ne-resize");        return k; }
-    inline InternedKey nw_resize() { static InternedKey k = PSNameTable::INTERN("nw-resize");        return k; }
-    inline InternedKey n_resize() { static InternedKey k = PSNameTable::INTERN("n-resize");         return k; }
-    inline InternedKey se_resize() { static InternedKey k = PSNameTable::INTERN("se-resize");        return k; }
-    inline InternedKey sw_resize() { static InternedKey k = PSNameTable::INTERN("sw-resize");        return k; }
-    inline InternedKey s_resize() { static InternedKey k = PSNameTable::INTERN("s-resize");         return k; }
-    inline InternedKey w_resize() { static InternedKey k = PSNameTable::INTERN("w-resize");         return k; }
+    inline InternedKey crosshair() { static constexpr InternedKey k = svgStaticAtom("crosshair");        return k; }
+    inline InternedKey pointer() { static constexpr InternedKey k = svgStaticAtom("pointer");          return k; }
+    inline InternedKey move() { static constexpr InternedKey k = svgStaticAtom("move");             return k; }
+    inline InternedKey e_resize() { static constexpr InternedKey k = svgStaticAtom("e-resize");         return k; }
+    inline InternedKey ne_resize() { static constexpr InternedKey k = svgStaticAtom("ne-resize");        return k; }
+    inline InternedKey nw_resize() { static constexpr InternedKey k = svgStaticAtom("nw-resize");        return k; }
+    inline InternedKey n_resize() { static constexpr InternedKey k = svgStaticAtom("n-resize");         return k; }
+    inline InternedKey se_resize() { static constexpr InternedKey k = svgStaticAtom("se-resize");        return k; }
+    inline InternedKey sw_resize() { static constexpr InternedKey k = svgStaticAtom("sw-resize");        return k; }
+    inline InternedKey s_resize() { static constexpr InternedKey k = svgStaticAtom("s-resize");         return k; }
+    inline InternedKey w_resize() { static constexpr InternedKey k = svgStaticAtom("w-resize");         return k; }
 }
 
 
@@ -401,97 +404,97 @@ namespace waavs::svgval_legacy
 namespace waavs::svgtag
 {
     // Document / container / structure
-    inline InternedKey tag_svg() { static InternedKey k = PSNameTable::INTERN("svg");          return k; }
-    inline InternedKey tag_g() { static InternedKey k = PSNameTable::INTERN("g");            return k; }
-    inline InternedKey tag_defs() { static InternedKey k = PSNameTable::INTERN("defs");         return k; }
-    inline InternedKey tag_symbol() { static InternedKey k = PSNameTable::INTERN("symbol");       return k; }
-    inline InternedKey tag_use() { static InternedKey k = PSNameTable::INTERN("use");          return k; }
-    inline InternedKey tag_switch_() { static InternedKey k = PSNameTable::INTERN("switch");       return k; }
-    inline InternedKey tag_view() { static InternedKey k = PSNameTable::INTERN("view");         return k; }
+    inline InternedKey tag_svg() { static constexpr InternedKey k = svgStaticAtom("svg");          return k; }
+    inline InternedKey tag_g() { static constexpr InternedKey k = svgStaticAtom("g");            return k; }
+    inline InternedKey tag_defs() { static constexpr InternedKey k = svgStaticAtom("defs");         return k; }
+    inline InternedKey tag_symbol() { static constexpr InternedKey k = svgStaticAtom("symbol");       return k; }
+    inline InternedKey tag_use() { static constexpr InternedKey k = svgStaticAtom("use");          return k; }
+    inline InternedKey tag_switch_() { static constexpr InternedKey k = svgStaticAtom("switch");       return k; }
+    inline InternedKey tag_view() { static constexpr InternedKey k = svgStaticAtom("view");         return k; }
 
     // Linking / scripting
-    inline InternedKey tag_a() { static InternedKey k = PSNameTable::INTERN("a");            return k; }
-    inline InternedKey tag_script() { static InternedKey k = PSNameTable::INTERN("script");       return k; }
+    inline InternedKey tag_a() { static constexpr InternedKey k = svgStaticAtom("a");            return k; }
+    inline InternedKey tag_script() { static constexpr InternedKey k = svgStaticAtom("script");       return k; }
 
     // Descriptive / metadata
-    inline InternedKey tag_title() { static InternedKey k = PSNameTable::INTERN("title");        return k; }
-    inline InternedKey tag_desc() { static InternedKey k = PSNameTable::INTERN("desc");         return k; }
-    inline InternedKey tag_metadata() { static InternedKey k = PSNameTable::INTERN("metadata");     return k; }
-    inline InternedKey tag_style() { static InternedKey k = PSNameTable::INTERN("style");        return k; }
+    inline InternedKey tag_title() { static constexpr InternedKey k = svgStaticAtom("title");        return k; }
+    inline InternedKey tag_desc() { static constexpr InternedKey k = svgStaticAtom("desc");         return k; }
+    inline InternedKey tag_metadata() { static constexpr InternedKey k = svgStaticAtom("metadata");     return k; }
+    inline InternedKey tag_style() { static constexpr InternedKey k = svgStaticAtom("style");        return k; }
 
     // Basic shapes / graphics
-    inline InternedKey tag_circle() { static InternedKey k = PSNameTable::INTERN("circle");       return k; }
-    inline InternedKey tag_ellipse() { static InternedKey k = PSNameTable::INTERN("ellipse");      return k; }
-    inline InternedKey tag_line() { static InternedKey k = PSNameTable::INTERN("line");         return k; }
-    inline InternedKey tag_rect() { static InternedKey k = PSNameTable::INTERN("rect");         return k; }
-    inline InternedKey tag_path() { static InternedKey k = PSNameTable::INTERN("path");         return k; }
-    inline InternedKey tag_polygon() { static InternedKey k = PSNameTable::INTERN("polygon");      return k; }
-    inline InternedKey tag_polyline() { static InternedKey k = PSNameTable::INTERN("polyline");     return k; }
-    inline InternedKey tag_image() { static InternedKey k = PSNameTable::INTERN("image");        return k; }
-    inline InternedKey tag_foreignObject() { static InternedKey k = PSNameTable::INTERN("foreignObject"); return k; }
+    inline InternedKey tag_circle() { static constexpr InternedKey k = svgStaticAtom("circle");       return k; }
+    inline InternedKey tag_ellipse() { static constexpr InternedKey k = svgStaticAtom("ellipse");      return k; }
+    inline InternedKey tag_line() { static constexpr InternedKey k = svgStaticAtom("line");         return k; }
+    inline InternedKey tag_rect() { static constexpr InternedKey k = svgStaticAtom("rect");         return k; }
+    inline InternedKey tag_path() { static constexpr InternedKey k = svgStaticAtom("path");         return k; }
+    inline InternedKey tag_polygon() { static constexpr InternedKey k = svgStaticAtom("polygon");      return k; }
+    inline InternedKey tag_polyline() { static constexpr InternedKey k = svgStaticAtom("polyline");     return k; }
+    inline InternedKey tag_image() { static constexpr InternedKey k = svgStaticAtom("image");        return k; }
+    inline InternedKey tag_foreignObject() { static constexpr InternedKey k = svgStaticAtom("foreignObject"); return k; }
 
     // Text
-    inline InternedKey tag_text() { static InternedKey k = PSNameTable::INTERN("text");         return k; }
-    inline InternedKey tag_tspan() { static InternedKey k = PSNameTable::INTERN("tspan");        return k; }
-    inline InternedKey tag_textPath() { static InternedKey k = PSNameTable::INTERN("textPath");     return k; }
+    inline InternedKey tag_text() { static constexpr InternedKey k = svgStaticAtom("text");         return k; }
+    inline InternedKey tag_tspan() { static constexpr InternedKey k = svgStaticAtom("tspan");        return k; }
+    inline InternedKey tag_textPath() { static constexpr InternedKey k = svgStaticAtom("textPath");     return k; }
 
     // Clipping / masking
-    inline InternedKey tag_clipPath() { static InternedKey k = PSNameTable::INTERN("clipPath");     return k; }
-    inline InternedKey tag_mask() { static InternedKey k = PSNameTable::INTERN("mask");         return k; }
+    inline InternedKey tag_clipPath() { static constexpr InternedKey k = svgStaticAtom("clipPath");     return k; }
+    inline InternedKey tag_mask() { static constexpr InternedKey k = svgStaticAtom("mask");         return k; }
 
     // Gradients / paint servers
-    inline InternedKey tag_linearGradient() { static InternedKey k = PSNameTable::INTERN("linearGradient"); return k; }
-    inline InternedKey tag_radialGradient() { static InternedKey k = PSNameTable::INTERN("radialGradient"); return k; }
-    inline InternedKey tag_stop() { static InternedKey k = PSNameTable::INTERN("stop");         return k; }
-    inline InternedKey tag_pattern() { static InternedKey k = PSNameTable::INTERN("pattern");      return k; }
-    inline InternedKey tag_marker() { static InternedKey k = PSNameTable::INTERN("marker");       return k; }
-    inline InternedKey SVGSolidColorElement() { static InternedKey k = PSNameTable::INTERN("solidColor");       return k; }
+    inline InternedKey tag_linearGradient() { static constexpr InternedKey k = svgStaticAtom("linearGradient"); return k; }
+    inline InternedKey tag_radialGradient() { static constexpr InternedKey k = svgStaticAtom("radialGradient"); return k; }
+    inline InternedKey tag_stop() { static constexpr InternedKey k = svgStaticAtom("stop");         return k; }
+    inline InternedKey tag_pattern() { static constexpr InternedKey k = svgStaticAtom("pattern");      return k; }
+    inline InternedKey tag_marker() { static constexpr InternedKey k = svgStaticAtom("marker");       return k; }
+    inline InternedKey SVGSolidColorElement() { static constexpr InternedKey k = svgStaticAtom("solidColor");       return k; }
     // Filters
-    inline InternedKey tag_filter() { static InternedKey k = PSNameTable::INTERN("filter");       return k; }
-    inline InternedKey tag_feBlend() { static InternedKey k = PSNameTable::INTERN("feBlend");      return k; }
-    inline InternedKey tag_feColorMatrix() { static InternedKey k = PSNameTable::INTERN("feColorMatrix"); return k; }
-    inline InternedKey tag_feComponentTransfer() { static InternedKey k = PSNameTable::INTERN("feComponentTransfer"); return k; }
-    inline InternedKey tag_feComposite() { static InternedKey k = PSNameTable::INTERN("feComposite");  return k; }
-    inline InternedKey tag_feConvolveMatrix() { static InternedKey k = PSNameTable::INTERN("feConvolveMatrix"); return k; }
-    inline InternedKey tag_feDiffuseLighting() { static InternedKey k = PSNameTable::INTERN("feDiffuseLighting"); return k; }
-    inline InternedKey tag_feDisplacementMap() { static InternedKey k = PSNameTable::INTERN("feDisplacementMap"); return k; }
-    inline InternedKey tag_feDistantLight() { static InternedKey k = PSNameTable::INTERN("feDistantLight"); return k; }
-    inline InternedKey tag_feDropShadow() { static InternedKey k = PSNameTable::INTERN("feDropShadow");  return k; }
-    inline InternedKey tag_feFlood() { static InternedKey k = PSNameTable::INTERN("feFlood");      return k; }
-    inline InternedKey tag_feFuncA() { static InternedKey k = PSNameTable::INTERN("feFuncA");      return k; }
-    inline InternedKey tag_feFuncB() { static InternedKey k = PSNameTable::INTERN("feFuncB");      return k; }
-    inline InternedKey tag_feFuncG() { static InternedKey k = PSNameTable::INTERN("feFuncG");      return k; }
-    inline InternedKey tag_feFuncR() { static InternedKey k = PSNameTable::INTERN("feFuncR");      return k; }
-    inline InternedKey tag_feGaussianBlur() { static InternedKey k = PSNameTable::INTERN("feGaussianBlur"); return k; }
-    inline InternedKey tag_feImage() { static InternedKey k = PSNameTable::INTERN("feImage");      return k; }
-    inline InternedKey tag_feMerge() { static InternedKey k = PSNameTable::INTERN("feMerge");      return k; }
-    inline InternedKey tag_feMergeNode() { static InternedKey k = PSNameTable::INTERN("feMergeNode");  return k; }
-    inline InternedKey tag_feMorphology() { static InternedKey k = PSNameTable::INTERN("feMorphology"); return k; }
-    inline InternedKey tag_feOffset() { static InternedKey k = PSNameTable::INTERN("feOffset");     return k; }
-    inline InternedKey tag_fePointLight() { static InternedKey k = PSNameTable::INTERN("fePointLight"); return k; }
-    inline InternedKey tag_feSpecularLighting() { static InternedKey k = PSNameTable::INTERN("feSpecularLighting"); return k; }
-    inline InternedKey tag_feSpotLight() { static InternedKey k = PSNameTable::INTERN("feSpotLight");  return k; }
-    inline InternedKey tag_feTile() { static InternedKey k = PSNameTable::INTERN("feTile");       return k; }
-    inline InternedKey tag_feTurbulence() { static InternedKey k = PSNameTable::INTERN("feTurbulence"); return k; }
+    inline InternedKey tag_filter() { static constexpr InternedKey k = svgStaticAtom("filter");       return k; }
+    inline InternedKey tag_feBlend() { static constexpr InternedKey k = svgStaticAtom("feBlend");      return k; }
+    inline InternedKey tag_feColorMatrix() { static constexpr InternedKey k = svgStaticAtom("feColorMatrix"); return k; }
+    inline InternedKey tag_feComponentTransfer() { static constexpr InternedKey k = svgStaticAtom("feComponentTransfer"); return k; }
+    inline InternedKey tag_feComposite() { static constexpr InternedKey k = svgStaticAtom("feComposite");  return k; }
+    inline InternedKey tag_feConvolveMatrix() { static constexpr InternedKey k = svgStaticAtom("feConvolveMatrix"); return k; }
+    inline InternedKey tag_feDiffuseLighting() { static constexpr InternedKey k = svgStaticAtom("feDiffuseLighting"); return k; }
+    inline InternedKey tag_feDisplacementMap() { static constexpr InternedKey k = svgStaticAtom("feDisplacementMap"); return k; }
+    inline InternedKey tag_feDistantLight() { static constexpr InternedKey k = svgStaticAtom("feDistantLight"); return k; }
+    inline InternedKey tag_feDropShadow() { static constexpr InternedKey k = svgStaticAtom("feDropShadow");  return k; }
+    inline InternedKey tag_feFlood() { static constexpr InternedKey k = svgStaticAtom("feFlood");      return k; }
+    inline InternedKey tag_feFuncA() { static constexpr InternedKey k = svgStaticAtom("feFuncA");      return k; }
+    inline InternedKey tag_feFuncB() { static constexpr InternedKey k = svgStaticAtom("feFuncB");      return k; }
+    inline InternedKey tag_feFuncG() { static constexpr InternedKey k = svgStaticAtom("feFuncG");      return k; }
+    inline InternedKey tag_feFuncR() { static constexpr InternedKey k = svgStaticAtom("feFuncR");      return k; }
+    inline InternedKey tag_feGaussianBlur() { static constexpr InternedKey k = svgStaticAtom("feGaussianBlur"); return k; }
+    inline InternedKey tag_feImage() { static constexpr InternedKey k = svgStaticAtom("feImage");      return k; }
+    inline InternedKey tag_feMerge() { static constexpr InternedKey k = svgStaticAtom("feMerge");      return k; }
+    inline InternedKey tag_feMergeNode() { static constexpr InternedKey k = svgStaticAtom("feMergeNode");  return k; }
+    inline InternedKey tag_feMorphology() { static constexpr InternedKey k = svgStaticAtom("feMorphology"); return k; }
+    inline InternedKey tag_feOffset() { static constexpr InternedKey k = svgStaticAtom("feOffset");     return k; }
+    inline InternedKey tag_fePointLight() { static constexpr InternedKey k = svgStaticAtom("fePointLight"); return k; }
+    inline InternedKey tag_feSpecularLighting() { static constexpr InternedKey k = svgStaticAtom("feSpecularLighting"); return k; }
+    inline InternedKey tag_feSpotLight() { static constexpr InternedKey k = svgStaticAtom("feSpotLight");  return k; }
+    inline InternedKey tag_feTile() { static constexpr InternedKey k = svgStaticAtom("feTile");       return k; }
+    inline InternedKey tag_feTurbulence() { static constexpr InternedKey k = svgStaticAtom("feTurbulence"); return k; }
 
     // FlowRoot
-    inline InternedKey tag_flowRoot() { static InternedKey k = PSNameTable::INTERN("flowRoot");      return k; }
-    inline InternedKey tag_flowRegion() { static InternedKey k = PSNameTable::INTERN("flowRegion");    return k; }
-    inline InternedKey tag_flowRegionBreak() { static InternedKey k = PSNameTable::INTERN("flowRegionBreak"); return k; }
-    inline InternedKey tag_flowSpan() { static InternedKey k = PSNameTable::INTERN("flowSpan");      return k; }
-    inline InternedKey tag_flowLine() { static InternedKey k = PSNameTable::INTERN("flowLine");      return k; }
-    inline InternedKey tag_flowPara() { static InternedKey k = PSNameTable::INTERN("flowPara");      return k; }
+    inline InternedKey tag_flowRoot() { static constexpr InternedKey k = svgStaticAtom("flowRoot");      return k; }
+    inline InternedKey tag_flowRegion() { static constexpr InternedKey k = svgStaticAtom("flowRegion");    return k; }
+    inline InternedKey tag_flowRegionBreak() { static constexpr InternedKey k = svgStaticAtom("flowRegionBreak"); return k; }
+    inline InternedKey tag_flowSpan() { static constexpr InternedKey k = svgStaticAtom("flowSpan");      return k; }
+    inline InternedKey tag_flowLine() { static constexpr InternedKey k = svgStaticAtom("flowLine");      return k; }
+    inline InternedKey tag_flowPara() { static constexpr InternedKey k = svgStaticAtom("flowPara");      return k; }
 
     // Animation (SMIL)
-    inline InternedKey tag_animate() { static InternedKey k = PSNameTable::INTERN("animate");      return k; }
-    inline InternedKey tag_animateMotion() { static InternedKey k = PSNameTable::INTERN("animateMotion"); return k; }
-    inline InternedKey tag_animateTransform() { static InternedKey k = PSNameTable::INTERN("animateTransform"); return k; }
-    inline InternedKey tag_set() { static InternedKey k = PSNameTable::INTERN("set");          return k; }
-    inline InternedKey tag_mpath() { static InternedKey k = PSNameTable::INTERN("mpath");        return k; }
+    inline InternedKey tag_animate() { static constexpr InternedKey k = svgStaticAtom("animate");      return k; }
+    inline InternedKey tag_animateMotion() { static constexpr InternedKey k = svgStaticAtom("animateMotion"); return k; }
+    inline InternedKey tag_animateTransform() { static constexpr InternedKey k = svgStaticAtom("animateTransform"); return k; }
+    inline InternedKey tag_set() { static constexpr InternedKey k = svgStaticAtom("set");          return k; }
+    inline InternedKey tag_mpath() { static constexpr InternedKey k = svgStaticAtom("mpath");        return k; }
 
     // SVG2 specials that can appear (rare, but show up in the SVG2 element index)
-    inline InternedKey tag_discard() { static InternedKey k = PSNameTable::INTERN("discard");      return k; }
-    inline InternedKey tag_unknown() { static InternedKey k = PSNameTable::INTERN("unknown");      return k; }
+    inline InternedKey tag_discard() { static constexpr InternedKey k = svgStaticAtom("discard");      return k; }
+    inline InternedKey tag_unknown() { static constexpr InternedKey k = svgStaticAtom("unknown");      return k; }
 }
 
 
@@ -500,51 +503,51 @@ namespace waavs::svgtag_legacy
     // ------------------------------------------------------------
     // SVG Fonts (deprecated/removed in SVG2; common in older assets)
     // ------------------------------------------------------------
-    inline InternedKey tag_font() { static InternedKey k = PSNameTable::INTERN("font");              return k; }
-    inline InternedKey tag_font_face() { static InternedKey k = PSNameTable::INTERN("font-face");         return k; }
-    inline InternedKey tag_font_face_src() { static InternedKey k = PSNameTable::INTERN("font-face-src");     return k; }
-    inline InternedKey tag_font_face_uri() { static InternedKey k = PSNameTable::INTERN("font-face-uri");     return k; }
-    inline InternedKey tag_font_face_name() { static InternedKey k = PSNameTable::INTERN("font-face-name");    return k; }
-    inline InternedKey tag_font_face_format() { static InternedKey k = PSNameTable::INTERN("font-face-format");  return k; }
-
-    inline InternedKey tag_glyph() { static InternedKey k = PSNameTable::INTERN("glyph");             return k; }
-    inline InternedKey tag_missing_glyph() { static InternedKey k = PSNameTable::INTERN("missing-glyph");     return k; }
-    inline InternedKey tag_hkern() { static InternedKey k = PSNameTable::INTERN("hkern");             return k; }
-    inline InternedKey tag_vkern() { static InternedKey k = PSNameTable::INTERN("vkern");             return k; }
+    inline InternedKey tag_font() { static constexpr InternedKey k = svgStaticAtom("font");              return k; }
+    inline InternedKey tag_font_face() { static constexpr InternedKey k = svgStaticAtom("font-face");         return k; }
+    inline InternedKey tag_font_face_src() { static constexpr InternedKey k = svgStaticAtom("font-face-src");     return k; }
+    inline InternedKey tag_font_face_uri() { static constexpr InternedKey k = svgStaticAtom("font-face-uri");     return k; }
+    inline InternedKey tag_font_face_name() { static constexpr InternedKey k = svgStaticAtom("font-face-name");    return k; }
+    inline InternedKey tag_font_face_format() { static constexpr InternedKey k = svgStaticAtom("font-face-format");  return k; }
+
+    inline InternedKey tag_glyph() { static constexpr InternedKey k = svgStaticAtom("glyph");             return k; }
+    inline InternedKey tag_missing_glyph() { static constexpr InternedKey k = svgStaticAtom("missing-glyph");     return k; }
+    inline InternedKey tag_hkern() { static constexpr InternedKey k = svgStaticAtom("hkern");             return k; }
+    inline InternedKey tag_vkern() { static constexpr InternedKey k = svgStaticAtom("vkern");             return k; }
 
     // Less common SVG-font support elements seen in some generators
-    inline InternedKey tag_definition_src() { static InternedKey k = PSNameTable::INTERN("definition-src");    return k; }
+    inline InternedKey tag_definition_src() { static constexpr InternedKey k = svgStaticAtom("definition-src");    return k; }
 
     // ------------------------------------------------------------
     // Alternate glyph mechanism (deprecated/removed)
     // ------------------------------------------------------------
-    inline InternedKey tag_altGlyph() { static InternedKey k = PSNameTable::INTERN("altGlyph");          return k; }
-    inline InternedKey tag_altGlyphDef() { static InternedKey k = PSNameTable::INTERN("altGlyphDef");       return k; }
-    inline InternedKey tag_altGlyphItem() { static InternedKey k = PSNameTable::INTERN("altGlyphItem");      return k; }
-    inline InternedKey tag_glyphRef() { static InternedKey k = PSNameTable::INTERN("glyphRef");          return k; }
+    inline InternedKey tag_altGlyph() { static constexpr InternedKey k = svgStaticAtom("altGlyph");          return k; }
+    inline InternedKey tag_altGlyphDef() { static constexpr InternedKey k = svgStaticAtom("altGlyphDef");       return k; }
+    inline InternedKey tag_altGlyphItem() { static constexpr InternedKey k = svgStaticAtom("altGlyphItem");      return k; }
+    inline InternedKey tag_glyphRef() { static constexpr InternedKey k = svgStaticAtom("glyphRef");          return k; }
 
     // ------------------------------------------------------------
     // Legacy text reference element (deprecated/removed)
     // ------------------------------------------------------------
-    inline InternedKey tag_tref() { static InternedKey k = PSNameTable::INTERN("tref");              return k; }
+    inline InternedKey tag_tref() { static constexpr InternedKey k = svgStaticAtom("tref");              return k; }
 
     // ------------------------------------------------------------
     // Deprecated/removed metadata-ish elements
     // ------------------------------------------------------------
-    inline InternedKey tag_color_profile() { static InternedKey k = PSNameTable::INTERN("color-profile");     return k; }
-    inline InternedKey tag_cursor() { static InternedKey k = PSNameTable::INTERN("cursor");            return k; }
+    inline InternedKey tag_color_profile() { static constexpr InternedKey k = svgStaticAtom("color-profile");     return k; }
+    inline InternedKey tag_cursor() { static constexpr InternedKey k = svgStaticAtom("cursor");            return k; }
 
     // ------------------------------------------------------------
     // Rare legacy scripting/event element (SVG Tiny / older content)
     // ------------------------------------------------------------
-    inline InternedKey tag_handler() { static InternedKey k = PSNameTable::INTERN("handler");           return k; }
+    inline InternedKey tag_handler() { static constexpr InternedKey k = svgStaticAtom("handler");           return k; }
 
     // ------------------------------------------------------------
     // SMIL-related deprecated animation variants you might see
     // (you already have animate/animateMotion/animateTransform/set/mpath
     //  in your modern list; this covers older extras)
     // ------------------------------------------------------------
-    inline InternedKey tag_animateColor() { static InternedKey k = PSNameTable::INTERN("animateColor");      return k; }
+    inline InternedKey tag_animateColor() { static constexpr InternedKey k = svgStaticAtom("animateColor");      return k; }
 }
 
 
@@ -559,71 +562,71 @@ namespace waavs::svgattr_legacy
     // ============================================================
     // SVG Fonts (deprecated / removed)
     // ============================================================
-    inline InternedKey horiz_adv_x() { static InternedKey k = PSNameTable::INTERN("horiz-adv-x");      return k; }
-    inline InternedKey horiz_origin_x() { static InternedKey k = PSNameTable::INTERN("horiz-origin-x");   return k; }
-    inline InternedKey horiz_origin_y() { static InternedKey k = PSNameTable::INTERN("horiz-origin-y");   return k; }
-    inline InternedKey vert_adv_y() { static InternedKey k = PSNameTable::INTERN("vert-adv-y");       return k; }
-    inline InternedKey vert_origin_x() { static InternedKey k = PSNameTable::INTERN("vert-origin-x");    return k; }
-    inline InternedKey vert_origin_y() { static InternedKey k = PSNameTable::INTERN("vert-origin-y");    return k; }
-
-    inline InternedKey unicode() { static InternedKey k = PSNameTable::INTERN("unicode");          return k; }
-    inline InternedKey glyph_name() { static InternedKey k = PSNameTable::INTERN("glyph-name");       return k; }
-    inline InternedKey arabic_form() { static InternedKey k = PSNameTable::INTERN("arabic-form");      return k; }
-    inline InternedKey lang() { static InternedKey k = PSNameTable::INTERN("lang");             return k; }
-    inline InternedKey orientation() { static InternedKey k = PSNameTable::INTERN("orientation");      return k; }
-
-    inline InternedKey panose_1() { static InternedKey k = PSNameTable::INTERN("panose-1");          return k; }
-    inline InternedKey units_per_em() { static InternedKey k = PSNameTable::INTERN("units-per-em");      return k; }
-    inline InternedKey ascent() { static InternedKey k = PSNameTable::INTERN("ascent");            return k; }
-    inline InternedKey descent() { static InternedKey k = PSNameTable::INTERN("descent");           return k; }
-    inline InternedKey alphabetic() { static InternedKey k = PSNameTable::INTERN("alphabetic");        return k; }
-    inline InternedKey mathematical() { static InternedKey k = PSNameTable::INTERN("mathematical");      return k; }
-    inline InternedKey ideographic() { static InternedKey k = PSNameTable::INTERN("ideographic");       return k; }
-    inline InternedKey hanging() { static InternedKey k = PSNameTable::INTERN("hanging");           return k; }
-    inline InternedKey v_ideographic() { static InternedKey k = PSNameTable::INTERN("v-ideographic");     return k; }
-
-    inline InternedKey underline_position() { static InternedKey k = PSNameTable::INTERN("underline-position"); return k; }
+    inline InternedKey horiz_adv_x() { static constexpr InternedKey k = svgStaticAtom("horiz-adv-x");      return k; }
+    inline InternedKey horiz_origin_x() { static constexpr InternedKey k = svgStaticAtom("horiz-origin-x");   return k; }
+    inline InternedKey horiz_origin_y() { static constexpr InternedKey k = svgStaticAtom("horiz-origin-y");   return k; }
+    inline InternedKey vert_adv_y() { static constexpr InternedKey k = svgStaticAtom("vert-adv-y");       return k; }
+    inline InternedKey vert_origin_x() { static constexpr InternedKey k = svgStaticAtom("vert-origin-x");    return k; }
+    inline InternedKey vert_origin_y() { static constexpr InternedKey k = svgStaticAtom("vert-origin-y");    return k; }
+
+    inline InternedKey unicode() { static constexpr InternedKey k = svgStaticAtom("unicode");          return k; }
+    inline InternedKey glyph_name() { static constexpr InternedKey k = svgStaticAtom("glyph-name");       return k; }
+    inline InternedKey arabic_form() { static constexpr InternedKey k = svgStaticAtom("arabic-form");      return k; }
+    inline InternedKey lang() { static constexpr InternedKey k = svgStaticAtom("lang");             return k; }
+    inline InternedKey orientation() { static constexpr InternedKey k = svgStaticAtom("orientation");      return k; }
+
+    inline InternedKey panose_1() { static constexpr InternedKey k = svgStaticAtom("panose-1");          return k; }
+    inline InternedKey units_per_em() { static constexpr InternedKey k = svgStaticAtom("units-per-em");      return k; }
+    inline InternedKey ascent() { static constexpr InternedKey k = svgStaticAtom("ascent");            return k; }
+    inline InternedKey descent() { static constexpr InternedKey k = svgStaticAtom("descent");           return k; }
+    inline InternedKey alphabetic() { static constexpr InternedKey k = svgStaticAtom("alphabetic");        return k; }
+    inline InternedKey mathematical() { static constexpr InternedKey k = svgStaticAtom("mathematical");      return k; }
+    inline InternedKey ideographic() { static constexpr InternedKey k = svgStaticAtom("ideographic");       return k; }
+    inline InternedKey hanging() { static constexpr InternedKey k = svgStaticAtom("hanging");           return k; }
+    inline InternedKey v_ideographic() { static constexpr InternedKey k = svgStaticAtom("v-ideographic");     return k; }
+
+    inline InternedKey underline_position() { static constexpr InternedKey k = svgStaticAtom("underline-position"); return k; }
     inline InternedKey underline_thickness()
     {
-        static InternedKey k = PSNameTable::INTERN("underline-thickness"); return k;
+        static constexpr InternedKey k = svgStaticAtom("underline-thickness"); return k;
     }
     inline InternedKey strikethrough_position()
     {
-        static InternedKey k = PSNameTable::INTERN("strikethrough-position"); return k;
+        static constexpr InternedKey k = svgStaticAtom("strikethrough-position"); return k;
     }
     inline InternedKey strikethrough_thickness()
     {
-        static InternedKey k = PSNameTable::INTERN("strikethrough-thickness"); return k;
+        static constexpr InternedKey k = svgStaticAtom("strikethrough-thickness"); return k;
     }
 
     // ------------------------------------------------------------
     // Alternate glyph system (deprecated / removed)
     // ------------------------------------------------------------
-    inline InternedKey glyph_ref() { static InternedKey k = PSNameTable::INTERN("glyphRef");         return k; }
-    inline InternedKey alt_glyph() { static InternedKey k = PSNameTable::INTERN("altGlyph");         return k; }
-    inline InternedKey alt_glyph_def() { static InternedKey k = PSNameTable::INTERN("altGlyphDef");      return k; }
-    inline InternedKey alt_glyph_item() { static InternedKey k = PSNameTable::INTERN("altGlyphItem");     return k; }
+    inline InternedKey glyph_ref() { static constexpr InternedKey k = svgStaticAtom("glyphRef");         return k; }
+    inline InternedKey alt_glyph() { static constexpr InternedKey k = svgStaticAtom("altGlyph");         return k; }
+    inline InternedKey alt_glyph_def() { static constexpr InternedKey k = svgStaticAtom("altGlyphDef");      return k; }
+    inline InternedKey alt_glyph_item() { static constexpr InternedKey k = svgStaticAtom("altGlyphItem");     return k; }
 
     // ------------------------------------------------------------
     // Deprecated text / linking
     // ------------------------------------------------------------
-    inline InternedKey tref() { static InternedKey k = PSNameTable::INTERN("tref");              return k; }
+    inline InternedKey tref() { static constexpr InternedKey k = svgStaticAtom("tref");              return k; }
 
     // ------------------------------------------------------------
     // Color profile / cursor (deprecated)
     // ------------------------------------------------------------
-    inline InternedKey color_profile() { static InternedKey k = PSNameTable::INTERN("color-profile");     return k; }
-    inline InternedKey cursor() { static InternedKey k = PSNameTable::INTERN("cursor");            return k; }
+    inline InternedKey color_profile() { static constexpr InternedKey k = svgStaticAtom("color-profile");     return k; }
+    inline InternedKey cursor() { static constexpr InternedKey k = svgStaticAtom("cursor");            return k; }
 
     // ------------------------------------------------------------
     // Rare / obsolete scripting / metadata
     // ------------------------------------------------------------
-    inline InternedKey baseProfile() { static InternedKey k = PSNameTable::INTERN("baseProfile");       return k; }
-    inline InternedKey version() { static InternedKey k = PSNameTable::INTERN("version");           return k; }
+    inline InternedKey baseProfile() { static constexpr InternedKey k = svgStaticAtom("baseProfile");       return k; }
+    inline InternedKey version() { static constexpr InternedKey k = svgStaticAtom("version");           return k; }
 
     // ------------------------------------------------------------
     // Deprecated SMIL animation variants
     // ------------------------------------------------------------
-    inline InternedKey animateColor() { static InternedKey k = PSNameTable::INTERN("animateColor");      return k; }
+    inline InternedKey animateColor() { static constexpr InternedKey k = svgStaticAtom("animateColor");      return k; }
 }
 
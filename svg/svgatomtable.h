@@ -0,0 +1,222 @@
+#pragma once
+
+//
+// The fixed set of atoms used throughout the SVG code.
+//
+// These are the names that show up in svgatoms.h, filter_types.h and
+// svgunits.h.  They are gathered
+// here into a table that is built at compile time, so that:
+//  - svgatoms.h can resolve a well known name to its atom as a 
+//    constant expression, without touching the name table at all.
+//  - PSNameTable can recognize a well known name with a single hash,
+//    and a short bounded probe, without taking part in the dynamic table.
+//
+// The atom for a well known name is the address of its copy in the
+// character pool of kSVGStaticAtoms.  Being part of an inline variable, 
+// that address is the same in every translation unit, which is not
+// guaranteed for the string literals themselves.
+// If you add a name to one of those, add it here as well, or the build 
+// will fail when svgStaticAtom() can't find it.
+//
+
+#include "bit_util.h"
+
+
+namespace waavs
+{
+    inline constexpr const char* kSVGStaticAtomNames[] = {
+        "id", "class", "style", "display", "visibility", "systemLanguage", "opacity", "x", "y",
+        "x1", "y1", "x2", "y2", "cx", "cy", "r", "rx", "ry", "width", "height", "dx", "dy",
+        "rotate", "d", "points", "viewBox", "preserveAspectRatio", "transform", "color",
+        "solid-color", "solid-opacity", "fill", "fill-opacity", "fill-rule", "stroke",
+        "stroke-opacity", "stroke-width", "stroke-linecap", "stroke-linecap-start",
+        "stroke-linecap-end", "stroke-linejoin", "stroke-miterlimit", "stroke-dasharray",
+        "stroke-dashoffset", "line-height", "font-family", "font-size", "font-weight",
+        "font_stretch", "font-style", "text-anchor", "text-align", "dominant-baseline",
+        "alignment-baseline", "href", "xlink:href", "clip-path", "clipPathUnits", "maskUnits",
+        "maskContentUnits", "mask-type", "mask", "filter", "stop-color", "stop-opacity",
+        "offset", "gradientUnits", "gradientTransform", "spreadMethod", "extendMode", "angle",
+        "repeat", "fx", "fy", "fr", "patternUnits", "patternContentUnits", "patternTransform",
+        "marker", "marker-start", "marker-mid", "marker-end", "markerUnits", "markerWidth",
+        "markerHeight", "refX", "refY", "orient", "vector-effect", "paint-order",
+        "shape-rendering", "text-rendering", "image-rendering", "filterUnits",
+        "primitiveUnits", "src", "frame-rate", "cropX", "cropY", "cropWidth", "cropHeight",
+        "capX", "capY", "capWidth", "capHeight", "displayUnits", "onclick", "onmouseover",
+        "onmouseout", "none", "inherit", "initial", "unset", "currentColor", "context-fill",
+        "context-stroke", "inline", "block", "visible", "hidden", "collapse", "nonzero",
+        "evenodd", "butt", "round", "square", "miter", "bevel", "auto", "userSpaceOnUse",
+        "objectBoundingBox", "meet", "slice", "xMinYMin", "xMidYMin", "xMaxYMin", "xMinYMid",
+        "xMidYMid", "xMaxYMid", "xMinYMax", "xMidYMax", "xMaxYMax", "non-scaling-stroke",
+        "center", "right", "left", "start", "middle", "end", "normal", "bold", "bolder",
+        "lighter", "italic", "oblique", "optimizeSpeed", "crispEdges", "geometricPrecision",
+        "pixelated", "pad", "reflect", "luminance", "alpha", "visiblePainted", "visibleFill",
+        "visibleStroke", "painted", "all", "context-value", "freeze", "remove", "spacing",
+        "spacingAndGlyphs", "baseline", "before-edge", "text-before-edge", "central",
+        "after-edge", "text-after-edge", "ideographic", "alphabetic", "hanging",
+        "mathematical", "lr-tb", "rl-tb", "tb-rl", "0deg", "90deg", "180deg", "270deg",
+        "userSpace", "crosshair", "pointer", "move", "e-resize", "ne-resize", "nw-resize",
+        "n-resize", "se-resize", "sw-resize", "s-resize", "w-resize", "svg", "g", "defs",
+        "symbol", "use", "switch", "view", "a", "script", "title", "desc", "metadata",
+        "circle", "ellipse", "line", "rect", "path", "polygon", "polyline", "image",
+        "foreignObject", "text", "tspan", "textPath", "clipPath", "linearGradient",
+        "radialGradient", "stop", "pattern", "solidColor", "feBlend", "feColorMatrix",
+        "feComponentTransfer", "feComposite", "feConvolveMatrix", "feDiffuseLighting",
+        "feDisplacementMap", "feDistantLight", "feDropShadow", "feFlood", "feFuncA", "feFuncB",
+        "feFuncG", "feFuncR", "feGaussianBlur", "feImage", "feMerge", "feMergeNode",
+        "feMorphology", "feOffset", "fePointLight", "feSpecularLighting", "feSpotLight",
+        "feTile", "feTurbulence", "flowRoot", "flowRegion", "flowRegionBreak", "flowSpan",
+        "flowLine", "flowPara", "animate", "animateMotion", "animateTransform", "set", "mpath",
+        "discard", "unknown", "font", "font-face", "font-face-src", "font-face-uri",
+        "font-face-name", "font-face-format", "glyph", "missing-glyph", "hkern", "vkern",
+        "definition-src", "altGlyph", "altGlyphDef", "altGlyphItem", "glyphRef", "tref",
+        "color-profile", "cursor", "handler", "animateColor", "horiz-adv-x", "horiz-origin-x",
+        "horiz-origin-y", "vert-adv-y", "vert-origin-x", "vert-origin-y", "unicode",
+        "glyph-name", "arabic-form", "lang", "orientation", "panose-1", "units-per-em",
+        "ascent", "descent", "v-ideographic", "underline-position", "underline-thickness",
+        "strikethrough-position", "strikethrough-thickness", "baseProfile", "version",
+
+        // filter primitive attributes and values, units
+        "color-interpolation-filters", "linearRGB", "sRGB", "SourceGraphic", "SourceAlpha",
+        "BackgroundImage", "BackgroundAlpha", "__last__", "in", "in2", "result", "stdDeviation",
+        "flood-color", "flood-opacity", "type", "values", "mode", "multiply", "screen",
+        "overlay", "darken", "lighten", "color-dodge", "color-burn", "hard-light", "soft-light",
+        "difference", "exclusion", "operator", "k1", "k2", "k3", "k4", "over", "out", "atop",
+        "xor", "arithmetic", "tableValues", "slope", "intercept", "amplitude", "exponent",
+        "identity", "table", "discrete", "linear", "gamma", "order", "kernelMatrix", "divisor",
+        "bias", "targetX", "targetY", "edgeMode", "kernelUnitLength", "preserveAlpha", "scale",
+        "xChannelSelector", "yChannelSelector", "baseFrequency", "numOctaves", "seed",
+        "stitchTiles", "surfaceScale", "diffuseConstant", "specularConstant",
+        "specularExponent", "lighting-color", "azimuth", "elevation", "pointsAtX", "pointsAtY",
+        "pointsAtZ", "limitingConeAngle", "z", "radius", "true", "false", "stitch", "noStitch",
+        "matrix", "saturate", "hueRotate", "luminanceToAlpha", "erode", "dilate", "duplicate",
+        "wrap", "R", "G", "B", "A", "turbulence", "fractalNoise", "px", "cm", "mm", "pt", "pc",
+        "em", "ex", "ch", "rem", "vw", "vh", "vmin", "vmax", "%", "deg", "rad", "grad", "turn",
+        "s", "ms", "Hz", "kHz", "dpi", "dpcm", "dppx", "xml:space"
+    };
+
+    static constexpr size_t kSVGStaticAtomCount = sizeof(kSVGStaticAtomNames) / sizeof(kSVGStaticAtomNames[0]);
+
+    // Must be a power of two, and comfortably larger than the 
+    // number of names, so the probe sequences stay short
+    static constexpr size_t kSVGStaticAtomTableSize = 2048;
+    static constexpr size_t kSVGStaticAtomMaxProbe = 4;
+
+    static constexpr size_t atom_strlen(const char* s) noexcept
+    {
+        size_t n = 0;
+        while (s[n])
+            ++n;
+        return n;
+    }
+
+    static constexpr bool atom_equal(const char* atom, const char* s, size_t n) noexcept
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (atom[i] != s[i])
+                return false;
+        }
+        return atom[n] == 0;
+    }
+
+    // Total size of the names, with their null terminators
+    static constexpr size_t svgStaticAtomPoolSize() noexcept
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < kSVGStaticAtomCount; ++i)
+            total += atom_strlen(kSVGStaticAtomNames[i]) + 1;
+        return total;
+    }
+
+    static constexpr size_t kSVGStaticAtomPoolSize = svgStaticAtomPoolSize();
+
+    // SVGStaticAtomTable
+    //
+    // Open addressed, linear probed table of offsets into a pool holding
+    // a copy of each of the kSVGStaticAtomNames.
+    // Built entirely at compile time.
+    struct SVGStaticAtomTable
+    {
+        char fChars[kSVGStaticAtomPoolSize]{};
+        uint16_t fSlots[kSVGStaticAtomTableSize]{};   // offset + 1, 0 == empty
+        size_t fMaxProbe{ 0 };
+
+        constexpr SVGStaticAtomTable() noexcept
+        {
+            size_t offset = 0;
+            for (size_t i = 0; i < kSVGStaticAtomCount; ++i)
+            {
+                const char* name = kSVGStaticAtomNames[i];
+                const size_t len = atom_strlen(name);
+                for (size_t c = 0; c < len; ++c)
+                    fChars[offset + c] = name[c];
+                fChars[offset + len] = 0;
+
+                size_t idx = fnv1a_64_chars(name, len) & (kSVGStaticAtomTableSize - 1);
+                size_t probe = 1;
+
+                while (fSlots[idx] != 0)
+                {
+                    idx = (idx + 1) & (kSVGStaticAtomTableSize - 1);
+                    ++probe;
+                }
+
+                fSlots[idx] = uint16_t(offset + 1);
+                if (probe > fMaxProbe)
+                    fMaxProbe = probe;
+
+                offset += len + 1;
+            }
+        }
+
+        // Return the slot of the name, its offset + 1 in the pool, 
+        // or 0 if it's not one of the well known names.
+        constexpr uint16_t findSlot(const char* s, size_t n, uint64_t hash) const noexcept
+        {
+            size_t idx = hash & (kSVGStaticAtomTableSize - 1);
+
+            for (size_t probe = 0; probe < fMaxProbe; ++probe)
+            {
+                const uint16_t slot = fSlots[idx];
+                if (slot == 0)
+                    return 0;
+
+                if (atom_equal(&fChars[slot - 1], s, n))
+                    return slot;
+
+                idx = (idx + 1) & (kSVGStaticAtomTableSize - 1);
+            }
+
+            return 0;
+        }
+
+        // Return the atom for the name, or nullptr if it's not one
+        // of the well known names.
+        constexpr const char* find(const char* s, size_t n, uint64_t hash) const noexcept
+        {
+            const uint16_t slot = findSlot(s, n, hash);
+            return slot ? &fChars[slot - 1] : nullptr;
+        }
+    };
+
+    inline constexpr SVGStaticAtomTable kSVGStaticAtoms{};
+
+    static_assert(kSVGStaticAtomPoolSize < 0xffff, "too many static atoms for 16-bit slots");
+    static_assert(kSVGStaticAtoms.fMaxProbe <= kSVGStaticAtomMaxProbe, "static atom table probes are too long, grow kSVGStaticAtomTableSize");
+
+    // Not constexpr, so using it in a constant expression is a compile error
+    inline const char* svgStaticAtomNotFound() noexcept { return nullptr; }
+
+    // svgStaticAtom()
+    //
+    // Resolve a well known name to its atom at compile time
+    // static constexpr InternedKey k = svgStaticAtom("fill");
+    template <size_t N>
+    constexpr const char* svgStaticAtom(const char(&name)[N]) noexcept
+    {
+        // Tested by slot, as some compilers won't compare the address
+        // of part of a constexpr object to nullptr in a constant expression
+        const uint16_t slot = kSVGStaticAtoms.findSlot(name, N - 1, fnv1a_64_chars(name, N - 1));
+        return slot ? &kSVGStaticAtoms.fChars[slot - 1] : svgStaticAtomNotFound();
+    }
+}
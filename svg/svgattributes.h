@@ -136,7 +136,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::extendMode(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGPatternExtendMode>(nullptr);
+                auto node = makeNode<SVGPatternExtendMode>(nullptr);
                 node->loadFromAttributes(attrs);
                 return node;
                 });
@@ -184,7 +184,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::opacity(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGOpacity>(nullptr);
+                auto node = makeNode<SVGOpacity>(nullptr);
             node->loadFromAttributes(attrs);
             return node;
                 });
@@ -228,7 +228,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::fill_opacity(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGFillOpacity>(nullptr); 
+                auto node = makeNode<SVGFillOpacity>(nullptr); 
                 node->loadFromAttributes(attrs);
                 return node;
                 });
@@ -248,7 +248,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::stroke_opacity(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGStrokeOpacity>(nullptr); 
+                auto node = makeNode<SVGStrokeOpacity>(nullptr); 
                 node->loadFromAttributes(attrs);
                 return node; 
                 });
@@ -273,7 +273,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::paint_order(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGPaintOrderAttribute>(nullptr); 
+                auto node = makeNode<SVGPaintOrderAttribute>(nullptr); 
                 node->loadFromAttributes(attrs);
                 return node; 
                 });
@@ -325,7 +325,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::text_anchor(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGTextAnchorAttribute>();
+                auto node = makeNode<SVGTextAnchorAttribute>();
                 node->loadFromAttributes(attrs);
                 return node;
                 });
@@ -400,7 +400,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::font_size(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGFontSize>(nullptr); 
+                auto node = makeNode<SVGFontSize>(nullptr); 
                 node->loadFromAttributes(attrs);
                 return node; 
                 });
@@ -480,7 +480,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::font_family(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGFontFamily>(nullptr); 
+                auto node = makeNode<SVGFontFamily>(nullptr); 
                 node->loadFromAttributes(attrs);
                 return node; 
                 });
@@ -525,7 +525,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::font_style(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGFontStyleAttribute>();
+                auto node = makeNode<SVGFontStyleAttribute>();
                 node->loadFromAttributes(attrs);
                 return node;
                 });
@@ -562,7 +562,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttributeByName("font-weight", [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGFontWeightAttribute>();
+                auto node = makeNode<SVGFontWeightAttribute>();
                 node->loadFromAttributes(attrs);
                 return node;
                 });
@@ -593,7 +593,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::font_stretch(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGFontStretchAttribute>();
+                auto node = makeNode<SVGFontStretchAttribute>();
                 node->loadFromAttributes(attrs);
                 return node;
                 });
@@ -910,7 +910,18 @@ namespace waavs {
                 ByteSpan cSpan = colorSpan;
                 size_t len = 0;
                 len = cSpan.size();
-                if ((len >= 1) && (*cSpan == '#'))
+
+                // Colors that have been parsed before come from the memo
+                SVGValueMemo* memo = SVGValueMemo::current();
+                bool memoized = false;
+
+                if (memo && memo->fColors.find(cSpan, cSRGB))
+                {
+                    set(true);
+                    fSemantics = COLOR_SEMANTIC_COLOR;
+                    memoized = true;
+                }
+                else if ((len >= 1) && (*cSpan == '#'))
                 {
                     if (parse_colorsrgb_from_hex(cSpan, cSRGB) == WG_SUCCESS)
                     {
@@ -984,6 +995,9 @@ namespace waavs {
                         }
                     }
                 }
+
+                if (memo && !memoized && fSemantics == COLOR_SEMANTIC_COLOR)
+                    memo->fColors.insert(cSpan, cSRGB);
             }
 
             // Finally, assign the color value.  
@@ -1138,7 +1152,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttributeByName("color", [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGColorPaint>();
+                auto node = makeNode<SVGColorPaint>();
                 node->loadFromAttributes(attrs);
                 return node;
                 });
@@ -1164,7 +1178,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::fill(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGFillPaint>();
+                auto node = makeNode<SVGFillPaint>();
                 node->loadFromAttributes(attrs);
                 return node;
                 });
@@ -1192,7 +1206,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::fill_rule(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGFillRuleAttribute>(nullptr);
+                auto node = makeNode<SVGFillRuleAttribute>(nullptr);
                 node->loadFromAttributes(attrs);
                 return node;
                 });
@@ -1229,7 +1243,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttributeByName(svgattr::stroke(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGStrokePaint>(); 
+                auto node = makeNode<SVGStrokePaint>(); 
                 node->loadFromAttributes(attrs);
                 return node; 
                 });
@@ -1306,7 +1320,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::stroke_width(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGStrokeWidth>(nullptr); 
+                auto node = makeNode<SVGStrokeWidth>(nullptr); 
                 node->loadFromAttributes(attrs);  
                 return node; 
                 });
@@ -1350,7 +1364,7 @@ namespace waavs {
     struct SVGStrokeMiterLimit : public SVGVisualProperty
     {
         static void registerFactory() {
-            registerSVGAttribute(svgattr::stroke_miterlimit(), [](const XmlAttributeCollection& attrs) {auto node = std::make_shared<SVGStrokeMiterLimit>(nullptr); node->loadFromAttributes(attrs);  return node; });
+            registerSVGAttribute(svgattr::stroke_miterlimit(), [](const XmlAttributeCollection& attrs) {auto node = makeNode<SVGStrokeMiterLimit>(nullptr); node->loadFromAttributes(attrs);  return node; });
         }
 
 
@@ -1393,9 +1407,9 @@ namespace waavs {
     {
         static void registerFactory()
         {
-            registerSVGAttributeByName(svgattr::stroke_linecap(), [](const XmlAttributeCollection& attrs) {auto node = std::make_shared<SVGStrokeLineCap>(nullptr, svgattr::stroke_linecap()); node->loadFromAttributes(attrs);  return node; });
-            registerSVGAttributeByName(svgattr::stroke_linecap_start(), [](const XmlAttributeCollection& attrs) {auto node = std::make_shared<SVGStrokeLineCap>(nullptr, svgattr::stroke_linecap_start()); node->loadFromAttributes(attrs);  return node; });
-            registerSVGAttributeByName(svgattr::stroke_linecap_end(), [](const XmlAttributeCollection& attrs) {auto node = std::make_shared<SVGStrokeLineCap>(nullptr, svgattr::stroke_linecap_end()); node->loadFromAttributes(attrs);  return node; });
+            registerSVGAttributeByName(svgattr::stroke_linecap(), [](const XmlAttributeCollection& attrs) {auto node = makeNode<SVGStrokeLineCap>(nullptr, svgattr::stroke_linecap()); node->loadFromAttributes(attrs);  return node; });
+            registerSVGAttributeByName(svgattr::stroke_linecap_start(), [](const XmlAttributeCollection& attrs) {auto node = makeNode<SVGStrokeLineCap>(nullptr, svgattr::stroke_linecap_start()); node->loadFromAttributes(attrs);  return node; });
+            registerSVGAttributeByName(svgattr::stroke_linecap_end(), [](const XmlAttributeCollection& attrs) {auto node = makeNode<SVGStrokeLineCap>(nullptr, svgattr::stroke_linecap_end()); node->loadFromAttributes(attrs);  return node; });
         }
 
 
@@ -1454,7 +1468,7 @@ namespace waavs {
     struct SVGStrokeLineJoin : public SVGVisualProperty
     {
         static void registerFactory() {
-            registerSVGAttribute(svgattr::stroke_linejoin(), [](const XmlAttributeCollection& attrs) {auto node = std::make_shared<SVGStrokeLineJoin>(nullptr); node->loadFromAttributes(attrs);  return node; });
+            registerSVGAttribute(svgattr::stroke_linejoin(), [](const XmlAttributeCollection& attrs) {auto node = makeNode<SVGStrokeLineJoin>(nullptr); node->loadFromAttributes(attrs);  return node; });
         }
 
         BLStrokeJoin fLineJoin{ BL_STROKE_JOIN_MITER_BEVEL };
@@ -1491,7 +1505,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGAttribute(svgattr::transform(), [](const XmlAttributeCollection& attrs)
-                {auto node = std::make_shared<SVGTransform>(); node->loadFromAttributes(attrs);  return node; });
+                {auto node = makeNode<SVGTransform>(); node->loadFromAttributes(attrs);  return node; });
         }
 
         WGMatrix3x3 fMatrix = WGMatrix3x3::makeIdentity() ;
@@ -1536,7 +1550,7 @@ namespace waavs {
     struct SVGViewbox : public SVGVisualProperty
     {
         static void registerFactory() {
-            registerSVGAttributeByName("viewBox", [](const XmlAttributeCollection& attrs) {auto node = std::make_shared<SVGViewbox>(nullptr); node->loadFromAttributes(attrs);  return node; });
+            registerSVGAttributeByName("viewBox", [](const XmlAttributeCollection& attrs) {auto node = makeNode<SVGViewbox>(nullptr); node->loadFromAttributes(attrs);  return node; });
 
         }
 
@@ -1756,10 +1770,10 @@ namespace waavs {
     {
         
         static void registerMarkerFactory() {
-            registerSVGAttribute(svgattr::marker(), [](const XmlAttributeCollection& attrs) {auto node = std::make_shared<SVGMarkerAttribute>(svgattr::marker()); node->loadFromAttributes(attrs);  return node; });
-            registerSVGAttribute(svgattr::marker_start(), [](const XmlAttributeCollection& attrs) {auto node = std::make_shared<SVGMarkerAttribute>(svgattr::marker_start()); node->loadFromAttributes(attrs);  return node; });
-            registerSVGAttribute(svgattr::marker_mid(), [](const XmlAttributeCollection& attrs) {auto node = std::make_shared<SVGMarkerAttribute>(svgattr::marker_mid()); node->loadFromAttributes(attrs);  return node; });
-            registerSVGAttribute(svgattr::marker_end(), [](const XmlAttributeCollection& attrs) {auto node = std::make_shared<SVGMarkerAttribute>(svgattr::marker_end()); node->loadFromAttributes(attrs);  return node; });
+            registerSVGAttribute(svgattr::marker(), [](const XmlAttributeCollection& attrs) {auto node = makeNode<SVGMarkerAttribute>(svgattr::marker()); node->loadFromAttributes(attrs);  return node; });
+            registerSVGAttribute(svgattr::marker_start(), [](const XmlAttributeCollection& attrs) {auto node = makeNode<SVGMarkerAttribute>(svgattr::marker_start()); node->loadFromAttributes(attrs);  return node; });
+            registerSVGAttribute(svgattr::marker_mid(), [](const XmlAttributeCollection& attrs) {auto node = makeNode<SVGMarkerAttribute>(svgattr::marker_mid()); node->loadFromAttributes(attrs);  return node; });
+            registerSVGAttribute(svgattr::marker_end(), [](const XmlAttributeCollection& attrs) {auto node = makeNode<SVGMarkerAttribute>(svgattr::marker_end()); node->loadFromAttributes(attrs);  return node; });
         }
 
         std::shared_ptr<IViewable> fWrappedNode = nullptr;
@@ -1825,7 +1839,7 @@ namespace waavs {
         static void registerFactory()
         {
             registerSVGAttribute(svgattr::clip_path(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGClipPathAttribute>(nullptr);
+                auto node = makeNode<SVGClipPathAttribute>(nullptr);
                 node->loadFromAttributes(attrs);
 
                 return node;
@@ -1895,7 +1909,7 @@ namespace waavs {
     struct SVGVectorEffectAttribute : public SVGVisualProperty
     {
         static void registerFactory() {
-            registerSVGAttribute(svgattr::vector_effect(), [](const XmlAttributeCollection& attrs) {auto node = std::make_shared<SVGVectorEffectAttribute>(nullptr); node->loadFromAttributes(attrs);  return node; });
+            registerSVGAttribute(svgattr::vector_effect(), [](const XmlAttributeCollection& attrs) {auto node = makeNode<SVGVectorEffectAttribute>(nullptr); node->loadFromAttributes(attrs);  return node; });
         }
 
         VectorEffectKind fEffectKind{ VECTOR_EFFECT_NONE };
@@ -1935,7 +1949,7 @@ namespace waavs
         static void registerFactory()
         {
             registerSVGAttribute(svgattr::stroke_dasharray(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGStrokeDashArray>();
+                auto node = makeNode<SVGStrokeDashArray>();
                 node->loadFromAttributes(attrs);
                 return node;
                 });
@@ -2023,7 +2037,7 @@ namespace waavs
         static void registerFactory()
         {
             registerSVGAttribute(svgattr::stroke_dashoffset(), [](const XmlAttributeCollection& attrs) {
-                auto node = std::make_shared<SVGStrokeDashOffset>(nullptr);
+                auto node = makeNode<SVGStrokeDashOffset>(nullptr);
                 node->loadFromAttributes(attrs);
                 return node;
                 });
@@ -53,6 +53,15 @@ namespace waavs
 
             BLResult res = fDrawingContext->begin(fTargetImage, ctxInfo);
 
+            // A tile is drawn in canvas coordinates, so its offset goes
+            // into the meta transform, under whatever the user sets
+            const WGPointI& origin = targetOrigin();
+            if (origin.x != 0 || origin.y != 0)
+            {
+                fDrawingContext->translate(-double(origin.x), -double(origin.y));
+                fDrawingContext->user_to_meta();
+            }
+
             if (state)
                 copyDrawingState(*state);
             else
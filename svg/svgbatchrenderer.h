@@ -0,0 +1,300 @@
+#pragma once
+
+//
+// Batch rendering
+//
+// Rendering a great many small documents, icons and thumbnails, is
+// a throughput problem rather than a latency one.  Each document is
+// too small for a multi-threaded drawing context to pay off, so
+// instead, documents are handed out to threads whole.  Each one is
+// an independent job; parse, draw, and encode.
+//
+// The jobs are run on the shared WorkerPool, as tiles are.  Each
+// worker pulls the next job until there are none left, so a few
+// large documents don't hold up the rest.  Each worker keeps its own
+// driver, pixels and codecs, and reuses them from one job to the
+// next, so after the first few jobs, there's little allocation
+// other than the documents themselves.  A job that fails, even by
+// throwing, only fails its own result.
+//
+// The library doesn't read files itself, so inputs are given as
+// memory, typically mapped files.  Pages of a mapped file are only
+// read in when the job parses it, on whichever thread that is.
+// Outputs are written with Blend2D's codecs, either to a file, or
+// kept in memory with the job's result.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "svgfactory.h"
+#include "svgb2ddriver.h"
+#include "viewport.h"
+#include "stopwatch.h"
+#include "workerpool.h"
+
+
+namespace waavs
+{
+    // SVGBatchItem
+    //
+    // One document to render, and where to put it
+    struct SVGBatchItem
+    {
+        std::shared_ptr<const void> fSourceOwner{};    // keeps fSource alive, if needed
+        ByteSpan fSource{};                             // .svg or .svgb contents
+
+        int fWidth{ 0 };                // 0 == the document's own width
+        int fHeight{ 0 };               // 0 == the document's own height
+
+        std::string fOutputFile{};      // empty == keep the encoded image in the result
+        std::string fFormat{};          // codec name, "PNG", "QOI", ..., empty == by the output extension
+    };
+
+    // SVGBatchResult
+    //
+    // What became of one item, and how long each step took
+    struct SVGBatchResult
+    {
+        bool fSuccess{ false };
+        const char* fError{ nullptr };
+
+        int fWidth{ 0 };
+        int fHeight{ 0 };
+
+        double fParseMillis{ 0 };
+        double fRenderMillis{ 0 };
+        double fEncodeMillis{ 0 };
+
+        size_t fWorker{ 0 };            // which thread did the job
+        BLArray<uint8_t> fEncoded{};    // when there's no output file
+    };
+
+    struct SVGBatchOptions
+    {
+        size_t fThreadCount{ 0 };       // 0 == all hardware threads
+        int fBlendThreads{ 0 };         // Blend2D threads for each job's context
+        double fDpi{ 96.0 };
+        BLRgba32 fBackground{ 0x00000000 };
+        bool fFitToCanvas{ true };      // scale the document to fit the output size
+
+        // Canvas size to parse against, when the item doesn't say
+        int fDefaultWidth{ 1920 };
+        int fDefaultHeight{ 1080 };
+    };
+
+
+    // SVGBatchWorker
+    //
+    // What a thread keeps from one job to the next.  Pixels are
+    // drawn into a part of one backing surface, which only grows,
+    // so differently sized outputs don't each allocate.
+    struct SVGBatchWorker
+    {
+        SVGB2DDriver fDriver{};
+        Surface fBacking{};
+        SurfacePool fSurfacePool{};
+
+        std::string fCodecName{};       // what fCodec was found by, an extension starts with '.'
+        BLImageCodec fCodec{};
+
+        bool acquireSurface(int w, int h, Surface& out)
+        {
+            if (int(fBacking.width()) < w || int(fBacking.height()) < h)
+            {
+                const int bw = std::max(w, int(fBacking.width()));
+                const int bh = std::max(h, int(fBacking.height()));
+
+                if (!fBacking.reset(bw, bh))
+                    return false;
+            }
+
+            return fBacking.getSubSurface(WGRectI{ 0, 0, w, h }, out) == WG_SUCCESS;
+        }
+
+        // The codec named, or the one for the output file's extension
+        bool acquireCodec(const SVGBatchItem& item)
+        {
+            const bool byExtension = item.fFormat.empty();
+            std::string key = item.fFormat;
+
+            if (byExtension)
+            {
+                const size_t dot = item.fOutputFile.rfind('.');
+                if (dot == std::string::npos || dot + 1 == item.fOutputFile.size())
+                    return false;
+
+                key = item.fOutputFile.substr(dot);
+            }
+
+            if (key == fCodecName)
+                return true;
+
+            BLResult r = byExtension
+                ? fCodec.find_by_extension(key.c_str() + 1)
+                : fCodec.find_by_name(key.c_str());
+
+            if (r != BL_SUCCESS)
+            {
+                fCodecName.clear();
+                return false;
+            }
+
+            fCodecName = key;
+            return true;
+        }
+    };
+
+
+    // renderBatchItem()
+    //
+    // Parse, draw, and encode one item
+    static INLINE void renderBatchItem(SVGBatchWorker& worker, const SVGBatchItem& item, const SVGBatchOptions& opts, SVGBatchResult& result)
+    {
+        StopWatch sw{};
+
+        if (item.fSource.empty())
+        {
+            result.fError = "no document";
+            return;
+        }
+
+        const int parseW = item.fWidth > 0 ? item.fWidth : opts.fDefaultWidth;
+        const int parseH = item.fHeight > 0 ? item.fHeight : opts.fDefaultHeight;
+
+        auto doc = SVGFactory::createFromSharedChunk(item.fSourceOwner, item.fSource, parseW, parseH, opts.fDpi);
+        if (!doc)
+        {
+            result.fError = "could not parse document";
+            return;
+        }
+
+        const WGRectD sceneFrame = doc->objectBoundingBox();
+        const int w = item.fWidth > 0 ? item.fWidth : (int)std::ceil(sceneFrame.w);
+        const int h = item.fHeight > 0 ? item.fHeight : (int)std::ceil(sceneFrame.h);
+
+        result.fParseMillis = sw.millis();
+
+        if (w <= 0 || h <= 0)
+        {
+            result.fError = "document has no size";
+            return;
+        }
+
+        sw.start();
+
+        Surface img{};
+        if (!worker.acquireSurface(w, h, img))
+        {
+            result.fError = "could not allocate pixels";
+            return;
+        }
+
+        WGMatrix3x3 tform = WGMatrix3x3::makeIdentity();
+        if (opts.fFitToCanvas)
+        {
+            PreserveAspectRatio par{};
+            computeViewBoxToViewport(WGRectD{ 0, 0, double(w), double(h) }, sceneFrame, par, tform);
+        }
+
+        SVGB2DDriver& ctx = worker.fDriver;
+        ctx.attach(img, opts.fBlendThreads);
+        ctx.setSurfacePool(&worker.fSurfacePool);
+        ctx.background(opts.fBackground);
+        ctx.renew();
+        ctx.clearToBackground();
+
+        ctx.transform(tform);
+        doc->draw(&ctx, doc.get());
+
+        ctx.detach();
+
+        result.fWidth = w;
+        result.fHeight = h;
+        result.fRenderMillis = sw.millis();
+
+        sw.start();
+
+        if (!worker.acquireCodec(item))
+        {
+            result.fError = "no codec for output format";
+            return;
+        }
+
+        BLImage blImg = blImageFromSurface(img);
+        BLResult r = item.fOutputFile.empty()
+            ? blImg.write_to_data(result.fEncoded, worker.fCodec)
+            : blImg.write_to_file(item.fOutputFile.c_str(), worker.fCodec);
+
+        result.fEncodeMillis = sw.millis();
+
+        if (r != BL_SUCCESS)
+        {
+            result.fError = "could not encode image";
+            return;
+        }
+
+        result.fSuccess = true;
+    }
+
+
+    // renderBatch()
+    //
+    // Render all the items, using up to opts.fThreadCount threads.
+    // 'results' gets one entry per item, in the same order.
+    // Returns the number of items that succeeded.
+    static INLINE size_t renderBatch(const std::vector<SVGBatchItem>& items, std::vector<SVGBatchResult>& results, const SVGBatchOptions& opts = {})
+    {
+        results.clear();
+        results.resize(items.size());
+
+        if (items.empty())
+            return 0;
+
+        WorkerPool& pool = WorkerPool::shared();
+
+        size_t threadCount = opts.fThreadCount;
+        if (threadCount == 0)
+            threadCount = pool.threadCount() + 1;
+
+        const size_t nWorkers = std::min(threadCount, items.size());
+
+        std::atomic<size_t> nextIndex{ 0 };
+        std::atomic<size_t> succeeded{ 0 };
+
+        // Each worker keeps one SVGBatchWorker for all the jobs it does
+        pool.parallelFor(nWorkers, nWorkers, [&](size_t workerId) {
+            SVGBatchWorker state{};
+
+            size_t idx;
+            while ((idx = nextIndex.fetch_add(1, std::memory_order_relaxed)) < items.size())
+            {
+                SVGBatchResult& result = results[idx];
+                result.fWorker = workerId;
+
+                try
+                {
+                    renderBatchItem(state, items[idx], opts, result);
+                }
+                catch (...)
+                {
+                    // Whatever was drawn, or encoded, is no good
+                    state.fDriver.detach();
+
+                    result = SVGBatchResult{};
+                    result.fWorker = workerId;
+                    result.fError = "exception while rendering";
+                }
+
+                if (result.fSuccess)
+                    succeeded.fetch_add(1, std::memory_order_relaxed);
+            }
+            });
+
+        return succeeded.load();
+    }
+}
@@ -0,0 +1,456 @@
+#pragma once
+
+//
+// SVGB - precompiled binary document image
+//
+// Loading an SVG document is mostly scanning: finding the elements
+// in the XML, and turning path 'd' attributes into PathPrograms.
+// For a library of assets that get loaded over and over, that work
+// can be done once, and saved.
+//
+// An .svgb image is a single relocatable chunk of memory, laid out
+// so it can be memory mapped and used in place:
+//
+//  header
+//  source      - the original document text, which all the attribute
+//                spans of the loaded document refer to
+//  names       - element names, as the scanner saw them
+//  elements    - one XmlElementRecord per element, in document order
+//  paths       - one SVGBPathRecord per path element, in document order
+//  args, ops   - the PathPrograms for those paths, back to back
+//
+// All offsets are from the start of the image.  Values are in the
+// byte order of the machine that wrote the image, and an image from
+// a machine of the other byte order is refused.
+//
+// An image is loaded by replaying the element records through an
+// XmlPull, so node construction is exactly what it would be from
+// the source, and path elements pick up their programs from the
+// image rather than parsing them.
+//
+// Only path data is precompiled.  Every other attribute, style,
+// transform, color and so on, is still parsed from the source text
+// as the image is loaded, and style resolution is left to the 
+// document as always, as it depends on the context the document is
+// bound to.
+//
+// An image may come from anywhere, so open() checks everything in it
+// that is later used without checking: every element is of a kind the
+// scanner makes, its name and data lie within their sections, and
+// every path program is well formed, with exactly the arguments its
+// ops call for.
+//
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "xmlscan.h"
+#include "svgatoms.h"
+#include "pathprogram.h"
+#include "pathattribute_parser.h"
+
+
+namespace waavs
+{
+    static constexpr uint8_t  kSVGBMagic[4] = { 'S', 'V', 'G', 'B' };
+    static constexpr uint32_t kSVGBVersion = 1;
+    static constexpr uint32_t kSVGBByteOrderMark = 0x01020304;
+
+    struct SVGBHeader
+    {
+        uint8_t  fMagic[4];
+        uint32_t fVersion;
+        uint32_t fByteOrder;        // kSVGBByteOrderMark, as written
+        uint32_t fHeaderSize;
+
+        uint64_t fSourceOffset;
+        uint64_t fSourceSize;
+        uint64_t fNamesOffset;
+        uint64_t fNamesSize;
+        uint64_t fElementsOffset;
+        uint64_t fElementCount;
+        uint64_t fPathsOffset;
+        uint64_t fPathCount;
+        uint64_t fOpsOffset;
+        uint64_t fOpsCount;
+        uint64_t fArgsOffset;
+        uint64_t fArgsCount;
+    };
+    static_assert(sizeof(SVGBHeader) == 112, "SVGBHeader layout changed");
+
+    // Where the PathProgram for one path element's 'd' attribute lives
+    struct SVGBPathRecord
+    {
+        uint32_t fDataOffset;       // the 'd' attribute value, within the source
+        uint32_t fDataLength;
+        uint32_t fOpsStart;
+        uint32_t fOpsCount;
+        uint32_t fArgsStart;
+        uint32_t fArgsCount;
+    };
+
+
+    // svgb_is_image()
+    //
+    // Does the chunk start out looking like an .svgb image
+    static INLINE bool svgb_is_image(const ByteSpan& chunk) noexcept
+    {
+        return chunk.size() >= sizeof(SVGBHeader) && memcmp(chunk.data(), kSVGBMagic, 4) == 0;
+    }
+
+
+    // SVGBImage
+    //
+    // A read only view of an .svgb image.  It doesn't own the memory,
+    // which has to stay put for as long as the view, and anything
+    // loaded from it, is in use.
+    struct SVGBImage
+    {
+        ByteSpan fImage{};
+        SVGBHeader fHeader{};
+
+        const XmlElementRecord* fElements{ nullptr };
+        const SVGBPathRecord* fPaths{ nullptr };
+        const uint8_t* fOps{ nullptr };
+        const float* fArgs{ nullptr };
+
+    private:
+        bool sectionFits(uint64_t offset, uint64_t count, size_t elemSize, size_t align) const noexcept
+        {
+            if (offset % align != 0 || offset > fImage.size())
+                return false;
+
+            return count <= (fImage.size() - offset) / elemSize;
+        }
+
+        // Does [offset, offset+length) lie within the section
+        static bool spanWithin(uint64_t offset, uint64_t length, uint64_t sectionOffset, uint64_t sectionSize) noexcept
+        {
+            return offset >= sectionOffset && length <= sectionSize && offset - sectionOffset <= sectionSize - length;
+        }
+
+        // Each element is of a known kind, with its name and data
+        // within their sections
+        bool elementsValid() const noexcept
+        {
+            for (size_t i = 0; i < fHeader.fElementCount; i++)
+            {
+                const XmlElementRecord& rec = fElements[i];
+
+                // Replay hands the kind straight to the element, and an
+                // invalid one would read as the end of the document
+                if (rec.fKind <= XML_ELEMENT_TYPE_INVALID || rec.fKind > XML_ELEMENT_TYPE_ENTITY)
+                    return false;
+
+                if (rec.fNameLength && !spanWithin(rec.fNameOffset, rec.fNameLength, fHeader.fNamesOffset, fHeader.fNamesSize))
+                    return false;
+                if (rec.fDataLength && !spanWithin(rec.fDataOffset, rec.fDataLength, fHeader.fSourceOffset, fHeader.fSourceSize))
+                    return false;
+            }
+
+            return true;
+        }
+
+        // Each path's data is in the source, in document order, and its
+        // program has valid ops, ending with OP_END, which between them
+        // take exactly the arguments recorded for it
+        bool pathsValid() const noexcept
+        {
+            uint64_t lastOffset = 0;
+
+            for (size_t i = 0; i < fHeader.fPathCount; i++)
+            {
+                const SVGBPathRecord& rec = fPaths[i];
+
+                if (!spanWithin(rec.fDataOffset, rec.fDataLength, fHeader.fSourceOffset, fHeader.fSourceSize))
+                    return false;
+                if (i > 0 && rec.fDataOffset <= lastOffset)
+                    return false;
+                lastOffset = rec.fDataOffset;
+
+                if (!spanWithin(rec.fOpsStart, rec.fOpsCount, 0, fHeader.fOpsCount) ||
+                    !spanWithin(rec.fArgsStart, rec.fArgsCount, 0, fHeader.fArgsCount))
+                    return false;
+
+                if (rec.fOpsCount == 0 || fOps[rec.fOpsStart + rec.fOpsCount - 1] != OP_END)
+                    return false;
+
+                uint64_t argsNeeded = 0;
+                for (uint32_t j = 0; j < rec.fOpsCount; j++)
+                {
+                    const uint8_t op = fOps[rec.fOpsStart + j];
+                    if (op >= std::size(kPathOpArity))
+                        return false;
+                    argsNeeded += kPathOpArity[op];
+                }
+
+                if (argsNeeded != rec.fArgsCount)
+                    return false;
+            }
+
+            return true;
+        }
+
+    public:
+        bool isOpen() const noexcept { return fElements != nullptr; }
+
+        void reset() noexcept
+        {
+            *this = SVGBImage{};
+        }
+
+        // open()
+        //
+        // Check the image is one we can use, and find its sections.
+        // The image has to be at least 8 byte aligned, as mapped files
+        // and heap blocks are.
+        bool open(const ByteSpan& image) noexcept
+        {
+            reset();
+
+            if (!svgb_is_image(image))
+                return false;
+
+            if (((uintptr_t)image.data() & 7) != 0)
+                return false;
+
+            memcpy(&fHeader, image.data(), sizeof(SVGBHeader));
+
+            if (fHeader.fVersion != kSVGBVersion ||
+                fHeader.fByteOrder != kSVGBByteOrderMark ||
+                fHeader.fHeaderSize != sizeof(SVGBHeader))
+                return false;
+
+            fImage = image;
+
+            if (!sectionFits(fHeader.fSourceOffset, fHeader.fSourceSize, 1, 1) ||
+                !sectionFits(fHeader.fNamesOffset, fHeader.fNamesSize, 1, 1) ||
+                !sectionFits(fHeader.fElementsOffset, fHeader.fElementCount, sizeof(XmlElementRecord), alignof(XmlElementRecord)) ||
+                !sectionFits(fHeader.fPathsOffset, fHeader.fPathCount, sizeof(SVGBPathRecord), alignof(SVGBPathRecord)) ||
+                !sectionFits(fHeader.fOpsOffset, fHeader.fOpsCount, 1, 1) ||
+                !sectionFits(fHeader.fArgsOffset, fHeader.fArgsCount, sizeof(float), alignof(float)))
+            {
+                reset();
+                return false;
+            }
+
+            const uint8_t* base = image.data();
+            fElements = (const XmlElementRecord*)(base + fHeader.fElementsOffset);
+            fPaths = (const SVGBPathRecord*)(base + fHeader.fPathsOffset);
+            fOps = base + fHeader.fOpsOffset;
+            fArgs = (const float*)(base + fHeader.fArgsOffset);
+
+            if (!elementsValid() || !pathsValid())
+            {
+                reset();
+                return false;
+            }
+
+            return true;
+        }
+
+        const ByteSpan& image() const noexcept { return fImage; }
+
+        ByteSpan source() const noexcept
+        {
+            return ByteSpan(fImage.data() + fHeader.fSourceOffset, size_t(fHeader.fSourceSize));
+        }
+
+        const XmlElementRecord* elements() const noexcept { return fElements; }
+        size_t elementCount() const noexcept { return size_t(fHeader.fElementCount); }
+
+        // findPathProgram()
+        //
+        // If 'd' is the attribute value of one of the precompiled
+        // paths, copy its program into 'prog'.  The span has to be
+        // the very one the element was loaded with, not just the same text.
+        bool findPathProgram(const ByteSpan& d, PathProgram& prog) const
+        {
+            if (!isOpen() || d.data() < fImage.data() || d.data() >= fImage.data() + fImage.size())
+                return false;
+
+            const uint64_t offset = uint64_t(d.data() - fImage.data());
+
+            // Paths are recorded in document order, so by offset
+            size_t lo = 0;
+            size_t hi = size_t(fHeader.fPathCount);
+            while (lo < hi)
+            {
+                const size_t mid = (lo + hi) / 2;
+                if (fPaths[mid].fDataOffset < offset)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+
+            if (lo >= fHeader.fPathCount)
+                return false;
+
+            const SVGBPathRecord& rec = fPaths[lo];
+            if (rec.fDataOffset != offset || rec.fDataLength != d.size())
+                return false;
+
+            // open() has checked the program is in bounds, and well formed
+
+            prog.ops.assign(fOps + rec.fOpsStart, fOps + rec.fOpsStart + rec.fOpsCount);
+            prog.args.assign(fArgs + rec.fArgsStart, fArgs + rec.fArgsStart + rec.fArgsCount);
+
+            return true;
+        }
+    };
+
+
+    // svgb_compile()
+    //
+    // Scan an SVG document, and write its .svgb image into 'out'.
+    // Returns false if the source can't be represented.  Offsets 
+    // within the image are 32 bit, so the whole image has to stay
+    // under 4GB, and the source is limited to 2GB, leaving room for
+    // the rest.
+    static bool svgb_compile(const ByteSpan& src, std::vector<uint8_t>& out)
+    {
+        out.clear();
+
+        if (src.size() > UINT32_MAX / 2)
+            return false;
+
+        // The names interned here are of no use to anyone else
+        PSNameScope names{};
+        PSNameScopeGuard nameGuard(&names);
+
+        auto align8 = [](uint64_t v) { return (v + 7) & ~uint64_t(7); };
+
+        // The source goes right after the header, so offsets into
+        // the source are known before anything else is laid out
+        const uint64_t sourceOffset = sizeof(SVGBHeader);
+        const uint64_t namesOffset = align8(sourceOffset + src.size());
+
+        std::vector<uint8_t> namePool{};
+        std::unordered_map<const char*, uint32_t> nameOffsets{};
+        std::vector<XmlElementRecord> elements{};
+        std::vector<SVGBPathRecord> paths{};
+        PathProgram allPaths{};
+        PathProgram prog{};
+
+        auto sourceOffsetOf = [&](const ByteSpan& s, uint32_t& offset) -> bool {
+            if (s.empty())
+            {
+                offset = 0;
+                return true;
+            }
+
+            if (s.data() < src.data() || s.data() + s.size() > src.data() + src.size())
+                return false;
+
+            offset = uint32_t(sourceOffset + (s.data() - src.data()));
+            return true;
+        };
+
+        XmlPull iter(src, true);
+        while (iter.next())
+        {
+            const XmlElement& elem = *iter;
+
+            XmlElementRecord rec{};
+            rec.fKind = elem.kind();
+
+            // The scanner hands back interned names, so the text
+            // of the name is stored once, however often it's used
+            const char* qname = elem.qNameAtom();
+            if (qname)
+            {
+                auto it = nameOffsets.find(qname);
+                if (it == nameOffsets.end())
+                {
+                    const size_t len = strlen(qname);
+                    it = nameOffsets.emplace(qname, uint32_t(namesOffset + namePool.size())).first;
+                    namePool.insert(namePool.end(), (const uint8_t*)qname, (const uint8_t*)qname + len);
+                }
+
+                rec.fNameOffset = it->second;
+                rec.fNameLength = uint32_t(strlen(qname));
+            }
+
+            if (!sourceOffsetOf(elem.data(), rec.fDataOffset))
+                return false;
+            rec.fDataLength = uint32_t(elem.data().size());
+
+            elements.push_back(rec);
+
+            // Compile the path data, just as the path element will
+            if (elem.nameAtom() == svgtag::tag_path() && (elem.isStart() || elem.isSelfClosing()))
+            {
+                ByteSpan attrs = elem.data();
+                ByteSpan key{};
+                ByteSpan value{};
+                while (readNextKeyAttribute(attrs, key, value))
+                {
+                    if (PSNameScope::INTERN(key) != svgattr::d())
+                        continue;
+
+                    prog.clear();
+                    if (!value.empty() && parsePathProgram(value, prog))
+                    {
+                        SVGBPathRecord prec{};
+                        if (!sourceOffsetOf(value, prec.fDataOffset))
+                            return false;
+                        prec.fDataLength = uint32_t(value.size());
+                        prec.fOpsStart = uint32_t(allPaths.ops.size());
+                        prec.fOpsCount = uint32_t(prog.ops.size());
+                        prec.fArgsStart = uint32_t(allPaths.args.size());
+                        prec.fArgsCount = uint32_t(prog.args.size());
+
+                        allPaths.ops.insert(allPaths.ops.end(), prog.ops.begin(), prog.ops.end());
+                        allPaths.args.insert(allPaths.args.end(), prog.args.begin(), prog.args.end());
+                        paths.push_back(prec);
+                    }
+                    break;
+                }
+            }
+        }
+
+        // Lay out everything that follows the names
+        SVGBHeader hdr{};
+        memcpy(hdr.fMagic, kSVGBMagic, 4);
+        hdr.fVersion = kSVGBVersion;
+        hdr.fByteOrder = kSVGBByteOrderMark;
+        hdr.fHeaderSize = sizeof(SVGBHeader);
+        hdr.fSourceOffset = sourceOffset;
+        hdr.fSourceSize = src.size();
+        hdr.fNamesOffset = namesOffset;
+        hdr.fNamesSize = namePool.size();
+        hdr.fElementsOffset = align8(namesOffset + namePool.size());
+        hdr.fElementCount = elements.size();
+        hdr.fPathsOffset = align8(hdr.fElementsOffset + elements.size() * sizeof(XmlElementRecord));
+        hdr.fPathCount = paths.size();
+        hdr.fArgsOffset = align8(hdr.fPathsOffset + paths.size() * sizeof(SVGBPathRecord));
+        hdr.fArgsCount = allPaths.args.size();
+        hdr.fOpsOffset = align8(hdr.fArgsOffset + allPaths.args.size() * sizeof(float));
+        hdr.fOpsCount = allPaths.ops.size();
+
+        const uint64_t total = hdr.fOpsOffset + allPaths.ops.size();
+        if (total > UINT32_MAX)
+            return false;
+
+        out.assign(size_t(total), 0);
+        uint8_t* base = out.data();
+
+        memcpy(base, &hdr, sizeof(hdr));
+        if (!src.empty())
+            memcpy(base + hdr.fSourceOffset, src.data(), src.size());
+        if (!namePool.empty())
+            memcpy(base + hdr.fNamesOffset, namePool.data(), namePool.size());
+        if (!elements.empty())
+            memcpy(base + hdr.fElementsOffset, elements.data(), elements.size() * sizeof(XmlElementRecord));
+        if (!paths.empty())
+            memcpy(base + hdr.fPathsOffset, paths.data(), paths.size() * sizeof(SVGBPathRecord));
+        if (!allPaths.args.empty())
+            memcpy(base + hdr.fArgsOffset, allPaths.args.data(), allPaths.args.size() * sizeof(float));
+        if (!allPaths.ops.empty())
+            memcpy(base + hdr.fOpsOffset, allPaths.ops.data(), allPaths.ops.size());
+
+        return true;
+    }
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+//
+// SVGBoundsIndex
+//
+// A bounding volume hierarchy over a set of rectangles.  Containers
+// use one over their render nodes, by where each of them draws, so
+// that when only a small part of a large container is visible, the
+// nodes that land there can be found without looking at all the rest.
+//
+// Items are identified by a number, the index of the render node.
+// A query hands back the items whose bounds touch the query rectangle,
+// in ascending order, so drawing them keeps the original paint order.
+// Items that have no bounds are handed back by every query.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "wggeometry.h"
+
+
+namespace waavs
+{
+    struct SVGBoundsIndex
+    {
+        static constexpr size_t kLeafSize = 8;
+
+        struct Node
+        {
+            WGRectD fBounds{};
+            uint32_t fFirst{ 0 };       // leaf: first of its items
+            uint32_t fCount{ 0 };       // leaf: how many items, 0 for a branch
+            uint32_t fSecond{ 0 };      // branch: the second child, the first follows the branch
+        };
+
+        std::vector<Node> fNodes{};
+        std::vector<uint32_t> fItems{};
+        std::vector<WGRectD> fItemBounds{};
+        std::vector<uint32_t> fUnbounded{};
+
+    private:
+        static bool touches(const WGRectD& a, const WGRectD& b) noexcept
+        {
+            return (a.x <= b.x + b.w) && (b.x <= a.x + a.w) &&
+                (a.y <= b.y + b.h) && (b.y <= a.y + a.h);
+        }
+
+        static WGRectD merged(const WGRectD& a, const WGRectD& b) noexcept
+        {
+            const double x0 = std::min(a.x, b.x);
+            const double y0 = std::min(a.y, b.y);
+            const double x1 = std::max(a.x + a.w, b.x + b.w);
+            const double y1 = std::max(a.y + a.h, b.y + b.h);
+
+            return WGRectD{ x0, y0, x1 - x0, y1 - y0 };
+        }
+
+        // Build the subtree over entries [first, first+count), and
+        // return the index of its node
+        uint32_t buildNode(std::vector<std::pair<uint32_t, WGRectD>>& entries, size_t first, size_t count)
+        {
+            const uint32_t nodeIdx = uint32_t(fNodes.size());
+            fNodes.push_back(Node{});
+
+            WGRectD bounds = entries[first].second;
+            for (size_t i = first + 1; i < first + count; i++)
+                bounds = merged(bounds, entries[i].second);
+
+            if (count <= kLeafSize)
+            {
+                Node& leaf = fNodes[nodeIdx];
+                leaf.fBounds = bounds;
+                leaf.fFirst = uint32_t(fItems.size());
+                leaf.fCount = uint32_t(count);
+
+                for (size_t i = first; i < first + count; i++)
+                {
+                    fItems.push_back(entries[i].first);
+                    fItemBounds.push_back(entries[i].second);
+                }
+
+                return nodeIdx;
+            }
+
+            // Split at the median center, along the longer side
+            const bool alongX = bounds.w >= bounds.h;
+            auto begin = entries.begin() + first;
+            auto mid = begin + count / 2;
+            auto end = begin + count;
+
+            std::nth_element(begin, mid, end, [alongX](const std::pair<uint32_t, WGRectD>& a, const std::pair<uint32_t, WGRectD>& b) {
+                return alongX ? (2.0 * a.second.x + a.second.w) < (2.0 * b.second.x + b.second.w)
+                    : (2.0 * a.second.y + a.second.h) < (2.0 * b.second.y + b.second.h);
+                });
+
+            const size_t half = count / 2;
+            buildNode(entries, first, half);
+            const uint32_t second = buildNode(entries, first + half, count - half);
+
+            fNodes[nodeIdx].fBounds = bounds;
+            fNodes[nodeIdx].fSecond = second;
+
+            return nodeIdx;
+        }
+
+    public:
+        bool empty() const noexcept { return fNodes.empty() && fUnbounded.empty(); }
+
+        void clear() noexcept
+        {
+            fNodes.clear();
+            fItems.clear();
+            fItemBounds.clear();
+            fUnbounded.clear();
+        }
+
+        // build()
+        //
+        // 'entries' are (item, bounds) pairs, and get reordered.
+        // 'unbounded' are the items with no bounds.
+        void build(std::vector<std::pair<uint32_t, WGRectD>>& entries, std::vector<uint32_t> unbounded)
+        {
+            clear();
+
+            fUnbounded = std::move(unbounded);
+            std::sort(fUnbounded.begin(), fUnbounded.end());
+
+            if (entries.empty())
+                return;
+
+            fNodes.reserve(2 * (entries.size() / kLeafSize + 1));
+            fItems.reserve(entries.size());
+            fItemBounds.reserve(entries.size());
+
+            buildNode(entries, 0, entries.size());
+        }
+
+        // query()
+        //
+        // The items whose bounds touch 'r', along with all the
+        // unbounded items, in ascending order
+        void query(const WGRectD& r, std::vector<uint32_t>& out) const
+        {
+            out.clear();
+
+            if (!fNodes.empty())
+            {
+                uint32_t stack[64];
+                size_t depth = 0;
+                stack[depth++] = 0;
+
+                while (depth > 0)
+                {
+                    const Node& node = fNodes[stack[--depth]];
+                    if (!touches(node.fBounds, r))
+                        continue;
+
+                    if (node.fCount > 0)
+                    {
+                        for (uint32_t i = node.fFirst; i < node.fFirst + node.fCount; i++)
+                        {
+                            if (touches(fItemBounds[i], r))
+                                out.push_back(fItems[i]);
+                        }
+                    }
+                    else
+                    {
+                        const uint32_t self = uint32_t(&node - fNodes.data());
+                        stack[depth++] = node.fSecond;
+                        stack[depth++] = self + 1;
+                    }
+                }
+            }
+
+            out.insert(out.end(), fUnbounded.begin(), fUnbounded.end());
+            std::sort(out.begin(), out.end());
+        }
+    };
+}
@@ -7,6 +7,7 @@
 #include "svgb2ddriver.h"
 #include "svgattributes.h"
 #include "svggraphicselement.h"
+#include "svgshapes.h"
 #include "pixeling_clip.h"
 
 namespace waavs 
@@ -31,7 +32,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName(svgtag::tag_clipPath(), [](IAmGroot * groot, XmlPull & iter) {
-                auto node = std::make_shared<SVGClipPathElement>(groot);
+                auto node = makeNode<SVGClipPathElement>(groot);
                 node->loadFromXmlPull(iter, groot);
 
                 return node;
@@ -55,7 +56,7 @@ namespace waavs
             fAttributes.getValue(svgattr::clipPathUnits(), clipUnitsAttr);
             if (clipUnitsAttr)
             {
-                InternedKey clipUnitsKey = PSNameTable::INTERN(clipUnitsAttr);
+                InternedKey clipUnitsKey = PSNameScope::LOOKUP(clipUnitsAttr);
                 if (clipUnitsKey == svgval::userSpaceOnUse())
                     fClipPathUnits = SpaceUnitsKind::SVG_SPACE_USER;
                 else if (clipUnitsKey == svgval::objectBoundingBox())
@@ -63,24 +64,144 @@ namespace waavs
             }
         }
 
-        bool renderClipSurface(IRenderSVG *ctx, IAmGroot* groot,
-            const IsolatedRenderPlan& plan,
-            Surface& outMask) noexcept
+        // Only a transform that keeps rectangles as rectangles will do,
+        // and no transform at all is the identity
+        static bool getRectilinearTransform(SVGGraphicsElement& elem, WGMatrix3x3& out) noexcept
         {
-            if (!groot)
+            out = WGMatrix3x3::makeIdentity();
+
+            auto prop = std::dynamic_pointer_cast<SVGTransform>(elem.getVisualProperty(svgattr::transform()));
+            if (!prop)
+                return !elem.hasFeature(svgattr::transform());
+
+            out = prop->fMatrix;
+            return out.isScaleTranslate();
+        }
+
+        // getGeometricClip()
+        //
+        // The clip comes down to a rectangle when it holds a single plain
+        // <rect>, with square corners, nothing of its own that needs
+        // isolation, and transforms that keep it a rectangle.  A clip
+        // with nothing in it clips everything away.
+        bool getGeometricClip(IRenderSVG* ctx, IAmGroot* groot,
+            const WGRectD& objectBBoxUS,
+            WGRectD& clipUS) noexcept override
+        {
+            if (!ctx || !groot)
                 return false;
 
-            WGMatrix3x3 maskCtm = plan.ctm;
+            // A clip on the clip needs drawing
+            if (hasFeature(svgattr::clip_path()))
+                return false;
 
-            if (fClipPathUnits == SpaceUnitsKind::SVG_SPACE_OBJECT)
+            if (fRenderNodes.empty())
             {
-                WGMatrix3x3 obb{};
-                obb.translate(plan.objectBBoxUS.x, plan.objectBBoxUS.y);
-                obb.scale(plan.objectBBoxUS.w, plan.objectBBoxUS.h);
+                clipUS = WGRectD{};
+                return true;
+            }
+
+            if (fRenderNodes.size() != 1)
+                return false;
 
-                maskCtm.postTransform(obb);
+            auto rectNode = std::dynamic_pointer_cast<SVGRectElement>(fRenderNodes[0]);
+            if (!rectNode || !rectNode->isVisible())
+                return false;
+
+            if (rectNode->hasFeature(svgattr::clip_path()) ||
+                rectNode->hasFeature(svgattr::mask()) ||
+                rectNode->hasFeature(svgattr::filter()) ||
+                rectNode->hasFeature(svgattr::display()) ||
+                rectNode->hasFeature(svgattr::visibility()))
+                return false;
+
+            const DocRectState& rs = rectNode->fDocState;
+            if ((rs.rx.isSet() && rs.rx.value() != 0.0) || (rs.ry.isSet() && rs.ry.value() != 0.0))
+                return false;
+
+            // The rect's transform, then the units, then the clip's own
+            // transform, as contentUnitsTransform() has it
+            WGMatrix3x3 rectXform{};
+            WGMatrix3x3 clipXform{};
+            if (!getRectilinearTransform(*rectNode, rectXform) || !getRectilinearTransform(*this, clipXform))
+                return false;
+
+            // Object bounding box units are fractions of the box, as
+            // are percentages
+            const bool objectUnits = fClipPathUnits == SpaceUnitsKind::SVG_SPACE_OBJECT;
+            const WGRectD paintVP = ctx->viewport();
+            const double dpi = groot->dpi();
+
+            LengthResolveCtx cx = makeLengthCtxUser(objectUnits ? 1.0 : paintVP.w, 0.0, dpi, nullptr);
+            LengthResolveCtx cy = makeLengthCtxUser(objectUnits ? 1.0 : paintVP.h, 0.0, dpi, nullptr);
+
+            WGRectD r{};
+            r.x = resolveLengthOr(rs.x, cx, 0);
+            r.y = resolveLengthOr(rs.y, cy, 0);
+            r.w = resolveLengthOr(rs.width, cx, 0);
+            r.h = resolveLengthOr(rs.height, cy, 0);
+
+            if (!(r.w > 0.0) || !(r.h > 0.0))
+            {
+                clipUS = WGRectD{};
+                return true;
             }
 
+            r = mapRectAABB(rectXform, r);
+
+            if (objectUnits)
+            {
+                if (!(objectBBoxUS.w > 0.0) || !(objectBBoxUS.h > 0.0))
+                {
+                    clipUS = WGRectD{};
+                    return true;
+                }
+
+                r = WGRectD{
+                    objectBBoxUS.x + r.x * objectBBoxUS.w,
+                    objectBBoxUS.y + r.y * objectBBoxUS.h,
+                    r.w * objectBBoxUS.w,
+                    r.h * objectBBoxUS.h };
+            }
+
+            clipUS = mapRectAABB(clipXform, r);
+            return true;
+        }
+
+        // contentUnitsTransform()
+        //
+        // Maps the clip's content into the clipped element's user
+        // space, ahead of the element's transform.  The content is
+        // drawn without drawBegin(), so the clipPath's own transform
+        // is here.  Object bounding box units are applied first, and
+        // the transform after, in the clipped element's user space.
+        WGMatrix3x3 contentUnitsTransform(const WGRectD& objectBBoxUS) noexcept
+        {
+            WGMatrix3x3 units = WGMatrix3x3::makeIdentity();
+
+            auto prop = std::dynamic_pointer_cast<SVGTransform>(getVisualProperty(svgattr::transform()));
+            if (prop)
+                units = prop->fMatrix;
+
+            if (fClipPathUnits == SpaceUnitsKind::SVG_SPACE_OBJECT)
+            {
+                units.translate(objectBBoxUS.x, objectBBoxUS.y);
+                units.scale(objectBBoxUS.w, objectBBoxUS.h);
+            }
+
+            return units;
+        }
+
+        bool renderClipSurface(IRenderSVG *ctx, IAmGroot* groot,
+            const IsolatedRenderPlan& plan,
+            Surface& outMask) noexcept
+        {
+            if (!groot)
+                return false;
+
+            WGMatrix3x3 maskCtm = contentUnitsTransform(plan.objectBBoxUS);
+            maskCtm.postTransform(plan.ctm);
+
             IsolatedSubtreeRequest req{};
             req.userRect = plan.effectRectUS;
             req.pixelRect = plan.pixelRect;
@@ -88,6 +209,7 @@ namespace waavs
             req.objectBBoxUS = plan.objectBBoxUS;
             req.renderMode = RF_Content;
             req.clear = true;
+            req.pool = plan.pool;
 
             return renderSubtreeToSurface(groot, this, req, outMask);
         }
@@ -114,5 +236,20 @@ namespace waavs
 
             return true;
         }
+
+        bool recordEffectPart(IRenderSVG* ctx, IAmGroot* groot,
+            const IsolatedRenderPlan& plan) noexcept override
+        {
+            ctx->beginEffectPart(SVG_EFFECT_CLIP, contentUnitsTransform(plan.objectBBoxUS));
+            ctx->push();
+            ctx->copyDrawingState(SVGDrawingState{});
+            ctx->setObjectFrame(plan.objectBBoxUS);
+            ctx->setViewport(plan.objectBBoxUS);
+            drawContent(ctx, groot);
+            ctx->pop();
+            ctx->endEffectPart();
+
+            return true;
+        }
     };
 }
\ No newline at end of file
@@ -22,7 +22,7 @@ namespace waavs {
         {
             registerContainerNode(svgtag::tag_switch_(),
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGSwitchElement>(groot);
+                    auto node = makeNode<SVGSwitchElement>(groot);
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -39,6 +39,9 @@ namespace waavs {
 
         SVGSwitchElement(IAmGroot* root) noexcept : SVGGraphicsElement() {}
 
+        // What's drawn is the selected node, which isn't a render node
+        bool canCull() const noexcept override { return false; }
+
         std::shared_ptr<IViewable> getSelectedNode() noexcept 
         { 
             if (fSelectedNode)
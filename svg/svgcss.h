@@ -2,11 +2,12 @@
 
 
 
+#include <cstring>
 #include <map>
 #include <unordered_map>
 #include <vector>
 #include <string>
-#include <functional>
+#include <algorithm>
 #include <iterator>
 
 #include "xmlscan.h"
@@ -127,45 +128,292 @@ namespace waavs
         return true;
     }
     
+    //======================================================
+    // CSSMatchSubject
+    //
+    // What a selector gets to see of an element when it's
+    // being matched.  The class list is the raw, whitespace
+    // separated, 'class' attribute.  The attributes are the
+    // element's presentation attributes.
+    //======================================================
+    struct CSSMatchSubject
+    {
+        InternedKey fTag{ nullptr };
+        ByteSpan fId{};
+        ByteSpan fClasses{};
+        const XmlAttributeCollection* fAttributes{ nullptr };
+    };
+
+    // Is 'token' one of the whitespace separated words in 'list'
+    static INLINE bool css_list_contains(const ByteSpan& list, const ByteSpan& token) noexcept
+    {
+        ByteSpan s = list;
+        while (s)
+        {
+            ByteSpan word = chunk_token(s, chrWspChars);
+            if (word && word == token)
+                return true;
+        }
+
+        return false;
+    }
+
+
+    //======================================================
+    // CSSMatchOp
+    //
+    // A selector is compiled into a short program of these,
+    // one per simple selector in a compound selector, so
+    // 'rect.outline[stroke]' becomes TAG, CLASS, ATTR_EXISTS.
+    // An element matches when every op in the program does.
+    //======================================================
+    enum CSSMatchOpCode : uint32_t
+    {
+        CSS_MATCH_TAG = 0,          // tag atom is fKey
+        CSS_MATCH_ID,               // id is fValue
+        CSS_MATCH_CLASS,            // class list has the word fValue
+        CSS_MATCH_ATTR_EXISTS,      // [fKey]
+        CSS_MATCH_ATTR_EQUALS,      // [fKey=fValue]
+        CSS_MATCH_ATTR_INCLUDES,    // [fKey~=fValue]
+    };
+
+    struct CSSMatchOp
+    {
+        uint32_t fCode{ CSS_MATCH_TAG };
+        InternedKey fKey{ nullptr };
+        ByteSpan fValue{};
+    };
+
+    // Everything that can end a simple selector's name
+    static charset cssselectordelims = charset(".#[:>+~*,") + chrWspChars;
+
+    // css_pack_specificity()
+    //
+    // Pack (id count, class and attribute count, tag count) one per
+    // byte, so specificity compares as a single number.  Each count
+    // saturates at 255, rather than carrying into the field above it.
+    static INLINE uint32_t css_pack_specificity(uint32_t ids, uint32_t classes, uint32_t tags) noexcept
+    {
+        return (std::min<uint32_t>(ids, 255) << 16) | (std::min<uint32_t>(classes, 255) << 8) | std::min<uint32_t>(tags, 255);
+    }
+
+    // compileSelector()
+    //
+    // Turn the selector named in 'info' into a match program, and
+    // figure its specificity.  The iterator has already classified
+    // the first simple selector, and stripped its leading character.
+    //
+    // Selectors the matcher can't evaluate, combinators, pseudo
+    // classes and at-rules, return false and are left out.
+    static bool compileSelector(const CSSSelectorInfo& info, std::vector<CSSMatchOp>& prog, uint32_t& specificity)
+    {
+        prog.clear();
+        specificity = 0;
+
+        uint32_t ids = 0;
+        uint32_t classes = 0;
+        uint32_t tags = 0;
+
+        ByteSpan s = info.name();
+        uint32_t kind = info.kind();
+
+        while (true)
+        {
+            switch (kind)
+            {
+            case CSS_SELECTOR_UNIVERSAL:
+                break;
+
+            case CSS_SELECTOR_ELEMENT:
+            case CSS_SELECTOR_ID:
+            case CSS_SELECTOR_CLASS:
+            {
+                const unsigned char* start = s.begin();
+                while (s && !cssselectordelims[*s])
+                    s++;
+                ByteSpan name = ByteSpan::fromPointers(start, s.begin());
+                if (!name)
+                    return false;
+
+                CSSMatchOp op{};
+                op.fKey = PSNameScope::INTERN(name);
+                op.fValue = name;
+
+                if (kind == CSS_SELECTOR_ELEMENT) {
+                    op.fCode = CSS_MATCH_TAG;
+                    tags++;
+                }
+                else if (kind == CSS_SELECTOR_ID) {
+                    op.fCode = CSS_MATCH_ID;
+                    ids++;
+                }
+                else {
+                    op.fCode = CSS_MATCH_CLASS;
+                    classes++;
+                }
+
+                prog.push_back(op);
+            } break;
+
+            case CSS_SELECTOR_ATTRIBUTE:
+            {
+                // name ']' | name '=' value ']' | name '~=' value ']'
+                ByteSpan inside = chunk_token_char(s, ']');
+                const unsigned char* eq = (const unsigned char*)memchr(inside.data(), '=', inside.size());
+
+                CSSMatchOp op{};
+                op.fCode = eq ? CSS_MATCH_ATTR_EQUALS : CSS_MATCH_ATTR_EXISTS;
+
+                ByteSpan attrName = eq ? ByteSpan::fromPointers(inside.begin(), eq) : inside;
+                if (eq && attrName)
+                {
+                    const unsigned char last = *(attrName.end() - 1);
+                    if (last == '~') {
+                        op.fCode = CSS_MATCH_ATTR_INCLUDES;
+                        attrName = ByteSpan::fromPointers(attrName.begin(), attrName.end() - 1);
+                    }
+                    else if (last == '^' || last == '$' || last == '*' || last == '|') {
+                        return false;
+                    }
+
+                    ByteSpan value = chunk_trim(ByteSpan::fromPointers(eq + 1, inside.end()), chrWspChars);
+                    op.fValue = chunk_trim(value, charset("\"'"));
+                }
+
+                attrName = chunk_trim(attrName, chrWspChars);
+                if (!attrName)
+                    return false;
+
+                op.fKey = PSNameScope::INTERN(attrName);
+
+                classes++;
+                prog.push_back(op);
+            } break;
+
+            default:
+                return false;
+            }
+
+            // Next simple selector of the compound, if there is one
+            if (!s)
+                break;
+
+            switch (*s)
+            {
+            case '.': kind = CSS_SELECTOR_CLASS; break;
+            case '#': kind = CSS_SELECTOR_ID; break;
+            case '[': kind = CSS_SELECTOR_ATTRIBUTE; break;
+            default:
+                return false;
+            }
+            s++;
+        }
+
+        specificity = css_pack_specificity(ids, classes, tags);
+
+        return true;
+    }
+
+    // Does the element have the attribute, and if so, what is it
+    static INLINE bool css_subject_attribute(const CSSMatchSubject& subject, InternedKey key, ByteSpan& value) noexcept
+    {
+        if (key == svgattr::id()) {
+            value = subject.fId;
+            return !value.empty();
+        }
+        if (key == svgattr::klass()) {
+            value = subject.fClasses;
+            return !value.empty();
+        }
+
+        value.reset();
+        return subject.fAttributes && subject.fAttributes->getValue(key, value);
+    }
+
     //======================================================
     // CSSSelector
     // 
 	// Holds onto a single CSS selector, which has a map of
     // attribute name/value pairs.
-	// This is a simple selector, not a complex selector, so
-	// it can be used on its own, but also act as a building
-    // block for more complex selectors, and style sheets
+    // The selector is compiled into a match program when it's
+    // created, so matching is a walk over a few ops.
     //======================================================
 
     struct CSSSelector
     {
-        using MatchFunction = std::function<bool(const XmlElement&)>;
-
     private:
         uint32_t fKind{ CSS_SELECTOR_INVALID };
         ByteSpan fName{};
         ByteSpan fData{};
         XmlAttributeCollection fAttributes{};
-        MatchFunction fMatchFunction{};
+        std::vector<CSSMatchOp> fProgram{};
+        uint32_t fSpecificity{ 0 };
+        uint32_t fOrder{ 0 };
+        bool fCompiled{ false };
 
     public:
         CSSSelector() = default;
 
-        CSSSelector(uint32_t kind, const ByteSpan& name, const ByteSpan& data, MatchFunction matchFn)
-            : fKind(kind), fName(name), fData(data), fMatchFunction(std::move(matchFn))
+        // Check compiled() to see whether it came out usable
+        CSSSelector(const CSSSelectorInfo& info, uint32_t order)
+            : fKind(info.kind()), fName(info.name()), fOrder(order)
         {
-            loadFromChunk(data);
+            fCompiled = compileSelector(info, fProgram, fSpecificity);
+            if (fCompiled)
+                loadFromChunk(info.data());
         }
 
-        bool matches(const XmlElement& element) const noexcept
+        bool compiled() const noexcept { return fCompiled; }
+
+        bool matches(const CSSMatchSubject& subject) const noexcept
         {
-            return fMatchFunction ? fMatchFunction(element) : false;
+            for (const CSSMatchOp& op : fProgram)
+            {
+                switch (op.fCode)
+                {
+                case CSS_MATCH_TAG:
+                    if (subject.fTag != op.fKey)
+                        return false;
+                    break;
+
+                case CSS_MATCH_ID:
+                    if (subject.fId != op.fValue)
+                        return false;
+                    break;
+
+                case CSS_MATCH_CLASS:
+                    if (!css_list_contains(subject.fClasses, op.fValue))
+                        return false;
+                    break;
+
+                default:
+                {
+                    ByteSpan value{};
+                    if (!css_subject_attribute(subject, op.fKey, value))
+                        return false;
+
+                    if (op.fCode == CSS_MATCH_ATTR_EQUALS && value != op.fValue)
+                        return false;
+                    if (op.fCode == CSS_MATCH_ATTR_INCLUDES && !css_list_contains(value, op.fValue))
+                        return false;
+                } break;
+                }
+            }
+
+            return true;
         }
 
         uint32_t kind() const noexcept { return fKind; }
         const ByteSpan& name() const noexcept { return fName; }
         ByteSpan data() const noexcept { return fData; }
         const XmlAttributeCollection& attributes() const noexcept { return fAttributes; }
+        const std::vector<CSSMatchOp>& program() const noexcept { return fProgram; }
+
+        // Specificity is (id count, class and attribute count, tag count)
+        // packed one per byte, see css_pack_specificity().
+        uint32_t specificity() const noexcept { return fSpecificity; }
+        uint32_t order() const noexcept { return fOrder; }
+        void setOrder(uint32_t order) noexcept { fOrder = order; }
 
         CSSSelector& mergeProperties(const CSSSelector& other)
         {
@@ -182,7 +430,6 @@ namespace waavs
         }
     };
 
-
  
 
     // CSSSelectorIterator
@@ -358,119 +605,208 @@ namespace waavs
 	// CSSStyleSheet
 	//
 	// This class represents a CSS style sheet
+    //
+    // The rules are kept in source order, and indexed by the most
+    // selective thing in each one; its id, else its first class,
+    // else its tag, else its first attribute name.  An element
+    // is then only tested against the rules in the buckets for
+    // its own id, class words, tag and attributes, plus the few
+    // that can't be bucketed, like '*'.
     //======================================================
     struct CSSStyleSheet
     {
-        using SelectorMap = std::unordered_map<ByteSpan, CSSSelector, ByteSpanHash, ByteSpanEquivalent>;
+        using RuleBucket = std::vector<uint32_t>;
+        using RuleIndex = std::unordered_map<InternedKey, RuleBucket, InternedKeyHash, InternedKeyEquivalent>;
+
+    private:
+        std::vector<CSSSelector> fRules{};
 
-        std::unordered_map<uint32_t, SelectorMap> selectors;
+        RuleIndex fById{};
+        RuleIndex fByClass{};
+        RuleIndex fByTag{};
+        RuleIndex fByAttribute{};
+        RuleBucket fUniversal{};
 
+        static void gatherBucket(const RuleIndex& index, InternedKey key, std::vector<uint32_t>& out)
+        {
+            if (!key)
+                return;
 
+            auto it = index.find(key);
+            if (it != index.end())
+                out.insert(out.end(), it->second.begin(), it->second.end());
+        }
+
+    public:
         CSSStyleSheet()
         {
             reset();
         }
 
-        //CSSStyleSheet(const waavs::ByteSpan& inSpan)
-        //{
-        //    reset();
-        //    loadFromSpan(inSpan);
-        //}
-        
-
         void reset()
         {
-            selectors.clear();
+            fRules.clear();
+            fById.clear();
+            fByClass.clear();
+            fByTag.clear();
+            fByAttribute.clear();
+            fUniversal.clear();
         }
 
-		SelectorMap & getSelectorMap(uint32_t kind)
-		{
-			auto it = selectors.find(kind);
-            if (it != selectors.end())
-            {
-                return it->second;
-            }
-
-            selectors[kind] = {};
-			return selectors[kind];
-		}
+        bool empty() const noexcept { return fRules.empty(); }
+        size_t size() const noexcept { return fRules.size(); }
+        const std::vector<CSSSelector>& rules() const noexcept { return fRules; }
 
-        CSSSelector* getSelector(CSSSelectorKind kind, const ByteSpan& name)
+        // Add a selector to the style sheet, and index it by
+        // the most selective op in its program.
+        void addSelector(const CSSSelectorInfo& info)
         {
-            auto& aMap = getSelectorMap(kind);
+            if (info.empty())
+                return;
 
-            auto selIt = aMap.find(name);
-            if (selIt != aMap.end())
-                return &selIt->second;
+            CSSSelector sel(info, uint32_t(fRules.size()));
+            if (!sel.compiled())
+                return;
 
-            return nullptr;
+            addCompiled(std::move(sel));
         }
 
- 
+        // appendSheet()
+        //
+        // Add the rules of another sheet after the ones already
+        // here, as if they had been loaded into this one.
+        void appendSheet(const CSSStyleSheet& other)
+        {
+            for (const CSSSelector& sel : other.fRules)
+                addCompiled(CSSSelector(sel));
+        }
 
-        // Add a selector to the style sheet
-        // based on the info.name(), put the selector into
-        // the proper selector category
-        void addSelector(const CSSSelectorInfo& info)
+    private:
+        void addCompiled(CSSSelector&& sel)
         {
-            if (info.empty())
-                return;
+            const uint32_t ruleIndex = uint32_t(fRules.size());
+            sel.setOrder(ruleIndex);
+
+            const CSSMatchOp* byId = nullptr;
+            const CSSMatchOp* byClass = nullptr;
+            const CSSMatchOp* byTag = nullptr;
+            const CSSMatchOp* byAttr = nullptr;
 
-            // Determine predicate dynamically
-            std::function<bool(const XmlElement&)> predicate;
-            switch (info.kind())
+            for (const CSSMatchOp& op : sel.program())
             {
-            case CSS_SELECTOR_ID:
-                predicate = [info](const XmlElement& elem) {
-                    ByteSpan idValue;
-                    return elem.getElementAttribute("id", idValue) && idValue == info.name();
-                    };
-                break;
+                switch (op.fCode)
+                {
+                case CSS_MATCH_ID: if (!byId) byId = &op; break;
+                case CSS_MATCH_CLASS: if (!byClass) byClass = &op; break;
+                case CSS_MATCH_TAG: if (!byTag) byTag = &op; break;
+                default: if (!byAttr) byAttr = &op; break;
+                }
+            }
 
-            case CSS_SELECTOR_CLASS:
-                predicate = [info](const XmlElement& elem) {
-                    ByteSpan classValue{};
-                    ByteSpan nameValue{};
-                    return elem.getElementAttribute("class", classValue) && chunk_find(classValue,info.name(), nameValue);
-                    };
-                break;
+            if (byId)
+                fById[byId->fKey].push_back(ruleIndex);
+            else if (byClass)
+                fByClass[byClass->fKey].push_back(ruleIndex);
+            else if (byTag)
+                fByTag[byTag->fKey].push_back(ruleIndex);
+            else if (byAttr)
+                fByAttribute[byAttr->fKey].push_back(ruleIndex);
+            else
+                fUniversal.push_back(ruleIndex);
 
-            case CSS_SELECTOR_ELEMENT:
-                predicate = [info](const XmlElement& elem) {
-                    return info.name() == elem.nameAtom();
-                    };
-                break;
+            fRules.push_back(std::move(sel));
+        }
 
-            case CSS_SELECTOR_ATTRIBUTE:
-                predicate = [info](const XmlElement& elem) {
-                    ByteSpan attrValue;
-                    return elem.getElementAttribute(info.name(), attrValue);
-                    };
-                break;
+    public:
+        // collectMatches()
+        //
+        // Find the rules that apply to an element, in the order
+        // they should be merged; lowest specificity first, and
+        // source order within the same specificity, so later
+        // rules win.  Only reads the sheet, so can be called
+        // from several threads at once.
+        //
+        // The candidate list is scratch space kept by each thread,
+        // so matching an element doesn't allocate once it's grown.
+        //
+        // Returns the number of matches found.
+        size_t collectMatches(const CSSMatchSubject& subject, std::vector<const CSSSelector*>& out) const
+        {
+            out.clear();
 
-            default:
-                return;
-            }
+            if (fRules.empty())
+                return 0;
 
-            // Construct selector with the predicate
-            CSSSelector newSelector(info.kind(), info.name(), info.data(), predicate);
+            static thread_local std::vector<uint32_t> candidates{};
+            candidates.assign(fUniversal.begin(), fUniversal.end());
 
-            //selectors[info.kind()][info.name()] = newSelector;
+            if (subject.fId && !fById.empty())
+                gatherBucket(fById, PSNameScope::LOOKUP(subject.fId), candidates);
 
-            // Get correct selector map and add/merge
-            auto& selectorMap = getSelectorMap(info.kind());
-            auto it = selectorMap.find(info.name());
-            if (it != selectorMap.end())
+            if (subject.fClasses && !fByClass.empty())
             {
-                it->second.mergeProperties(newSelector);
+                ByteSpan s = subject.fClasses;
+                while (s)
+                {
+                    ByteSpan word = chunk_token(s, chrWspChars);
+                    if (word)
+                        gatherBucket(fByClass, PSNameScope::LOOKUP(word), candidates);
+                }
             }
-            else
+
+            if (!fByTag.empty())
+                gatherBucket(fByTag, subject.fTag, candidates);
+
+            if (!fByAttribute.empty())
             {
-                selectorMap.emplace(info.name(), std::move(newSelector));
+                if (subject.fId)
+                    gatherBucket(fByAttribute, svgattr::id(), candidates);
+                if (subject.fClasses)
+                    gatherBucket(fByAttribute, svgattr::klass(), candidates);
+                if (subject.fAttributes)
+                {
+                    for (const auto& attr : subject.fAttributes->values())
+                        gatherBucket(fByAttribute, attr.first, candidates);
+                }
             }
+
+            if (candidates.empty())
+                return 0;
+
+            // A class that's repeated on the element gathers its rules twice
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+            for (uint32_t idx : candidates)
+            {
+                const CSSSelector& sel = fRules[idx];
+                if (sel.matches(subject))
+                    out.push_back(&sel);
+            }
+
+            // candidates were in source order, so a stable sort keeps it
+            std::stable_sort(out.begin(), out.end(), [](const CSSSelector* a, const CSSSelector* b) {
+                return a->specificity() < b->specificity();
+                });
+
+            return out.size();
         }
 
+        // Merge the properties of every matching rule into 'attrs',
+        // in increasing order of precedence.
+        size_t applyMatches(const CSSMatchSubject& subject, XmlAttributeCollection& attrs) const
+        {
+            if (fRules.empty())
+                return 0;
+
+            static thread_local std::vector<const CSSSelector*> matched{};
+            collectMatches(subject, matched);
 
+            for (const CSSSelector* sel : matched)
+                attrs.mergeAttributes(sel->attributes());
+
+            return matched.size();
+        }
 
         bool loadFromSpan(const ByteSpan& inSpan)
         {
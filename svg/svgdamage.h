@@ -0,0 +1,156 @@
+#pragma once
+
+//
+// SVGDamageRegion
+//
+// The parts of a canvas that need to be drawn again, in device pixels.
+// When a few small things change on a large, otherwise static canvas,
+// only the area they covered before, and the area they cover now,
+// need to be redrawn.
+//
+// The region is kept as a short list of rectangles.  Rectangles that
+// overlap are merged, and when there are too many, they're all merged
+// into one.  A region can also be 'full', when there's no telling what
+// changed, and everything needs to be drawn again.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "wggeometry.h"
+
+
+namespace waavs
+{
+    struct SVGDamageRegion
+    {
+        static constexpr size_t kMaxRects = 16;
+
+        std::vector<WGRectD> fRects{};
+        bool fFull{ false };
+
+    private:
+        static bool overlaps(const WGRectD& a, const WGRectD& b) noexcept
+        {
+            return (a.x <= b.x + b.w) && (b.x <= a.x + a.w) &&
+                (a.y <= b.y + b.h) && (b.y <= a.y + a.h);
+        }
+
+        static bool encloses(const WGRectD& a, const WGRectD& b) noexcept
+        {
+            return (b.x >= a.x) && (b.y >= a.y) &&
+                (b.x + b.w <= a.x + a.w) && (b.y + b.h <= a.y + a.h);
+        }
+
+    public:
+        bool empty() const noexcept { return !fFull && fRects.empty(); }
+        bool isFull() const noexcept { return fFull; }
+        const std::vector<WGRectD>& rects() const noexcept { return fRects; }
+
+        void clear() noexcept
+        {
+            fRects.clear();
+            fFull = false;
+        }
+
+        void markFull() noexcept
+        {
+            fRects.clear();
+            fFull = true;
+        }
+
+        // add()
+        //
+        // Add a rectangle, merging it with any it overlaps
+        void add(const WGRectD& r)
+        {
+            if (fFull || !(r.w > 0.0) || !(r.h > 0.0))
+                return;
+
+            WGRectD merged = r;
+
+            // Merging can make the rectangle overlap ones it didn't
+            // before, so keep going until nothing changes
+            bool changed = true;
+            while (changed)
+            {
+                changed = false;
+                for (size_t i = 0; i < fRects.size(); i++)
+                {
+                    if (!overlaps(fRects[i], merged))
+                        continue;
+
+                    merged = wg_rectd_merge_rect(merged, fRects[i]);
+                    fRects[i] = fRects.back();
+                    fRects.pop_back();
+                    changed = true;
+                    break;
+                }
+            }
+
+            fRects.push_back(merged);
+
+            if (fRects.size() > kMaxRects)
+            {
+                WGRectD all = fRects[0];
+                for (size_t i = 1; i < fRects.size(); i++)
+                    all = wg_rectd_merge_rect(all, fRects[i]);
+
+                fRects.clear();
+                fRects.push_back(all);
+            }
+        }
+
+        void add(const SVGDamageRegion& other)
+        {
+            if (other.fFull)
+            {
+                markFull();
+                return;
+            }
+
+            for (const auto& r : other.fRects)
+                add(r);
+        }
+
+        // covers()
+        //
+        // Whether all of 'r' is already within the region
+        bool covers(const WGRectD& r) const noexcept
+        {
+            if (fFull)
+                return true;
+
+            for (const auto& d : fRects)
+            {
+                if (encloses(d, r))
+                    return true;
+            }
+
+            return false;
+        }
+
+        // pixelRect()
+        //
+        // A damaged rectangle, as whole pixels, with a pixel of slack
+        // for antialiasing, limited to a width x height canvas.
+        // False if none of it lands on the canvas.
+        static bool pixelRect(const WGRectD& r, int width, int height, WGRectI& out) noexcept
+        {
+            const double w = double(width);
+            const double h = double(height);
+
+            const int x0 = (int)std::clamp(std::floor(r.x) - 1.0, 0.0, w);
+            const int y0 = (int)std::clamp(std::floor(r.y) - 1.0, 0.0, h);
+            const int x1 = (int)std::clamp(std::ceil(r.x + r.w) + 1.0, 0.0, w);
+            const int y1 = (int)std::clamp(std::ceil(r.y + r.h) + 1.0, 0.0, h);
+
+            if (x1 <= x0 || y1 <= y0)
+                return false;
+
+            out = WGRectI{ x0, y0, x1 - x0, y1 - y0 };
+            return true;
+        }
+    };
+}
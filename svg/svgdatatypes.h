@@ -17,6 +17,7 @@
 #include "svgunits.h"
 #include "xmlscan.h"
 #include "wggeometry.h"
+#include "svgvaluememo.h"
 
 //
 // Parsing routines for the core SVG data types
@@ -1199,14 +1200,40 @@ namespace waavs {
         if (styleChunk.empty())
             return false;
 
+        // The same style string is usually repeated many times, 
+        // so it's split once, and the declarations reused
+        SVGValueMemo* memo = SVGValueMemo::current();
+        if (memo == nullptr)
+        {
+            ByteSpan name{};
+            ByteSpan value{};
+            while (readNextCSSKeyValue(styleChunk, name, value))
+            {
+                styleAttributes.addValueBySpan(name, value);
+            }
+
+            return true;
+        }
 
-        ByteSpan name{};
-        ByteSpan value{};
-        while (readNextCSSKeyValue(styleChunk, name, value))
+        std::shared_ptr<const SVGStyleDeclarations> decls{};
+        if (!memo->fStyles.find(styleChunk, decls))
         {
-            styleAttributes.addValueBySpan(name, value);
+            auto parsed = std::make_shared<SVGStyleDeclarations>();
+
+            ByteSpan s = styleChunk;
+            ByteSpan name{};
+            ByteSpan value{};
+            while (readNextCSSKeyValue(s, name, value))
+            {
+                parsed->emplace_back(PSNameScope::INTERN(name), value);
+            }
+
+            decls = parsed;
+            memo->fStyles.insert(styleChunk, decls);
         }
 
+        for (const auto& decl : *decls)
+            styleAttributes.addValue(decl.first, decl.second);
 
         return true;
     }
@@ -1426,7 +1453,7 @@ namespace waavs
     // into a single BLMatrix2D structure
     // This will repeatedly apply the portions that are parsed
     //
-    static bool parseTransform(const ByteSpan& inChunk, WGMatrix3x3& xform)
+    static bool parseTransformList(const ByteSpan& inChunk, WGMatrix3x3& xform)
     {        
         ByteSpan s = inChunk;
         s = bspan_skip_spaces(s);
@@ -1487,6 +1514,27 @@ namespace waavs
 
         return isSet;
     }
+
+    // parseTransform()
+    //
+    // parseTransformList(), by way of the current value memo,
+    // since exports repeat the same transforms a lot.
+    static bool parseTransform(const ByteSpan& inChunk, WGMatrix3x3& xform)
+    {
+        SVGValueMemo* memo = SVGValueMemo::current();
+        if (memo == nullptr)
+            return parseTransformList(inChunk, xform);
+
+        if (memo->fTransforms.find(inChunk, xform))
+            return true;
+
+        if (!parseTransformList(inChunk, xform))
+            return false;
+
+        memo->fTransforms.insert(inChunk, xform);
+
+        return true;
+    }
 }
 
 
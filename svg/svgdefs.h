@@ -16,7 +16,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("defs", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGDefsNode>();
+                auto node = makeNode<SVGDefsNode>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -28,7 +28,7 @@ namespace waavs
         {
             registerContainerNodeByName(svgtag::tag_defs(),
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGDefsNode>();
+                    auto node = makeNode<SVGDefsNode>();
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -0,0 +1,1125 @@
+#pragma once
+
+//
+// Display lists
+//
+// Drawing a document walks the whole tree, resolves paint servers,
+// and rebuilds geometry, every time.  When the same document is drawn
+// again, at another size, or in the next frame, all of that work comes
+// out the same.
+//
+// The SVGRecordingDriver is an IRenderSVG that doesn't draw anything.
+// It writes down what it's asked to do, with all the values already
+// resolved: transforms, state changes, paths, paints, images, text.
+// When it's done, what's left is an SVGDisplayList, which can be
+// replayed onto any other IRenderSVG, an SVGB2DDriver typically,
+// without going anywhere near the document.
+//
+// Things to know:
+//  - A display list doesn't change once it's been recorded, so any
+//    number of threads can replay the same list at once, each onto
+//    its own driver.
+//  - Replay takes a base transform, which maps the canvas the list
+//    was recorded on to the target.  Paths, paints and text stay
+//    vectors, so they're sharp at any scale.
+//  - Plain opacity is kept as a group, which is rendered and
+//    composited at replay time, so it too works at any scale.
+//  - Filters, masks and clip paths that need drawing offscreen are
+//    kept as effects.  An effect holds the filter program, and the
+//    ranges of the list for the content, the masks and clips, and
+//    what feImage refers to.  It's all drawn offscreen, and the
+//    filter run, at replay time, at the resolution of the target.
+//    Pattern tiles are paints, and are whatever the document made.
+//  - Each element's commands are kept as a cull range, with where
+//    the element drew.  A range that doesn't reach the visible part
+//    of the target is skipped, so a tile only replays the containers,
+//    and shapes, that land on it.
+//  - Tiles of one canvas can share an SVGEffectCache, so a filter
+//    that spans several tiles is only run once.
+//  - Paths, paints, fonts and images are reference counted, so the
+//    list shares them with the document rather than copying.  Images
+//    the document only lends out are copied, so the list can outlive
+//    the document.
+//  - Clearing the canvas is left to whoever does the replay.
+//
+
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "svgb2ddriver.h"
+#include "svgdocument.h"
+
+
+namespace waavs
+{
+    enum SVGDisplayOpCode : uint16_t
+    {
+        SVG_DL_PUSH = 0,
+        SVG_DL_POP,
+
+        SVG_DL_TRANSFORM,               // fMatrices[fIndex], relative to the recording canvas
+        SVG_DL_APPLY_TRANSFORM,         // fMatrices[fIndex]
+        SVG_DL_SCALE,                   // fScalars[fIndex..+1]
+        SVG_DL_TRANSLATE,               // fScalars[fIndex..+1]
+        SVG_DL_ROTATE,                  // fScalars[fIndex..+2]
+
+        SVG_DL_STROKE_BEFORE_TRANSFORM, // fAux == bool
+        SVG_DL_BLEND_MODE,              // fAux == comp op
+        SVG_DL_GLOBAL_OPACITY,          // fScalars[fIndex]
+        SVG_DL_STROKE_CAP,              // fAux == start | (end << 8)
+        SVG_DL_STROKE_CAPS,             // fAux == cap
+        SVG_DL_STROKE_WIDTH,            // fScalars[fIndex]
+        SVG_DL_LINE_JOIN,               // fAux == join
+        SVG_DL_MITER_LIMIT,             // fScalars[fIndex]
+
+        SVG_DL_FILL_PAINT,              // fPaints[fIndex]
+        SVG_DL_NO_FILL,
+        SVG_DL_FILL_OPACITY,            // fScalars[fIndex]
+        SVG_DL_FILL_RULE,               // fAux == rule
+        SVG_DL_STROKE_PAINT,            // fPaints[fIndex]
+        SVG_DL_NO_STROKE,
+        SVG_DL_STROKE_OPACITY,          // fScalars[fIndex]
+
+        SVG_DL_CLIP_RECT,               // fScalars[fIndex..+3]
+        SVG_DL_NO_CLIP,
+
+        SVG_DL_FILL_PATH,               // fPaths[fIndex]
+        SVG_DL_STROKE_PATH,             // fPaths[fIndex]
+        SVG_DL_DRAW_PATH,               // fPaths[fIndex], fAux == paint order
+
+        SVG_DL_IMAGE,                   // fImages[fIndex]
+        SVG_DL_SCALE_IMAGE,             // fImages[fIndex]
+
+        SVG_DL_FILL_GLYPHS,             // fGlyphRuns[fIndex]
+        SVG_DL_STROKE_GLYPHS,           // fGlyphRuns[fIndex]
+
+        SVG_DL_FILL_TEXT,               // fTexts[fIndex]
+        SVG_DL_STROKE_TEXT,             // fTexts[fIndex]
+        SVG_DL_DRAW_TEXT,               // fTexts[fIndex], fAux == paint order
+
+        SVG_DL_BEGIN_GROUP,             // fGroups[fIndex]
+        SVG_DL_END_GROUP,
+
+        SVG_DL_BEGIN_EFFECT,            // fEffects[fIndex]
+        SVG_DL_END_EFFECT,
+
+        SVG_DL_BEGIN_CULL,              // fCulls[fIndex]
+        SVG_DL_END_CULL,
+    };
+
+    // A single command.  Whatever it needs beyond a small
+    // enum value is in one of the list's pools.
+    struct SVGDisplayOp
+    {
+        SVGDisplayOpCode fCode{ SVG_DL_PUSH };
+        uint16_t fAux{ 0 };
+        uint32_t fIndex{ 0 };
+    };
+
+    struct SVGDisplayImage
+    {
+        Surface fSurface{};
+        WGRectI fSrc{};                 // only for SVG_DL_SCALE_IMAGE
+        WGRectD fDst{};                 // for SVG_DL_IMAGE, only x and y
+    };
+
+    struct SVGDisplayGlyphRun
+    {
+        uint32_t fFont{ 0 };
+        uint32_t fFirstGlyph{ 0 };      // into fGlyphIds, and fPlacements
+        uint32_t fGlyphCount{ 0 };
+        uint8_t fPlacementType{ BL_GLYPH_PLACEMENT_TYPE_NONE };
+        uint32_t fFlags{ 0 };
+        double fX{ 0 }, fY{ 0 };
+    };
+
+    struct SVGDisplayText
+    {
+        uint32_t fFont{ 0 };
+        uint32_t fOffset{ 0 };          // into fText
+        uint32_t fSize{ 0 };
+        double fX{ 0 }, fY{ 0 };
+    };
+
+    struct SVGDisplayGroup
+    {
+        WGRectD fUserRect{};
+        double fOpacity{ 1.0 };
+        uint32_t fEnd{ 0 };             // index of the matching SVG_DL_END_GROUP
+    };
+
+    struct SVGDisplayEffectPart
+    {
+        SVGEffectPartKind fKind{ SVG_EFFECT_CONTENT };
+        WGMatrix3x3 fUnits{};          // into the element's user space
+        InternedKey fHref{};
+        uint32_t fFirst{ 0 };           // the part's commands are [fFirst, fLast)
+        uint32_t fLast{ 0 };
+    };
+
+    struct SVGDisplayEffect
+    {
+        SVGEffectDesc fDesc{};
+        std::vector<SVGDisplayEffectPart> fParts{};     // the content first
+        uint32_t fEnd{ 0 };             // index of the matching SVG_DL_END_EFFECT
+    };
+
+
+    struct SVGDisplayCull
+    {
+        WGRectD fUserBounds{};          // in the user space at SVG_DL_BEGIN_CULL
+        bool fHasBounds{ false };
+        uint32_t fEnd{ 0 };             // index of the matching SVG_DL_END_CULL
+    };
+
+
+    //
+    // SVGEffectCache
+    //
+    // A filter can reach across the whole of its region, so a tile
+    // can't run just its own part of it.  Drawn a tile at a time, a
+    // filter that spans several tiles would be run once for each.
+    // Tiles of the same canvas, replaying the same list through the
+    // same transform, can share a cache instead.  The first tile to
+    // get to a filtered effect runs it over the whole canvas, the
+    // others wait for that, and composite what it made.
+    //
+    // Filters that read the background are left out, since that's
+    // whatever each tile has drawn so far.
+    //
+    struct SVGEffectCache
+    {
+        struct Entry
+        {
+            std::mutex fLock{};
+            bool fDone{ false };
+            WGMatrix3x3 fCtm{};
+            Surface fResult{};
+            WGRectI fRect{};
+        };
+
+        explicit SVGEffectCache(const WGRectI& canvas) noexcept
+            : fCanvas(canvas) {}
+
+        SVGEffectCache(const SVGEffectCache&) = delete;
+        SVGEffectCache& operator=(const SVGEffectCache&) = delete;
+
+        // The canvas effects are run over, in the coordinates tiles draw in
+        const WGRectI& canvas() const noexcept { return fCanvas; }
+
+        // entry()
+        //
+        // The entry for effect 'index' of a list with 'count' effects.
+        // A cache only serves the first list it's used with.
+        Entry* entry(const void* list, size_t count, uint32_t index)
+        {
+            std::lock_guard<std::mutex> guard(fLock);
+
+            if (!fList)
+            {
+                fList = list;
+                fEntries.resize(count);
+            }
+
+            if (list != fList || index >= fEntries.size())
+                return nullptr;
+
+            if (!fEntries[index])
+                fEntries[index] = std::make_unique<Entry>();
+
+            return fEntries[index].get();
+        }
+
+    private:
+        std::mutex fLock{};
+        WGRectI fCanvas{};
+        const void* fList{ nullptr };
+        std::vector<std::unique_ptr<Entry>> fEntries{};
+    };
+
+
+    //
+    // SVGDisplayList
+    //
+    struct SVGDisplayList
+    {
+        double fWidth{ 0 };             // size of the recording canvas
+        double fHeight{ 0 };
+
+        std::vector<SVGDisplayOp> fOps{};
+
+        std::vector<double> fScalars{};
+        std::vector<WGMatrix3x3> fMatrices{};
+        std::vector<BLPath> fPaths{};
+        std::vector<BLVar> fPaints{};
+        std::vector<BLFont> fFonts{};
+        std::vector<SVGDisplayImage> fImages{};
+        std::vector<SVGDisplayGlyphRun> fGlyphRuns{};
+        std::vector<uint32_t> fGlyphIds{};
+        std::vector<BLGlyphPlacement> fPlacements{};
+        std::vector<SVGDisplayText> fTexts{};
+        std::vector<char> fText{};
+        std::vector<SVGDisplayGroup> fGroups{};
+        std::vector<SVGDisplayEffect> fEffects{};
+        std::vector<SVGDisplayCull> fCulls{};
+
+        // Filter programs, and feImage references, use names from the
+        // document's scope, which is kept for as long as the list
+        std::shared_ptr<const PSNameScope> fNames{};
+
+        bool empty() const noexcept { return fOps.empty(); }
+        size_t size() const noexcept { return fOps.size(); }
+
+        // replay()
+        //
+        // Draw the list onto 'ctx'.  'base' maps the recording canvas
+        // onto the target, and is set as the context's transform.  The
+        // context's state is saved and restored around the replay.
+        // 'effects' is shared by the tiles of one canvas, if given.
+        void replay(IRenderSVG& ctx, const WGMatrix3x3& base = WGMatrix3x3::makeIdentity(), SVGEffectCache* effects = nullptr) const
+        {
+            ctx.push();
+            ctx.transform(base);
+
+            replayRange(ctx, 0, fOps.size(), base, effects);
+
+            ctx.pop();
+        }
+
+    private:
+        // RangeSubtree
+        //
+        // A range of the list, drawn the way an element draws its
+        // content, so it can go through the same offscreen drawing,
+        // and filters, the document uses.  'fToBase' takes the
+        // transform it's drawn under to the base it's replayed with.
+        struct RangeSubtree
+        {
+            const SVGDisplayList* fList{ nullptr };
+            uint32_t fFirst{ 0 };
+            uint32_t fLast{ 0 };
+            WGMatrix3x3 fToBase{};
+
+            void drawContent(IRenderSVG* ctx, IAmGroot*)
+            {
+                WGMatrix3x3 b = fToBase;
+                b.postTransform(ctx->getTransform());
+
+                fList->replayRange(*ctx, fFirst, fLast, b);
+            }
+        };
+
+        // EffectReferences
+        //
+        // What an effect's feImage primitives refer to
+        struct EffectReferences : public IFilterReferenceSource
+        {
+            const SVGDisplayList* fList{ nullptr };
+            const SVGDisplayEffect* fEffect{ nullptr };
+
+            EffectReferences(const SVGDisplayList* list, const SVGDisplayEffect* effect) noexcept
+                : fList(list), fEffect(effect) {}
+
+            bool drawFilterReference(InternedKey href, IRenderSVG& ctx) noexcept override
+            {
+                for (const SVGDisplayEffectPart& part : fEffect->fParts)
+                {
+                    if (part.fKind == SVG_EFFECT_IMAGE && part.fHref == href)
+                    {
+                        fList->replayRange(ctx, part.fFirst, part.fLast, ctx.getTransform());
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+        };
+
+        void replayRange(IRenderSVG& ctx, size_t first, size_t last, const WGMatrix3x3& base, SVGEffectCache* effects = nullptr) const
+        {
+            for (size_t i = first; i < last; i++)
+            {
+                const SVGDisplayOp& op = fOps[i];
+                const double* s = (op.fIndex < fScalars.size()) ? fScalars.data() + op.fIndex : nullptr;
+
+                switch (op.fCode)
+                {
+                case SVG_DL_PUSH: ctx.push(); break;
+                case SVG_DL_POP: ctx.pop(); break;
+
+                case SVG_DL_TRANSFORM:
+                {
+                    // Recorded relative to the recording canvas
+                    WGMatrix3x3 m = fMatrices[op.fIndex];
+                    m.postTransform(base);
+                    ctx.transform(m);
+                } break;
+
+                case SVG_DL_APPLY_TRANSFORM: ctx.applyTransform(fMatrices[op.fIndex]); break;
+                case SVG_DL_SCALE: ctx.scale(s[0], s[1]); break;
+                case SVG_DL_TRANSLATE: ctx.translate(s[0], s[1]); break;
+                case SVG_DL_ROTATE: ctx.rotate(s[0], s[1], s[2]); break;
+
+                case SVG_DL_STROKE_BEFORE_TRANSFORM: ctx.strokeBeforeTransform(op.fAux != 0); break;
+                case SVG_DL_BLEND_MODE: ctx.blendMode(int(op.fAux)); break;
+                case SVG_DL_GLOBAL_OPACITY: ctx.globalOpacity(s[0]); break;
+                case SVG_DL_STROKE_CAP:
+                    ctx.strokeCap(BLStrokeCap(op.fAux & 0xff), BL_STROKE_CAP_POSITION_START);
+                    ctx.strokeCap(BLStrokeCap(op.fAux >> 8), BL_STROKE_CAP_POSITION_END);
+                    break;
+                case SVG_DL_STROKE_CAPS: ctx.strokeCaps(BLStrokeCap(op.fAux)); break;
+                case SVG_DL_STROKE_WIDTH: ctx.strokeWidth(s[0]); break;
+                case SVG_DL_LINE_JOIN: ctx.lineJoin(BLStrokeJoin(op.fAux)); break;
+                case SVG_DL_MITER_LIMIT: ctx.strokeMiterLimit(s[0]); break;
+
+                case SVG_DL_FILL_PAINT: ctx.fill(fPaints[op.fIndex]); break;
+                case SVG_DL_NO_FILL: ctx.noFill(); break;
+                case SVG_DL_FILL_OPACITY: ctx.fillOpacity(s[0]); break;
+                case SVG_DL_FILL_RULE: ctx.fillRule(BLFillRule(op.fAux)); break;
+                case SVG_DL_STROKE_PAINT: ctx.stroke(fPaints[op.fIndex]); break;
+                case SVG_DL_NO_STROKE: ctx.noStroke(); break;
+                case SVG_DL_STROKE_OPACITY: ctx.strokeOpacity(s[0]); break;
+
+                case SVG_DL_CLIP_RECT: ctx.clipRect(WGRectD{ s[0], s[1], s[2], s[3] }); break;
+                case SVG_DL_NO_CLIP: ctx.noClip(); break;
+
+                case SVG_DL_FILL_PATH: ctx.fillShape(fPaths[op.fIndex]); break;
+                case SVG_DL_STROKE_PATH: ctx.strokeShape(fPaths[op.fIndex]); break;
+                case SVG_DL_DRAW_PATH:
+                    ctx.setPaintOrder(op.fAux);
+                    ctx.drawShape(fPaths[op.fIndex]);
+                    break;
+
+                case SVG_DL_IMAGE:
+                {
+                    const SVGDisplayImage& img = fImages[op.fIndex];
+                    ctx.image(img.fSurface, img.fDst.x, img.fDst.y);
+                } break;
+
+                case SVG_DL_SCALE_IMAGE:
+                {
+                    const SVGDisplayImage& img = fImages[op.fIndex];
+                    ctx.scaleImage(img.fSurface, img.fSrc.x, img.fSrc.y, img.fSrc.w, img.fSrc.h,
+                        img.fDst.x, img.fDst.y, img.fDst.w, img.fDst.h);
+                } break;
+
+                case SVG_DL_FILL_GLYPHS:
+                case SVG_DL_STROKE_GLYPHS:
+                {
+                    const SVGDisplayGlyphRun& g = fGlyphRuns[op.fIndex];
+
+                    BLGlyphRun run{};
+                    run.glyph_data = (void*)(fGlyphIds.data() + g.fFirstGlyph);
+                    run.placement_data = (g.fPlacementType != BL_GLYPH_PLACEMENT_TYPE_NONE) ? (void*)(fPlacements.data() + g.fFirstGlyph) : nullptr;
+                    run.size = g.fGlyphCount;
+                    run.placement_type = g.fPlacementType;
+                    run.glyph_advance = int8_t(sizeof(uint32_t));
+                    run.placement_advance = int8_t(sizeof(BLGlyphPlacement));
+                    run.flags = g.fFlags;
+
+                    if (op.fCode == SVG_DL_FILL_GLYPHS)
+                        ctx.fillGlyphRun(fFonts[g.fFont], run, g.fX, g.fY);
+                    else
+                        ctx.strokeGlyphRun(fFonts[g.fFont], run, g.fX, g.fY);
+                } break;
+
+                case SVG_DL_FILL_TEXT:
+                case SVG_DL_STROKE_TEXT:
+                case SVG_DL_DRAW_TEXT:
+                {
+                    const SVGDisplayText& t = fTexts[op.fIndex];
+                    const ByteSpan txt((const uint8_t*)fText.data() + t.fOffset, t.fSize);
+
+                    BLFont font = fFonts[t.fFont];
+                    ctx.setFont(font);
+
+                    if (op.fCode == SVG_DL_FILL_TEXT)
+                        ctx.fillText(txt, t.fX, t.fY);
+                    else if (op.fCode == SVG_DL_STROKE_TEXT)
+                        ctx.strokeText(txt, t.fX, t.fY);
+                    else {
+                        ctx.setPaintOrder(op.fAux);
+                        ctx.drawText(txt, t.fX, t.fY);
+                    }
+                } break;
+
+                case SVG_DL_BEGIN_GROUP:
+                {
+                    const SVGDisplayGroup& g = fGroups[op.fIndex];
+                    replayGroup(ctx, g, i + 1, base);
+                    i = g.fEnd;
+                } break;
+
+                case SVG_DL_BEGIN_EFFECT:
+                {
+                    const SVGDisplayEffect& e = fEffects[op.fIndex];
+                    if (effects)
+                        replayCachedEffect(ctx, op.fIndex, e, base, *effects);
+                    else
+                        replayEffect(ctx, e, base);
+                    i = e.fEnd;
+                } break;
+
+                case SVG_DL_BEGIN_CULL:
+                {
+                    const SVGDisplayCull& c = fCulls[op.fIndex];
+                    if (c.fHasBounds && SVGGraphicsElement::isOutsideVisibleRect(&ctx, c.fUserBounds))
+                        i = c.fEnd;
+                } break;
+
+                case SVG_DL_END_GROUP:
+                case SVG_DL_END_EFFECT:
+                case SVG_DL_END_CULL:
+                default:
+                    break;
+                }
+            }
+        }
+
+        // replayGroup()
+        //
+        // The same as the document does for an element with opacity;
+        // draw the content offscreen, covering the part of the group
+        // that lands on the target, then composite it.
+        void replayGroup(IRenderSVG& ctx, const SVGDisplayGroup& g, size_t first, const WGMatrix3x3& base) const
+        {
+            const WGMatrix3x3 ctm = ctx.getTransform();
+            WGRectD devRect = mapRectAABB(ctm, g.fUserRect);
+
+            WGRectI limit{};
+            if (ctx.getVisibleRect(limit)) {
+                devRect = intersection(devRect, WGRectD{ double(limit.x), double(limit.y), double(limit.w), double(limit.h) });
+            }
+
+            if (!(devRect.w > 0.0) || !(devRect.h > 0.0))
+                return;
+
+            const int x0 = (int)std::floor(devRect.x);
+            const int y0 = (int)std::floor(devRect.y);
+            const int x1 = (int)std::ceil(devRect.x + devRect.w);
+            const int y1 = (int)std::ceil(devRect.y + devRect.h);
+
+            Surface result(x1 - x0, y1 - y0);
+            if (result.empty())
+                return;
+
+            WGMatrix3x3 off = ctm;
+            off.postTranslate(-double(x0), -double(y0));
+
+            WGMatrix3x3 groupBase = base;
+            groupBase.postTranslate(-double(x0), -double(y0));
+
+            SVGB2DDriver tmp{};
+            tmp.attach(result, 1, ctx.getDrawingState());
+            tmp.clear();
+            tmp.transform(off);
+
+            replayRange(tmp, first, g.fEnd, groupBase);
+
+            tmp.detach();
+
+            ctx.push();
+            ctx.transform(WGMatrix3x3::makeIdentity());
+            ctx.blendMode(BL_COMP_OP_SRC_OVER);
+            ctx.globalOpacity(g.fOpacity);
+            ctx.image(result, double(x0), double(y0));
+            ctx.flush();
+            ctx.pop();
+        }
+
+        // renderEffect()
+        //
+        // The same as the document does for an element with a filter,
+        // a mask, or a clip path, at the context's current transform.
+        // The content is drawn offscreen, filtered, masked and clipped,
+        // into 'result', which goes at 'resultRect' on the target.
+        bool renderEffect(IRenderSVG& ctx, const SVGDisplayEffect& e, const WGMatrix3x3& base, Surface& result, WGRectI& resultRect) const
+        {
+            result = {};
+
+            if (e.fParts.empty() || e.fParts[0].fKind != SVG_EFFECT_CONTENT)
+                return false;
+
+            IsolatedRenderPlan plan{};
+            plan.objectBBoxUS = e.fDesc.fObjectBBox;
+            plan.effectRectUS = e.fDesc.fEffectRect;
+            plan.ctm = ctx.getTransform();
+            plan.invCtm = plan.ctm;
+            plan.hasFilter = e.fDesc.fFilter != nullptr;
+            plan.pool = ctx.surfacePool();
+
+            if (!plan.invCtm.invert())
+                return false;
+
+            if (!resolveIsolatedPixelRect(&ctx, plan))
+                return false;
+
+            // The content was recorded under the element's transform,
+            // which is where the context is now
+            const SVGDisplayEffectPart& content = e.fParts[0];
+
+            RangeSubtree source{ this, content.fFirst, content.fLast, base };
+            source.fToBase.postTransform(plan.invCtm);
+
+            if (plan.hasFilter) {
+                EffectReferences refs(this, &e);
+
+                WGRectI filteredRect = plan.pixelRect;
+
+                B2DFilterExecutor exec;
+                exec.setReferenceSource(&refs);
+                exec.applyFilterToSurface(
+                    &ctx,
+                    nullptr,
+                    &source,
+                    plan.objectBBoxUS,
+                    plan.effectRectUS,
+                    plan.pixelRect,
+                    *e.fDesc.fFilter,
+                    result,
+                    RF_Content,
+                    &filteredRect);
+
+                plan.pixelRect = filteredRect;
+            }
+            else {
+                IsolatedSubtreeRequest req{};
+                SVGDrawingState* ds = ctx.getDrawingState();
+                if (ds)
+                    req.drawingState = *ds;
+                req.userRect = plan.effectRectUS;
+                req.pixelRect = plan.pixelRect;
+                req.ctm = plan.ctm;
+                req.objectBBoxUS = plan.objectBBoxUS;
+                req.renderMode = RF_Content;
+                req.pool = plan.pool;
+
+                renderSubtreeToSurface(nullptr, &source, req, result);
+            }
+
+            if (result.empty())
+                return false;
+
+            // Masks and clips were recorded from an identity transform
+            for (const SVGDisplayEffectPart& part : e.fParts)
+            {
+                if (part.fKind != SVG_EFFECT_MASK_LUMINANCE && part.fKind != SVG_EFFECT_MASK_ALPHA && part.fKind != SVG_EFFECT_CLIP)
+                    continue;
+
+                RangeSubtree partSource{ this, part.fFirst, part.fLast, WGMatrix3x3::makeIdentity() };
+
+                IsolatedSubtreeRequest req{};
+                req.userRect = plan.effectRectUS;
+                req.pixelRect = plan.pixelRect;
+                req.ctm = part.fUnits;
+                req.ctm.postTransform(plan.ctm);
+                req.objectBBoxUS = plan.objectBBoxUS;
+                req.renderMode = RF_Content;
+                req.clear = true;
+                req.pool = plan.pool;
+
+                Surface partSurface{};
+                if (!renderSubtreeToSurface(nullptr, &partSource, req, partSurface))
+                    continue;
+
+                Surface_ARGB32 partView = partSurface.info();
+                Surface_ARGB32 resultView = result.info();
+
+                if (part.fKind == SVG_EFFECT_CLIP)
+                    wg_surface_clip(resultView, partView);
+                else
+                    wg_surface_mask(resultView, partView, (part.fKind == SVG_EFFECT_MASK_ALPHA) ? MASKTYPE_ALPHA : MASKTYPE_LUMINANCE);
+            }
+
+            resultRect = plan.pixelRect;
+            return true;
+        }
+
+        static void compositeEffect(IRenderSVG& ctx, const SVGDisplayEffect& e, const Surface& result, const WGRectI& resultRect)
+        {
+            ctx.push();
+            ctx.transform(WGMatrix3x3::makeIdentity());
+            ctx.blendMode(BL_COMP_OP_SRC_OVER);
+            ctx.globalOpacity(e.fDesc.fOpacity);
+            ctx.image(result, double(resultRect.x), double(resultRect.y));
+            ctx.flush();
+            ctx.pop();
+        }
+
+        void replayEffect(IRenderSVG& ctx, const SVGDisplayEffect& e, const WGMatrix3x3& base) const
+        {
+            Surface result{};
+            WGRectI resultRect{};
+
+            if (renderEffect(ctx, e, base, result, resultRect))
+                compositeEffect(ctx, e, result, resultRect);
+        }
+
+        // replayCachedEffect()
+        //
+        // As replayEffect(), with a filter run once for all the tiles
+        // sharing 'cache'.  The run is done over the whole canvas, and
+        // kept out of this session's surface pool, since its result
+        // outlives this tile.
+        void replayCachedEffect(IRenderSVG& ctx, uint32_t index, const SVGDisplayEffect& e, const WGMatrix3x3& base, SVGEffectCache& cache) const
+        {
+            if (!e.fDesc.fFilter || filterReadsBackground(*e.fDesc.fFilter))
+            {
+                replayEffect(ctx, e, base);
+                return;
+            }
+
+            SVGEffectCache::Entry* entry = cache.entry(this, fEffects.size(), index);
+            if (!entry)
+            {
+                replayEffect(ctx, e, base);
+                return;
+            }
+
+            const WGMatrix3x3 ctm = ctx.getTransform();
+
+            std::unique_lock<std::mutex> lock(entry->fLock);
+
+            if (!entry->fDone)
+            {
+                WGRectI tileRect{};
+                const bool hadCullRect = ctx.getCullRect(tileRect);
+                SurfacePool* pool = ctx.surfacePool();
+
+                ctx.setCullRect(cache.canvas());
+                ctx.setSurfacePool(nullptr);
+
+                if (!renderEffect(ctx, e, base, entry->fResult, entry->fRect))
+                    entry->fResult = {};
+
+                ctx.setSurfacePool(pool);
+                if (hadCullRect)
+                    ctx.setCullRect(tileRect);
+                else
+                    ctx.clearCullRect();
+
+                entry->fCtm = ctm;
+                entry->fDone = true;
+            }
+            else if (!entry->fCtm.equals(ctm))
+            {
+                // Not where it was cached, so not this canvas
+                lock.unlock();
+                replayEffect(ctx, e, base);
+                return;
+            }
+
+            if (!entry->fResult.empty())
+                compositeEffect(ctx, e, entry->fResult, entry->fRect);
+        }
+    };
+
+
+    //
+    // SVGRecordingDriver
+    //
+    // Records whatever is drawn to it into an SVGDisplayList
+    //
+    struct SVGRecordingDriver : public IRenderSVG
+    {
+        std::shared_ptr<SVGDisplayList> fList{ std::make_shared<SVGDisplayList>() };
+        std::vector<uint32_t> fOpenGroups{};
+        std::vector<uint32_t> fOpenEffects{};
+        std::vector<uint32_t> fOpenParts{};         // the effect each open part belongs to
+        std::vector<uint32_t> fOpenCulls{};
+
+    private:
+        void addOp(SVGDisplayOpCode code, uint32_t index = 0, uint16_t aux = 0)
+        {
+            fList->fOps.push_back(SVGDisplayOp{ code, aux, index });
+        }
+
+        uint32_t addScalars(std::initializer_list<double> values)
+        {
+            const uint32_t idx = uint32_t(fList->fScalars.size());
+            fList->fScalars.insert(fList->fScalars.end(), values);
+            return idx;
+        }
+
+        uint32_t addMatrix(const WGMatrix3x3& m)
+        {
+            fList->fMatrices.push_back(m);
+            return uint32_t(fList->fMatrices.size() - 1);
+        }
+
+        uint32_t addPath(const BLPath& path)
+        {
+            // Shapes usually fill, then stroke, the same path
+            auto& paths = fList->fPaths;
+            if (!paths.empty() && paths.back().size() == path.size() && paths.back().vertex_data() == path.vertex_data())
+                return uint32_t(paths.size() - 1);
+
+            paths.push_back(path);
+            return uint32_t(paths.size() - 1);
+        }
+
+        uint32_t addPaint(const BLVar& paint)
+        {
+            fList->fPaints.push_back(paint);
+            return uint32_t(fList->fPaints.size() - 1);
+        }
+
+        uint32_t addFont(const BLFont& font)
+        {
+            auto& fonts = fList->fFonts;
+            if (!fonts.empty() && fonts.back().equals(font))
+                return uint32_t(fonts.size() - 1);
+
+            fonts.push_back(font);
+            return uint32_t(fonts.size() - 1);
+        }
+
+        void addImage(SVGDisplayOpCode code, const Surface& surf, const WGRectI& src, const WGRectD& dst)
+        {
+            SVGDisplayImage img{};
+
+            // The list keeps its own reference to the pixels.  If the
+            // surface is only borrowing them, they're copied.
+            if (surf.isBorrowed())
+            {
+                if (!img.fSurface.reset(int32_t(surf.width()), int32_t(surf.height())))
+                    return;
+                img.fSurface.blit(surf, 0, 0);
+            }
+            else {
+                img.fSurface = surf;
+            }
+
+            img.fSrc = src;
+            img.fDst = dst;
+
+            fList->fImages.push_back(img);
+            addOp(code, uint32_t(fList->fImages.size() - 1));
+        }
+
+        void addGlyphRun(SVGDisplayOpCode code, const BLFont& font, const BLGlyphRun& run, double x, double y)
+        {
+            static_assert(sizeof(BLGlyphPlacement) == sizeof(BLPoint), "glyph placements are copied as 16 bytes");
+
+            SVGDisplayGlyphRun g{};
+            g.fFont = addFont(font);
+            g.fFirstGlyph = uint32_t(fList->fGlyphIds.size());
+            g.fGlyphCount = uint32_t(run.size);
+            g.fPlacementType = run.placement_data ? run.placement_type : uint8_t(BL_GLYPH_PLACEMENT_TYPE_NONE);
+            g.fFlags = run.flags;
+            g.fX = x;
+            g.fY = y;
+
+            const uint8_t* glyphs = (const uint8_t*)run.glyph_data;
+            const uint8_t* placements = (const uint8_t*)run.placement_data;
+
+            for (size_t i = 0; i < run.size; i++)
+            {
+                uint32_t gid{ 0 };
+                memcpy(&gid, glyphs + intptr_t(i) * run.glyph_advance, sizeof(gid));
+                fList->fGlyphIds.push_back(gid);
+
+                BLGlyphPlacement pl{};
+                if (placements)
+                    memcpy(&pl, placements + intptr_t(i) * run.placement_advance, sizeof(pl));
+                fList->fPlacements.push_back(pl);
+            }
+
+            fList->fGlyphRuns.push_back(g);
+            addOp(code, uint32_t(fList->fGlyphRuns.size() - 1));
+        }
+
+        void addText(SVGDisplayOpCode code, const ByteSpan& txt, double x, double y, uint16_t aux = 0)
+        {
+            SVGDisplayText t{};
+            t.fFont = addFont(getFont());
+            t.fOffset = uint32_t(fList->fText.size());
+            t.fSize = uint32_t(txt.size());
+            t.fX = x;
+            t.fY = y;
+
+            fList->fText.insert(fList->fText.end(), (const char*)txt.data(), (const char*)txt.data() + txt.size());
+
+            fList->fTexts.push_back(t);
+            addOp(code, uint32_t(fList->fTexts.size() - 1), aux);
+        }
+
+    public:
+        SVGRecordingDriver() = default;
+
+        // finish()
+        //
+        // Hand over what's been recorded, for a canvas of the given
+        // size, and the name scope of the document it came from.  The
+        // driver starts over with an empty list.
+        std::shared_ptr<const SVGDisplayList> finish(double width, double height,
+            std::shared_ptr<const PSNameScope> names = {})
+        {
+            // Close anything left open, so replay stays balanced
+            while (!fOpenParts.empty())
+                onEndEffectPart();
+            while (!fOpenEffects.empty())
+                onEndEffect();
+            while (!fOpenGroups.empty())
+                onEndGroup();
+            while (!fOpenCulls.empty())
+                onEndCullRange(WGRectD{}, false);
+
+            fList->fWidth = width;
+            fList->fHeight = height;
+            fList->fNames = std::move(names);
+
+            std::shared_ptr<const SVGDisplayList> result = std::move(fList);
+            fList = std::make_shared<SVGDisplayList>();
+
+            return result;
+        }
+
+        // When a full drawing state is copied in, it's recorded as
+        // the individual changes that make it up.
+        void onCopyDrawingState(const SVGDrawingState& state) override
+        {
+            addOp(SVG_DL_TRANSFORM, addMatrix(getTransform()));
+            addOp(SVG_DL_BLEND_MODE, 0, uint16_t(getCompositeMode()));
+            addOp(SVG_DL_FILL_RULE, 0, uint16_t(getFillRule()));
+            addOp(SVG_DL_STROKE_BEFORE_TRANSFORM, 0, getStrokeBeforeTransform() ? 1 : 0);
+            addOp(SVG_DL_STROKE_WIDTH, addScalars({ getStrokeWidth() }));
+            addOp(SVG_DL_MITER_LIMIT, addScalars({ getStrokeMiterLimit() }));
+            addOp(SVG_DL_LINE_JOIN, 0, uint16_t(getLineJoin()));
+            addOp(SVG_DL_STROKE_CAP, 0, uint16_t(startStrokeCap() | (getEndStrokeCap() << 8)));
+            addOp(SVG_DL_FILL_PAINT, addPaint(getFillPaint()));
+            addOp(SVG_DL_STROKE_PAINT, addPaint(getStrokePaint()));
+            addOp(SVG_DL_GLOBAL_OPACITY, addScalars({ getGlobalOpacity() }));
+            addOp(SVG_DL_FILL_OPACITY, addScalars({ getFillOpacity() }));
+            addOp(SVG_DL_STROKE_OPACITY, addScalars({ getStrokeOpacity() }));
+
+            addOp(SVG_DL_NO_CLIP);
+            const WGRectD cRect = getClipRect();
+            if ((cRect.w > 0) && (cRect.h > 0))
+                addOp(SVG_DL_CLIP_RECT, addScalars({ cRect.x, cRect.y, cRect.w, cRect.h }));
+        }
+
+        void onPush() override { addOp(SVG_DL_PUSH); }
+        void onPop() override { addOp(SVG_DL_POP); }
+
+        // Coordinate system transformation
+        // The state keeps track of the transform, the same way
+        // the Blend2D context would
+        void onTransform(const WGMatrix3x3& value) override
+        {
+            setTransform(value);
+            addOp(SVG_DL_TRANSFORM, addMatrix(value));
+        }
+
+        void onApplyTransform(const WGMatrix3x3& value) override
+        {
+            WGMatrix3x3 t = getTransform();
+            t.transform(value);
+            setTransform(t);
+
+            addOp(SVG_DL_APPLY_TRANSFORM, addMatrix(value));
+        }
+
+        void onScale(double x, double y) override
+        {
+            WGMatrix3x3 t = getTransform();
+            t.scale(x, y);
+            setTransform(t);
+
+            addOp(SVG_DL_SCALE, addScalars({ x, y }));
+        }
+
+        void onTranslate(double x, double y) override
+        {
+            WGMatrix3x3 t = getTransform();
+            t.translate(x, y);
+            setTransform(t);
+
+            addOp(SVG_DL_TRANSLATE, addScalars({ x, y }));
+        }
+
+        void onRotate(double angle, double cx, double cy) override
+        {
+            // matches SVGB2DDriver, which rotates about the origin
+            WGMatrix3x3 t = getTransform();
+            t.rotate(angle);
+            setTransform(t);
+
+            addOp(SVG_DL_ROTATE, addScalars({ angle, cx, cy }));
+        }
+
+        // Drawing attributes
+        void onStrokeBeforeTransform() override { addOp(SVG_DL_STROKE_BEFORE_TRANSFORM, 0, getStrokeBeforeTransform() ? 1 : 0); }
+        void onBlendMode(int mode) override { addOp(SVG_DL_BLEND_MODE, 0, uint16_t(mode)); }
+        void onGlobalOpacity(double alpha) override { addOp(SVG_DL_GLOBAL_OPACITY, addScalars({ alpha })); }
+        void onStrokeCap() override { addOp(SVG_DL_STROKE_CAP, 0, uint16_t(startStrokeCap() | (getEndStrokeCap() << 8))); }
+        void onStrokeCaps(BLStrokeCap caps) override { addOp(SVG_DL_STROKE_CAPS, 0, uint16_t(caps)); }
+        void onStrokeWidth(double width) override { addOp(SVG_DL_STROKE_WIDTH, addScalars({ width })); }
+        void onLineJoin() override { addOp(SVG_DL_LINE_JOIN, 0, uint16_t(getLineJoin())); }
+        void onStrokeMiterLimit() override { addOp(SVG_DL_MITER_LIMIT, addScalars({ getStrokeMiterLimit() })); }
+
+        void onFill() override { addOp(SVG_DL_FILL_PAINT, addPaint(getFillPaint())); }
+        void onNoFill() override { addOp(SVG_DL_NO_FILL); }
+        void onFillOpacity() override { addOp(SVG_DL_FILL_OPACITY, addScalars({ getFillOpacity() })); }
+        void onFillRule() override { addOp(SVG_DL_FILL_RULE, 0, uint16_t(getFillRule())); }
+        void onStroke() override { addOp(SVG_DL_STROKE_PAINT, addPaint(getStrokePaint())); }
+        void onNoStroke() override { addOp(SVG_DL_NO_STROKE); }
+        void onStrokeOpacity() override { addOp(SVG_DL_STROKE_OPACITY, addScalars({ getStrokeOpacity() })); }
+
+        // Clipping
+        void onClipRect() override
+        {
+            const WGRectD cRect = getClipRect();
+            addOp(SVG_DL_CLIP_RECT, addScalars({ cRect.x, cRect.y, cRect.w, cRect.h }));
+        }
+
+        void onNoClip() override { addOp(SVG_DL_NO_CLIP); }
+
+        // Isolation groups
+        bool onBeginGroup(const WGRectD& userRect, double opacity) override
+        {
+            SVGDisplayGroup g{};
+            g.fUserRect = userRect;
+            g.fOpacity = opacity;
+
+            fList->fGroups.push_back(g);
+            fOpenGroups.push_back(uint32_t(fList->fGroups.size() - 1));
+            addOp(SVG_DL_BEGIN_GROUP, uint32_t(fList->fGroups.size() - 1));
+
+            return true;
+        }
+
+        void onEndGroup() override
+        {
+            if (fOpenGroups.empty())
+                return;
+
+            fList->fGroups[fOpenGroups.back()].fEnd = uint32_t(fList->fOps.size());
+            fOpenGroups.pop_back();
+
+            addOp(SVG_DL_END_GROUP);
+        }
+
+        // Cull ranges
+        void onBeginCullRange() override
+        {
+            fList->fCulls.push_back(SVGDisplayCull{});
+            fOpenCulls.push_back(uint32_t(fList->fCulls.size() - 1));
+            addOp(SVG_DL_BEGIN_CULL, uint32_t(fList->fCulls.size() - 1));
+        }
+
+        void onEndCullRange(const WGRectD& userBounds, bool hasBounds) override
+        {
+            if (fOpenCulls.empty())
+                return;
+
+            SVGDisplayCull& c = fList->fCulls[fOpenCulls.back()];
+            c.fUserBounds = userBounds;
+            c.fHasBounds = hasBounds;
+            c.fEnd = uint32_t(fList->fOps.size());
+            fOpenCulls.pop_back();
+
+            addOp(SVG_DL_END_CULL);
+        }
+
+        // Effects
+        bool recordsEffects() const noexcept override { return true; }
+
+        void onBeginEffect(const SVGEffectDesc& desc) override
+        {
+            SVGDisplayEffect e{};
+            e.fDesc = desc;
+
+            fList->fEffects.push_back(std::move(e));
+            fOpenEffects.push_back(uint32_t(fList->fEffects.size() - 1));
+            addOp(SVG_DL_BEGIN_EFFECT, uint32_t(fList->fEffects.size() - 1));
+        }
+
+        void onBeginEffectPart(SVGEffectPartKind kind, const WGMatrix3x3& units, InternedKey href) override
+        {
+            if (fOpenEffects.empty())
+                return;
+
+            SVGDisplayEffectPart part{};
+            part.fKind = kind;
+            part.fUnits = units;
+            part.fHref = href;
+            part.fFirst = uint32_t(fList->fOps.size());
+            part.fLast = part.fFirst;
+
+            fList->fEffects[fOpenEffects.back()].fParts.push_back(part);
+            fOpenParts.push_back(fOpenEffects.back());
+        }
+
+        void onEndEffectPart() override
+        {
+            if (fOpenParts.empty())
+                return;
+
+            fList->fEffects[fOpenParts.back()].fParts.back().fLast = uint32_t(fList->fOps.size());
+            fOpenParts.pop_back();
+        }
+
+        void onEndEffect() override
+        {
+            if (fOpenEffects.empty())
+                return;
+
+            fList->fEffects[fOpenEffects.back()].fEnd = uint32_t(fList->fOps.size());
+            fOpenEffects.pop_back();
+
+            addOp(SVG_DL_END_EFFECT);
+        }
+
+        // Shapes
+        void onStrokeShape(const BLPath& apath) override { addOp(SVG_DL_STROKE_PATH, addPath(apath)); }
+        void onFillShape(const BLPath& apath) override { addOp(SVG_DL_FILL_PATH, addPath(apath)); }
+        void onDrawShape(const BLPath& apath) override { addOp(SVG_DL_DRAW_PATH, addPath(apath), uint16_t(getPaintOrder())); }
+
+        // Bitmaps
+        void onImage(const Surface& surf, double x, double y) override
+        {
+            if (!surf.data())
+                return;
+
+            addImage(SVG_DL_IMAGE, surf, surf.boundsI(), WGRectD{ x, y, 0, 0 });
+        }
+
+        void onScaleImage(const Surface& surf,
+            int srcX, int srcY, int srcWidth, int srcHeight,
+            double dstX, double dstY, double dstWidth, double dstHeight) override
+        {
+            if (!surf.data())
+                return;
+
+            addImage(SVG_DL_SCALE_IMAGE, surf, WGRectI{ srcX, srcY, srcWidth, srcHeight }, WGRectD{ dstX, dstY, dstWidth, dstHeight });
+        }
+
+        // Text
+        void onFillGlyphRun(const BLFont& font, const BLGlyphRun& run, double x, double y) override { addGlyphRun(SVG_DL_FILL_GLYPHS, font, run, x, y); }
+        void onStrokeGlyphRun(const BLFont& font, const BLGlyphRun& run, double x, double y) override { addGlyphRun(SVG_DL_STROKE_GLYPHS, font, run, x, y); }
+
+        void onFillText(const ByteSpan& txt, double x, double y) override { addText(SVG_DL_FILL_TEXT, txt, x, y); }
+        void onStrokeText(const ByteSpan& txt, double x, double y) override { addText(SVG_DL_STROKE_TEXT, txt, x, y); }
+        void onDrawText(const ByteSpan& txt, double x, double y) override { addText(SVG_DL_DRAW_TEXT, txt, x, y, uint16_t(getPaintOrder())); }
+    };
+
+
+    // recordDocument()
+    //
+    // Draw a document once, into a display list, at the
+    // document's own canvas size.
+    static INLINE std::shared_ptr<const SVGDisplayList> recordDocument(SVGDocument& doc)
+    {
+        SVGRecordingDriver rec{};
+        rec.renew();
+
+        doc.draw(&rec, &doc);
+
+        return rec.finish(doc.canvasWidth(), doc.canvasHeight(), doc.sharedNameScope());
+    }
+}
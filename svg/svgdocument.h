@@ -59,11 +59,37 @@
 
 #include "svguse.h"
 
+#include "svgsubtreeloader.h"
+#include "svgbinary.h"
+#include "svgdamage.h"
+
 
 
 
 namespace waavs 
 {
+    // SVGDocumentStorage
+    //
+    // What a document's nodes are made of, and named with.  The
+    // document derives from this first, so it's torn down last, 
+    // after every node the document holds.
+    struct SVGDocumentStorage
+    {
+        // Names interned while loading this document, that aren't
+        // already known globally.  Attribute and element names, filter
+        // result names, and the like.  They go away with the document,
+        // instead of piling up in the global name table.
+        // The node arena holds a share as well.
+        std::shared_ptr<PSNameScope> fNames{ std::make_shared<PSNameScope>() };
+
+        // The nodes, and their properties, created while loading
+        // this document are allocated from this arena.  Each node
+        // holds a share of it, so a node kept after the document
+        // still has its memory.
+        std::shared_ptr<NodeArena> fNodeArena{ std::make_shared<NodeArena>(fNames) };
+    };
+
+
     // SVGDocument
     // 
     // This is the structure that represents an entire SVG file/document
@@ -86,13 +112,52 @@ namespace waavs
     // the initial source memory is copied into a MemBuff that is held
     // onto for the life of the document.
     //
-    struct SVGDocument : public  SVGGraphicsElement, public IAmGroot 
+    // When the source is already in memory that will stay put, such as
+    // a mapped file, the copy can be avoided, either by handing the document
+    // shared ownership of that memory (createFromSharedChunk), or by
+    // promising it will outlive the document (createFromBorrowedChunk).
+    //
+    // Any of these will also take a precompiled (.svgb) image, as
+    // written by writeBinaryImage(), in place of the SVG text.
+    //
+    // The nodes are allocated from the document's own arena, so
+    // none of them may be held past the life of the document.
+    //
+    struct SVGDocument : public SVGDocumentStorage, public  SVGGraphicsElement, public IAmGroot 
     {
         // create a memBuff from srcChunk
         // since we use memory references, we need
         // to keep the memory around for the duration of the 
         // document's life
         MemBuff fSourceMem{};
+
+        // When the source memory isn't copied, this keeps it alive
+        // if the document was given a share of it
+        std::shared_ptr<const void> fSourceOwner{};
+
+        // The memory all the document's spans refer to
+        ByteSpan fSource{};
+
+        // When loaded from a precompiled (.svgb) image, the view
+        // of that image, which fSource is a part of
+        SVGBImage fBinary{};
+
+        // Parsed style, transform and color values, by their text,
+        // so values repeated throughout the document parse once
+        SVGValueMemo fValueMemo{};
+
+        // Parallel loading
+        // With more than one load thread, the larger subtrees under the
+        // root <svg> are built concurrently before the main load pass,
+        // which then picks them up in document order.  Off unless asked
+        // for, with setLoadThreads(), or the loadThreads of the create 
+        // functions.
+        static constexpr size_t kMinParallelSubtreeSize = 16 * 1024;
+
+        size_t fLoadThreads{ 1 };
+        std::vector<SVGPrebuiltSubtree> fPrebuilt{};
+        size_t fNextPrebuilt{ 0 };
+        bool fDocTypeLoaded{ false };
                 
         // BUGBUG - this should go away
         // Although there can be multiple <svg> elements in a document
@@ -115,6 +180,10 @@ namespace waavs
         double fDocumentHeight{};
         
         WGRectD fPortalFrame{};  // used to set viewport and objectframe before drawing
+
+        // What's been reported as damaged, by elements that changed,
+        // since a view last took it
+        SVGDamageRegion fDamage{};
         
         //==========================================
         // Construction / Destruction
@@ -154,6 +223,33 @@ namespace waavs
         double canvasWidth() const override { return fCanvasWidth; }
         double canvasHeight() const override { return fCanvasHeight; }
         void setCanvasSize(const double w, const double h) noexcept { fCanvasWidth = w; fCanvasHeight = h; }
+
+        void addDamage(const WGRectD& r) override { fDamage.add(r); }
+        void addFullDamage() override { fDamage.markFull(); }
+
+        // takeDamage()
+        //
+        // Hand over what's been damaged since the last time, and 
+        // start over.
+        void takeDamage(SVGDamageRegion& out)
+        {
+            out = std::move(fDamage);
+            fDamage.clear();
+        }
+
+        // The document itself is never drawn where it could be noted, 
+        // so when something changed, and its ancestors couldn't say 
+        // where, that's the whole thing.
+        void update(IAmGroot* groot) override
+        {
+            PSNameScopeGuard nameGuard(fNames.get());
+            SVGValueMemoGuard memoGuard(&fValueMemo);
+
+            SVGGraphicsElement::update(groot);
+
+            if (fChangeUnplaced)
+                fDamage.markFull();
+        }
         
         const WGRectD viewPort() const noexcept
         {
@@ -188,6 +284,28 @@ namespace waavs
 
         const CSSStyleSheet& styleSheet() const override { return fStyleSheet; }
         CSSStyleSheet& styleSheet() override { return fStyleSheet; }
+
+        // The document's own interned names
+        PSNameScope* nameScope() noexcept override { return fNames.get(); }
+        std::shared_ptr<PSNameScope> sharedNameScope() const noexcept { return fNames; }
+
+        // The document's memo of parsed attribute values, for
+        // its hit and miss counts, and to set its capacity
+        SVGValueMemo& valueMemo() noexcept { return fValueMemo; }
+
+        // Where the document's nodes are allocated
+        NodeArena* nodeArena() noexcept { return fNodeArena.get(); }
+        std::shared_ptr<NodeArena> sharedNodeArena() const noexcept { return fNodeArena; }
+
+        // Number of threads used to construct the document.
+        // 1 loads on the calling thread only, 0 uses all the hardware threads
+        size_t loadThreads() const noexcept { return fLoadThreads; }
+        void setLoadThreads(size_t n) noexcept
+        {
+            if (n == 0)
+                n = std::max<size_t>(1, std::thread::hardware_concurrency());
+            fLoadThreads = n;
+        }
         
 
         // retrieve root svg node
@@ -218,6 +336,69 @@ namespace waavs
             
             return true;
         }
+
+        std::shared_ptr<IViewable> claimPrebuiltSubtree(XmlPull& iter) override
+        {
+            if (fNextPrebuilt >= fPrebuilt.size())
+                return nullptr;
+
+            SVGPrebuiltSubtree& sub = fPrebuilt[fNextPrebuilt];
+            if (iter.position() != sub.fAfterStartTag)
+                return nullptr;
+
+            fNextPrebuilt++;
+
+            if (!sub.fNode)
+                return nullptr;
+
+            // Make the changes building the subtree would have made,
+            // just as they would have been had it been loaded here
+            for (auto& ent : sub.fEntities)
+                addXmlEntity(ent.first, ent.second);
+
+            for (auto& ref : sub.fReferences)
+                addElementReference(ref.first, ref.second);
+
+            if (sub.fStyleSheet)
+                fStyleSheet.appendSheet(*sub.fStyleSheet);
+
+            iter.skipTo(sub.fEnd);
+
+            return std::move(sub.fNode);
+        }
+
+        bool findPrecompiledPath(const ByteSpan& d, PathProgram& prog) override
+        {
+            return fBinary.findPathProgram(d, prog);
+        }
+
+        // prebuildSubtrees()
+        //
+        // Find the large subtrees, and construct them across the 
+        // load threads, ready to be claimed by the main load
+        void prebuildSubtrees(const ByteSpan& src)
+        {
+            fPrebuilt.clear();
+            fNextPrebuilt = 0;
+
+            XmlElement docType{};
+            findRootSubtrees(src, kMinParallelSubtreeSize, fPrebuilt, docType);
+
+            // Not worth the threads
+            if (fPrebuilt.size() < 2)
+            {
+                fPrebuilt.clear();
+                return;
+            }
+
+            // Entities have to be known before anything is built.
+            // The main load will pass over the DOCTYPE again, and
+            // leave it alone.
+            if (docType.kind() == XML_ELEMENT_TYPE_DOCTYPE)
+                loadDocTypeNode(docType, this);
+
+            buildSubtreesParallel(fPrebuilt, fLoadThreads, this, &fValueMemo, fNodeArena.get());
+        }
         
         void onDocumentLoaded(IAmGroot* groot)
         {
@@ -267,9 +448,14 @@ namespace waavs
 
         // loadDocTypeNode
         //
-        // Parse the DocType and apply entities if they exist
+        // Parse the DocType and apply entities if they exist.
+        // A document has only one, so it's only applied once.
         void loadDocTypeNode(const XmlElement& elem, IAmGroot* groot)
         {
+            if (fDocTypeLoaded)
+                return;
+            fDocTypeLoaded = true;
+
             XmlDocTypeDecl decl{};
             if (!parseDocTypeDecl(elem.data(), decl))
                 return;
@@ -337,11 +523,13 @@ namespace waavs
         // loadFromChunk
         // 
         // Assuming we've already got a document mapped into memory
-        // construct the SVGDocument from the given memory chunk
+        // construct the SVGDocument from the given memory chunk.
+        // The chunk is copied, so it doesn't need to outlive the document.
         bool loadFromChunk(const ByteSpan &srcChunk)
         {
 
             fSourceMem.resetFromSpan(srcChunk);
+            fSourceOwner.reset();
             
             // BUGBUG - It would be nice to take this opportunity to convert basic XML
             // entities such as &amp; &lt; &gt; &quot; &#39; into their
@@ -355,15 +543,132 @@ namespace waavs
             // ByteSpan dstSpan = fSourceMem.span();
             // size_t sz = expandXmlEntities(srcChunk, dstSpan);
 
+            return loadFromSource(fSourceMem.span());
+        }
+
+        // loadFromSharedChunk
+        //
+        // Construct the document directly from 'srcChunk', without copying.
+        // 'owner' is whatever holds that memory, a MappedFile for instance,
+        // and the document keeps a share of it for as long as it lives.
+        bool loadFromSharedChunk(std::shared_ptr<const void> owner, const ByteSpan& srcChunk)
+        {
+            fSourceMem.reset();
+            fSourceOwner = std::move(owner);
+
+            return loadFromSource(srcChunk);
+        }
+
+        // loadFromBorrowedChunk
+        //
+        // Construct the document directly from 'srcChunk', without copying.
+        // The caller guarantees the memory outlives the document.
+        bool loadFromBorrowedChunk(const ByteSpan& srcChunk)
+        {
+            fSourceMem.reset();
+            fSourceOwner.reset();
+
+            return loadFromSource(srcChunk);
+        }
+
+    private:
+        bool loadFromSource(const ByteSpan& src)
+        {
+            fSource = src;
+            fBinary.reset();
+            fDocTypeLoaded = false;
+
+            // Anything interned while loading goes into the 
+            // document's own name scope
+            PSNameScopeGuard nameGuard(fNames.get());
+            SVGValueMemoGuard memoGuard(&fValueMemo);
+            NodeArenaGuard arenaGuard(fNodeArena.get());
+
+            // A precompiled image has its elements already found,
+            // so they're replayed instead of scanned
+            if (svgb_is_image(src))
+            {
+                if (!fBinary.open(src))
+                    return false;
+
+                fSource = fBinary.source();
+
+                XmlPull iter(fBinary.image(), fBinary.elements(), fBinary.elementCount());
+                loadDocumentFromXmlPull(iter, this);
+
+                return true;
+            }
+
+            if (fLoadThreads > 1)
+                prebuildSubtrees(fSource);
+
             // Create the XML Iterator we're going to use to parse the document
-            XmlPull iter(fSourceMem.span(), true);
+            XmlPull iter(fSource, true);
             loadDocumentFromXmlPull(iter, this);
             
-
+            fPrebuilt.clear();
+            fNextPrebuilt = 0;
 
             return true;
         }
 
+        // collectImageHrefs()
+        //
+        // Gather the embedded (data:) image references of <image>
+        // and <feImage> elements in a subtree.
+        static void collectImageHrefs(const SVGGraphicsElement* elem, std::vector<ByteSpan>& hrefs)
+        {
+            for (auto& node : elem->fChildren)
+            {
+                auto ge = std::dynamic_pointer_cast<SVGGraphicsElement>(node);
+                if (!ge)
+                    continue;
+
+                InternedKey name = ge->fSourceElement.nameAtom();
+                if (name == svgtag::tag_image() || name == svgtag::tag_feImage())
+                {
+                    ByteSpan href{};
+                    if (!ge->getElementAttribute("href", href))
+                        ge->getElementAttribute("xlink:href", href);
+
+                    href = chunk_trim(href, chrWspChars);
+                    if (bspan_starts_with(href, "data:"))
+                        hrefs.push_back(href);
+                }
+
+                collectImageHrefs(ge.get(), hrefs);
+            }
+        }
+
+    public:
+        // prefetchImages()
+        //
+        // Decode all the embedded images the document refers to into
+        // the shared image cache, using up to 'threadCount' threads
+        // (0 == all hardware threads), so drawing doesn't have to stop
+        // and decode them.
+        void prefetchImages(size_t threadCount = 0)
+        {
+            std::vector<ByteSpan> hrefs{};
+            collectImageHrefs(this, hrefs);
+
+            waavs::prefetchImages(hrefs, threadCount);
+        }
+
+        // writeBinaryImage()
+        //
+        // Write the precompiled (.svgb) image of this document into 'out'.
+        // Loading that image later skips the XML scanning and path parsing.
+        bool writeBinaryImage(std::vector<uint8_t>& out) const
+        {
+            if (fBinary.isOpen())
+            {
+                out.assign(fBinary.image().begin(), fBinary.image().end());
+                return true;
+            }
+
+            return svgb_compile(fSource, out);
+        }
 
         
         // Bind to a context of a given size
@@ -385,6 +690,9 @@ namespace waavs
         // 
         void bindToContext(IRenderSVG* ctx, IAmGroot* groot) noexcept override
         {
+            PSNameScopeGuard nameGuard(fNames.get());
+            SVGValueMemoGuard memoGuard(&fValueMemo);
+
             fPortalFrame = { 0, 0, fCanvasWidth, fCanvasHeight };
 
             ctx->setViewport(fPortalFrame);
@@ -397,8 +705,18 @@ namespace waavs
         }
 
         
+        // draw()
+        //
+        // Not thread-safe.  Drawing binds nodes to the context, builds
+        // geometry, and remembers bounds, all in the document, so only
+        // one thread can be drawing a document at a time.  To draw
+        // from several threads, freeze it into a display list first,
+        // see svgrendersession.h.
         void draw(IRenderSVG* ctx, IAmGroot* groot, RenderFlags featureSet = RenderFeature::RF_All) override
         {        
+            PSNameScopeGuard nameGuard(fNames.get());
+            SVGValueMemoGuard memoGuard(&fValueMemo);
+
             if (needsBinding())
                 this->bindToContext(ctx, groot);
 
@@ -417,9 +735,10 @@ namespace waavs
         }
 
 
-        static std::shared_ptr<SVGDocument> createFromChunk(const ByteSpan& srcChunk, const double w, const double h, const double ppi)
+        static std::shared_ptr<SVGDocument> createFromChunk(const ByteSpan& srcChunk, const double w, const double h, const double ppi, size_t loadThreads = 1)
         {
             auto doc = std::make_shared<SVGDocument>(w, h, ppi);
+            doc->setLoadThreads(loadThreads);
             if (!doc->loadFromChunk(srcChunk))
             {
                 printf("SVGFactory::CreateFromChunk() failed to load\n");
@@ -428,6 +747,33 @@ namespace waavs
             return doc;
         }
 
+        // Create a document that shares ownership of the source memory, rather than copying it
+        static std::shared_ptr<SVGDocument> createFromSharedChunk(std::shared_ptr<const void> owner, const ByteSpan& srcChunk, const double w, const double h, const double ppi, size_t loadThreads = 1)
+        {
+            auto doc = std::make_shared<SVGDocument>(w, h, ppi);
+            doc->setLoadThreads(loadThreads);
+            if (!doc->loadFromSharedChunk(std::move(owner), srcChunk))
+            {
+                printf("SVGFactory::CreateFromSharedChunk() failed to load\n");
+                return nullptr;
+            }
+            return doc;
+        }
+
+        // Create a document referencing the source memory, which the caller
+        // guarantees will outlive the document
+        static std::shared_ptr<SVGDocument> createFromBorrowedChunk(const ByteSpan& srcChunk, const double w, const double h, const double ppi, size_t loadThreads = 1)
+        {
+            auto doc = std::make_shared<SVGDocument>(w, h, ppi);
+            doc->setLoadThreads(loadThreads);
+            if (!doc->loadFromBorrowedChunk(srcChunk))
+            {
+                printf("SVGFactory::CreateFromBorrowedChunk() failed to load\n");
+                return nullptr;
+            }
+            return doc;
+        }
+
     };
 
     using SVGDocumentHandle = std::shared_ptr<SVGDocument>;
@@ -19,7 +19,9 @@ namespace waavs {
 
     struct SvgAttributeCollection
     {
-        std::unordered_map<ByteSpan, ByteSpan> fAttributes{};
+        using Dictionary = SmallFlatMap<ByteSpan, ByteSpan, kInlineAttributes, ByteSpanHash, ByteSpanEquivalent>;
+
+        Dictionary fAttributes{};
 
         // Constructors
         SvgAttributeCollection() = default;
@@ -35,7 +37,7 @@ namespace waavs {
         // IMPLEMENTATION
         
         // Return a const attribute collection
-        const std::unordered_map<ByteSpan, ByteSpan>& attributes() const { return fAttributes; }
+        const Dictionary& attributes() const { return fAttributes; }
 
         // size()
         // Return number of attributes in collection
@@ -51,7 +53,7 @@ namespace waavs {
         // collection can intercept the setting of the attribute
         virtual void setAttribute(const ByteSpan& name, const ByteSpan& value)
         {
-            fAttributes[name] = value;
+            fAttributes.set(name, value);
         }
 
         
@@ -84,10 +86,10 @@ namespace waavs {
         //
         bool getAttribute(const ByteSpan& name, ByteSpan& out) const
         {
-            auto it = fAttributes.find(name);
-			if (it != fAttributes.end())
+            const ByteSpan* found = fAttributes.find(name);
+			if (found)
 			{
-				out = it->second;
+				out = *found;
 				return true;
 			}
             
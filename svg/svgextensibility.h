@@ -22,7 +22,7 @@ namespace waavs {
 		{
 			registerContainerNode("foreignObject",
 				[](IAmGroot* groot, XmlPull& iter) {
-					auto node = std::make_shared<SVGForeignObjectElement>(groot);
+					auto node = makeNode<SVGForeignObjectElement>(groot);
 					node->loadFromXmlPull(iter, groot);
 
 					return node;
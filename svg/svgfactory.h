@@ -207,10 +207,10 @@ namespace waavs {
 
         // A convenience to construct the document from a chunk, and return
         // a shared pointer to the document
-        static std::shared_ptr<SVGDocument> createFromChunkInternal(const ByteSpan& srcChunk, const double w, const double h, const double ppi)
+        static std::shared_ptr<SVGDocument> createFromChunkInternal(const ByteSpan& srcChunk, const double w, const double h, const double ppi, size_t loadThreads)
         {
             // this MUST be done, or node registrations will not happen
-            auto doc = SVGDocument::createFromChunk(srcChunk, w, h, ppi);
+            auto doc = SVGDocument::createFromChunk(srcChunk, w, h, ppi, loadThreads);
 
             if (doc == nullptr)
             {
@@ -232,14 +232,36 @@ namespace waavs {
 
         // A convenience to construct the document from a chunk, and return
         // a shared pointer to the document
-        static std::shared_ptr<SVGDocument> createFromChunk(const ByteSpan& srcChunk, double w, double h, double ppi=96.0)
+        // loadThreads - threads used to construct the document, 0 == all hardware threads
+        static std::shared_ptr<SVGDocument> createFromChunk(const ByteSpan& srcChunk, double w, double h, double ppi=96.0, size_t loadThreads = 1)
         {
-            auto doc = getSingleton()->createFromChunkInternal(srcChunk, w, h, ppi);
+            auto doc = getSingleton()->createFromChunkInternal(srcChunk, w, h, ppi, loadThreads);
 
             if (!doc)
                 return nullptr;
 
             return doc;
         }
+
+        // Construct the document directly from memory that's already in place,
+        // such as a mapped file, without copying it.  The document holds
+        // a share of 'owner' to keep that memory alive.
+        static std::shared_ptr<SVGDocument> createFromSharedChunk(std::shared_ptr<const void> owner, const ByteSpan& srcChunk, double w, double h, double ppi = 96.0, size_t loadThreads = 1)
+        {
+            // make sure the node registrations have happened
+            getSingleton();
+
+            return SVGDocument::createFromSharedChunk(std::move(owner), srcChunk, w, h, ppi, loadThreads);
+        }
+
+        // As createFromSharedChunk(), but the caller guarantees the
+        // memory outlives the document
+        static std::shared_ptr<SVGDocument> createFromBorrowedChunk(const ByteSpan& srcChunk, double w, double h, double ppi = 96.0, size_t loadThreads = 1)
+        {
+            // make sure the node registrations have happened
+            getSingleton();
+
+            return SVGDocument::createFromBorrowedChunk(srcChunk, w, h, ppi, loadThreads);
+        }
     };
 }
@@ -12,6 +12,7 @@
 #include "filter_program_builder.h"
 #include "filter_primitive_element.h"
 #include "filter_primitive_subcomponent.h"
+#include "imagecache.h"
 
 // Elements related to filters
 // filter			- compound
@@ -63,7 +64,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feBlend", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeBlendElement>(groot);
+                auto node = makeNode<SVGFeBlendElement>(groot);
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -73,7 +74,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feBlend", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeBlendElement>(groot);
+                auto node = makeNode<SVGFeBlendElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 
                 return node;
@@ -104,7 +105,7 @@ namespace waavs
             (void)groot;
             ByteSpan modeAttr{};
             if (getAttribute(filter::mode(), modeAttr)) 
-                fMode = parseFilterBlendMode(PSNameTable::INTERN(modeAttr));
+                fMode = parseFilterBlendMode(PSNameScope::LOOKUP(modeAttr));
             else
                 fMode = FilterBlendMode::FILTER_BLEND_NORMAL;
         }
@@ -127,25 +128,25 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feFuncA", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeFuncElement>();
+                auto node = makeNode<SVGFeFuncElement>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
                 });
             registerSVGSingularNodeByName("feFuncR", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeFuncElement>();
+                auto node = makeNode<SVGFeFuncElement>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
                 });
             registerSVGSingularNodeByName("feFuncG", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeFuncElement>();
+                auto node = makeNode<SVGFeFuncElement>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
                 });
             registerSVGSingularNodeByName("feFuncB", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeFuncElement>();
+                auto node = makeNode<SVGFeFuncElement>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -176,7 +177,7 @@ namespace waavs
 
             ByteSpan typeAttr{};
             if (getAttribute(filter::type_(), typeAttr))
-                fFunc.fType = parseFilterTransferFuncType(PSNameTable::INTERN(typeAttr));
+                fFunc.fType = parseFilterTransferFuncType(PSNameScope::LOOKUP(typeAttr));
             else
                 fFunc.fType = FILTER_TRANSFER_IDENTITY;
 
@@ -220,7 +221,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feComponentTransfer", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeComponentTransferElement>(groot);
+                auto node = makeNode<SVGFeComponentTransferElement>(groot);
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -230,7 +231,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feComponentTransfer", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeComponentTransferElement>(groot);
+                auto node = makeNode<SVGFeComponentTransferElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 return node;
                 });
@@ -317,7 +318,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feComposite", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeCompositeElement>(groot);
+                auto node = makeNode<SVGFeCompositeElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 
                 return node;
@@ -327,7 +328,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feComposite", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeCompositeElement>(groot);
+                auto node = makeNode<SVGFeCompositeElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 
                 return node;
@@ -377,7 +378,7 @@ namespace waavs
 
             ByteSpan opAttr{};
             if (getAttribute(filter::operator_(), opAttr))
-                fCompOp = parseFilterCompositeOp(PSNameTable::INTERN(opAttr));
+                fCompOp = parseFilterCompositeOp(PSNameScope::LOOKUP(opAttr));
             else
                 fCompOp = FILTER_COMPOSITE_OVER;
 
@@ -397,7 +398,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feColorMatrix", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeColorMatrixElement>();
+                auto node = makeNode<SVGFeColorMatrixElement>();
                 node->loadFromXmlElement(elem, groot);
                 
                 return node;
@@ -407,7 +408,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feColorMatrix", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeColorMatrixElement>();
+                auto node = makeNode<SVGFeColorMatrixElement>();
                 node->loadFromXmlPull(iter, groot);
                 
                 return node;
@@ -461,7 +462,7 @@ namespace waavs
 
             ByteSpan typeAttr{};
             if (getAttribute(filter::type_(), typeAttr))
-                fType = parseFilterColorMatrixType(PSNameTable::INTERN(typeAttr));
+                fType = parseFilterColorMatrixType(PSNameScope::LOOKUP(typeAttr));
             else
                 fType = FILTER_COLOR_MATRIX_MATRIX;
 
@@ -501,7 +502,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feConvolveMatrix", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeConvolveMatrixElement>(groot);
+                auto node = makeNode<SVGFeConvolveMatrixElement>(groot);
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -511,7 +512,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feConvolveMatrix", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeConvolveMatrixElement>(groot);
+                auto node = makeNode<SVGFeConvolveMatrixElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 return node;
                 });
@@ -620,7 +621,7 @@ namespace waavs
 
             ByteSpan edgeAttr{};
             if (getAttribute(filter::edgeMode(), edgeAttr))
-                fEdgeMode = parseFilterEdgeMode(PSNameTable::INTERN(edgeAttr));
+                fEdgeMode = parseFilterEdgeMode(PSNameScope::LOOKUP(edgeAttr));
             else
                 fEdgeMode = FILTER_EDGE_DUPLICATE;
 
@@ -647,7 +648,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feDiffuseLighting", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeDiffuseLightingElement>();
+                auto node = makeNode<SVGFeDiffuseLightingElement>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -657,7 +658,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feDiffuseLighting", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeDiffuseLightingElement>();
+                auto node = makeNode<SVGFeDiffuseLightingElement>();
                 node->loadFromXmlPull(iter, groot);
                 return node;
                 });
@@ -768,7 +769,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feDisplacementMap", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeDisplacementMapElement>(groot);
+                auto node = makeNode<SVGFeDisplacementMapElement>(groot);
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -778,7 +779,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feDisplacementMap", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeDisplacementMapElement>(groot);
+                auto node = makeNode<SVGFeDisplacementMapElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 return node;
                 });
@@ -819,12 +820,12 @@ namespace waavs
             ByteSpan ySelAttr{};
 
             if (getAttribute(filter::xChannelSelector(), xSelAttr))
-                fXChannel = parseFilterChannelSelector(PSNameTable::INTERN(xSelAttr));
+                fXChannel = parseFilterChannelSelector(PSNameScope::LOOKUP(xSelAttr));
             else
                 fXChannel = FILTER_CHANNEL_A;
 
             if (getAttribute(filter::yChannelSelector(), ySelAttr))
-                fYChannel = parseFilterChannelSelector(PSNameTable::INTERN(ySelAttr));
+                fYChannel = parseFilterChannelSelector(PSNameScope::LOOKUP(ySelAttr));
             else
                 fYChannel = FILTER_CHANNEL_A;
         }
@@ -846,7 +847,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feDropShadow", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeDropShadowElement>(groot);
+                auto node = makeNode<SVGFeDropShadowElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 return node;
                 });
@@ -855,7 +856,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feDropShadow", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeDropShadowElement>(groot);
+                auto node = makeNode<SVGFeDropShadowElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 return node;
                 });
@@ -953,7 +954,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feFlood", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeFloodElement>(groot);
+                auto node = makeNode<SVGFeFloodElement>(groot);
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -963,7 +964,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feFlood", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeFloodElement>(groot);
+                auto node = makeNode<SVGFeFloodElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 
                 return node;
@@ -1017,7 +1018,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feGaussianBlur", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeGaussianBlurElement>(groot);
+                auto node = makeNode<SVGFeGaussianBlurElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 
                 return node;
@@ -1027,7 +1028,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feGaussianBlur", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeGaussianBlurElement>(groot);
+                auto node = makeNode<SVGFeGaussianBlurElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 
                 return node;
@@ -1078,7 +1079,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feImage", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeImageElement>(groot);
+                auto node = makeNode<SVGFeImageElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 return node;
                 });
@@ -1087,7 +1088,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feImage", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeImageElement>(groot);
+                auto node = makeNode<SVGFeImageElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 return node;
                 });
@@ -1119,6 +1120,16 @@ namespace waavs
             emit_u32(out, (uint32_t)fAlign);
             emit_u32(out, (uint32_t)fMeetOrSlice);
 
+            // An embedded image is decoded now, and goes with the
+            // program, so running it, tile after tile, doesn't
+            // look it up again
+            if (fImageKey && bspan_starts_with(ByteSpan(fImageKey), "data:") && !out.findImage(fImageKey))
+            {
+                BLImage img{};
+                if (parseImage(fImageKey, img) && !img.is_empty())
+                    out.images.emplace_back(fImageKey, img);
+            }
+
             return true;
         }
 
@@ -1132,7 +1143,7 @@ namespace waavs
                 hrefAttr = getAttribute(filter::xlink_href());
 
             if (hrefAttr)
-                fImageKey = PSNameTable::INTERN(hrefAttr);
+                fImageKey = PSNameScope::INTERN(hrefAttr);
             else
                 fImageKey = nullptr;
 
@@ -1152,7 +1163,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feMergeNode", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeMergeNodeElement>();
+                auto node = makeNode<SVGFeMergeNodeElement>();
                 node->loadFromXmlElement(elem, groot);
                 return node;
                 });
@@ -1161,7 +1172,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feMergeNode", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeMergeNodeElement>();
+                auto node = makeNode<SVGFeMergeNodeElement>();
                 node->loadFromXmlPull(iter, groot);
                 return node;
                 });
@@ -1186,7 +1197,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feMerge", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeMergeElement>(groot);
+                auto node = makeNode<SVGFeMergeElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 return node;
                 });
@@ -1195,7 +1206,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feMerge", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeMergeElement>(groot);
+                auto node = makeNode<SVGFeMergeElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 return node;
                 });
@@ -1255,9 +1266,9 @@ namespace waavs
                 // If "in" is not specified, SVG spec says the default is the result of the previous filter primitive.
                 if (!mn->getAttribute(filter::in(), inAttr))
                 {
-                    k = PSNameTable::INTERN("__last__");
+                    k = filter::Filter_Last();
                 }else
-                    k = PSNameTable::INTERN(inAttr);
+                    k = PSNameScope::INTERN(inAttr);
 
 
                 fInputs.push_back(k);
@@ -1274,7 +1285,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feMorphology", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeMorphologyElement>(groot);
+                auto node = makeNode<SVGFeMorphologyElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 return node;
                 });
@@ -1283,7 +1294,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feMorphology", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeMorphologyElement>(groot);
+                auto node = makeNode<SVGFeMorphologyElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 return node;
                 });
@@ -1318,7 +1329,7 @@ namespace waavs
 
             ByteSpan opAttr{};
             if (getAttribute(filter::operator_(), opAttr))
-                fMorphOp = parseFilterMorphologyOp(PSNameTable::INTERN(opAttr));
+                fMorphOp = parseFilterMorphologyOp(PSNameScope::LOOKUP(opAttr));
             else
                 fMorphOp = FILTER_MORPHOLOGY_ERODE;
 
@@ -1347,7 +1358,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feOffset", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeOffsetElement>(groot);
+                auto node = makeNode<SVGFeOffsetElement>(groot);
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -1357,7 +1368,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feOffset", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeOffsetElement>(groot);
+                auto node = makeNode<SVGFeOffsetElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 
                 return node;
@@ -1411,7 +1422,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feSpecularLighting", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeSpecularLightingElement>();
+                auto node = makeNode<SVGFeSpecularLightingElement>();
                 node->loadFromXmlElement(elem, groot);
                 return node;
                 });
@@ -1420,7 +1431,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feSpecularLighting", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeSpecularLightingElement>();
+                auto node = makeNode<SVGFeSpecularLightingElement>();
                 node->loadFromXmlPull(iter, groot);
                 return node;
                 });
@@ -1538,7 +1549,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feTile", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeTileElement>(groot);
+                auto node = makeNode<SVGFeTileElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 return node;
                 });
@@ -1547,7 +1558,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feTile", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeTileElement>(groot);
+                auto node = makeNode<SVGFeTileElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 return node;
                 });
@@ -1586,7 +1597,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("feTurbulence", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFeTurbulenceElement>(groot);
+                auto node = makeNode<SVGFeTurbulenceElement>(groot);
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -1596,7 +1607,7 @@ namespace waavs
         static void registerFactory()
         {
             registerContainerNodeByName("feTurbulence", [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFeTurbulenceElement>(groot);
+                auto node = makeNode<SVGFeTurbulenceElement>(groot);
                 node->loadFromXmlPull(iter, groot);
                 
                 return node;
@@ -1647,7 +1658,7 @@ namespace waavs
 
             ByteSpan typeAttr{};
             if (getAttribute(filter::type_(), typeAttr))
-                fType = parseFilterTurbulenceType(PSNameTable::INTERN(typeAttr));
+                fType = parseFilterTurbulenceType(PSNameScope::LOOKUP(typeAttr));
             else
                 fType = FILTER_TURBULENCE_TURBULENCE;
 
@@ -1678,7 +1689,7 @@ namespace waavs {
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName(svgtag::tag_filter(), [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGFilterElement>();
+                auto node = makeNode<SVGFilterElement>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -1688,7 +1699,7 @@ namespace waavs {
         static void registerFactory()
         {
             registerContainerNodeByName(svgtag::tag_filter(), [](IAmGroot* groot, XmlPull& iter) {
-                auto node = std::make_shared<SVGFilterElement>();
+                auto node = makeNode<SVGFilterElement>();
                 node->loadFromXmlPull(iter, groot);
 
                 return node;
@@ -1834,7 +1845,7 @@ namespace waavs {
             ByteSpan interpAttr{};
             if (getAttribute(filter::color_interpolation_filters(), interpAttr))
             {
-                InternedKey interpKey = PSNameTable::INTERN(interpAttr);
+                InternedKey interpKey = PSNameScope::LOOKUP(interpAttr);
                 fColorInterpolation = parseFilterColorInterpolation(interpKey, FilterColorInterpolation::FILTER_COLOR_INTERPOLATION_LINEAR_RGB);
             }
             
@@ -348,11 +348,14 @@ namespace waavs {
     //============================================================
     struct SVGFlowRoot final : public SVGGraphicsElement
     {
+        // Flowed text is laid out as it's drawn
+        bool canCull() const noexcept override { return false; }
+
         static void registerFactory()
         {
             registerContainerNodeByName("flowRoot",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGFlowRoot>(groot);
+                    auto node = makeNode<SVGFlowRoot>(groot);
                     node->loadFromXmlPull(iter, groot);
                     return node;
                 });
@@ -394,7 +397,7 @@ namespace waavs {
 
             while (readNextKeyAttribute(src, k, v))
             {
-                InternedKey key = PSNameTable::INTERN(k);
+                InternedKey key = PSNameScope::LOOKUP(k);
 
                 // avoid repeated INTERN calls for constants by caching once
                 static InternedKey kx = svgattr::x();
@@ -610,7 +613,7 @@ namespace waavs {
             {
                 ByteSpan ta = chunk_trim(getAttributeByName(svgattr::text_align()), chrWspChars);
                 if (ta) {
-                    InternedKey tak = PSNameTable::INTERN(ta);
+                    InternedKey tak = PSNameScope::LOOKUP(ta);
 
                     if (tak == svgval::center()) 
                         align = ALIGN_MIDDLE;
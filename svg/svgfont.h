@@ -39,7 +39,7 @@ namespace waavs {
 		static void registerFactory()
 		{
 			registerContainerNodeByName("font", [](IAmGroot* groot, XmlPull& iter) {
-				auto node = std::make_shared<SVGFontNode>(groot);
+				auto node = makeNode<SVGFontNode>(groot);
 				node->loadFromXmlPull(iter, groot);
 
 				return node;
@@ -90,7 +90,7 @@ namespace waavs {
 		static void registerSingularNode()
 		{
 			registerSVGSingularNodeByName("font-face", [](IAmGroot* groot, const XmlElement& elem) {
-				auto node = std::make_shared<SVGFontFaceNode>(groot);
+				auto node = makeNode<SVGFontFaceNode>(groot);
 				node->loadFromXmlElement(elem, groot);
 
 				return node;
@@ -100,7 +100,7 @@ namespace waavs {
 		static void registerFactory()
 		{
 			registerContainerNodeByName("font-face", [](IAmGroot* groot, XmlPull& iter) {
-				auto node = std::make_shared<SVGFontFaceNode>(groot);
+				auto node = makeNode<SVGFontFaceNode>(groot);
 				node->loadFromXmlPull(iter, groot);
 
 				return node;
@@ -175,7 +175,7 @@ namespace waavs {
 		static void registerSingularNode()
 		{
 			registerSVGSingularNodeByName("missing-glyph", [](IAmGroot* groot, const XmlElement& elem) {
-				auto node = std::make_shared<SVGMissingGlyphNode>(groot);
+				auto node = makeNode<SVGMissingGlyphNode>(groot);
 				node->loadFromXmlElement(elem, groot);
 
 				return node;
@@ -185,7 +185,7 @@ namespace waavs {
 		static void registerFactory()
 		{
 			registerContainerNodeByName("missing-glyph", [](IAmGroot* groot, XmlPull& iter) {
-				auto node = std::make_shared<SVGMissingGlyphNode>(groot);
+				auto node = makeNode<SVGMissingGlyphNode>(groot);
 				node->loadFromXmlPull(iter, groot);
 
 				return node;
@@ -237,7 +237,7 @@ namespace waavs {
 	{
 		static void registerFactory() {
 			registerSVGSingularNodeByName("glyph", [](IAmGroot* groot, const XmlElement& elem) {
-				auto node = std::make_shared<SVGGlyphNode>(groot);
+				auto node = makeNode<SVGGlyphNode>(groot);
 				node->loadFromXmlElement(elem, groot);
 				
 				return node;
@@ -290,7 +290,7 @@ namespace waavs {
 		static void registerSingularNode()
 		{
 			registerSVGSingularNodeByName("font-face-src", [](IAmGroot* groot, const XmlElement& elem) {
-				auto node = std::make_shared<SVGFontFaceSrcNode>(groot);
+				auto node = makeNode<SVGFontFaceSrcNode>(groot);
 				node->loadFromXmlElement(elem, groot);
 
 				return node;
@@ -300,7 +300,7 @@ namespace waavs {
 		static void registerFactory()
 		{
 			registerContainerNodeByName("font-face-src", [](IAmGroot* groot, XmlPull& iter) {
-				auto node = std::make_shared<SVGFontFaceSrcNode>(groot);
+				auto node = makeNode<SVGFontFaceSrcNode>(groot);
 				node->loadFromXmlPull(iter, groot);
 
 				return node;
@@ -321,7 +321,7 @@ namespace waavs {
 	{
 		static void registerFactory() {
 			registerSVGSingularNodeByName("font-face-name", [](IAmGroot* groot, const XmlElement& elem) {
-				auto node = std::make_shared<SVGFontFaceNameNode>(groot);
+				auto node = makeNode<SVGFontFaceNameNode>(groot);
 				node->loadFromXmlElement(elem, groot);
 				return node;
 			});
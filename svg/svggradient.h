@@ -341,7 +341,7 @@ namespace waavs {
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("linearGradient", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGLinearGradient>();
+                auto node = makeNode<SVGLinearGradient>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -352,7 +352,7 @@ namespace waavs {
         {
             registerContainerNodeByName("linearGradient",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGLinearGradient>();
+                    auto node = makeNode<SVGLinearGradient>();
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -598,7 +598,7 @@ namespace waavs {
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("radialGradient", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGRadialGradient>();
+                auto node = makeNode<SVGRadialGradient>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -609,7 +609,7 @@ namespace waavs {
         {
             registerContainerNodeByName("radialGradient",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGRadialGradient>();
+                    auto node = makeNode<SVGRadialGradient>();
                     node->loadFromXmlPull(iter, groot);
                     return node;
                 });
@@ -883,7 +883,7 @@ namespace waavs {
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("conicGradient", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGConicGradient>();
+                auto node = makeNode<SVGConicGradient>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -894,7 +894,7 @@ namespace waavs {
         {
             registerContainerNodeByName("conicGradient",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGConicGradient>();
+                    auto node = makeNode<SVGConicGradient>();
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
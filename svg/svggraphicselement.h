@@ -1,11 +1,49 @@
 #pragma once
 
+#include <algorithm>
+
 #include "svgstructuretypes.h"
+#include "svgboundsindex.h"
 #include "filter_program_exec_b2d.h"
 
 namespace waavs
 {
 
+    // resolveIsolatedPixelRect()
+    //
+    // Where on the target the plan's offscreen surface goes, from its
+    // effect rectangle and transform.  False if none of it is drawn.
+    static INLINE bool resolveIsolatedPixelRect(IRenderSVG* ctx, IsolatedRenderPlan& plan) noexcept
+    {
+        plan.nominalRectPX = mapRectAABB(plan.ctm, plan.effectRectUS);
+
+        // Opacity, masks and clips work pixel by pixel, so only the
+        // part being drawn is needed.  Filters can pull in pixels from
+        // anywhere in their region, so they get all of it.
+        plan.allocRectPX = plan.nominalRectPX;
+
+        WGRectI visible{};
+        if (!plan.hasFilter && ctx->getVisibleRect(visible))
+        {
+            plan.allocRectPX = intersection(plan.nominalRectPX, WGRectD{ double(visible.x), double(visible.y), double(visible.w), double(visible.h) });
+        }
+
+        if (!(plan.allocRectPX.w > 0.0) || !(plan.allocRectPX.h > 0.0))
+            return false;
+
+        const int x0 = (int)std::floor(plan.allocRectPX.x);
+        const int y0 = (int)std::floor(plan.allocRectPX.y);
+        const int x1 = (int)std::ceil(plan.allocRectPX.x + plan.allocRectPX.w);
+        const int y1 = (int)std::ceil(plan.allocRectPX.y + plan.allocRectPX.h);
+
+        if (x1 <= x0 || y1 <= y0)
+            return false;
+
+        plan.pixelRect = WGRectI{ x0, y0, x1 - x0, y1 - y0 };
+        return true;
+    }
+
+
     template<class SubtreeT>
     static bool resolveIsolatedRenderPlan(
         IRenderSVG* ctx,
@@ -20,6 +58,7 @@ namespace waavs
 
         plan = {};
         plan.objectBBoxUS = objectBBoxUS;
+        plan.pool = ctx->surfacePool();
         plan.ctm = ctx->getTransform();
         plan.invCtm = plan.ctm;
         (void)plan.invCtm.invert();
@@ -74,27 +113,15 @@ namespace waavs
             return false;
 
         plan.effectRectUS = effectRectUS;
-        plan.nominalRectPX = mapRectAABB(plan.ctm, effectRectUS);
-
-        // Later this should intersect against viewport/device clip.
-        plan.allocRectPX = plan.nominalRectPX;
 
-        if (!(plan.allocRectPX.w > 0.0) || !(plan.allocRectPX.h > 0.0))
-            return false;
-
-        const int x0 = (int)std::floor(plan.allocRectPX.x);
-        const int y0 = (int)std::floor(plan.allocRectPX.y);
-        const int x1 = (int)std::ceil(plan.allocRectPX.x + plan.allocRectPX.w);
-        const int y1 = (int)std::ceil(plan.allocRectPX.y + plan.allocRectPX.h);
-
-        if (x1 <= x0 || y1 <= y0)
-            return false;
-
-        plan.pixelRect = WGRectI{ x0, y0, x1 - x0, y1 - y0 };
-        return true;
+        return resolveIsolatedPixelRect(ctx, plan);
     }
 
-
+    // renderSubtreeToSurface()
+    //
+    // Draw the subtree's content offscreen, into a surface covering
+    // req.pixelRect.  'groot' is only passed along, to a subtree that
+    // needs it.
     template<class SubtreeT>
     bool renderSubtreeToSurface(
         IAmGroot* groot,
@@ -102,22 +129,13 @@ namespace waavs
         const IsolatedSubtreeRequest& req,
         Surface& outSurface) noexcept
     {
-        if (!groot || !subtree)
+        if (!subtree)
             return false;
 
         if (req.pixelRect.w <= 0 || req.pixelRect.h <= 0)
             return true;
 
-        // Resize the output surface if needed.
-        //
-        if (outSurface.width() != uint32_t(req.pixelRect.w) || outSurface.height() != uint32_t(req.pixelRect.h))
-        {
-            outSurface.reset(
-                uint32_t(req.pixelRect.w),
-                uint32_t(req.pixelRect.h));
-        }
-
-        if (outSurface.empty())
+        if (!acquireSurface(req.pool, req.pixelRect.w, req.pixelRect.h, outSurface))
             return false;
 
         WGMatrix3x3 off = req.ctm;
@@ -125,6 +143,7 @@ namespace waavs
 
         SVGB2DDriver tmp{};
         tmp.attach(outSurface, 1, &req.drawingState);
+        tmp.setSurfacePool(req.pool);
         //tmp.renew();
 
         // We have to pass along the drawing state
@@ -154,6 +173,110 @@ namespace waavs
 
 namespace waavs {
 
+    using SVGVisualPropertyMap = std::unordered_map<InternedKey, std::shared_ptr<SVGVisualProperty>, InternedKeyHash, InternedKeyEquivalent>;
+
+    //================================================
+    // SVGStyleSharingCache
+    //
+    // Siblings very often end up with exactly the same style,
+    // a few hundred thousand paths in a chart all with the 
+    // same class, say.  Their visual properties come only from
+    // their resolved attributes, so siblings whose style inputs
+    // are the same can share one set of properties, rather 
+    // than each parsing and allocating its own.
+    //
+    // The style inputs are the attributes that have property 
+    // converters, plus 'color', which fill and stroke read
+    // for 'currentColor'.  The cache remembers the last few 
+    // distinct sets it has seen.  It's only used for the 
+    // children of a single parent, so they share the same
+    // inherited context as well.
+    //================================================
+    struct SVGStyleSharingCache
+    {
+        static constexpr size_t kCapacity = 16;
+
+        struct Entry
+        {
+            uint64_t fHash{ 0 };
+            std::vector<std::pair<InternedKey, ByteSpan>> fInputs{};
+            std::shared_ptr<SVGVisualPropertyMap> fProperties{};
+        };
+
+        Entry fEntries[kCapacity]{};
+        size_t fNext{ 0 };
+
+        static bool isStyleInput(InternedKey key) noexcept
+        {
+            return key == svgattr::color() || hasAttributeConverter(key);
+        }
+
+        // Hash of the style inputs, and how many there are
+        static uint64_t signature(const XmlAttributeCollection& attrs, size_t& count) noexcept
+        {
+            uint64_t h = 0xCBF29CE484222325ull;
+            count = 0;
+
+            for (const auto& attr : attrs.values())
+            {
+                if (!isStyleInput(attr.first))
+                    continue;
+
+                // Attributes can come in any order, so each one's
+                // hash is combined in a way that doesn't care
+                uint64_t ah = 0xCBF29CE484222325ull ^ uint64_t(uintptr_t(attr.first));
+                for (unsigned char c : attr.second)
+                    ah = (ah ^ c) * 0x100000001B3ull;
+
+                h += ah * 0x9E3779B97F4A7C15ull;
+                count++;
+            }
+
+            return h;
+        }
+
+        std::shared_ptr<SVGVisualPropertyMap> find(const XmlAttributeCollection& attrs, uint64_t hash, size_t count) noexcept
+        {
+            for (const Entry& e : fEntries)
+            {
+                if (!e.fProperties || e.fHash != hash || e.fInputs.size() != count)
+                    continue;
+
+                bool same = true;
+                for (const auto& input : e.fInputs)
+                {
+                    ByteSpan value{};
+                    if (!attrs.getValue(input.first, value) || value != input.second)
+                    {
+                        same = false;
+                        break;
+                    }
+                }
+
+                if (same)
+                    return e.fProperties;
+            }
+
+            return nullptr;
+        }
+
+        void insert(const XmlAttributeCollection& attrs, uint64_t hash, std::shared_ptr<SVGVisualPropertyMap> props)
+        {
+            Entry& e = fEntries[fNext];
+            fNext = (fNext + 1) % kCapacity;
+
+            e.fHash = hash;
+            e.fInputs.clear();
+            for (const auto& attr : attrs.values())
+            {
+                if (isStyleInput(attr.first))
+                    e.fInputs.emplace_back(attr.first, attr.second);
+            }
+            e.fProperties = std::move(props);
+        }
+    };
+
+
     //================================================
     // SVGGraphicsElement
     //================================================
@@ -169,8 +292,10 @@ namespace waavs {
         bool fStyleResolved{ false };
 
 
-        // The resolved properties of this node
-        std::unordered_map<InternedKey, std::shared_ptr<SVGVisualProperty>, InternedKeyHash, InternedKeyEquivalent> fVisualProperties{};
+        // The resolved properties of this node.  These might be
+        // shared with siblings that have the same style, so they're
+        // copied before they're changed.
+        std::shared_ptr<SVGVisualPropertyMap> fVisualProperties{};
         
         // The child nodes of this element, in tree order.
         // This is all the nodes in the subtree, not just the
@@ -180,6 +305,49 @@ namespace waavs {
         // All the nodes in the subtree which participate in drawing directly.
         std::vector<std::shared_ptr<IViewable>> fRenderNodes{};
 
+        // Bounds, for culling
+        // Where this element drew, in its parent's user space, where
+        // its render nodes drew, in its own user space, and an index
+        // over the render nodes by where they drew.  These are learned
+        // while drawing, and forgotten when the element is rebound, or
+        // something in its subtree changes.  Until then they only grow.
+        WGRectD fDrawnBounds{};
+        bool fHasDrawnBounds{ false };
+        WGRectD fContentBounds{};
+        bool fHasContentBounds{ false };
+        WGRectD fSubtreeBounds{};               // as fContentBounds, before drawSelf()'s transform
+        bool fHasSubtreeBounds{ false };
+        std::unique_ptr<SVGBoundsIndex> fRenderNodeIndex{};
+
+        // Cached union of the render nodes' object bounding boxes
+        WGRectD fCachedObjectBBox{};
+        bool fHasCachedObjectBBox{ false };
+
+        // The target of a <use> is bound again for each instance, and
+        // drawn in more than one context, so while its binding is one
+        // made for a <use>, it doesn't keep an index.  The next binding
+        // made outside of one lets it have an index again.
+        bool fBoundForUse{ false };
+
+        // Scratch for the index's queries, kept so a draw doesn't allocate
+        std::vector<uint32_t> fIndexHits{};
+
+        static constexpr size_t kMinIndexedNodes = 16;
+
+        // Damage
+        // Where the element landed on the target the last time it
+        // was drawn by a driver that tracks damage.  When it changes,
+        // that's reported as damaged, and so is wherever it lands the
+        // next time it's drawn.
+        WGRectD fDeviceBounds{};
+        bool fHasDeviceBounds{ false };
+        bool fIsDirty{ false };             // changed since the last update()
+        bool fReportNextBounds{ false };    // report where it lands next time
+
+        // What the last update() found, for the parent
+        bool fSubtreeChanged{ false };
+        bool fChangeUnplaced{ false };      // changed, and where it was is unknown
+
 
         SVGGraphicsElement()
         {
@@ -191,6 +359,9 @@ namespace waavs {
         // time.
         const WGRectD getObjectBoundingBox(IRenderSVG* ctx, IAmGroot* groot) noexcept
         {
+            if (fHasCachedObjectBBox)
+                return fCachedObjectBBox;
+
             WGRectD bbox{};
             for (auto& node : fRenderNodes)
             {
@@ -201,9 +372,24 @@ namespace waavs {
                 wg_rectD_union(bbox, nodeBox);
             }
 
+            fCachedObjectBBox = bbox;
+            fHasCachedObjectBBox = true;
+
             return bbox;
         }
 
+        // invalidateBounds()
+        //
+        // Forget everything learned about where this element draws
+        void invalidateBounds() noexcept
+        {
+            fHasDrawnBounds = false;
+            fHasContentBounds = false;
+            fHasSubtreeBounds = false;
+            fHasCachedObjectBBox = false;
+            fRenderNodeIndex.reset();
+        }
+
         // hasFeature
         //
         // Indicates whether the node has a particular feature
@@ -263,6 +449,15 @@ namespace waavs {
         }
 
         // Deal with clipping
+        // A clip that comes down to one rectangle in the clipped
+        // element's user space can be left to the driver, without
+        // drawing anything offscreen.  An empty rectangle clips
+        // everything away.  False if the clip needs to be drawn.
+        virtual bool getGeometricClip(IRenderSVG*, IAmGroot*, const WGRectD&, WGRectD&) noexcept
+        {
+            return false;
+        }
+
         virtual bool applyClipToSurface(
             IRenderSVG *ctx,
             IAmGroot* groot,
@@ -272,6 +467,14 @@ namespace waavs {
             return true;
         }
 
+        // Masks and clip paths, for a driver that records effects,
+        // draw their content as a part of the effect on 'plan'
+        virtual bool recordEffectPart(IRenderSVG* ctx, IAmGroot* groot,
+            const IsolatedRenderPlan& plan) noexcept
+        {
+            return false;
+        }
+
 
 
         const BLVar getVariant(IRenderSVG* ctx, IAmGroot* groot) noexcept override
@@ -320,7 +523,7 @@ namespace waavs {
 
         ByteSpan getAttributeByName(const char* name) const noexcept
         {
-            return getAttribute(PSNameTable::INTERN(name));
+            return getAttribute(PSNameScope::LOOKUP(name));
         }
 
         // setting attributes
@@ -329,12 +532,63 @@ namespace waavs {
             fAttributes.addValue(name, value);
         }
 
-        void setAttributeByName(const char* name, const ByteSpan& value) noexcept
+        // changeAttribute()
+        //
+        // Set an attribute on an element that has already been drawn,
+        // as animation does, so it's bound again and redrawn.  If the
+        // attribute is one that's drawn as a property, fill, stroke,
+        // opacity, transform and the like, the property is made again
+        // from the new value.
+        void changeAttribute(InternedKey name, const ByteSpan& value, IAmGroot* groot) noexcept
         {
-            InternedKey key = PSNameTable::INTERN(name);
+            PSNameScopeGuard nameGuard(nameScopeOf(groot));
+
+            setAttribute(name, value);
+
+            // Styles not resolved yet convert everything when they are
+            if (fStyleResolved)
+            {
+                reconvertAttribute(name);
+
+                // paint reads its opacity along with its color
+                if (name == svgattr::fill_opacity())
+                    reconvertAttribute(svgattr::fill());
+                else if (name == svgattr::stroke_opacity())
+                    reconvertAttribute(svgattr::stroke());
+            }
+
+            markDirty();
+        }
+
+        // markDirty()
+        //
+        // Something about the element changed.  It will be bound 
+        // again, and the next update() reports where it was drawn.
+        void markDirty() noexcept
+        {
+            fIsDirty = true;
+            setNeedsBinding(true);
+        }
+
+        void setAttributeByName(const char* name, const ByteSpan& value, IAmGroot* groot) noexcept
+        {
+            PSNameScopeGuard nameGuard(nameScopeOf(groot));
+
+            InternedKey key = PSNameScope::INTERN(name);
             setAttribute(key, value);
         }
 
+        // nameScopeOf()
+        //
+        // The scope names should be interned in, when changing an
+        // element of 'groot'.  If the document doesn't have one,
+        // whatever is already current.
+        static PSNameScope* nameScopeOf(IAmGroot* groot) noexcept
+        {
+            PSNameScope* scope = groot ? groot->nameScope() : nullptr;
+            return scope ? scope : PSNameScope::current();
+        }
+
         // The way the inheritance works is, if we don't currently have
         // a value for a particular attribute, but the referred to element does
         // then we should take that value from the referred to gradient.
@@ -354,13 +608,32 @@ namespace waavs {
         // Property management
         void addVisualProperty(InternedKey key, std::shared_ptr<SVGVisualProperty> prop)
         {
-            fVisualProperties[key] = prop;
+            if (!fVisualProperties)
+                fVisualProperties = std::make_shared<SVGVisualPropertyMap>();
+            else if (fVisualProperties.use_count() > 1)
+                fVisualProperties = std::make_shared<SVGVisualPropertyMap>(*fVisualProperties);
+
+            (*fVisualProperties)[key] = prop;
+        }
+
+        void removeVisualProperty(InternedKey key)
+        {
+            if (!fVisualProperties || fVisualProperties->find(key) == fVisualProperties->end())
+                return;
+
+            if (fVisualProperties.use_count() > 1)
+                fVisualProperties = std::make_shared<SVGVisualPropertyMap>(*fVisualProperties);
+
+            fVisualProperties->erase(key);
         }
 
         std::shared_ptr<SVGVisualProperty> getVisualProperty(InternedKey key) override
         {
-            auto it = fVisualProperties.find(key);
-            if (it != fVisualProperties.end())
+            if (!fVisualProperties)
+                return nullptr;
+
+            auto it = fVisualProperties->find(key);
+            if (it != fVisualProperties->end())
                 return it->second;
 
             return nullptr;
@@ -497,7 +770,10 @@ namespace waavs {
             // If the name of the element is found in the map,
             // then create a new node of that type and add it
             // to the list of nodes.
-            auto node = createContainerNode(iter, groot);
+            std::shared_ptr<IViewable> node = groot ? groot->claimPrebuiltSubtree(iter) : nullptr;
+            if (node == nullptr)
+                node = createContainerNode(iter, groot);
+
             if (node != nullptr) {
                 this->addNode(node, groot);
             }
@@ -624,7 +900,7 @@ namespace waavs {
 
             while (readNextKeyAttribute(src, attrName, attrValue))
             {
-                InternedKey attrKey = PSNameTable::INTERN(attrName);
+                InternedKey attrKey = PSNameScope::INTERN(attrName);
 
                 if (attrKey == svgattr::id())
                 {
@@ -671,50 +947,21 @@ namespace waavs {
             }
 
             // Next in precedence are the CSS based attributes, which can 
-            // come from multiple selectors, so we need to loop through 
-            // all of them and merge them in order of increasing precedence
-            if (groot != nullptr)
+            // come from multiple selectors.  The style sheet finds the 
+            // ones that match, by tag, id, class and attribute, and they
+            // are merged in order of increasing precedence.
+            if (groot != nullptr && !groot->styleSheet().empty())
             {
-                // CSS based on tagname
-                if (nameAtom())
-                {
-                    auto esel = groot->styleSheet().getSelector(CSS_SELECTOR_ELEMENT, nameAtom());
-                    if (esel != nullptr)
-                    {
-                        fAttributes.mergeAttributes(esel->attributes());
-                    }
-                }
-
-                // CSS class list specifier
-                // An element can belong to multiple classes, which
-                // are specified in the 'class' attribute as a whitespace 
-                // delimited list of class names, so we need to loop through 
-                // all of them and merge in any attributes from any matching 
-                // class selectors.
-                ByteSpan classChunk = classAttribute;
-                while (classChunk)
-                {
-                    // peel a word off the front
-                    auto classId = chunk_token(classChunk, chrWspChars);
-                    auto csel = groot->styleSheet().getSelector(CSS_SELECTOR_CLASS, classId);
-                    if (csel != nullptr)
-                    {
-                        fAttributes.mergeAttributes(csel->attributes());
-                    }
-                    else {
-                        //printf("SVGVisualNode::bindPropertiesToGroot, ERROR - NO CLASS SELECTOR FOR %s\n", toString(classId).c_str());
-                    }
-                }
-
-                // CSS ID based selector if we have one
-                if (id())
-                {
-                    auto idsel = groot->styleSheet().getSelector(CSS_SELECTOR_ID, id());
-                    if (idsel != nullptr)
-                    {
-                        fAttributes.mergeAttributes(idsel->attributes());
-                    }
-                }
+                CSSMatchSubject subject{};
+                subject.fTag = nameAtom();
+                subject.fId = id();
+                subject.fClasses = classAttribute;
+                subject.fAttributes = &fAttributes;
+
+                // Attribute selectors see the presentation attributes
+                // only, as all the matching is done before any of the 
+                // rules are merged in
+                groot->styleSheet().applyMatches(subject, fAttributes);
             }
 
 
@@ -736,7 +983,7 @@ namespace waavs {
             if (fAttributes.getValue(svgattr::display(), displayAttr))
             {
                 displayAttr = chunk_trim(displayAttr, chrWspChars);
-                InternedKey dv = PSNameTable::INTERN(displayAttr);
+                InternedKey dv = PSNameScope::LOOKUP(displayAttr);
 
                 if (dv == svgval::none())
                     setIsVisible(false);
@@ -751,25 +998,52 @@ namespace waavs {
         // that have property mappers can be converted 
         // into properties for use during drawing.
         // 
-        void resolveStyleAttributes(IAmGroot* groot)
+        // With a sharing cache, the properties of a sibling 
+        // with the same style are used, if there is one.
+        void resolveStyleAttributes(IAmGroot* groot, SVGStyleSharingCache* sharing = nullptr)
         {
             fixupStyleAttributes(groot);
             fStyleResolved = true;
 
+            if (sharing == nullptr)
+            {
+                convertAttributesToProperties(nullptr, groot);
+                return;
+            }
+
+            size_t inputCount = 0;
+            const uint64_t hash = SVGStyleSharingCache::signature(fAttributes, inputCount);
+            if (inputCount == 0)
+                return;
+
+            if (auto shared = sharing->find(fAttributes, hash, inputCount))
+            {
+                fVisualProperties = std::move(shared);
+                return;
+            }
+
             convertAttributesToProperties(nullptr, groot);
+            if (fVisualProperties)
+                sharing->insert(fAttributes, hash, fVisualProperties);
         }
 
         // This is called after the document is fully loaded
         // and nodes available through groot, but before any
         // drawing has occured.
 
-        void resolveStyleSubtree(IAmGroot* groot)
+        void resolveStyleSubtree(IAmGroot* groot, SVGStyleSharingCache* sharing = nullptr)
         {
             // First resolve our own style attributes, if we haven't already
             if (!fStyleResolved)
-                resolveStyleAttributes(groot);
+                resolveStyleAttributes(groot, sharing);
+
+            if (fChildren.empty())
+                return;
+
+            // Then resolve the subtree, where the children
+            // can share styles amongst themselves
+            SVGStyleSharingCache childSharing{};
 
-            // Then resolve the subtree
             //for (auto& node : fRenderNodes)
             for (auto& node : fChildren)
             {
@@ -779,7 +1053,7 @@ namespace waavs {
                 // Only GraphicsElements have a style attributes and fNodes
                 auto ge = std::dynamic_pointer_cast<SVGGraphicsElement>(node);
                 if (ge) {
-                    ge->resolveStyleSubtree(groot);
+                    ge->resolveStyleSubtree(groot, &childSharing);
                 }
                 else {
 
@@ -795,7 +1069,10 @@ namespace waavs {
         // update themselves
         virtual void updateProperties(IAmGroot* groot)
         {
-            for (auto& prop : fVisualProperties)
+            if (!fVisualProperties)
+                return;
+
+            for (auto& prop : *fVisualProperties)
             {
                 prop.second->update(groot);
             }
@@ -816,6 +1093,45 @@ namespace waavs {
             //this->updateProperties(groot);
             this->updateSelf(groot);
             this->updateChildren(groot);
+
+            collectDamage(groot);
+        }
+
+        // collectDamage()
+        //
+        // After the children have been updated, see what changed.
+        // An element that changed reports where it was drawn.  If it
+        // wasn't drawn where that could be noted, the nearest ancestor
+        // that was reports its own area instead.  Anything that
+        // changed makes the bounds of its ancestors unreliable.
+        void collectDamage(IAmGroot* groot)
+        {
+            bool changed = fIsDirty;
+            bool unplaced = fIsDirty;
+
+            for (auto& node : fChildren)
+            {
+                auto ge = dynamic_cast<SVGGraphicsElement*>(node.get());
+                if (!ge || !ge->fSubtreeChanged)
+                    continue;
+
+                changed = true;
+                unplaced = unplaced || ge->fChangeUnplaced;
+            }
+
+            if (unplaced && fHasDeviceBounds && groot)
+            {
+                groot->addDamage(fDeviceBounds);
+                fReportNextBounds = true;
+                unplaced = false;
+            }
+
+            if (changed)
+                invalidateBounds();
+
+            fIsDirty = false;
+            fSubtreeChanged = changed;
+            fChangeUnplaced = unplaced;
         }
         //========================================
 
@@ -828,7 +1144,7 @@ namespace waavs {
         void convertAttributesToProperties(IRenderSVG* ctx, IAmGroot* groot)
         {
             //
-            for (auto& attr : fAttributes.values())
+            for (const auto& attr : fAttributes.values())
             {
                 // Find an attribute to property converter, if it exists
                 auto propertyMapper = getAttributeConverter(attr.first);
@@ -841,6 +1157,26 @@ namespace waavs {
             }
         }
 
+        // reconvertAttribute()
+        //
+        // Make the property for one attribute again, after its value
+        // changed.  The property map might be shared with siblings of
+        // the same style, so it's copied before it's changed, which
+        // leaves theirs alone.  A value that no longer converts takes
+        // the property away.
+        void reconvertAttribute(InternedKey key)
+        {
+            auto propertyMapper = getAttributeConverter(key);
+            if (!propertyMapper)
+                return;
+
+            auto prop = propertyMapper(fAttributes);
+            if (prop != nullptr)
+                addVisualProperty(key, prop);
+            else
+                removeVisualProperty(key);
+        }
+
         virtual void bindSelfToContext(IRenderSVG*, IAmGroot*) { ; }
         virtual void bindGeometryToContext(IRenderSVG*, IAmGroot*) { ; }
         virtual void bindPaintToContext(IRenderSVG*, IAmGroot*) { ; }
@@ -866,6 +1202,10 @@ namespace waavs {
             // Tell the structure to bind the rest of its stuff
             bindSelfToContext(ctx, groot);
 
+            // Geometry might come out differently this time around
+            invalidateBounds();
+            fBoundForUse = ctx->cullingSuspended();
+
             setNeedsBinding(false);
         }
 
@@ -898,13 +1238,16 @@ namespace waavs {
                 if (!name)
                     continue;
 
-                applyProperty(ctx, groot, PSNameTable::INTERN(name));
+                applyProperty(ctx, groot, PSNameScope::LOOKUP(name));
             }
         }
 
         virtual void applyProperties(IRenderSVG* ctx, IAmGroot* groot)
         {
-            for (auto& prop : fVisualProperties)
+            if (!fVisualProperties)
+                return;
+
+            for (auto& prop : *fVisualProperties)
             {
                 if (prop.second->autoDraw() && prop.second->isSet())
                 {
@@ -913,8 +1256,102 @@ namespace waavs {
             }
         }
 
+        // getVisibleUserRect()
+        //
+        // The visible part of the canvas, in the current user space,
+        // with a pixel of slack for antialiasing.
+        static bool getVisibleUserRect(IRenderSVG* ctx, WGRectD& out) noexcept
+        {
+            WGRectI visible{};
+            if (!ctx->getVisibleRect(visible))
+                return false;
+
+            WGMatrix3x3 inv = ctx->getTransform();
+            if (!inv.invert())
+                return false;
+
+            out = mapRectAABB(inv, WGRectD{ double(visible.x) - 1.0, double(visible.y) - 1.0, double(visible.w) + 2.0, double(visible.h) + 2.0 });
+            return true;
+        }
+
+        // learnSubtreeBounds()
+        //
+        // After all the render nodes have been drawn, gather up where 
+        // they drew.  If they all know, that's the extent of the subtree.  
+        // If there are enough of them, they're indexed, so next time only
+        // the ones that are visible need to be looked at.
+        void learnSubtreeBounds(IRenderSVG* ctx)
+        {
+            bool allBounded = true;
+            WGRectD subtree{};
+            bool hasSubtree = false;
+
+            std::vector<std::pair<uint32_t, WGRectD>> entries{};
+            std::vector<uint32_t> unbounded{};
+
+            for (size_t i = 0; i < fRenderNodes.size(); i++)
+            {
+                auto& node = fRenderNodes[i];
+                if (!node)
+                    continue;
+
+                // Might be visible some other time
+                if (!node->isVisible())
+                {
+                    unbounded.push_back(uint32_t(i));
+                    continue;
+                }
+
+                auto ge = dynamic_cast<SVGGraphicsElement*>(node.get());
+                if (!ge || !ge->fHasDrawnBounds)
+                {
+                    allBounded = false;
+                    unbounded.push_back(uint32_t(i));
+                    continue;
+                }
+
+                entries.emplace_back(uint32_t(i), ge->fDrawnBounds);
+                subtree = hasSubtree ? wg_rectd_merge_rect(subtree, ge->fDrawnBounds) : ge->fDrawnBounds;
+                hasSubtree = true;
+            }
+
+            if (allBounded && hasSubtree)
+            {
+                fSubtreeBounds = fHasSubtreeBounds ? wg_rectd_merge_rect(fSubtreeBounds, subtree) : subtree;
+                fHasSubtreeBounds = true;
+            }
+
+            // Bounds learned in a <use>, or while culling was off for
+            // some other reason, might not hold for the next draw
+            if (fBoundForUse || ctx->cullingSuspended())
+                return;
+
+            if (fRenderNodes.size() >= kMinIndexedNodes && !entries.empty())
+            {
+                fRenderNodeIndex = std::make_unique<SVGBoundsIndex>();
+                fRenderNodeIndex->build(entries, std::move(unbounded));
+            }
+        }
+
         virtual void drawRenderSubtree(IRenderSVG* ctx, IAmGroot* groot)
         {
+            // Once there's an index, only the nodes that land on the
+            // visible part of the canvas are looked at
+            WGRectD visible{};
+            if (fRenderNodeIndex && !ctx->cullingSuspended() && getVisibleUserRect(ctx, visible))
+            {
+                fRenderNodeIndex->query(visible, fIndexHits);
+
+                for (uint32_t idx : fIndexHits)
+                {
+                    auto& node = fRenderNodes[idx];
+                    if (node->isVisible())
+                        node->draw(ctx, groot);
+                }
+
+                return;
+            }
+
             for (auto& node : fRenderNodes)
             {
                 // should we check to see if the node
@@ -925,6 +1362,9 @@ namespace waavs {
                     node->draw(ctx, groot);
                 }
             }
+
+            if (!fRenderNodeIndex)
+                learnSubtreeBounds(ctx);
         }
 
 
@@ -937,9 +1377,30 @@ namespace waavs {
         // All environment preperation occurs outside this call.
         void drawContent(IRenderSVG* ctx, IAmGroot* groot)
         {
+            const WGMatrix3x3 userCtm = ctx->getTransform();
+
             //applyProperties(ctx, groot);
             drawSelf(ctx, groot);
+
+            const WGMatrix3x3 subtreeCtm = ctx->getTransform();
             drawRenderSubtree(ctx, groot);
+
+            // drawSelf() might have set up a coordinate system for the
+            // children, a viewBox say, so their extent is brought back
+            // to this element's user space
+            if (fHasSubtreeBounds && !fRenderNodes.empty())
+            {
+                WGMatrix3x3 inv = userCtm;
+                if (inv.invert())
+                {
+                    WGMatrix3x3 toUser = subtreeCtm;
+                    toUser.postTransform(inv);
+
+                    const WGRectD content = mapRectAABB(toUser, fSubtreeBounds);
+                    fContentBounds = fHasContentBounds ? wg_rectd_merge_rect(fContentBounds, content) : content;
+                    fHasContentBounds = true;
+                }
+            }
         }
 
         WGRectD drawBegin(IRenderSVG* ctx, IAmGroot* groot) 
@@ -995,7 +1456,315 @@ namespace waavs {
 
         void drawEnd(IRenderSVG* ctx, IAmGroot* groot)
         {
+            // Drawn, but there's no telling where
+            if (fReportNextBounds && ctx->tracksDamage() && !ctx->cullingSuspended())
+            {
+                groot->addFullDamage();
+                fReportNextBounds = false;
+            }
+
+            ctx->pop();
+        }
+
+        // canCull()
+        //
+        // Whether everything this element draws is within its object 
+        // bounding box plus its stroke, or for containers, within what
+        // its render nodes draw.  Markers hang off the ends of paths, 
+        // and some elements draw things that aren't render nodes, so
+        // those say no.
+        virtual bool canCull() const noexcept
+        {
+            return true;
+        }
+
+        // getDrawnUserBounds()
+        //
+        // Where the element draws, in its own user space, as far as can
+        // be told.  Has to be called after drawBegin(), so the context 
+        // has the element's transform and stroke.  Elements without
+        // children go by their geometry, and containers by what their
+        // children drew before.  False if there's no telling.
+        bool getDrawnUserBounds(IRenderSVG* ctx, const WGRectD& bbox, const IsolatedRenderPlan& plan, WGRectD& out) const noexcept
+        {
+            // Nothing gets out of a filter region
+            if (plan.hasFilter)
+            {
+                out = plan.effectRectUS;
+                return true;
+            }
+
+            return getContentUserBounds(ctx, bbox, out);
+        }
+
+        // getContentUserBounds()
+        //
+        // As getDrawnUserBounds(), but where the element's own content
+        // goes, before any filter spreads it.
+        bool getContentUserBounds(IRenderSVG* ctx, const WGRectD& bbox, WGRectD& out) const noexcept
+        {
+            if (!canCull())
+                return false;
+
+            if (!fRenderNodes.empty())
+            {
+                if (!fHasContentBounds || ctx->cullingSuspended())
+                    return false;
+
+                out = fContentBounds;
+                return true;
+            }
+
+            // Without any geometry, there's nothing to go on
+            if (!(bbox.w > 0.0) && !(bbox.h > 0.0))
+                return false;
+
+            // Enough for the widest miter or square cap
+            const double miter = std::max(ctx->getStrokeMiterLimit(), 1.5);
+            const double pad = 0.5 * ctx->getStrokeWidth() * miter;
+
+            out = WGRectD{ bbox.x - pad, bbox.y - pad, bbox.w + 2.0 * pad, bbox.h + 2.0 * pad };
+            return true;
+        }
+
+        // rememberDrawnBounds()
+        //
+        // Keep where the element drew, in its parent's user space,
+        // for the parent's index.  'parentCtm' is the transform from 
+        // before drawBegin(), and 'userCtm' the one from after.
+        void rememberDrawnBounds(const WGMatrix3x3& parentCtm, const WGMatrix3x3& userCtm, const WGRectD& userBounds) noexcept
+        {
+            WGMatrix3x3 inv = parentCtm;
+            if (!inv.invert())
+                return;
+
+            WGMatrix3x3 local = userCtm;
+            local.postTransform(inv);
+
+            const WGRectD b = mapRectAABB(local, userBounds);
+            fDrawnBounds = fHasDrawnBounds ? wg_rectd_merge_rect(fDrawnBounds, b) : b;
+            fHasDrawnBounds = true;
+        }
+
+        // rememberContentBounds()
+        //
+        // A container only finds out where it draws by drawing its
+        // children, so the first time through, remember that afterwards.
+        void rememberContentBounds(IRenderSVG* ctx, IAmGroot* groot, const WGMatrix3x3& parentCtm, const WGMatrix3x3& userCtm, bool alreadyKnown) noexcept
+        {
+            if (alreadyKnown || !fHasContentBounds || !canCull() || ctx->cullingSuspended())
+                return;
+
+            rememberDrawnBounds(parentCtm, userCtm, fContentBounds);
+            noteDeviceBounds(ctx, groot, mapRectAABB(userCtm, fContentBounds));
+        }
+
+        // noteDeviceBounds()
+        //
+        // Where the element lands on the target, for damage tracking.
+        // Under a <use>, the same element lands in several places, so
+        // they're all kept.
+        void noteDeviceBounds(IRenderSVG* ctx, IAmGroot* groot, const WGRectD& devRect) noexcept
+        {
+            if (!ctx->tracksDamage())
+                return;
+
+            if (fHasDeviceBounds && ctx->cullingSuspended())
+                fDeviceBounds = wg_rectd_merge_rect(fDeviceBounds, devRect);
+            else
+                fDeviceBounds = devRect;
+            fHasDeviceBounds = true;
+
+            if (fReportNextBounds && groot)
+            {
+                groot->addDamage(devRect);
+                fReportNextBounds = false;
+            }
+        }
+
+        // closeCullRange()
+        //
+        // End the cull range draw() opened, with where the element drew,
+        // if that's known by now.  A container drawn for the first time
+        // only knows once its children have been drawn.  Its content
+        // bounds only grow, so they hold for this draw too.
+        void closeCullRange(IRenderSVG* ctx, bool hasDrawnBounds, const WGRectD& drawnBounds) noexcept
+        {
+            if (hasDrawnBounds)
+                ctx->endCullRange(drawnBounds, true);
+            else if (fHasContentBounds && canCull() && !fRenderNodes.empty())
+                ctx->endCullRange(fContentBounds, true);
+            else
+                ctx->endCullRange(WGRectD{}, false);
+        }
+
+        // isOutsideVisibleRect()
+        //
+        // Whether something with the given bounds, in the current user
+        // space, lands entirely outside the visible part of the canvas.
+        static bool isOutsideVisibleRect(IRenderSVG* ctx, const WGRectD& userBounds) noexcept
+        {
+            WGRectI visible{};
+            if (!ctx->getVisibleRect(visible))
+                return false;
+
+            const WGRectD devRect = mapRectAABB(ctx->getTransform(), userBounds);
+
+            // a pixel of slack for antialiasing
+            const double x0 = devRect.x - 1.0;
+            const double y0 = devRect.y - 1.0;
+            const double x1 = devRect.x + devRect.w + 1.0;
+            const double y1 = devRect.y + devRect.h + 1.0;
+
+            return (x1 <= double(visible.x)) || (y1 <= double(visible.y)) ||
+                (x0 >= double(visible.x + visible.w)) || (y0 >= double(visible.y + visible.h));
+        }
+
+        // getOpacityValue()
+        //
+        // The element's own 'opacity', if it has one that parses
+        bool getOpacityValue(double& value) const noexcept
+        {
+            ByteSpan opacityAttr{};
+            if (!getAttribute(svgattr::opacity(), opacityAttr))
+                return false;
+
+            SVGNumberOrPercent op{};
+            if (!readSVGNumberOrPercent(opacityAttr, op))
+                return false;
+
+            value = op.calculatedValue();
+            return true;
+        }
+
+        // drawGeometricClip()
+        //
+        // Draw the content clipped to a rectangle by the driver, when
+        // the clip comes down to one, and the rectangle stays one on
+        // the target.  False, with nothing drawn, when the clip has to
+        // be drawn offscreen instead.
+        bool drawGeometricClip(IRenderSVG* ctx, IAmGroot* groot, const IsolatedRenderPlan& plan) noexcept
+        {
+            if (!plan.ctm.isScaleTranslate())
+                return false;
+
+            auto clipNode = getReferencedFeatureNode(groot, svgattr::clip_path());
+            if (!clipNode)
+                return false;
+
+            WGRectD clipUS{};
+            if (!clipNode->getGeometricClip(ctx, groot, plan.objectBBoxUS, clipUS))
+                return false;
+
+            // Clipped away entirely
+            if (!(clipUS.w > 0.0) || !(clipUS.h > 0.0))
+                return true;
+
+            double opacityValue = 1.0;
+            const bool withOpacity = plan.hasOpacity && getOpacityValue(opacityValue);
+
+            ctx->push();
+            ctx->clipRect(clipUS);
+
+            // Opacity still needs a group, which only some drivers keep
+            if (withOpacity && !ctx->beginGroup(plan.effectRectUS, opacityValue)) {
+                ctx->pop();
+                return false;
+            }
+
+            drawContent(ctx, groot);
+
+            if (withOpacity)
+                ctx->endGroup();
+
+            ctx->pop();
+
+            return true;
+        }
+
+        // recordFilterImages()
+        //
+        // What the filter's feImage primitives refer to, each drawn once
+        // as a part of the effect, from its own user space.
+        static void recordFilterImages(IRenderSVG* ctx, IAmGroot* groot, const FilterProgramStream& program)
+        {
+            std::vector<InternedKey> hrefs{};
+            collectFilterImageRefs(program, hrefs);
+
+            for (size_t i = 0; i < hrefs.size(); i++)
+            {
+                const InternedKey href = hrefs[i];
+                if (href[0] != '#')
+                    continue;
+
+                if (std::find(hrefs.begin(), hrefs.begin() + i, href) != hrefs.begin() + i)
+                    continue;
+
+                auto elem = groot->findNodeByHref(ByteSpan(href));
+                if (!elem)
+                    continue;
+
+                ctx->beginEffectPart(SVG_EFFECT_IMAGE, WGMatrix3x3::makeIdentity(), href);
+                ctx->push();
+                ctx->transform(WGMatrix3x3::makeIdentity());
+                elem->draw(ctx, groot);
+                ctx->pop();
+                ctx->endEffectPart();
+            }
+        }
+
+        // recordEffect()
+        //
+        // A driver that records effects is handed the effect, and what
+        // goes into it, rather than the pixels, so it can be done at
+        // whatever resolution the recording is played back at.
+        void recordEffect(IRenderSVG* ctx, IAmGroot* groot, const IsolatedRenderPlan& plan)
+        {
+            SVGEffectDesc desc{};
+            desc.fEffectRect = plan.effectRectUS;
+            desc.fObjectBBox = plan.objectBBoxUS;
+
+            if (plan.hasOpacity)
+                getOpacityValue(desc.fOpacity);
+
+            if (plan.hasFilter)
+            {
+                auto filterNode = getReferencedFeatureNode(groot, svgattr::filter());
+                desc.fFilter = filterNode ? filterNode->getFilterProgramStream(groot) : nullptr;
+
+                // Same as drawing it, no program, nothing to show
+                if (!desc.fFilter)
+                    return;
+            }
+
+            ctx->beginEffect(desc);
+
+            ctx->beginEffectPart(SVG_EFFECT_CONTENT);
+            ctx->push();
+            ctx->setObjectFrame(plan.objectBBoxUS);
+            ctx->setViewport(plan.objectBBoxUS);
+            drawContent(ctx, groot);
             ctx->pop();
+            ctx->endEffectPart();
+
+            if (desc.fFilter)
+                recordFilterImages(ctx, groot, *desc.fFilter);
+
+            if (plan.hasMask)
+            {
+                auto featureNode = getReferencedFeatureNode(groot, svgattr::mask());
+                if (featureNode)
+                    featureNode->recordEffectPart(ctx, groot, plan);
+            }
+
+            if (plan.hasClip)
+            {
+                auto featureNode = getReferencedFeatureNode(groot, svgattr::clip_path());
+                if (featureNode)
+                    featureNode->recordEffectPart(ctx, groot, plan);
+            }
+
+            ctx->endEffect();
         }
 
         void draw(IRenderSVG* ctx, IAmGroot* groot, RenderFlags rFlags = RF_All) override
@@ -1003,14 +1772,38 @@ namespace waavs {
             if (!ctx || !groot)
                 return;
 
+            const WGMatrix3x3 parentCtm = ctx->getTransform();
+
             WGRectD bbox = drawBegin(ctx, groot);
+            const WGMatrix3x3 userCtm = ctx->getTransform();
+            ctx->beginCullRange();
 
             IsolatedRenderPlan plan{};
             if (!resolveIsolatedRenderPlan(ctx, groot, this, bbox, rFlags, plan)) {
+                // Nothing drawn, so nothing more to report
+                if (ctx->tracksDamage())
+                    fReportNextBounds = false;
+
+                ctx->endCullRange(WGRectD{}, false);
                 drawEnd(ctx, groot);
                 return;
             }
 
+            // Nothing to do if it all lands outside the visible part 
+            // of the canvas
+            WGRectD drawnBounds{};
+            const bool hasDrawnBounds = getDrawnUserBounds(ctx, bbox, plan, drawnBounds);
+            if (hasDrawnBounds) {
+                rememberDrawnBounds(parentCtm, userCtm, drawnBounds);
+                noteDeviceBounds(ctx, groot, mapRectAABB(userCtm, drawnBounds));
+
+                if (isOutsideVisibleRect(ctx, drawnBounds)) {
+                    closeCullRange(ctx, hasDrawnBounds, drawnBounds);
+                    drawEnd(ctx, groot);
+                    return;
+                }
+            }
+
             // BUGBUG - just for debugging
             //plan.needsIsolation = false;
 
@@ -1018,6 +1811,43 @@ namespace waavs {
             // as per usual
             if (!plan.needsIsolation) {
                 drawContent(ctx, groot);
+                rememberContentBounds(ctx, groot, parentCtm, userCtm, hasDrawnBounds);
+                closeCullRange(ctx, hasDrawnBounds, drawnBounds);
+                drawEnd(ctx, groot);
+                return;
+            }
+
+            // Plain opacity can be left to a driver that keeps
+            // groups of its own
+            if (plan.hasOpacity && !plan.hasFilter && !plan.hasMask && !plan.hasClip) {
+                double opacityValue = 1.0;
+                getOpacityValue(opacityValue);
+
+                if (ctx->beginGroup(plan.effectRectUS, opacityValue)) {
+                    drawContent(ctx, groot);
+                    ctx->endGroup();
+                    rememberContentBounds(ctx, groot, parentCtm, userCtm, hasDrawnBounds);
+                    closeCullRange(ctx, hasDrawnBounds, drawnBounds);
+                    drawEnd(ctx, groot);
+                    return;
+                }
+            }
+
+            // A clip the driver can do itself doesn't need the content,
+            // or the clip, drawn offscreen
+            if (plan.hasClip && !plan.hasFilter && !plan.hasMask) {
+                if (drawGeometricClip(ctx, groot, plan)) {
+                    rememberContentBounds(ctx, groot, parentCtm, userCtm, hasDrawnBounds);
+                    closeCullRange(ctx, hasDrawnBounds, drawnBounds);
+                    drawEnd(ctx, groot);
+                    return;
+                }
+            }
+
+            if (ctx->recordsEffects()) {
+                recordEffect(ctx, groot, plan);
+                rememberContentBounds(ctx, groot, parentCtm, userCtm, hasDrawnBounds);
+                closeCullRange(ctx, hasDrawnBounds, drawnBounds);
                 drawEnd(ctx, groot);
                 return;
             }
@@ -1035,6 +1865,13 @@ namespace waavs {
                     sourceFlags.remove(RF_Mask);
                     sourceFlags.remove(RF_Clip);
 
+                    // The filter may only compute part of the region,
+                    // the mask, clip and compositing follow it
+                    WGRectI filteredRect = plan.pixelRect;
+
+                    WGRectD contentBounds{};
+                    const bool hasContentBounds = getContentUserBounds(ctx, bbox, contentBounds);
+
                     B2DFilterExecutor exec;
                     WGResult err = exec.applyFilterToSurface(
                         ctx,
@@ -1045,7 +1882,11 @@ namespace waavs {
                         plan.pixelRect,
                         *program,
                         result,
-                        sourceFlags);
+                        sourceFlags,
+                        &filteredRect,
+                        hasContentBounds ? &contentBounds : nullptr);
+
+                    plan.pixelRect = filteredRect;
                 }
             }
             else {
@@ -1058,6 +1899,7 @@ namespace waavs {
                 req.ctm = plan.ctm;
                 req.objectBBoxUS = plan.objectBBoxUS;
                 req.renderMode = RF_Content;
+                req.pool = plan.pool;
 
                 renderSubtreeToSurface(groot, this, req, result);
             }
@@ -1087,16 +1929,9 @@ namespace waavs {
                 if (plan.hasOpacity)
                 {
                     //printf("Applying opacity to surface...\n");
-                    ByteSpan opacityAttr{};
-                    if (getAttribute(svgattr::opacity(), opacityAttr))
-                    {
-                        SVGNumberOrPercent op{};
-                        if (readSVGNumberOrPercent(opacityAttr, op))
-                        {
-                            double opacityValue = op.calculatedValue();
-                            ctx->globalOpacity(opacityValue);
-                        }
-                    }
+                    double opacityValue = 1.0;
+                    if (getOpacityValue(opacityValue))
+                        ctx->globalOpacity(opacityValue);
                 }
 
 
@@ -1105,6 +1940,8 @@ namespace waavs {
                 ctx->pop();
             }
 
+            rememberContentBounds(ctx, groot, parentCtm, userCtm, hasDrawnBounds);
+            closeCullRange(ctx, hasDrawnBounds, drawnBounds);
             drawEnd(ctx, groot);
         }
 
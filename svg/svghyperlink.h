@@ -21,7 +21,7 @@ namespace waavs {
 		static void registerSingularNode()
 		{
 			registerSVGSingularNodeByName("a", [](IAmGroot* groot, const XmlElement& elem) {
-				auto node = std::make_shared<SVGAElement>(groot);
+				auto node = makeNode<SVGAElement>(groot);
 				node->loadFromXmlElement(elem, groot);
 
 				return node;
@@ -33,7 +33,7 @@ namespace waavs {
 		{
 			registerContainerNodeByName("a",
 				[](IAmGroot* groot, XmlPull& iter) {
-					auto node = std::make_shared<SVGAElement>(groot);
+					auto node = makeNode<SVGAElement>(groot);
 					node->loadFromXmlPull(iter, groot);
 
 					return node;
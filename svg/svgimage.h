@@ -11,83 +11,12 @@
 
 
 #include "converters.h"
+#include "imagecache.h"
 #include "svgattributes.h"
 #include "svggraphicselement.h"
 
 #include "viewport.h"
 
-namespace waavs {
-    //
-    // parseImage()
-    // 
-    // Turn a base64 encoded inlined image into a Surface
-    // We are handed the attribute, typically coming from a 
-    // href of an <image> tag, or as a lookup for a fill, or stroke, 
-    // paint attribute.
-    // What we're passed are the contents of the 'url()'.  
-    // 
-    // Example: <image id="image_textures" x="0" y="0" width="1024" height="768" xlink:href="data:image/jpeg;base64,/9j/...
-    //
-    static bool parseImage(const ByteSpan& inChunk, BLImage& img)
-    {
-        static int n = 1;
-        bool success{ false };
-        ByteSpan value = chunk_trim(inChunk, chrWspChars);
-
-        // figure out what kind of encoding we're dealing with
-        // value starts with: 'data:image/png;base64,<base64 encoded image>
-        //
-        ByteSpan data = chunk_token(value, ":");
-        auto mime = chunk_token(value, ";");
-        auto encoding = chunk_token(value, ",");
-
-
-        if (encoding == "base64")
-        {
-            // allocate some memory to decode into
-            unsigned int outBuffSize = base64::getDecodeOutputSize(value.size());
-            MemBuff outBuff(outBuffSize);
-
-            size_t decodedSize = base64::decode(value.data(), value.size(), outBuff.data(), outBuffSize);
-
-            // BUGBUG - write chunk to file for debugging
-            //ByteSpan outChunk = ByteSpan(outBuff.data(), outBuff.size());
-            //char filename[256]{ 0 };
-            //sprintf_s(filename, "base64_%02d.dat", n++);
-            //FILE *s = fopen(filename, "wb");
-            //fwrite(outBuff.data(), 1, outBuff.size(), s);
-            //fclose(s);
-
-            
-            if (decodedSize < 1 || decodedSize > outBuffSize) {
-                printf("parseImage: Error in base64::decode, decodedSize: %d \n", decodedSize);
-                return false;
-            }
-            
-            // See if it's a format that blend2d can deal with using its
-            // own codecs
-            BLResult res = img.read_from_data(outBuff.data(), decodedSize);
-
-            success = (res == BL_SUCCESS);
-            
-            // If we didn't succeed in decoding, then try any specilized methods of decoding
-            // we might have.
-            if (!success) {
-                if (mime == "image/gif")
-                {
-                    printf("parseImage:: trying to decode GIF\n");
-                    // try to decode it as a gif
-                    //BLResult res = img.readFromData(outBuff.data(), outBuff.size());
-                    //success = (res == BL_SUCCESS);
-                }
-            }
-            
-        }
-
-        return success;
-    }
-}
-
 namespace waavs 
 {
     struct DocImageState
@@ -126,7 +55,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("image", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGImageElement>(groot);
+                auto node = makeNode<SVGImageElement>(groot);
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -137,7 +66,7 @@ namespace waavs
         {
             registerContainerNodeByName("image",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGImageElement>(groot);
+                    auto node = makeNode<SVGImageElement>(groot);
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -151,6 +80,9 @@ namespace waavs
         DocImageState fDocState{};
 
         // Resolved state of the image
+        // The image data isn't decoded until something needs it,
+        // so images that are never drawn cost nothing.
+        bool fImageLoaded{ false };
         Surface fSurface{};
         BLImage fImage{};
         BLVar fImageVar{};
@@ -189,12 +121,50 @@ namespace waavs
         {
             if (fImageVar.is_null())
             {
+                ensureImageLoaded();
                 bindSelfToContext(ctx, groot);
             }
             
             return fImageVar;
         }
 
+        // ensureImageLoaded()
+        //
+        // Decode the image the first time it's needed.  Whether that
+        // works or not, it's only tried once.
+        void ensureImageLoaded()
+        {
+            if (fImageLoaded)
+                return;
+
+            fImageLoaded = true;
+
+            if (!fDocState.href)
+                return;
+
+            // First, see if it's embedded data
+            if (bspan_starts_with(fDocState.href, "data:"))
+            {
+                if (!parseImage(fDocState.href, fImage))
+                    return;
+
+                fSurface = surfaceFromBLImage(fImage);
+                fImageVar = fImage;
+            }
+            else {
+                // Otherwise, assume it's a file reference
+                auto filepath = toString(fDocState.href);
+                if (filepath.size() > 0)
+                {
+                    if (fImage.read_from_file(filepath.c_str()) == BL_SUCCESS)
+                    {
+                        fSurface = surfaceFromBLImage(fImage);
+                        fImageVar = fImage;
+                    }
+                }
+            }
+        }
+
         void fixupSelfStyleAttributes(IAmGroot*groot) override
         {
             (void)groot;
@@ -208,35 +178,9 @@ namespace waavs
             if (par)
                 fPAR.loadFromChunk(par);
 
-
-            // We can parse the image here, because the href is not
-            // subject to change over time, so we don't need to delay 
-            // until bind time.
-            if (fDocState.href)
-            {
-                // First, see if it's embedded data
-                if (bspan_starts_with(fDocState.href, "data:"))
-                {
-                    if (!parseImage(fDocState.href, fImage))
-                        return;
-
-                    fSurface = surfaceFromBLImage(fImage);
-                    fImageVar = fImage;
-                }
-                else {
-                    // Otherwise, assume it's a file reference
-                    auto filepath = toString(fDocState.href);
-                    if (filepath.size() > 0)
-                    {
-                        if (fImage.read_from_file(filepath.c_str()) == BL_SUCCESS)
-                        {
-                            fSurface = surfaceFromBLImage(fImage);
-                            fImageVar = fImage;
-                        }
-                    }
-                }
-            }
-
+            // The href is not subject to change over time, but decoding
+            // it is expensive, so that waits until the image is needed,
+            // either to be drawn, or for its size.
         }
 
 
@@ -258,6 +202,10 @@ namespace waavs
             cy = makeLengthCtxUser(paintVP.h, 0.0, dpi, fontOpt);
             cw = cx; ch = cy;
 
+            // Without an explicit size, the image's own size is needed
+            if (!fDocState.width.isSet() || !fDocState.height.isSet())
+                ensureImageLoaded();
+
             fX = resolveLengthOr(fDocState.x, cx, 0);
             fY = resolveLengthOr(fDocState.y, cy, 0);
             fWidth = resolveLengthOr(fDocState.width, cw, fImage.size().w);
@@ -267,29 +215,31 @@ namespace waavs
 
         void drawSelf(IRenderSVG* ctx, IAmGroot* groot) override
         {
-            if (fImage.is_empty())
-                return;
-            
             if (fWidth <= 0 || fHeight <= 0)
                 return;
 
-            // The image's intrinsic size in pixels
-            const double iw = double(fImage.size().w);
-            const double ih = double(fImage.size().h);
-            if (iw <= 0.0 || ih <= 0.0)
-                return;
-
             // don't display, if we have a display attribute of 'none'
             ByteSpan displayAttr{};
             if (fAttributes.getValue(svgattr::display(), displayAttr))
             {
                 displayAttr = chunk_trim(displayAttr, chrWspChars);
-                InternedKey dv = PSNameTable::INTERN(displayAttr);
+                InternedKey dv = PSNameScope::LOOKUP(displayAttr);
 
                 if (dv == svgval::none())
                     return;
             }
 
+            ensureImageLoaded();
+
+            if (fImage.is_empty())
+                return;
+
+            // The image's intrinsic size in pixels
+            const double iw = double(fImage.size().w);
+            const double ih = double(fImage.size().h);
+            if (iw <= 0.0 || ih <= 0.0)
+                return;
+
             // We want to apply the preserveAspectRatio rules to determine 
             // how to fit the image into the specified width/height.
             const WGRectD viewport{ fX, fY, fWidth, fHeight };
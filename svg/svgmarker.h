@@ -71,7 +71,7 @@ namespace waavs {
         {
             registerContainerNodeByName("marker",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGMarkerElement>(groot);
+                    auto node = makeNode<SVGMarkerElement>(groot);
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
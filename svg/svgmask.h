@@ -25,7 +25,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("mask", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGMaskElement>();
+                auto node = makeNode<SVGMaskElement>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -37,7 +37,7 @@ namespace waavs
         {
             registerContainerNodeByName("mask",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGMaskElement>();
+                    auto node = makeNode<SVGMaskElement>();
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -85,7 +85,7 @@ namespace waavs
             fAttributes.getValue(svgattr::mask_type(), maskTypeAttr);
             if (maskTypeAttr)
             {
-                InternedKey maskTypeKey = PSNameTable::INTERN(maskTypeAttr);
+                InternedKey maskTypeKey = PSNameScope::LOOKUP(maskTypeAttr);
                 if (maskTypeKey == svgval::luminance())
                     fMaskType = MASKTYPE_LUMINANCE;
                 else if (maskTypeKey == svgval::alpha())
@@ -97,7 +97,7 @@ namespace waavs
             fAttributes.getValue(svgattr::mask_units(), maskUnitsAttr);
             if (maskUnitsAttr)
             {
-                InternedKey maskUnitsKey = PSNameTable::INTERN(maskUnitsAttr);
+                InternedKey maskUnitsKey = PSNameScope::LOOKUP(maskUnitsAttr);
                 if (maskUnitsKey == svgval::userSpaceOnUse())
                     fMaskUnits = SpaceUnitsKind::SVG_SPACE_USER;
                 else if (maskUnitsKey == svgval::objectBoundingBox())
@@ -109,7 +109,7 @@ namespace waavs
             fAttributes.getValue(svgattr::mask_content_units(), maskContentUnitsAttr);
             if (maskContentUnitsAttr)
             {
-                InternedKey maskContentUnitsKey = PSNameTable::INTERN(maskContentUnitsAttr);
+                InternedKey maskContentUnitsKey = PSNameScope::LOOKUP(maskContentUnitsAttr);
                 if (maskContentUnitsKey == svgval::userSpaceOnUse())
                     fMaskContentUnits = SpaceUnitsKind::SVG_SPACE_USER;
                 else if (maskContentUnitsKey == svgval::objectBoundingBox())
@@ -172,6 +172,23 @@ namespace waavs
         }
         */
 
+        // contentUnitsTransform()
+        //
+        // Maps the mask's content into the masked element's user
+        // space, ahead of the element's transform
+        WGMatrix3x3 contentUnitsTransform(const WGRectD& objectBBoxUS) const noexcept
+        {
+            WGMatrix3x3 obb = WGMatrix3x3::makeIdentity();
+
+            if (fMaskContentUnits == SpaceUnitsKind::SVG_SPACE_OBJECT)
+            {
+                obb.translate(objectBBoxUS.x, objectBBoxUS.y);
+                obb.scale(objectBBoxUS.w, objectBBoxUS.h);
+            }
+
+            return obb;
+        }
+
         bool renderMaskSurface(
             IAmGroot* groot,
             const IsolatedRenderPlan& plan,
@@ -180,16 +197,8 @@ namespace waavs
             if (!groot)
                 return false;
 
-            WGMatrix3x3 maskCtm = plan.ctm;
-
-            if (fMaskContentUnits == SpaceUnitsKind::SVG_SPACE_OBJECT)
-            {
-                WGMatrix3x3 obb = WGMatrix3x3::makeIdentity();
-                obb.translate(plan.objectBBoxUS.x, plan.objectBBoxUS.y);
-                obb.scale(plan.objectBBoxUS.w, plan.objectBBoxUS.h);
-
-                maskCtm.postTransform(obb);
-            }
+            WGMatrix3x3 maskCtm = contentUnitsTransform(plan.objectBBoxUS);
+            maskCtm.postTransform(plan.ctm);
 
             IsolatedSubtreeRequest req{};
             //SVGDrawigState* ds = ctx->getDrawingState();
@@ -201,6 +210,7 @@ namespace waavs
             req.objectBBoxUS = plan.objectBBoxUS;
             req.renderMode = RF_Content;
             req.clear = true;
+            req.pool = plan.pool;
 
             return renderSubtreeToSurface(groot, this, req, outMask);
         }
@@ -227,6 +237,23 @@ namespace waavs
             return true;
         }
 
+        bool recordEffectPart(IRenderSVG* ctx, IAmGroot* groot,
+            const IsolatedRenderPlan& plan) noexcept override
+        {
+            const SVGEffectPartKind kind = (maskType() == MASKTYPE_ALPHA) ? SVG_EFFECT_MASK_ALPHA : SVG_EFFECT_MASK_LUMINANCE;
+
+            ctx->beginEffectPart(kind, contentUnitsTransform(plan.objectBBoxUS));
+            ctx->push();
+            ctx->copyDrawingState(SVGDrawingState{});
+            ctx->setObjectFrame(plan.objectBBoxUS);
+            ctx->setViewport(plan.objectBBoxUS);
+            drawContent(ctx, groot);
+            ctx->pop();
+            ctx->endEffectPart();
+
+            return true;
+        }
+
     };
 
 
@@ -17,7 +17,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("desc", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGDescNode>(groot);
+                auto node = makeNode<SVGDescNode>(groot);
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -29,7 +29,7 @@ namespace waavs
         {
             registerContainerNodeByName("desc",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGDescNode>(groot);
+                    auto node = makeNode<SVGDescNode>(groot);
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -69,7 +69,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("title", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGTitleNode>(groot);
+                auto node = makeNode<SVGTitleNode>(groot);
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -81,7 +81,7 @@ namespace waavs
         {
             registerContainerNodeByName("title",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGTitleNode>(groot);
+                    auto node = makeNode<SVGTitleNode>(groot);
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
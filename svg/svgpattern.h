@@ -32,7 +32,7 @@ namespace waavs
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("pattern", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGPatternElement>(groot);
+                auto node = makeNode<SVGPatternElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 return node;
                 });
@@ -42,7 +42,7 @@ namespace waavs
         {
             registerContainerNodeByName("pattern",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGPatternElement>(groot);
+                    auto node = makeNode<SVGPatternElement>(groot);
                     node->loadFromXmlPull(iter, groot);
                     return node;
                 });
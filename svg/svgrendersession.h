@@ -0,0 +1,209 @@
+#pragma once
+
+//
+// Render sessions
+//
+// Drawing a document changes it.  Nodes bind themselves to the
+// context, build their geometry, resolve paint servers, fill in
+// pattern tiles, and remember where they landed, all as they go.  So
+// one document can't be drawn from several threads at once, see
+// SVGDocument::draw().
+//
+// What one render needs is split in two:
+//  - An SVGFrozenDocument, everything that's the same no matter
+//    who's drawing.  The document is walked once, which is when all
+//    the changes happen, into a display list, see svgdisplaylist.h.
+//    Nothing about it changes after that, so any number of threads
+//    can share it.
+//  - An SVGRenderSession, everything that's particular to a render.
+//    The driver, with its state stack and clipping, the pixels,
+//    and the offscreen surfaces for filters, masks and such.  Each
+//    thread has its own, and reuses it from one render to the next.
+//
+// Freezing is the one part that has to happen on a single thread,
+// and it doesn't draw any pixels.  It walks the tree, and writes
+// down paths, paints and text, with their transforms.  Filters,
+// masks and clip paths are written down as effects, the filter
+// program plus what goes into it, and opacity as groups.  All the
+// pixel work, including running the filters, happens when a session
+// replays the list, at that session's resolution, and in parallel
+// when there are several sessions.
+//
+// So a frozen document is drawn at whatever size, or whatever part
+// of it, each session asks for, and stays sharp.  Only pattern tiles
+// are pixels, made the way the document would have made them.
+//
+// A frozen document is a snapshot.  Changes made to the document
+// afterwards aren't seen until it's frozen again.
+//
+
+#include <memory>
+
+#include "svgdisplaylist.h"
+#include "viewport.h"
+
+
+namespace waavs
+{
+    //
+    // SVGFrozenDocument
+    //
+    struct SVGFrozenDocument
+    {
+        std::shared_ptr<const SVGDisplayList> fList{};
+
+        // The extent of the document, in its own units
+        WGRectD fSceneFrame{};
+
+        // What the list was recorded under, mapping the document's
+        // units to the recording canvas
+        WGMatrix3x3 fCanvasTransform{ WGMatrix3x3::makeIdentity() };
+
+        // replayTransform()
+        //
+        // The base transform for replaying the list, such that the
+        // document lands on the target through 'sceneToTarget'
+        bool replayTransform(const WGMatrix3x3& sceneToTarget, WGMatrix3x3& out) const noexcept
+        {
+            WGMatrix3x3 canvasToScene = fCanvasTransform;
+            if (!canvasToScene.invert())
+                return false;
+
+            out = canvasToScene;
+            out.postTransform(sceneToTarget);
+
+            return true;
+        }
+    };
+
+
+    // freezeDocument()
+    //
+    // Record 'doc' once, through 'canvasTransform', into a frozen
+    // document that can be shared between threads.  This is the
+    // only part that changes 'doc', so it must not be drawn anywhere
+    // else at the same time.  The transform is only where the list's
+    // coordinates start from, it doesn't fix the resolution of
+    // anything in it.
+    static INLINE std::shared_ptr<const SVGFrozenDocument> freezeDocument(SVGDocument& doc,
+        const WGMatrix3x3& canvasTransform = WGMatrix3x3::makeIdentity())
+    {
+        auto frozen = std::make_shared<SVGFrozenDocument>();
+        frozen->fSceneFrame = doc.objectBoundingBox();
+        frozen->fCanvasTransform = canvasTransform;
+
+        SVGRecordingDriver rec{};
+        rec.renew();
+        rec.transform(canvasTransform);
+
+        doc.draw(&rec, &doc);
+
+        frozen->fList = rec.finish(doc.canvasWidth(), doc.canvasHeight(), doc.sharedNameScope());
+
+        return frozen;
+    }
+
+
+    //
+    // SVGRenderSession
+    //
+    struct SVGRenderSession
+    {
+        SVGB2DDriver fDriver{};
+        Surface fPixels{};
+        SurfacePool fSurfacePool{};     // offscreen surfaces, kept from one render to the next
+        int fBlendThreads{ 0 };
+
+        SVGRenderSession(int blendThreads = 0) noexcept
+            : fBlendThreads(blendThreads)
+        {
+            fDriver.setSurfacePool(&fSurfacePool);
+        }
+
+        SVGRenderSession(const SVGRenderSession&) = delete;
+        SVGRenderSession& operator=(const SVGRenderSession&) = delete;
+
+        const Surface& pixels() const noexcept { return fPixels; }
+
+        // renderInto()
+        //
+        // Draw 'doc' into 'target', with 'sceneToTarget' mapping the
+        // document's units onto the target's pixels.
+        bool renderInto(const SVGFrozenDocument& doc, Surface& target, const WGMatrix3x3& sceneToTarget, BLRgba32 background = BLRgba32(0x00000000))
+        {
+            if (!doc.fList || target.empty())
+                return false;
+
+            WGMatrix3x3 base{};
+            if (!doc.replayTransform(sceneToTarget, base))
+                return false;
+
+            fDriver.attach(target, fBlendThreads);
+            fDriver.background(background);
+            fDriver.renew();
+            fDriver.clearToBackground();
+
+            doc.fList->replay(fDriver, base);
+
+            fDriver.detach();
+
+            return true;
+        }
+
+        // renderTile()
+        //
+        // As renderInto(), for one tile of a larger canvas.  'tile' is
+        // the tile's pixels, and (originX, originY) where it sits on the
+        // canvas 'sceneToCanvas' maps onto.  Tiles of the same canvas
+        // can share 'effects', so filters are only run once.
+        bool renderTile(const SVGFrozenDocument& doc, Surface& tile, int originX, int originY,
+            const WGMatrix3x3& sceneToCanvas, BLRgba32 background = BLRgba32(0x00000000),
+            SVGEffectCache* effects = nullptr)
+        {
+            if (!doc.fList || tile.empty())
+                return false;
+
+            WGMatrix3x3 base{};
+            if (!doc.replayTransform(sceneToCanvas, base))
+                return false;
+
+            fDriver.attachTile(tile, originX, originY, fBlendThreads);
+            fDriver.background(background);
+            fDriver.renew();
+            fDriver.clearToBackground();
+
+            doc.fList->replay(fDriver, base, effects);
+
+            fDriver.detach();
+
+            return true;
+        }
+
+        // render()
+        //
+        // Draw 'view', a part of the document in its own units, fit
+        // to a width x height image, which the session keeps.  An
+        // empty 'view' is the whole document.
+        bool render(const SVGFrozenDocument& doc, int width, int height,
+            const WGRectD& view = WGRectD{}, BLRgba32 background = BLRgba32(0x00000000))
+        {
+            if (width <= 0 || height <= 0)
+                return false;
+
+            if (int(fPixels.width()) != width || int(fPixels.height()) != height)
+            {
+                if (!fPixels.reset(width, height))
+                    return false;
+            }
+
+            const WGRectD& sceneView = (view.w > 0.0 && view.h > 0.0) ? view : doc.fSceneFrame;
+
+            WGMatrix3x3 sceneToTarget = WGMatrix3x3::makeIdentity();
+            PreserveAspectRatio par{};
+            if (sceneView.w > 0.0 && sceneView.h > 0.0)
+                computeViewBoxToViewport(WGRectD{ 0, 0, double(width), double(height) }, sceneView, par, sceneToTarget);
+
+            return renderInto(doc, fPixels, sceneToTarget, background);
+        }
+    };
+}
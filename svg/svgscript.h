@@ -21,7 +21,7 @@ namespace waavs {
         {
             registerContainerNode("script",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGScriptElement>(groot);
+                    auto node = makeNode<SVGScriptElement>(groot);
                     node->loadFromXmlPull(iter, groot);
                     return node;
                 });
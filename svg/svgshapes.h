@@ -107,6 +107,9 @@ namespace waavs
         // Indication of whether we have markers or not
         bool fHasMarkers{ false };
 
+        // Markers are drawn outside the path's bounds
+        bool canCull() const noexcept override { return !fHasMarkers && SVGGraphicsElement::canCull(); }
+
 
         SVGPathBasedGeometry(IAmGroot* iMap)
             :SVGGraphicsElement()
@@ -358,14 +361,14 @@ namespace waavs {
 
         static void registerFactory() {
             registerSVGSingularNodeByName("line", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGLineElement>(groot);
+                auto node = makeNode<SVGLineElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 return node;
             });
 
             registerContainerNodeByName("line",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGLineElement>(groot);
+                    auto node = makeNode<SVGLineElement>(groot);
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -545,7 +548,7 @@ namespace waavs {
     {
         static void registerSingular() {
             registerSVGSingularNodeByName("rect", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGRectElement>(groot);
+                auto node = makeNode<SVGRectElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 return node;
                 });
@@ -554,7 +557,7 @@ namespace waavs {
         static void registerFactory() {
             registerContainerNodeByName("rect",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGRectElement>(groot);
+                    auto node = makeNode<SVGRectElement>(groot);
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -653,7 +656,7 @@ namespace waavs {
     {
         static void registerSingular() {
             registerSVGSingularNodeByName("circle", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGCircleElement>();
+                auto node = makeNode<SVGCircleElement>();
                 node->loadFromXmlElement(elem, groot);
                 return node;
                 });
@@ -662,7 +665,7 @@ namespace waavs {
         static void registerFactory() {
             registerContainerNodeByName("circle",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGCircleElement>();
+                    auto node = makeNode<SVGCircleElement>();
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -749,14 +752,14 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGSingularNodeByName("ellipse", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGEllipseElement>(groot);
+                auto node = makeNode<SVGEllipseElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 
                 return node; });
 
             registerContainerNodeByName("ellipse",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGEllipseElement>(groot);
+                    auto node = makeNode<SVGEllipseElement>(groot);
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -898,7 +901,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGSingularNodeByName("polyline", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGPolylineElement>(groot);
+                auto node = makeNode<SVGPolylineElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 
                 return node;
@@ -906,7 +909,7 @@ namespace waavs {
 
             registerContainerNodeByName("polyline",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGPolylineElement>(groot);
+                    auto node = makeNode<SVGPolylineElement>(groot);
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -954,7 +957,7 @@ namespace waavs {
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("polygon", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGPolygonElement>(groot);
+                auto node = makeNode<SVGPolygonElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 return node;
                 });
@@ -963,7 +966,7 @@ namespace waavs {
         static void registerFactory() {
             registerContainerNodeByName("polygon",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGPolygonElement>(groot);
+                    auto node = makeNode<SVGPolygonElement>(groot);
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -1004,7 +1007,7 @@ namespace waavs {
     {
         static void registerSingularNode() {
             registerSVGSingularNodeByName(svgtag::tag_path(), [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGPathElement>(groot);
+                auto node = makeNode<SVGPathElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 
                 return node;
@@ -1015,7 +1018,7 @@ namespace waavs {
         {
             registerContainerNodeByName(svgtag::tag_path(),
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGPathElement>(groot);
+                    auto node = makeNode<SVGPathElement>(groot);
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -1040,7 +1043,8 @@ namespace waavs {
             if (d) {
                 fProg.clear();
                 invalidateGeometry();
-                parsePathProgram(d, fProg);
+                if (!groot || !groot->findPrecompiledPath(d, fProg))
+                    parsePathProgram(d, fProg);
             }
 
         }
@@ -17,7 +17,7 @@ namespace waavs {
     {
         static void registerFactory() {
             registerSVGSingularNodeByName("solidColor", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGSolidColorElement>();
+                auto node = makeNode<SVGSolidColorElement>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
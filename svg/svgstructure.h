@@ -30,7 +30,7 @@ namespace waavs {
         {
             registerContainerNodeByName("svg",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGSVGElement>(groot);
+                    auto node = makeNode<SVGSVGElement>(groot);
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
@@ -152,7 +152,7 @@ namespace waavs {
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("g", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGGElement>();
+                auto node = makeNode<SVGGElement>();
                 node->loadFromXmlElement(elem, groot);
 
                 return node;
@@ -164,7 +164,7 @@ namespace waavs {
         {
             registerContainerNodeByName("g",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGGElement>();
+                    auto node = makeNode<SVGGElement>();
                     node->loadFromXmlPull(iter, groot);
 
                     return node;
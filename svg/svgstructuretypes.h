@@ -21,6 +21,8 @@
 #include "stopwatch.h"
 
 #include "svgatoms.h"
+#include "nodearena.h"
+#include "pathprogram.h"
 
 
 
@@ -60,6 +62,9 @@ namespace waavs {
         bool hasMask = false;
         bool hasClip = false;
         bool hasOpacity = false;
+
+        // Where the offscreen surfaces come from, if anywhere
+        SurfacePool* pool = nullptr;
     };
 
 
@@ -75,6 +80,8 @@ namespace waavs {
         RenderFlags renderMode = RenderFeature::RF_All;
 
         bool clear = true;
+
+        SurfacePool* pool = nullptr;
     };
 
     // -----------------------------------------
@@ -271,6 +278,16 @@ namespace waavs
 
         return nullptr;
     }
+
+    // Same as getAttributeConverter() != nullptr, without copying the converter
+    static bool hasAttributeConverter(InternedKey k)
+    {
+        if (!k)
+            return false;
+
+        auto& mapper = getPropertyConstructionMap();
+        return mapper.find(k) != mapper.end();
+    }
 }
 
 
@@ -385,6 +402,31 @@ namespace waavs
 
         virtual ByteSpan systemLanguage() { return "en"; } // BUGBUG - What a big cheat!!
 
+        // The names interned for this document.  Anything that changes
+        // the document after it's loaded makes this current while it
+        // works, so new names land where the loaded ones did.
+        // nullptr means the global name table.
+        virtual PSNameScope* nameScope() noexcept { return nullptr; }
+
+        // Subtrees may have been constructed ahead of time, off the
+        // main loading thread.  When the iterator is sitting just past
+        // the start tag of one of them, return that node, with the
+        // iterator moved past its end tag.  Otherwise return nullptr,
+        // and the subtree is loaded as usual.
+        virtual std::shared_ptr<IViewable> claimPrebuiltSubtree(XmlPull&) { return nullptr; }
+
+        // A document loaded from a precompiled image has the programs
+        // for its path data ready made.  If 'd' is one of those, copy
+        // it into 'prog', otherwise return false, and it gets parsed.
+        virtual bool findPrecompiledPath(const ByteSpan&, PathProgram&) { return false; }
+
+        // Elements that change report where they were drawn before,
+        // and where they're drawn after, in device pixels, so a view 
+        // can redraw just those parts.  When there's no telling, the
+        // whole thing is damaged.  By default, nobody's listening.
+        virtual void addDamage(const WGRectD&) {}
+        virtual void addFullDamage() {}
+
         virtual double canvasWidth() const = 0;
         virtual double canvasHeight() const = 0;
         
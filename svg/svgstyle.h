@@ -27,7 +27,7 @@ namespace waavs {
 		{
 			registerContainerNodeByName("style",
 				[](IAmGroot* groot, XmlPull& iter) {
-					auto node = std::make_shared<SVGStyleNode>(groot);
+					auto node = makeNode<SVGStyleNode>(groot);
 					node->loadFromXmlPull(iter, groot);
 					return node;
 				});
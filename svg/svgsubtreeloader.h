@@ -0,0 +1,293 @@
+#pragma once
+
+//
+// Parallel subtree loading
+//
+// Large documents, maps in particular, tend to be a root <svg> with
+// a long list of sibling layers under it, each a <g> with thousands
+// of shapes.  Those layers don't depend on each other while they're
+// being constructed, so they can be built concurrently.
+//
+// Loading then happens in three steps:
+//  1) A structural pre-scan, with no attribute scanning, finds the
+//     byte range of each subtree directly under the root <svg>
+//  2) Worker threads construct the larger of those subtrees, each
+//     against an SVGSubtreeGroot.  That only reads the document, as
+//     it was before the workers started, and keeps whatever would
+//     have been written to it; id registrations, entities, and the
+//     rules of <style> elements.
+//  3) The regular single threaded load runs as always, and when it
+//     reaches the start of a subtree that has already been built, it
+//     claims that node, replays what the subtree would have written
+//     to the document, and skips ahead to its end tag.
+//
+// Since step 3 adds the nodes in document order, and the writes
+// happen at the same point they would have otherwise, paint order,
+// id lookups and style rule order are unchanged.  Nothing writes to 
+// the document while the workers are running.
+//
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "svgstructuretypes.h"
+
+
+namespace waavs
+{
+    // SVGSubtreeView
+    //
+    // What the workers may know about the document.  Taken on the
+    // loading thread before they start, and only read after that.
+    struct SVGSubtreeView
+    {
+        const IAmGroot* fDocument{ nullptr };
+        PSNameScope* fNames{ nullptr };
+        ByteSpan fSystemLanguage{};
+        double fCanvasWidth{ 0 };
+        double fCanvasHeight{ 0 };
+        double fDpi{ 96 };
+
+        explicit SVGSubtreeView(IAmGroot* doc)
+            : fDocument(doc)
+            , fNames(doc->nameScope())
+            , fSystemLanguage(doc->systemLanguage())
+            , fCanvasWidth(doc->canvasWidth())
+            , fCanvasHeight(doc->canvasHeight())
+            , fDpi(doc->dpi())
+        {
+        }
+    };
+
+
+    // SVGSubtreeGroot
+    //
+    // Stands in for the document while a subtree is constructed on
+    // a worker thread.  Queries look at what the subtree has added so
+    // far, then at the document.  Whatever would change the document
+    // is kept here instead, to be replayed by the document, in order.
+    struct SVGSubtreeGroot : public IAmGroot
+    {
+        const SVGSubtreeView& fView;
+
+        // In the order they were made
+        std::vector<std::pair<ByteSpan, std::shared_ptr<IViewable>>> fReferences{};
+        std::vector<std::pair<ByteSpan, ByteSpan>> fEntityWrites{};
+
+        // Rules from <style> elements within the subtree.  Style is
+        // resolved once the whole document is loaded, so nothing 
+        // built here needs to see the document's own rules.
+        CSSStyleSheet fStyleSheet{};
+
+        explicit SVGSubtreeGroot(const SVGSubtreeView& view) noexcept
+            : fView(view)
+        {
+        }
+
+        void addElementReference(const ByteSpan& name, std::shared_ptr<IViewable> obj) override
+        {
+            fReferences.emplace_back(name, obj);
+            IAmGroot::addElementReference(name, std::move(obj));
+        }
+
+        std::shared_ptr<IViewable> getElementById(const ByteSpan& name) override
+        {
+            if (auto node = IAmGroot::getElementById(name))
+                return node;
+
+            const auto& defs = fView.fDocument->fDefinitions;
+            auto it = defs.find(name);
+            return it != defs.end() ? it->second : nullptr;
+        }
+
+        void addXmlEntity(const ByteSpan& name, ByteSpan expansion) override
+        {
+            fEntityWrites.emplace_back(name, expansion);
+            IAmGroot::addXmlEntity(name, expansion);
+        }
+
+        ByteSpan findXmlEntity(const ByteSpan& name) override
+        {
+            if (ByteSpan local = IAmGroot::findXmlEntity(name))
+                return local;
+
+            const auto& ents = fView.fDocument->fEntities;
+            auto it = ents.find(name);
+            return it != ents.end() ? it->second : ByteSpan{};
+        }
+
+        const CSSStyleSheet& styleSheet() const override { return fView.fDocument->styleSheet(); }
+        CSSStyleSheet& styleSheet() override { return fStyleSheet; }
+
+        ByteSpan systemLanguage() override { return fView.fSystemLanguage; }
+        PSNameScope* nameScope() noexcept override { return fView.fNames; }
+
+        // Precompiled images are never loaded in parallel
+        bool findPrecompiledPath(const ByteSpan&, PathProgram&) override { return false; }
+
+        double canvasWidth() const override { return fView.fCanvasWidth; }
+        double canvasHeight() const override { return fView.fCanvasHeight; }
+
+        double dpi() const override { return fView.fDpi; }
+        void setDpi(const double) override {}
+    };
+
+
+    // SVGPrebuiltSubtree
+    //
+    // One subtree, by byte range within the document source, and
+    // what was built from it.
+    struct SVGPrebuiltSubtree
+    {
+        const unsigned char* fStart{ nullptr };         // the '<' of the start tag
+        const unsigned char* fAfterStartTag{ nullptr }; // just past the start tag's '>'
+        const unsigned char* fEnd{ nullptr };           // just past the end tag's '>'
+
+        std::shared_ptr<IViewable> fNode{};
+
+        // What building it would have written to the document
+        std::vector<std::pair<ByteSpan, std::shared_ptr<IViewable>>> fReferences{};
+        std::vector<std::pair<ByteSpan, ByteSpan>> fEntities{};
+        std::shared_ptr<CSSStyleSheet> fStyleSheet{};
+
+        size_t size() const noexcept { return size_t(fEnd - fStart); }
+    };
+
+
+    // findRootSubtrees()
+    //
+    // Structural pre-scan of a document.  Find the subtrees directly
+    // under the root <svg> that are at least 'minBytes' long.  A DOCTYPE, if there is one, is handed back in
+    // 'docType', as entities need to be known before construction starts.
+    static INLINE void findRootSubtrees(const ByteSpan& src, size_t minBytes,
+        std::vector<SVGPrebuiltSubtree>& outSubtrees, XmlElement& docType)
+    {
+        XmlPull iter(src, false);
+
+        int depth = 0;
+        bool inCandidate = false;
+        SVGPrebuiltSubtree candidate{};
+
+        const unsigned char* before = iter.position();
+
+        while (iter.next())
+        {
+            const XmlElement& elem = *iter;
+
+            switch (elem.kind())
+            {
+            case XML_ELEMENT_TYPE_START_TAG:
+            {
+                if (depth == 0 && elem.nameAtom() != svgtag::tag_svg())
+                    return;
+
+                if (depth == 1)
+                {
+                    // The element might be preceded by whitespace
+                    const unsigned char* lt = (const unsigned char*)memchr(before, '<', size_t(iter.position() - before));
+
+                    candidate = {};
+                    candidate.fStart = lt;
+                    candidate.fAfterStartTag = iter.position();
+                    inCandidate = (lt != nullptr);
+                }
+
+                depth++;
+            } break;
+
+            case XML_ELEMENT_TYPE_END_TAG:
+            {
+                depth--;
+
+                if (depth == 1 && inCandidate)
+                {
+                    candidate.fEnd = iter.position();
+                    if (candidate.size() >= minBytes)
+                        outSubtrees.push_back(candidate);
+
+                    inCandidate = false;
+                }
+
+                // Only the first root element is considered
+                if (depth <= 0)
+                    return;
+            } break;
+
+            case XML_ELEMENT_TYPE_DOCTYPE:
+                docType = elem;
+                break;
+
+            default:
+                break;
+            }
+
+            before = iter.position();
+        }
+    }
+
+
+    // buildSubtree()
+    //
+    // Construct one subtree.  Runs on a worker thread, with the
+    // document's name scope, value memo and node arena made current.
+    static INLINE void buildSubtree(SVGPrebuiltSubtree& sub, const SVGSubtreeView& view, SVGValueMemo* memo, NodeArena* arena)
+    {
+        PSNameScopeGuard nameGuard(view.fNames);
+        SVGValueMemoGuard memoGuard(memo);
+        NodeArenaGuard arenaGuard(arena);
+
+        SVGSubtreeGroot proxy(view);
+
+        XmlPull iter(ByteSpan::fromPointers(sub.fStart, sub.fEnd), true);
+        if (!iter.next() || iter->kind() != XML_ELEMENT_TYPE_START_TAG)
+            return;
+
+        auto node = createContainerNode(iter, &proxy);
+        if (!node)
+            return;
+
+        sub.fNode = node;
+        sub.fReferences = std::move(proxy.fReferences);
+        sub.fEntities = std::move(proxy.fEntityWrites);
+        if (!proxy.fStyleSheet.empty())
+            sub.fStyleSheet = std::make_shared<CSSStyleSheet>(std::move(proxy.fStyleSheet));
+    }
+
+
+    // buildSubtreesParallel()
+    //
+    // Build all the subtrees, using up to 'threadCount' threads.
+    // The threads pull the next unbuilt subtree until there are none
+    // left, so a few big layers don't hold up the rest.
+    static INLINE void buildSubtreesParallel(std::vector<SVGPrebuiltSubtree>& subtrees, size_t threadCount,
+        IAmGroot* doc, SVGValueMemo* memo, NodeArena* arena)
+    {
+        if (subtrees.empty())
+            return;
+
+        const SVGSubtreeView view(doc);
+        std::atomic<size_t> nextIndex{ 0 };
+
+        auto worker = [&]() {
+            size_t idx;
+            while ((idx = nextIndex.fetch_add(1, std::memory_order_relaxed)) < subtrees.size())
+                buildSubtree(subtrees[idx], view, memo, arena);
+            };
+
+        const size_t nThreads = std::min(threadCount, subtrees.size());
+
+        std::vector<std::thread> threads;
+        threads.reserve(nThreads);
+        for (size_t i = 1; i < nThreads; i++)
+            threads.emplace_back(worker);
+
+        // this thread takes a share too
+        worker();
+
+        for (auto& t : threads)
+            t.join();
+    }
+}
@@ -19,7 +19,7 @@ namespace waavs {
 		{
 			registerContainerNodeByName(svgtag::tag_symbol(),
 				[](IAmGroot* groot, XmlPull& iter) {
-					auto node = std::make_shared<SVGSymbolNode>(groot);
+					auto node = makeNode<SVGSymbolNode>(groot);
 					node->loadFromXmlPull(iter, groot);
 
 					return node;
@@ -572,6 +572,9 @@ namespace waavs
 
         double fX{ 0 }, fY{ 0 };
 
+        // Glyphs can reach outside the computed text bounds
+        bool canCull() const noexcept override { return false; }
+
 
         ByteSpan fDxSpan{}, fDySpan{}, fRotateSpan;
         bool fHasDxStream{ false }, fHasDyStream{ false }, fHasRotStream{ false };
@@ -606,7 +609,7 @@ namespace waavs
         // child loading shared between 'text' and 'tspan'
         void loadContentNode(const XmlElement& elem, IAmGroot* groot) override
         {
-            auto node = std::make_shared<SVGTextRun>(elem.data());
+            auto node = makeNode<SVGTextRun>(elem.data());
             if (!node)
                 return;
             addNode(node, groot);
@@ -652,7 +655,7 @@ namespace waavs
             bool preserveSpace = false;
             {
                 ByteSpan v{};
-                if (getElementAttribute(PSNameTable::INTERN("xml:space"), v)) {
+                if (getElementAttribute(svgStaticAtom("xml:space"), v)) {
                     v = chunk_trim(v, chrWspChars);
                     // accept "preserve" (case-sensitive per XML)
                     preserveSpace = (v == "preserve");
@@ -682,7 +685,7 @@ namespace waavs
                         totalBytes += run->rawText().size();
                     }
 
-                    auto merged = std::make_shared<SVGTextRun>();
+                    auto merged = makeNode<SVGTextRun>();
                     if (!merged) return;
 
                     MemBuff owned(totalBytes);
@@ -899,7 +902,7 @@ namespace waavs {
         {
             registerSVGSingularNodeByName(svgtag::tag_tspan(),
                 [](IAmGroot* groot, const XmlElement& elem) {
-                    auto node = std::make_shared<SVGTSpanNode>(groot);
+                    auto node = makeNode<SVGTSpanNode>(groot);
                     node->loadFromXmlElement(elem, groot);
                     return node;
                 });
@@ -909,7 +912,7 @@ namespace waavs {
         {
             registerContainerNode(svgtag::tag_tspan(),
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGTSpanNode>(groot);
+                    auto node = makeNode<SVGTSpanNode>(groot);
                     node->loadFromXmlPull(iter, groot);
                     return node;
                 });
@@ -932,7 +935,7 @@ namespace waavs {
         {
             registerContainerNode(svgtag::tag_text(),
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGTextNode>(groot);
+                    auto node = makeNode<SVGTextNode>(groot);
                     node->loadFromXmlPull(iter, groot);
                     return node;
                 });
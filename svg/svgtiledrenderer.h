@@ -0,0 +1,142 @@
+#pragma once
+
+//
+// Tile-parallel rendering
+//
+// Blend2D can spread rasterization across threads, but walking the
+// document, and running filters, happens on the one thread doing
+// the drawing.  For large outputs, that's the bottleneck.
+//
+// The tiled renderer splits the target Surface into tiles, and
+// draws them on several threads at once.  Each tile is a view into
+// the target, so tiles draw in place, and each thread has its own
+// render session.  Threads pull the next undrawn tile until there
+// are none left, so a few expensive tiles don't hold up the rest.
+//
+// Drawing changes the document, so the document is frozen first,
+// recorded once into a display list, which all the threads then
+// share.  Recording only walks the tree, the drawing, filters, masks
+// and all, is done by the tiles, in parallel, at the canvas's own
+// resolution.
+//
+// A tile's driver draws in whole canvas coordinates, so what ends up
+// in a tile matches a whole canvas render, including along the tile
+// edges.  Elements, and whole containers, that don't reach a tile are
+// skipped by their cull ranges.  A filter is run once, over the whole
+// canvas, by whichever tile gets to it first, and the others use what
+// it made, see SVGEffectCache.
+//
+// The threads are the shared WorkerPool's, not started for each call.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "svgdocument.h"
+#include "svgrendersession.h"
+#include "workerpool.h"
+
+
+namespace waavs
+{
+    struct SVGTileRenderOptions
+    {
+        int fTileSize{ 512 };           // tiles are square, other than at the edges
+        size_t fThreadCount{ 0 };       // 0 == all of the shared pool's threads, and the caller
+        int fBlendThreads{ 0 };         // Blend2D threads for each tile's context
+        BLRgba32 fBackground{ 0x00000000 };
+        WGMatrix3x3 fTransform{ WGMatrix3x3::makeIdentity() };    // canvas transform, applied before the document's own
+    };
+
+
+    // makeTileGrid()
+    //
+    // Cover a width x height canvas with tiles of (at most) tileSize
+    static INLINE void makeTileGrid(int width, int height, int tileSize, std::vector<WGRectI>& tiles)
+    {
+        tiles.clear();
+
+        if (width <= 0 || height <= 0)
+            return;
+
+        if (tileSize <= 0)
+            tileSize = std::max(width, height);
+
+        for (int y = 0; y < height; y += tileSize)
+        {
+            for (int x = 0; x < width; x += tileSize)
+            {
+                tiles.push_back(WGRectI{ x, y, std::min(tileSize, width - x), std::min(tileSize, height - y) });
+            }
+        }
+    }
+
+
+    // renderFrozenTiled()
+    //
+    // Draw the whole of a frozen document into 'target', a tile at
+    // a time, using up to opts.fThreadCount threads.  opts.fTransform
+    // maps the document's units onto the canvas.
+    static INLINE bool renderFrozenTiled(const SVGFrozenDocument& doc, Surface& target, const SVGTileRenderOptions& opts = {})
+    {
+        if (target.empty() || !doc.fList)
+            return false;
+
+        std::vector<WGRectI> tiles;
+        makeTileGrid(int(target.width()), int(target.height()), opts.fTileSize, tiles);
+
+        if (tiles.empty())
+            return false;
+
+        WorkerPool& pool = WorkerPool::shared();
+
+        size_t threadCount = opts.fThreadCount;
+        if (threadCount == 0)
+            threadCount = pool.threadCount() + 1;
+
+        const size_t nWorkers = std::min(threadCount, tiles.size());
+
+        SVGEffectCache effects(WGRectI{ 0, 0, int(target.width()), int(target.height()) });
+        std::atomic<size_t> nextIndex{ 0 };
+
+        // Each worker keeps one session for all the tiles it draws
+        pool.parallelFor(nWorkers, nWorkers, [&](size_t) {
+            SVGRenderSession session(opts.fBlendThreads);
+
+            size_t idx;
+            while ((idx = nextIndex.fetch_add(1, std::memory_order_relaxed)) < tiles.size())
+            {
+                const WGRectI& tileRect = tiles[idx];
+
+                Surface tile{};
+                if (target.getSubSurface(tileRect, tile) != WG_SUCCESS)
+                    continue;
+
+                session.renderTile(doc, tile, tileRect.x, tileRect.y, opts.fTransform, opts.fBackground, &effects);
+            }
+            });
+
+        return true;
+    }
+
+
+    // renderDocumentTiled()
+    //
+    // Draw the whole of 'doc' into 'target', a tile at a time, using
+    // up to opts.fThreadCount threads.  The document is frozen first,
+    // on this thread.  To draw the same document more than once, 
+    // freeze it once, and use renderFrozenTiled().
+    static INLINE bool renderDocumentTiled(SVGDocument& doc, Surface& target, const SVGTileRenderOptions& opts = {})
+    {
+        if (target.empty())
+            return false;
+
+        auto frozen = freezeDocument(doc, opts.fTransform);
+        if (!frozen)
+            return false;
+
+        return renderFrozenTiled(*frozen, target, opts);
+    }
+}
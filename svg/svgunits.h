@@ -10,82 +10,91 @@ namespace waavs::svgunits
 // Absolute length units
 // Syntactic Numeric modifiers
 // ============================================================
-    inline InternedKey none() { static InternedKey k = PSNameTable::INTERN("none"); return k; }
-    inline InternedKey px() { static InternedKey k = PSNameTable::INTERN("px");  return k; }  // CSS px (SVG default)
-    inline InternedKey cm() { static InternedKey k = PSNameTable::INTERN("cm");  return k; }
-    inline InternedKey mm() { static InternedKey k = PSNameTable::INTERN("mm");  return k; }
-    inline InternedKey in_() { static InternedKey k = PSNameTable::INTERN("in");  return k; }
-    inline InternedKey pt() { static InternedKey k = PSNameTable::INTERN("pt");  return k; }
-    inline InternedKey pc() { static InternedKey k = PSNameTable::INTERN("pc");  return k; }
+    inline InternedKey none() { static constexpr InternedKey k = svgStaticAtom("none"); return k; }
+    inline InternedKey px() { static constexpr InternedKey k = svgStaticAtom("px");  return k; }  // CSS px (SVG default)
+    inline InternedKey cm() { static constexpr InternedKey k = svgStaticAtom("cm");  return k; }
+    inline InternedKey mm() { static constexpr InternedKey k = svgStaticAtom("mm");  return k; }
+    inline InternedKey in_() { static constexpr InternedKey k = svgStaticAtom("in");  return k; }
+    inline InternedKey pt() { static constexpr InternedKey k = svgStaticAtom("pt");  return k; }
+    inline InternedKey pc() { static constexpr InternedKey k = svgStaticAtom("pc");  return k; }
 
     // ============================================================
     // Relative length units
     // ============================================================
 
-    inline InternedKey em() { static InternedKey k = PSNameTable::INTERN("em");  return k; }
-    inline InternedKey ex() { static InternedKey k = PSNameTable::INTERN("ex");  return k; }
-    inline InternedKey ch() { static InternedKey k = PSNameTable::INTERN("ch");  return k; }
-    inline InternedKey rem() { static InternedKey k = PSNameTable::INTERN("rem"); return k; }
+    inline InternedKey em() { static constexpr InternedKey k = svgStaticAtom("em");  return k; }
+    inline InternedKey ex() { static constexpr InternedKey k = svgStaticAtom("ex");  return k; }
+    inline InternedKey ch() { static constexpr InternedKey k = svgStaticAtom("ch");  return k; }
+    inline InternedKey rem() { static constexpr InternedKey k = svgStaticAtom("rem"); return k; }
 
     // ============================================================
     // Viewport / container relative
     // ============================================================
 
-    inline InternedKey vw() { static InternedKey k = PSNameTable::INTERN("vw");  return k; }
-    inline InternedKey vh() { static InternedKey k = PSNameTable::INTERN("vh");  return k; }
-    inline InternedKey vmin() { static InternedKey k = PSNameTable::INTERN("vmin"); return k; }
-    inline InternedKey vmax() { static InternedKey k = PSNameTable::INTERN("vmax"); return k; }
+    inline InternedKey vw() { static constexpr InternedKey k = svgStaticAtom("vw");  return k; }
+    inline InternedKey vh() { static constexpr InternedKey k = svgStaticAtom("vh");  return k; }
+    inline InternedKey vmin() { static constexpr InternedKey k = svgStaticAtom("vmin"); return k; }
+    inline InternedKey vmax() { static constexpr InternedKey k = svgStaticAtom("vmax"); return k; }
 
     // ============================================================
     // Percent
     // ============================================================
 
-    inline InternedKey pct() { static InternedKey k = PSNameTable::INTERN("%"); return k; }
+    inline InternedKey pct() { static constexpr InternedKey k = svgStaticAtom("%"); return k; }
 
     // ============================================================
     // Angles (for gradients, transforms, etc.)
     // ============================================================
 
-    inline InternedKey deg() { static InternedKey k = PSNameTable::INTERN("deg"); return k; }
-    inline InternedKey rad() { static InternedKey k = PSNameTable::INTERN("rad"); return k; }
-    inline InternedKey grad() { static InternedKey k = PSNameTable::INTERN("grad"); return k; }
-    inline InternedKey turn() { static InternedKey k = PSNameTable::INTERN("turn"); return k; }
+    inline InternedKey deg() { static constexpr InternedKey k = svgStaticAtom("deg"); return k; }
+    inline InternedKey rad() { static constexpr InternedKey k = svgStaticAtom("rad"); return k; }
+    inline InternedKey grad() { static constexpr InternedKey k = svgStaticAtom("grad"); return k; }
+    inline InternedKey turn() { static constexpr InternedKey k = svgStaticAtom("turn"); return k; }
 
     // ============================================================
     // Time units (animations)
     // ============================================================
 
-    inline InternedKey s() { static InternedKey k = PSNameTable::INTERN("s");  return k; }
-    inline InternedKey ms() { static InternedKey k = PSNameTable::INTERN("ms"); return k; }
+    inline InternedKey s() { static constexpr InternedKey k = svgStaticAtom("s");  return k; }
+    inline InternedKey ms() { static constexpr InternedKey k = svgStaticAtom("ms"); return k; }
 
     // ============================================================
     // Frequency (filters / audio-ish SVG extensions)
     // ============================================================
 
-    inline InternedKey hz() { static InternedKey k = PSNameTable::INTERN("Hz");  return k; }
-    inline InternedKey khz() { static InternedKey k = PSNameTable::INTERN("kHz"); return k; }
+    inline InternedKey hz() { static constexpr InternedKey k = svgStaticAtom("Hz");  return k; }
+    inline InternedKey khz() { static constexpr InternedKey k = svgStaticAtom("kHz"); return k; }
 
     // ============================================================
     // Resolution (filters, CSS images)
     // ============================================================
 
-    inline InternedKey dpi() { static InternedKey k = PSNameTable::INTERN("dpi");  return k; }
-    inline InternedKey dpcm() { static InternedKey k = PSNameTable::INTERN("dpcm"); return k; }
-    inline InternedKey dppx() { static InternedKey k = PSNameTable::INTERN("dppx"); return k; }
+    inline InternedKey dpi() { static constexpr InternedKey k = svgStaticAtom("dpi");  return k; }
+    inline InternedKey dpcm() { static constexpr InternedKey k = svgStaticAtom("dpcm"); return k; }
+    inline InternedKey dppx() { static constexpr InternedKey k = svgStaticAtom("dppx"); return k; }
 
     // ============================================================
     // Flex / grid (SVG2 / CSS compatibility)
     // ============================================================
 
-    inline InternedKey fr() { static InternedKey k = PSNameTable::INTERN("fr"); return k; }
+    inline InternedKey fr() { static constexpr InternedKey k = svgStaticAtom("fr"); return k; }
 
 
     // ============================================================
     // Unit Helpers
     // ============================================================
+    // Anything that isn't one of the units above comes back as 'unknown'
+    // rather than being interned, so junk in a document doesn't
+    // end up in the name table.
+    inline InternedKey unknownUnit() { static constexpr InternedKey k = svgStaticAtom("unknown"); return k; }
+
     inline InternedKey internUnit(const ByteSpan& s)
     {
-        return s ? PSNameTable::INTERN(s) : InternedKey{};
+        if (!s)
+            return InternedKey{};
+
+        InternedKey k = PSNameTable::FIND(s);
+        return k ? k : unknownUnit();
     }
 
     // Is this a length unit?
@@ -14,10 +14,13 @@ namespace waavs
     //====================================
     struct SVGUseElement : public SVGGraphicsElement
     {
+        // What's drawn is the referenced content, which can be anything
+        bool canCull() const noexcept override { return false; }
+
         static void registerSingularNode()
         {
             registerSVGSingularNodeByName("use", [](IAmGroot* groot, const XmlElement& elem) {
-                auto node = std::make_shared<SVGUseElement>(groot);
+                auto node = makeNode<SVGUseElement>(groot);
                 node->loadFromXmlElement(elem, groot);
                 return node;
                 });
@@ -27,7 +30,7 @@ namespace waavs
         {
             registerContainerNodeByName("use",
                 [](IAmGroot* groot, XmlPull& iter) {
-                    auto node = std::make_shared<SVGUseElement>(groot);
+                    auto node = makeNode<SVGUseElement>(groot);
                     node->loadFromXmlPull(iter, groot);
                     return node;
                 });
@@ -201,8 +204,12 @@ namespace waavs
                 ctx->setViewport({ 0.0, 0.0, fPlacedRect.w, fPlacedRect.h });
 
             // Ensure the target binds itself to the context before drawing.
+            // What the target learned about its bounds the last time it
+            // was drawn might not hold here, so don't cull by it.
             fTarget->setNeedsBinding(true); 
+            ctx->suspendCulling();
             fTarget->draw(ctx, groot);
+            ctx->resumeCulling();
 
             ctx->pop();
         }
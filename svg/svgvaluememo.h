@@ -0,0 +1,245 @@
+#pragma once
+
+//
+// Memoized attribute values
+//
+// Exported documents repeat the same attribute values over and over;
+// the same style="fill:#1f77b4;stroke:none", the same transform, the
+// same handful of colors, on thousands of elements.  Rather than parse
+// each occurrence again, the parsed result is remembered by the bytes
+// of the value, and later occurrences are a lookup.
+//
+// An SVGValueMemo belongs to a document.  The keys are spans of the
+// document's own source, and are kept as they are, not copied, so the
+// bytes they point at must outlive the memo.  Values handed to a
+// parser while a memo is current, from anywhere other than the
+// document's source, have to live at least as long as the document.
+// Like the name scope, the document makes its memo 'current' on a
+// thread while it's loading and drawing, and the parsers pick it up
+// from there.  With no memo current, values are parsed as always.
+//
+// Each table holds at most 'capacity' values.  A table is split into
+// shards by the hash of the key, each with its own lock, so threads
+// building parts of the same document seldom wait on each other.
+// When a shard fills up, it's emptied and starts over, which keeps a
+// long running document from growing without bound.
+//
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bspan.h"
+#include "bspan_utils.h"
+#include "nametable.h"
+#include "coloring.h"
+#include "wggeometry.h"
+
+
+namespace waavs
+{
+    struct SVGMemoStats
+    {
+        size_t fHits{ 0 };
+        size_t fMisses{ 0 };
+        size_t fEntries{ 0 };
+    };
+
+    // SVGMemoTable
+    //
+    // One kind of parsed value, by the bytes of its source.
+    template <typename V>
+    struct SVGMemoTable
+    {
+        static constexpr size_t kShardBits = 4;
+        static constexpr size_t kShardCount = size_t(1) << kShardBits;
+
+    private:
+        using ValueMap = std::unordered_map<ByteSpan, V, ByteSpanHash, ByteSpanEquivalent>;
+
+        // Each shard sits on its own cache line, so threads working
+        // in different shards don't trip over each other's locks.
+        struct alignas(64) Shard
+        {
+            mutable std::mutex fLock{};
+            ValueMap fValues{};
+        };
+
+        Shard fShards[kShardCount]{};
+        std::atomic<size_t> fShardCapacity{ 0 };
+
+        std::atomic<size_t> fHits{ 0 };
+        std::atomic<size_t> fMisses{ 0 };
+
+        // The map buckets on the low bits of the same hash, so the
+        // shard is picked from the high ones.
+        Shard& shardFor(const ByteSpan& key) noexcept
+        {
+            const uint64_t h = uint64_t(ByteSpanHash{}(key)) * 0x9E3779B97F4A7C15ull;
+            return fShards[size_t(h >> (64 - kShardBits))];
+        }
+
+        static size_t shardCapacity(size_t capacity) noexcept
+        {
+            return capacity == 0 ? 0 : (capacity + kShardCount - 1) / kShardCount;
+        }
+
+    public:
+        explicit SVGMemoTable(size_t capacity) noexcept : fShardCapacity(shardCapacity(capacity)) {}
+
+        SVGMemoTable(const SVGMemoTable&) = delete;
+        SVGMemoTable& operator=(const SVGMemoTable&) = delete;
+
+        bool find(const ByteSpan& key, V& out) noexcept
+        {
+            Shard& shard = shardFor(key);
+            std::lock_guard<std::mutex> guard(shard.fLock);
+
+            auto it = shard.fValues.find(key);
+            if (it == shard.fValues.end())
+            {
+                fMisses.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            out = it->second;
+            fHits.fetch_add(1, std::memory_order_relaxed);
+
+            return true;
+        }
+
+        // insert()
+        //
+        // 'key' is kept as is, so the bytes it points at have to
+        // stay where they are for as long as the table might hold it.
+        void insert(const ByteSpan& key, const V& value)
+        {
+            const size_t capacity = fShardCapacity.load(std::memory_order_relaxed);
+            if (capacity == 0)
+                return;
+
+            Shard& shard = shardFor(key);
+            std::lock_guard<std::mutex> guard(shard.fLock);
+
+            if (shard.fValues.size() >= capacity)
+                shard.fValues.clear();
+
+            shard.fValues.emplace(key, value);
+        }
+
+        // A capacity of 0 turns the table off
+        void setCapacity(size_t capacity)
+        {
+            const size_t perShard = shardCapacity(capacity);
+            fShardCapacity.store(perShard, std::memory_order_relaxed);
+
+            for (Shard& shard : fShards)
+            {
+                std::lock_guard<std::mutex> guard(shard.fLock);
+                if (shard.fValues.size() > perShard)
+                    shard.fValues.clear();
+            }
+        }
+
+        void clear()
+        {
+            for (Shard& shard : fShards)
+            {
+                std::lock_guard<std::mutex> guard(shard.fLock);
+                shard.fValues.clear();
+            }
+            fHits.store(0, std::memory_order_relaxed);
+            fMisses.store(0, std::memory_order_relaxed);
+        }
+
+        SVGMemoStats stats() const noexcept
+        {
+            size_t entries = 0;
+            for (const Shard& shard : fShards)
+            {
+                std::lock_guard<std::mutex> guard(shard.fLock);
+                entries += shard.fValues.size();
+            }
+
+            return { fHits.load(std::memory_order_relaxed), fMisses.load(std::memory_order_relaxed), entries };
+        }
+    };
+
+
+    // A style attribute, already split into its declarations
+    using SVGStyleDeclarations = std::vector<std::pair<InternedKey, ByteSpan>>;
+
+
+    //
+    // SVGValueMemo
+    //
+    // The memo tables of a single document
+    //
+    struct SVGValueMemo
+    {
+        static constexpr size_t kDefaultCapacity = 8192;
+
+        SVGMemoTable<std::shared_ptr<const SVGStyleDeclarations>> fStyles{ kDefaultCapacity };
+        SVGMemoTable<WGMatrix3x3> fTransforms{ kDefaultCapacity };
+        SVGMemoTable<ColorSRGB> fColors{ kDefaultCapacity };
+
+    private:
+        static SVGValueMemo*& currentSlot() noexcept
+        {
+            static thread_local SVGValueMemo* gCurrent = nullptr;
+            return gCurrent;
+        }
+
+    public:
+        SVGValueMemo() = default;
+        SVGValueMemo(const SVGValueMemo&) = delete;
+        SVGValueMemo& operator=(const SVGValueMemo&) = delete;
+
+        void setCapacity(size_t capacity)
+        {
+            fStyles.setCapacity(capacity);
+            fTransforms.setCapacity(capacity);
+            fColors.setCapacity(capacity);
+        }
+
+        void clear()
+        {
+            fStyles.clear();
+            fTransforms.clear();
+            fColors.clear();
+        }
+
+        SVGMemoStats styleStats() const noexcept { return fStyles.stats(); }
+        SVGMemoStats transformStats() const noexcept { return fTransforms.stats(); }
+        SVGMemoStats colorStats() const noexcept { return fColors.stats(); }
+
+        static SVGValueMemo* current() noexcept { return currentSlot(); }
+
+        static SVGValueMemo* setCurrent(SVGValueMemo* memo) noexcept
+        {
+            SVGValueMemo* prev = currentSlot();
+            currentSlot() = memo;
+            return prev;
+        }
+    };
+
+    // SVGValueMemoGuard
+    //
+    // Make a memo current on this thread, for the life of the guard.
+    struct SVGValueMemoGuard
+    {
+        SVGValueMemo* fPrevious{ nullptr };
+
+        explicit SVGValueMemoGuard(SVGValueMemo* memo) noexcept
+            : fPrevious(SVGValueMemo::setCurrent(memo))
+        {
+        }
+        ~SVGValueMemoGuard() { SVGValueMemo::setCurrent(fPrevious); }
+
+        SVGValueMemoGuard(const SVGValueMemoGuard&) = delete;
+        SVGValueMemoGuard& operator=(const SVGValueMemoGuard&) = delete;
+    };
+}
@@ -288,6 +288,20 @@ namespace waavs
         return WGRectI{ r.x - dw, r.y - dh, r.w + 2 * dw, r.h + 2 * dh };
     }
 
+    // The smallest rectangle holding both.  An empty rectangle adds nothing.
+    static INLINE WGRectI wg_rectI_union(const WGRectI& a, const WGRectI& b) noexcept
+    {
+        if (!wg_rectI_is_valid(a)) return b;
+        if (!wg_rectI_is_valid(b)) return a;
+
+        const int x0 = (a.x < b.x) ? a.x : b.x;
+        const int y0 = (a.y < b.y) ? a.y : b.y;
+        const int x1 = ((a.x + a.w) > (b.x + b.w)) ? (a.x + a.w) : (b.x + b.w);
+        const int y1 = ((a.y + a.h) > (b.y + b.h)) ? (a.y + a.h) : (b.y + b.h);
+
+        return WGRectI{ x0, y0, x1 - x0, y1 - y0 };
+    }
+
     static INLINE WGRectI intersection(const WGRectI& a, const WGRectI& b) noexcept {
         const int x0 = (a.x > b.x) ? a.x : b.x;
         const int y0 = (a.y > b.y) ? a.y : b.y;
@@ -681,6 +695,13 @@ namespace waavs {
                 almost_zero(m22 - 1.0);
         }
 
+        // Only scales and translates, so rectangles stay rectangles
+        WG_NODISCARD
+            INLINE bool isScaleTranslate() const noexcept
+        {
+            return isAffine2D() && m01 == 0.0 && m10 == 0.0;
+        }
+
         WG_NODISCARD
             INLINE double determinant() const noexcept {
             return
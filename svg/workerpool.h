@@ -0,0 +1,170 @@
+#pragma once
+
+//
+// WorkerPool
+//
+// A set of threads that are started once, and kept around, to run
+// short bursts of parallel work.  Starting threads costs far more
+// than decoding a small image, or drawing a small tile, so things
+// that are called often share this pool, instead of spawning threads
+// of their own each time.
+//
+// parallelFor() hands out indices to the pool's threads, and to the
+// calling thread, which always takes a share.  Since the caller can
+// finish the work by itself, calling parallelFor() from within a
+// pool thread doesn't deadlock, it just gets less help.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace waavs
+{
+    struct WorkerPool
+    {
+    private:
+        struct ForState
+        {
+            std::atomic<size_t> fNext{ 0 };
+            std::atomic<size_t> fDone{ 0 };
+            size_t fCount{ 0 };
+
+            std::mutex fLock{};
+            std::condition_variable fFinished{};
+        };
+
+        std::mutex fLock{};
+        std::condition_variable fWake{};
+        std::deque<std::function<void()>> fTasks{};
+        std::vector<std::thread> fThreads{};
+        bool fStopping{ false };
+
+        void run()
+        {
+            for (;;)
+            {
+                std::function<void()> task{};
+                {
+                    std::unique_lock<std::mutex> lock(fLock);
+                    fWake.wait(lock, [this] { return fStopping || !fTasks.empty(); });
+
+                    if (fTasks.empty())
+                        return;
+
+                    task = std::move(fTasks.front());
+                    fTasks.pop_front();
+                }
+
+                task();
+            }
+        }
+
+        // drain()
+        //
+        // Claim and run indices until there are none left.  'fn' is
+        // only touched for an index that was claimed, which means
+        // the parallelFor() that owns it is still waiting.
+        template <typename Fn>
+        static void drain(ForState& st, Fn& fn)
+        {
+            size_t idx;
+            while ((idx = st.fNext.fetch_add(1, std::memory_order_relaxed)) < st.fCount)
+            {
+                fn(idx);
+
+                if (st.fDone.fetch_add(1, std::memory_order_acq_rel) + 1 == st.fCount)
+                {
+                    std::lock_guard<std::mutex> guard(st.fLock);
+                    st.fFinished.notify_all();
+                }
+            }
+        }
+
+    public:
+        explicit WorkerPool(size_t threadCount)
+        {
+            fThreads.reserve(threadCount);
+            for (size_t i = 0; i < threadCount; i++)
+                fThreads.emplace_back([this] { run(); });
+        }
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        ~WorkerPool()
+        {
+            {
+                std::lock_guard<std::mutex> guard(fLock);
+                fStopping = true;
+            }
+            fWake.notify_all();
+
+            for (auto& t : fThreads)
+                t.join();
+        }
+
+        // The pool shared by the whole process, one thread short of
+        // the hardware, since callers always take a share.
+        static WorkerPool& shared()
+        {
+            static WorkerPool sPool(std::max<size_t>(1, std::thread::hardware_concurrency()) - 1);
+            return sPool;
+        }
+
+        size_t threadCount() const noexcept { return fThreads.size(); }
+
+        // parallelFor()
+        //
+        // Call fn(i) for every i in [0, count), on at most 'maxThreads'
+        // threads, counting the caller.  0 means as many as the pool
+        // has.  Returns once every call has returned.
+        template <typename Fn>
+        void parallelFor(size_t count, size_t maxThreads, Fn&& fn)
+        {
+            if (count == 0)
+                return;
+
+            if (maxThreads == 0)
+                maxThreads = fThreads.size() + 1;
+
+            const size_t helpers = std::min({ maxThreads, count, fThreads.size() + 1 }) - 1;
+
+            if (helpers == 0)
+            {
+                for (size_t i = 0; i < count; i++)
+                    fn(i);
+                return;
+            }
+
+            // Helpers that only get going after the work is done
+            // find nothing left to claim, and let go of the state.
+            auto state = std::make_shared<ForState>();
+            state->fCount = count;
+
+            using FnType = std::remove_reference_t<Fn>;
+            FnType* fnPtr = &fn;
+
+            {
+                std::lock_guard<std::mutex> guard(fLock);
+                for (size_t i = 0; i < helpers; i++)
+                    fTasks.emplace_back([state, fnPtr] { drain(*state, *fnPtr); });
+            }
+            fWake.notify_all();
+
+            drain(*state, fn);
+
+            std::unique_lock<std::mutex> lock(state->fLock);
+            state->fFinished.wait(lock, [&] { return state->fDone.load(std::memory_order_acquire) == count; });
+        }
+    };
+}
@@ -692,52 +692,33 @@ namespace waavs {
         const unsigned char* attrStart = p;
 
         selfClosing = false;
-        unsigned char quote = 0;
 
-        while (p < end)
+        // Jump straight to the closing '>', using the structural index
+        // to skip over attribute content, and quoted values
+        const unsigned char* gt = xml_index_find_tag_end(iter.fState.index, p, end);
+        if (gt < end)
         {
-            unsigned char c = *p++;
+            // Self-close if immediately preceded by '/' (ignoring trailing whitespace).
+            // This matches XML behavior like: <tag ... />
+            const unsigned char* q = gt;
+            while (q > attrStart && chrWspChars(*(q - 1)))
+                --q;
 
-            if (quote)
+            if (q > attrStart && *(q - 1) == '/')
             {
-                if (c == quote)
-                    quote = 0;
-                continue;
+                selfClosing = true;
+                // Exclude that '/' from the attribute span (also exclude any whitespace before '>' if you want).
+                attrSpan = ByteSpan::fromPointers( attrStart, q - 1 );
             }
-
-            if (c == '"' || c == '\'')
+            else
             {
-                quote = c;
-                continue;
+                attrSpan = ByteSpan::fromPointers( attrStart, gt );
             }
 
-            if (c == '>')
-            {
-                // Tag ends at p-1 (the '>')
-                const unsigned char* gt = p - 1;
-
-                // Self-close if immediately preceded by '/' (ignoring trailing whitespace).
-                // This matches XML behavior like: <tag ... />
-                const unsigned char* q = gt;
-                while (q > attrStart && chrWspChars(*(q - 1)))
-                    --q;
-
-                if (q > attrStart && *(q - 1) == '/')
-                {
-                    selfClosing = true;
-                    // Exclude that '/' from the attribute span (also exclude any whitespace before '>' if you want).
-                    attrSpan = ByteSpan::fromPointers( attrStart, q - 1 );
-                }
-                else
-                {
-                    attrSpan = ByteSpan::fromPointers( attrStart, gt );
-                }
-
-                // Advance iterator past '>'
-                iter.fState.input.resetStart(p);
-                iter.fState.inTag = false;
-                return true;
-            }
+            // Advance iterator past '>'
+            iter.fState.input.resetStart(gt + 1);
+            iter.fState.inTag = false;
+            return true;
         }
 
         return false; // EOF before closing '>'
@@ -937,24 +918,56 @@ namespace waavs {
 }
 
 namespace waavs {
+    // XmlElementRecord
+    //
+    // An element as it was scanned, with its name and data kept as
+    // offsets into some base chunk of memory.  A run of these can be
+    // replayed through an XmlPull later on, without scanning again.
+    struct XmlElementRecord
+    {
+        uint32_t fKind;
+        uint32_t fNameOffset;
+        uint32_t fNameLength;
+        uint32_t fDataOffset;
+        uint32_t fDataLength;
+    };
+
     // A simple pull model forward XML element iterator
     struct XmlPull
     {
         XmlIterator fIter{};
         XmlElement fCurrentElement{};
 
+        // When replaying recorded elements, instead of scanning
+        ByteSpan fRecordBase{};
+        const XmlElementRecord* fRecords{ nullptr };
+        size_t fRecordCount{ 0 };
+        size_t fNextRecord{ 0 };
+
         explicit XmlPull(const ByteSpan& s, bool autoAttrs = false)
             : fIter{ s }
         {
             fIter.fParams.fAutoScanAttributes = autoAttrs;
         }
 
+        // Replay 'count' recorded elements, whose offsets are
+        // relative to the start of 'base'
+        XmlPull(const ByteSpan& base, const XmlElementRecord* records, size_t count)
+            : fRecordBase(base)
+            , fRecords(records)
+            , fRecordCount(count)
+        {
+        }
+
         // Convenience methods for dealing with current element
         const XmlElement& operator*() const { return fCurrentElement; }
         const XmlElement* operator->() const { return &fCurrentElement; }
 
         bool next()
         {
+            if (fRecords)
+                return nextRecord();
+
             const unsigned char* before = fIter.fState.input.begin();
 
             bool success = nextXmlElement(fIter, fCurrentElement);
@@ -969,5 +982,46 @@ namespace waavs {
 
             return success;
         }
+
+        // Current position within the input
+        const unsigned char* position() const noexcept { return fIter.fState.input.begin(); }
+
+        // skipTo()
+        //
+        // Continue scanning from 'p', which must be within the input, 
+        // and outside of any tag, such as the end of an element that
+        // was handled elsewhere.
+        void skipTo(const unsigned char* p) noexcept
+        {
+            fIter.fState.input.resetStart(p);
+            fIter.fState.inTag = false;
+            fIter.fState.index.reset();
+            fCurrentElement.reset();
+        }
+
+    private:
+        bool nextRecord()
+        {
+            fCurrentElement.reset();
+
+            if (fNextRecord >= fRecordCount)
+                return false;
+
+            const XmlElementRecord& rec = fRecords[fNextRecord++];
+            const uint64_t baseSize = fRecordBase.size();
+
+            // Don't trust the offsets to stay within the base
+            if (uint64_t(rec.fNameOffset) + rec.fNameLength > baseSize ||
+                uint64_t(rec.fDataOffset) + rec.fDataLength > baseSize)
+                return false;
+
+            const unsigned char* base = fRecordBase.begin();
+            ByteSpan name(base + rec.fNameOffset, base + rec.fNameOffset + rec.fNameLength);
+            ByteSpan data(base + rec.fDataOffset, base + rec.fDataOffset + rec.fDataLength);
+
+            fCurrentElement.reset(int(rec.fKind), name, data);
+
+            return true;
+        }
     };
 }
\ No newline at end of file
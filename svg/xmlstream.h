@@ -0,0 +1,364 @@
+// xmlstream.h
+
+#pragma once
+
+//
+// A chunk fed variant of the XmlPull iterator.
+//
+// The XmlIterator works on a single contiguous span of memory, which
+// means the whole document has to be in memory before scanning begins.
+// The XmlStreamPull relaxes that.  The caller feeds successive buffers, as
+// they arrive from a pipe, a decompressor, a socket, or whatever, and
+// pulls elements out as they become complete.
+//
+// When an element (a tag, comment, CDATA section, text run...) crosses
+// the end of the data fed so far, the iterator reports that it needs more
+// input, and resumes from the beginning of that element once more data
+// has been fed.  Only the unconsumed tail of the input is retained, so
+// memory is bounded by the size of the largest single construct, rather
+// than the size of the whole document.
+//
+// While stalled, only the newly fed bytes are searched for whatever
+// would complete the construct ('>', '-->', ']]>', or the '<' after a
+// text run), so a construct spread over many chunks is scanned once,
+// not once per chunk.
+//
+// Truncated input and malformed input look the same until the end
+// arrives, so the window is bounded by default.  A construct that
+// doesn't fit within fMaxWindowSize, or that can't be markup at all,
+// is reported as XML_STREAM_ERROR, and the stream stays in error.
+//
+// Usage:
+//  XmlStreamPull pull;
+//  while (readSomeBytes(buff, n))
+//  {
+//      pull.feed(ByteSpan(buff, n));
+//      while (pull.next() == XML_STREAM_ELEMENT)
+//          doSomethingWith(*pull);
+//  }
+//  pull.finish();
+//  while (pull.next() == XML_STREAM_ELEMENT)
+//      doSomethingWith(*pull);
+//
+// Note:  The spans within the current XmlElement point into the stream's
+// window.  They are only valid until the next call to feed(), so anything
+// that needs to be retained must be copied out before then.
+//
+
+#include <cstring>
+
+#include "xmlscan.h"
+#include "membuff.h"
+
+
+namespace waavs
+{
+    enum XmlStreamStatus : uint32_t
+    {
+        XML_STREAM_ELEMENT = 0,     // A complete element is available
+        XML_STREAM_NEED_MORE,       // Feed more data, then call next() again
+        XML_STREAM_END,             // finish() was called, and all input consumed
+        XML_STREAM_ERROR            // Malformed input, or window limit exceeded
+    };
+
+    struct XmlStreamPull
+    {
+        static constexpr size_t kInitialWindowSize = 64 * 1024;
+        static constexpr size_t kDefaultMaxWindowSize = 16 * 1024 * 1024;
+
+        XmlIteratorParams fParams{};
+        XmlElement fCurrentElement{};
+
+        MemBuff fWindow{};
+        size_t fUsed{ 0 };          // bytes of fWindow holding input
+        size_t fCursor{ 0 };        // start of the first unconsumed byte
+
+        // Largest window we'll grow to.  A single construct larger than
+        // this is reported as an error.  0 == no limit
+        size_t fMaxWindowSize{ kDefaultMaxWindowSize };
+
+        bool fFinished{ false };
+        bool fFailed{ false };      // input was dropped, or can't be XML
+        bool fStalled{ false };     // last call to next() needed more data
+
+        // While stalled, what would complete the construct at the cursor,
+        // and how far past the cursor it has already been looked for
+        const char* fStallSuffix{ nullptr };
+        size_t fSearchFrom{ 0 };
+
+        // A stalled '<' whose next character hasn't arrived, so it isn't
+        // known yet whether it can start a tag
+        size_t fOpenCheckAt{ 0 };
+        bool fOpenChecked{ true };
+
+        XmlStreamPull() = default;
+
+        explicit XmlStreamPull(bool autoAttrs, size_t maxWindowSize = kDefaultMaxWindowSize)
+            : fMaxWindowSize(maxWindowSize)
+        {
+            fParams.fAutoScanAttributes = autoAttrs;
+        }
+
+        const XmlElement& operator*() const { return fCurrentElement; }
+        const XmlElement* operator->() const { return &fCurrentElement; }
+
+        bool finished() const noexcept { return fFinished; }
+        bool failed() const noexcept { return fFailed; }
+
+        // Number of bytes currently retained, waiting to be consumed
+        size_t pendingSize() const noexcept { return fUsed - fCursor; }
+
+        // Number of bytes the window currently occupies
+        size_t windowSize() const noexcept { return fWindow.size(); }
+
+        // feed()
+        //
+        // Append a chunk of input.  Bytes that have already been consumed
+        // are discarded first, which invalidates the spans of any element
+        // previously returned from next().
+        // Returns false if the data could not be retained, after which
+        // next() reports XML_STREAM_ERROR
+        bool feed(const ByteSpan& chunk) noexcept
+        {
+            if (fFinished || fFailed)
+                return false;
+
+            if (chunk.empty())
+                return true;
+
+            compact();
+
+            const size_t needed = fUsed + chunk.size();
+            if (needed > fWindow.size())
+            {
+                if (!growTo(needed))
+                {
+                    fFailed = true;
+                    return false;
+                }
+            }
+
+            memcpy(fWindow.data() + fUsed, chunk.data(), chunk.size());
+            fUsed += chunk.size();
+
+            return true;
+        }
+
+        // finish()
+        //
+        // Signal there is no more input.  Whatever remains in the window
+        // is scanned as the tail of the document.
+        void finish() noexcept
+        {
+            fFinished = true;
+        }
+
+        // next()
+        //
+        // Try to scan the next element from what has been fed so far.
+        XmlStreamStatus next() noexcept
+        {
+            fCurrentElement.reset();
+
+            if (fFailed)
+                return XML_STREAM_ERROR;
+
+            if (fStalled && !fFinished)
+            {
+                if (!openCanBeMarkup())
+                {
+                    fFailed = true;
+                    return XML_STREAM_ERROR;
+                }
+
+                if (!suffixArrived())
+                    return XML_STREAM_NEED_MORE;
+            }
+
+            if (fCursor >= fUsed)
+                return fFinished ? XML_STREAM_END : stall();
+
+            const uint8_t* start = fWindow.data() + fCursor;
+            const uint8_t* end = fWindow.data() + fUsed;
+
+            // Resume scanning from the start of the unconsumed input.
+            // The structural index is reset, as the window may have moved
+            // since the last time we scanned.
+            XmlIterator iter{};
+            iter.fParams = fParams;
+            iter.fState.input = ByteSpan::fromPointers(start, end);
+            iter.fState.inTag = false;
+
+            XmlElement elem{};
+            bool success = nextXmlElement(iter, elem);
+
+            const uint8_t* after = iter.fState.input.begin();
+
+            if (!success || after == start)
+            {
+                if (!fFinished)
+                    return stall();
+
+                // With no more input coming, the only valid reason
+                // not to get an element is that there's only skippable
+                // stuff (whitespace, comments) left
+                if (iter.fState.input.empty())
+                {
+                    fCursor = fUsed;
+                    return XML_STREAM_END;
+                }
+
+                fFailed = true;
+                return XML_STREAM_ERROR;
+            }
+
+            // A text run that reaches the end of the window might
+            // continue in the next chunk, so hold onto it
+            if (!fFinished && elem.isContent() && after == end)
+                return stall();
+
+            fCursor += size_t(after - start);
+            fStalled = false;
+            fStallSuffix = nullptr;
+            fSearchFrom = 0;
+            fOpenChecked = true;
+            fCurrentElement = elem;
+
+            return XML_STREAM_ELEMENT;
+        }
+
+    private:
+        // The window has been scanned, and the construct at the cursor
+        // runs off the end of it.  Note what would complete it, which can
+        // only turn up in bytes fed from here on.
+        XmlStreamStatus stall() noexcept
+        {
+            fStalled = true;
+            fOpenChecked = true;
+
+            const ByteSpan pending = ByteSpan::fromPointers(fWindow.data() + fCursor, fWindow.data() + fUsed);
+            ByteSpan s = chunk_ltrim(pending, xmlwsp);
+
+            if (s.empty() || *s != '<')
+                fStallSuffix = "<";
+            else if (bspan_starts_with(s, "<!--"))
+                fStallSuffix = "-->";
+            else if (bspan_starts_with(s, "<![CDATA["))
+                fStallSuffix = "]]>";
+            else
+            {
+                fStallSuffix = ">";
+                fOpenCheckAt = size_t(s.begin() - pending.begin()) + 1;
+                fOpenChecked = false;
+
+                if (!openCanBeMarkup())
+                {
+                    fFailed = true;
+                    return XML_STREAM_ERROR;
+                }
+            }
+
+            fSearchFrom = 0;
+            fSearchFrom = searchedTo(pending.size());
+
+            if (fMaxWindowSize && pendingSize() >= fMaxWindowSize)
+            {
+                fFailed = true;
+                return XML_STREAM_ERROR;
+            }
+
+            return XML_STREAM_NEED_MORE;
+        }
+
+        // openCanBeMarkup()
+        //
+        // False once the first character after a stalled '<' has arrived,
+        // and it can't start a tag, end tag, comment, or anything else
+        bool openCanBeMarkup() noexcept
+        {
+            if (fOpenChecked)
+                return true;
+
+            const uint8_t* start = fWindow.data() + fCursor;
+            ByteSpan name = chunk_ltrim(ByteSpan::fromPointers(start + fOpenCheckAt, fWindow.data() + fUsed), xmlwsp);
+            fOpenCheckAt = size_t(name.begin() - start);
+
+            if (name.empty())
+                return true;
+
+            fOpenChecked = true;
+
+            const uint8_t c = *name;
+            return c == '/' || c == '?' || c == '!' || xmlNameStartChars(c);
+        }
+
+        // suffixArrived()
+        //
+        // Whether the bytes fed since stalling hold what would complete
+        // the stalled construct.  What's been searched already isn't
+        // searched again.
+        bool suffixArrived() noexcept
+        {
+            if (!fStallSuffix)
+                return true;
+
+            const uint8_t* start = fWindow.data() + fCursor;
+            const ByteSpan fresh = ByteSpan::fromPointers(start + fSearchFrom, fWindow.data() + fUsed);
+
+            if (chunk_find_cstr(fresh, fStallSuffix))
+                return true;
+
+            fSearchFrom = searchedTo(pendingSize());
+
+            return false;
+        }
+
+        // Where to start looking next time, leaving room for a suffix
+        // that is split across chunks
+        size_t searchedTo(size_t pending) const noexcept
+        {
+            const size_t overlap = std::strlen(fStallSuffix) - 1;
+            const size_t to = pending > overlap ? pending - overlap : 0;
+
+            return to > fSearchFrom ? to : fSearchFrom;
+        }
+
+        // Slide the unconsumed bytes down to the front of the window
+        void compact() noexcept
+        {
+            if (fCursor == 0)
+                return;
+
+            const size_t remaining = fUsed - fCursor;
+            if (remaining)
+                memmove(fWindow.data(), fWindow.data() + fCursor, remaining);
+
+            fUsed = remaining;
+            fCursor = 0;
+        }
+
+        bool growTo(size_t needed) noexcept
+        {
+            if (fMaxWindowSize && needed > fMaxWindowSize)
+                return false;
+
+            size_t newSize = fWindow.size() ? fWindow.size() : kInitialWindowSize;
+            while (newSize < needed)
+                newSize *= 2;
+
+            if (fMaxWindowSize && newSize > fMaxWindowSize)
+                newSize = fMaxWindowSize;
+
+            MemBuff bigger{};
+            if (!bigger.resetFromSize(newSize) || !bigger.data())
+                return false;
+
+            if (fUsed)
+                memcpy(bigger.data(), fWindow.data(), fUsed);
+
+            fWindow = std::move(bigger);
+
+            return true;
+        }
+    };
+}
@@ -3,6 +3,7 @@
 
 
 #include "bspan.h"
+#include "scanning.h"
 
 
 enum XmlTokenType {
@@ -35,9 +36,13 @@ namespace waavs {
     static constexpr charset xmlNcnameChars = chrAlphaChars + chrDecDigits + ".-_";
 
     // The retained state of the nextXmlToken function
+    // 'index' caches the structural classification of the block
+    // of input the cursor is currently in, so successive tokens
+    // don't have to look at the same bytes again.
     struct XmlTokenState {
         ByteSpan input;
         bool inTag = false;
+        XmlStructuralIndex index{};
 
         //bool empty() const noexcept { return input.empty(); }   
     };
@@ -71,10 +76,7 @@ namespace waavs {
     static inline bool readText(XmlTokenState& state, XmlToken& out)
     {
         const unsigned char* start = state.input.begin();
-        const unsigned char* lt = static_cast<const unsigned char*>(memchr(start, '<', state.input.size()));
-        
-        if (!lt)
-            lt = state.input.end();
+        const unsigned char* lt = xml_index_find_lt(state.index, start, state.input.end());
 
         if (lt != start) {
             out.reset(XML_TOKEN_TEXT, ByteSpan::fromPointers( start, lt ), false);
@@ -93,7 +95,7 @@ namespace waavs {
     // === Inside tag ===
     static inline bool readTagToken(XmlTokenState& state, XmlToken& out)
     {
-        bspan_skip_spaces(state.input);
+        state.input.resetStart(xml_index_skip_wsp(state.index, state.input.begin(), state.input.end()));
         if (state.input.empty())
             return false;
 
@@ -9,6 +9,7 @@
 
 #include "bspan_utils.h"
 #include "nametable.h"
+#include "smallmap.h"
 
 enum XML_ELEMENT_TYPE {
     XML_ELEMENT_TYPE_INVALID = 0
@@ -311,9 +312,9 @@ namespace waavs
                 kind == XML_ELEMENT_TYPE_SELF_CLOSING ||
                 kind == XML_ELEMENT_TYPE_END_TAG)
             {
-                fQNameAtom = !fQName.empty() ? PSNameTable::INTERN(fQName) : nullptr;
-                fLocalNameAtom = !fLocalName.empty() ? PSNameTable::INTERN(fLocalName) : nullptr;
-                fPrefixAtom = !fPrefix.empty() ? PSNameTable::INTERN(fPrefix) : nullptr;
+                fQNameAtom = !fQName.empty() ? PSNameScope::INTERN(fQName) : nullptr;
+                fLocalNameAtom = !fLocalName.empty() ? PSNameScope::INTERN(fLocalName) : nullptr;
+                fPrefixAtom = !fPrefix.empty() ? PSNameScope::INTERN(fPrefix) : nullptr;
             }
             else {
                 fQNameAtom = nullptr;
@@ -374,9 +375,14 @@ namespace waavs {
     //============================================================
     // XmlAttributeCollection
     // A collection of the attibutes found on an XmlElement
+    // 
+    // Most elements have only a few attributes, so they're held 
+    // in a SmallFlatMap, which doesn't allocate until there are more
+    // than kInlineAttributes of them.
     //============================================================
     using AttrKey = InternedKey;
-    using AttrDictionary = std::unordered_map<AttrKey, ByteSpan, InternedKeyHash, InternedKeyEquivalent>;
+    static constexpr size_t kInlineAttributes = 8;
+    using AttrDictionary = SmallFlatMap<AttrKey, ByteSpan, kInlineAttributes, InternedKeyHash, InternedKeyEquivalent>;
 
     struct XmlAttributeCollection
     {
@@ -395,7 +401,7 @@ namespace waavs {
         size_t size() const noexcept { return fAttributes.size(); }
         void clear() noexcept { fAttributes.clear(); }
 
-        bool hasValue(AttrKey key) const noexcept {return key && (fAttributes.find(key) != fAttributes.end());}
+        bool hasValue(AttrKey key) const noexcept {return key && fAttributes.contains(key);}
 
 
         // Add a single attribute to our collection of attributes
@@ -412,7 +418,7 @@ namespace waavs {
 
         void addValueBySpan(const ByteSpan& name, const ByteSpan& valueChunk) noexcept
         {
-            AttrKey key = PSNameTable::INTERN(name);
+            AttrKey key = PSNameScope::INTERN(name);
             return addValue(key, valueChunk);
         }
 
@@ -424,9 +430,9 @@ namespace waavs {
                 value.reset();
                 return false;
             }
-            auto it = fAttributes.find(key);
-            if (it != fAttributes.end()) {
-                value = it->second;
+            const ByteSpan* found = fAttributes.find(key);
+            if (found) {
+                value = *found;
                 return true;
             }
 
@@ -440,9 +446,11 @@ namespace waavs {
         }
 
         // get an attribute from the collection, based on a bytespan name
+        // A name that was never interned can't be in the collection, 
+        // so there's no need to intern it just to look
         bool getValueBySpan(const ByteSpan& name, ByteSpan& value) const noexcept
         {
-            AttrKey key = PSNameTable::INTERN(name);
+            AttrKey key = PSNameScope::LOOKUP(name);
             return getValue(key, value);
         }
 
@@ -455,7 +463,7 @@ namespace waavs {
         {
             for (const auto& attr : other.fAttributes)
             {
-                fAttributes[attr.first] = attr.second;
+                fAttributes.set(attr.first, attr.second);
             }
             return *this;
         }
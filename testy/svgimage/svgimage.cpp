@@ -63,7 +63,7 @@ static void setupFonts()
 // This is a little helper that takes a filename and creates a
 // SVGDocument from it.  You can create an in memory representation 
 // of the documet however you like.
-// Calling SVGFactory::createFromChunk() is the critical piece
+// Calling SVGFactory::createFromSharedChunk() is the critical piece
 //
 static SVGDocumentHandle createDocument(const char *filename)
 {
@@ -78,7 +78,7 @@ static SVGDocumentHandle createDocument(const char *filename)
 
 	ByteSpan mappedSpan;
 	mappedSpan.resetFromSize(mapped->data(), mapped->size());
-	auto doc = SVGFactory::createFromChunk(mappedSpan, CAN_WIDTH, CAN_HEIGHT, 96.0);
+	auto doc = SVGFactory::createFromSharedChunk(mapped, mappedSpan, CAN_WIDTH, CAN_HEIGHT, 96.0);
 
 	return doc;
 }
@@ -0,0 +1,150 @@
+//
+// test_atomtable
+//
+// Every well known name resolves to one atom, from its copy in the
+// static table, whether it's looked up at compile time or interned
+// at run time.  Other names get a stable atom of their own from the
+// dynamic table, however much it grows, and from any thread.
+//
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "unittest.h"
+
+#include "nametable.h"
+
+using namespace waavs;
+
+// Resolved at compile time, or this doesn't build
+static constexpr const char* kFillAtom = svgStaticAtom("fill");
+static constexpr const char* kRectAtom = svgStaticAtom("rect");
+
+static bool inStaticPool(const char* atom)
+{
+    return atom >= kSVGStaticAtoms.fChars && atom < kSVGStaticAtoms.fChars + kSVGStaticAtomPoolSize;
+}
+
+static void testStaticAtoms()
+{
+    CHECK(kFillAtom != nullptr && strcmp(kFillAtom, "fill") == 0);
+    CHECK(kRectAtom != nullptr && strcmp(kRectAtom, "rect") == 0);
+    CHECK(kFillAtom != kRectAtom);
+
+    // The table's own copy, not whichever string literal
+    CHECK(inStaticPool(kFillAtom));
+
+    size_t found = 0;
+    for (size_t i = 0; i < kSVGStaticAtomCount; i++)
+    {
+        const char* name = kSVGStaticAtomNames[i];
+        const size_t n = strlen(name);
+        const char* atom = kSVGStaticAtoms.find(name, n, fnv1a_64_chars(name, n));
+
+        if (atom && inStaticPool(atom) && strcmp(atom, name) == 0)
+            found++;
+    }
+    CHECK(found == kSVGStaticAtomCount);
+
+    // Not a well known name, or only part of one
+    CHECK(kSVGStaticAtoms.find("fil", 3, fnv1a_64_chars("fil", 3)) == nullptr);
+    CHECK(kSVGStaticAtoms.find("fills", 5, fnv1a_64_chars("fills", 5)) == nullptr);
+    CHECK(kSVGStaticAtoms.find("test-atomtable-name", 19, fnv1a_64_chars("test-atomtable-name", 19)) == nullptr);
+}
+
+static void testGlobalTable()
+{
+    // Well known names never reach the dynamic table
+    const size_t before = PSNameTable::getSingletonTable()->size();
+    CHECK(PSNameTable::INTERN("fill") == kFillAtom);
+    CHECK(PSNameTable::FIND("rect") == kRectAtom);
+
+    // Nor from a span that isn't null terminated
+    const char* text = "rectangle";
+    CHECK(PSNameTable::INTERN(ByteSpan((const unsigned char*)text, 4)) == kRectAtom);
+    CHECK(PSNameTable::getSingletonTable()->size() == before);
+}
+
+static void testDynamicNames()
+{
+    PSNameTable table(false, 16);
+
+    std::vector<std::string> names{};
+    std::vector<const char*> atoms{};
+    for (int i = 0; i < 3000; i++)
+    {
+        names.push_back("name-" + std::to_string(i));
+        atoms.push_back(table.intern(names.back().c_str()));
+    }
+
+    CHECK(table.size() == names.size());
+
+    // Grown many times over, and every atom is where it was
+    size_t same = 0;
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (table.find(names[i].c_str()) == atoms[i] && table.intern(names[i].c_str()) == atoms[i] && strcmp(atoms[i], names[i].c_str()) == 0)
+            same++;
+    }
+    CHECK(same == names.size());
+    CHECK(table.size() == names.size());
+
+    // Without the static atoms, a well known name is just a name
+    const char* fill = table.intern("fill");
+    CHECK(fill != kFillAtom && strcmp(fill, "fill") == 0);
+
+    CHECK(table.find("name-3000") == nullptr);
+}
+
+static void testConcurrentInterning()
+{
+    PSNameTable table(true, 16);
+
+    std::vector<std::string> names{};
+    for (int i = 0; i < 1000; i++)
+        names.push_back("shared-" + std::to_string(i));
+
+    const int kThreads = 8;
+    std::vector<std::vector<const char*>> seen(kThreads);
+    std::vector<std::thread> threads{};
+
+    for (int t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&, t]() {
+            // Each thread goes through the names in a different order
+            for (size_t i = 0; i < names.size(); i++)
+                table.intern(names[(i * 7 + size_t(t) * 131) % names.size()].c_str());
+
+            for (size_t i = 0; i < names.size(); i++)
+                seen[t].push_back(table.intern(names[i].c_str()));
+            });
+    }
+
+    for (auto& th : threads)
+        th.join();
+
+    CHECK(table.size() == names.size());
+
+    size_t agreed = 0;
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        bool same = true;
+        for (int t = 1; t < kThreads; t++)
+            same = same && seen[t][i] == seen[0][i];
+        if (same)
+            agreed++;
+    }
+    CHECK(agreed == names.size());
+}
+
+int main()
+{
+    testStaticAtoms();
+    testGlobalTable();
+    testDynamicNames();
+    testConcurrentInterning();
+
+    return unitTestReport("test_atomtable");
+}
@@ -0,0 +1,229 @@
+//
+// test_base64
+//
+// base64::decode() takes long runs a block at a time with AVX2 or
+// NEON where it's built for them, and the rest a quartet at a time.
+// Either way, the bytes, the status, and how far it got, have to be
+// exactly what the plain one-character-at-a-time rules give.
+//
+// Build it both with and without the vector instructions, to check 
+// both paths:
+//  g++ -std=c++20 -I ../../svg test_base64.cpp
+//  g++ -std=c++20 -mavx2 -I ../../svg test_base64.cpp
+//
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "unittest.h"
+
+#include "base64.h"
+
+using namespace waavs;
+
+struct DecodeResult
+{
+    DecodeStatus fStatus{};
+    size_t fRead{ 0 };
+    std::vector<uint8_t> fBytes{};
+
+    bool operator==(const DecodeResult& other) const
+    {
+        return fStatus == other.fStatus && fRead == other.fRead && fBytes == other.fBytes;
+    }
+};
+
+// referenceDecode()
+//
+// The rules, one character at a time
+static DecodeResult referenceDecode(const std::string& in)
+{
+    DecodeResult r{};
+
+    auto value = [](char c) -> int {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        if (c == '=') return 64;
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') return -2;
+        return -1;
+    };
+
+    int q[4];
+    int n = 0;
+    bool padded = false;
+
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        const int v = value(in[i]);
+        if (v == -2)
+            continue;
+
+        if (padded) { r.fStatus = DecodeStatus::DECODE_STATUS_InvalidPadding; r.fRead = i; return r; }
+        if (v == -1) { r.fStatus = DecodeStatus::DECODE_STATUS_InvalidByte; r.fRead = i; return r; }
+
+        q[n++] = v;
+        if (n < 4)
+            continue;
+        n = 0;
+
+        if (q[0] == 64 || q[1] == 64) { r.fStatus = DecodeStatus::DECODE_STATUS_InvalidPadding; r.fRead = i + 1; return r; }
+
+        const uint32_t bits = (uint32_t(q[0]) << 18) | (uint32_t(q[1]) << 12) | (uint32_t(q[2] & 63) << 6) | uint32_t(q[3] & 63);
+
+        if (q[2] != 64 && q[3] != 64)
+        {
+            r.fBytes.push_back(uint8_t(bits >> 16));
+            r.fBytes.push_back(uint8_t(bits >> 8));
+            r.fBytes.push_back(uint8_t(bits));
+        }
+        else if (q[2] == 64 && q[3] == 64)
+        {
+            r.fBytes.push_back(uint8_t(bits >> 16));
+            padded = true;
+        }
+        else if (q[2] != 64 && q[3] == 64)
+        {
+            r.fBytes.push_back(uint8_t(bits >> 16));
+            r.fBytes.push_back(uint8_t(bits >> 8));
+            padded = true;
+        }
+        else
+        {
+            r.fStatus = DecodeStatus::DECODE_STATUS_InvalidPadding;
+            r.fRead = i + 1;
+            return r;
+        }
+    }
+
+    r.fRead = in.size();
+
+    // Unpadded endings
+    if (n == 1) { r.fStatus = DecodeStatus::DECODE_STATUS_IncompleteQuartet; return r; }
+    if (n >= 2)
+    {
+        if (q[0] == 64 || q[1] == 64 || (n == 3 && q[2] == 64)) { r.fStatus = DecodeStatus::DECODE_STATUS_InvalidPadding; return r; }
+
+        const uint32_t bits = (uint32_t(q[0]) << 18) | (uint32_t(q[1]) << 12) | (n == 3 ? uint32_t(q[2]) << 6 : 0);
+        r.fBytes.push_back(uint8_t(bits >> 16));
+        if (n == 3)
+            r.fBytes.push_back(uint8_t(bits >> 8));
+    }
+
+    r.fStatus = DecodeStatus::DECODE_STATUS_Success;
+    return r;
+}
+
+static DecodeResult libraryDecode(const std::string& in)
+{
+    DecodeResult r{};
+    r.fBytes.resize(in.size());
+
+    size_t written = 0;
+    r.fStatus = base64::decode((const uint8_t*)in.data(), in.size(), r.fBytes.data(), r.fBytes.size(), r.fRead, written);
+    r.fBytes.resize(written);
+
+    // On failure, only the status and position are meaningful
+    return r;
+}
+
+static std::string encode(const std::vector<uint8_t>& bytes)
+{
+    std::string out(base64::getEncodeOutputSize(bytes.size()), '\0');
+    const size_t n = base64::encode(bytes.data(), bytes.size(), out.data());
+    out.resize(n);
+    return out;
+}
+
+static void testRoundTrip(std::mt19937& rng)
+{
+    int failures = 0;
+    for (size_t len = 0; len < 600; len++)
+    {
+        std::vector<uint8_t> bytes(len);
+        for (auto& b : bytes)
+            b = uint8_t(rng());
+
+        const std::string text = encode(bytes);
+        DecodeResult r = libraryDecode(text);
+        if (r.fStatus != DecodeStatus::DECODE_STATUS_Success || r.fBytes != bytes || r.fRead != text.size())
+            failures++;
+    }
+    CHECK(failures == 0);
+}
+
+static void testAgainstReference(std::mt19937& rng)
+{
+    static const char kJunk[] = " \n\t\r=!-_.*\x80\xff";
+
+    int failures = 0;
+    for (int i = 0; i < 20000; i++)
+    {
+        // Long enough for several vector blocks
+        std::vector<uint8_t> bytes(rng() % 300);
+        for (auto& b : bytes)
+            b = uint8_t(rng());
+
+        std::string text = encode(bytes);
+
+        // Sprinkle in whitespace, padding, or invalid bytes, 
+        // sometimes in the middle of a long run, sometimes not at all
+        const int edits = int(rng() % 4);
+        for (int e = 0; e < edits && !text.empty(); e++)
+        {
+            const size_t at = rng() % text.size();
+            const char c = kJunk[rng() % (sizeof(kJunk) - 1)];
+            if (rng() % 2)
+                text.insert(text.begin() + at, c);
+            else
+                text[at] = c;
+        }
+
+        // Sometimes drop the padding, or cut it short
+        if (rng() % 5 == 0)
+            text.resize(text.size() - std::min<size_t>(text.size(), rng() % 3));
+
+        const DecodeResult lib = libraryDecode(text);
+        const DecodeResult ref = referenceDecode(text);
+
+        bool same = lib.fStatus == ref.fStatus && lib.fRead == ref.fRead;
+        if (ref.fStatus == DecodeStatus::DECODE_STATUS_Success)
+            same = same && lib.fBytes == ref.fBytes;
+
+        if (!same)
+        {
+            if (failures == 0)
+                printf("first mismatch: \"%s\"\n", text.c_str());
+            failures++;
+        }
+    }
+    CHECK(failures == 0);
+}
+
+static void testOutputTooSmall()
+{
+    std::vector<uint8_t> bytes(200, 0x5a);
+    const std::string text = encode(bytes);
+
+    std::vector<uint8_t> out(100);
+    size_t read = 0, written = 0;
+    const DecodeStatus st = base64::decode((const uint8_t*)text.data(), text.size(), out.data(), out.size(), read, written);
+
+    CHECK(st == DecodeStatus::DECODE_STATUS_OutputTooSmall);
+    CHECK(written <= out.size());
+}
+
+int main()
+{
+    std::mt19937 rng(77);
+
+    testRoundTrip(rng);
+    testAgainstReference(rng);
+    testOutputTooSmall();
+
+    return unitTestReport("test_base64");
+}
@@ -0,0 +1,118 @@
+//
+// test_batchrenderer
+//
+// Every item gets its own result, in the order the items were given,
+// whichever worker did it.  Items that can't be done fail on their
+// own, without taking the rest of the batch with them, and only the
+// ones that worked are counted.  The background asked for is what's
+// under the drawing.
+//
+// This one draws, so it needs blend2d
+//
+// cl  /EHsc /std:c++20 -I ..\\..\\ -I ..\\..\\svg  test_batchrenderer.cpp blend2d.lib  /link /LIBPATH:"..\\..\\lib\\Release"
+//
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "unittest.h"
+
+#include "svgbatchrenderer.h"
+
+using namespace waavs;
+
+static const char* kSvg =
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"20\" height=\"20\" viewBox=\"0 0 20 20\">"
+    "<rect x=\"5\" y=\"5\" width=\"10\" height=\"10\" fill=\"blue\"/>"
+    "</svg>";
+
+// The pixel at (x, y) of an encoded image
+static bool decodedPixel(const BLArray<uint8_t>& encoded, int x, int y, uint32_t& pixel)
+{
+    BLImage img{};
+    if (img.read_from_data(encoded.data(), encoded.size()) != BL_SUCCESS)
+        return false;
+
+    BLImageData data{};
+    if (img.get_data(&data) != BL_SUCCESS || x >= data.size.w || y >= data.size.h)
+        return false;
+
+    pixel = ((const uint32_t*)((const uint8_t*)data.pixel_data + y * data.stride))[x];
+    return true;
+}
+
+static void testOrderAndFailures()
+{
+    const ByteSpan source((const unsigned char*)kSvg, strlen(kSvg));
+
+    std::vector<SVGBatchItem> items{};
+    for (int i = 0; i < 24; i++)
+    {
+        SVGBatchItem item{};
+        item.fSource = source;
+        item.fWidth = 20 + i;
+        item.fHeight = 20 + i;
+        item.fFormat = "PNG";
+
+        // Nothing to draw, and nothing to encode with
+        if (i == 5)
+            item.fSource = ByteSpan{};
+        if (i == 11)
+            item.fFormat = "NOT-A-CODEC";
+
+        items.push_back(item);
+    }
+
+    SVGBatchOptions opts{};
+    opts.fThreadCount = 4;
+    opts.fBackground = BLRgba32(0xFFFFFFFF);
+
+    std::vector<SVGBatchResult> results{};
+    const size_t succeeded = renderBatch(items, results, opts);
+
+    CHECK(results.size() == items.size());
+    CHECK(succeeded == items.size() - 2);
+
+    CHECK(!results[5].fSuccess && results[5].fError != nullptr);
+    CHECK(!results[11].fSuccess && results[11].fError != nullptr);
+
+    size_t inOrder = 0;
+    size_t counted = 0;
+    for (size_t i = 0; i < results.size() && i < items.size(); i++)
+    {
+        if (results[i].fSuccess)
+            counted++;
+
+        if (i == 5)
+            continue;
+
+        if (results[i].fWidth == items[i].fWidth && results[i].fHeight == items[i].fHeight)
+            inOrder++;
+    }
+    CHECK(counted == succeeded);
+    CHECK(inOrder == items.size() - 1);
+
+    // The background is under the corner, the drawing in the middle
+    uint32_t corner = 0;
+    uint32_t middle = 0;
+    CHECK(decodedPixel(results[0].fEncoded, 0, 0, corner) && corner == 0xFFFFFFFFu);
+    CHECK(decodedPixel(results[0].fEncoded, 10, 10, middle) && middle == 0xFF0000FFu);
+}
+
+static void testEmptyBatch()
+{
+    std::vector<SVGBatchItem> items{};
+    std::vector<SVGBatchResult> results(3);
+
+    CHECK(renderBatch(items, results) == 0);
+    CHECK(results.empty());
+}
+
+int main()
+{
+    testOrderAndFailures();
+    testEmptyBatch();
+
+    return unitTestReport("test_batchrenderer");
+}
@@ -0,0 +1,208 @@
+//
+// test_boundsindex
+//
+// SVGBoundsIndex hands back exactly the items whose bounds touch the
+// query rectangle, plus the unbounded ones, in ascending order, which
+// is what looking at every item would give.  That holds for empty
+// indexes, for bounds with no width or height, for items that only
+// share an edge with the query, and for an index built again.
+//
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "unittest.h"
+
+#include "svgboundsindex.h"
+
+using namespace waavs;
+
+using Entries = std::vector<std::pair<uint32_t, WGRectD>>;
+
+// Looking at every item
+static std::vector<uint32_t> bruteForce(const Entries& entries, const std::vector<uint32_t>& unbounded, const WGRectD& r)
+{
+    std::vector<uint32_t> out = unbounded;
+    for (const auto& e : entries)
+    {
+        const WGRectD& b = e.second;
+        if (b.x <= r.x + r.w && r.x <= b.x + b.w && b.y <= r.y + r.h && r.y <= b.y + b.h)
+            out.push_back(e.first);
+    }
+
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+static WGRectD randomRect(std::mt19937& rng, double extent, double maxSize)
+{
+    std::uniform_real_distribution<double> pos(-extent * 0.1, extent);
+    std::uniform_real_distribution<double> size(0.0, maxSize);
+
+    WGRectD r{ pos(rng), pos(rng), size(rng), size(rng) };
+
+    // Now and then, a line or a point
+    switch (rng() % 8)
+    {
+    case 0: r.w = 0; break;
+    case 1: r.h = 0; break;
+    case 2: r.w = 0; r.h = 0; break;
+    default: break;
+    }
+
+    return r;
+}
+
+static void testAgainstBruteForce()
+{
+    std::mt19937 rng(19);
+
+    const size_t counts[] = { 1, 7, 8, 9, 16, 17, 100, 1000, 5000 };
+    size_t agreed = 0;
+    size_t queries = 0;
+
+    for (size_t count : counts)
+    {
+        Entries entries{};
+        std::vector<uint32_t> unbounded{};
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (rng() % 10 == 0)
+                unbounded.push_back(i);
+            else
+                entries.emplace_back(i, randomRect(rng, 1000.0, 60.0));
+        }
+
+        // build() reorders what it's given
+        const Entries original = entries;
+
+        SVGBoundsIndex index{};
+        index.build(entries, unbounded);
+        CHECK(!index.empty());
+
+        std::vector<uint32_t> got{};
+        for (int q = 0; q < 200; q++)
+        {
+            const WGRectD r = randomRect(rng, 1000.0, q < 100 ? 50.0 : 600.0);
+
+            index.query(r, got);
+            queries++;
+            if (got == bruteForce(original, unbounded, r))
+                agreed++;
+        }
+    }
+
+    CHECK(agreed == queries);
+}
+
+static void testEmpty()
+{
+    SVGBoundsIndex index{};
+    CHECK(index.empty());
+
+    std::vector<uint32_t> got{ 1, 2, 3 };
+    index.query(WGRectD{ 0, 0, 100, 100 }, got);
+    CHECK(got.empty());
+
+    // Nothing bounded, but something to hand back
+    Entries entries{};
+    index.build(entries, { 4, 2 });
+    CHECK(!index.empty());
+
+    index.query(WGRectD{ 0, 0, 1, 1 }, got);
+    CHECK((got == std::vector<uint32_t>{ 2, 4 }));
+
+    index.build(entries, {});
+    CHECK(index.empty());
+    index.query(WGRectD{ 0, 0, 1, 1 }, got);
+    CHECK(got.empty());
+}
+
+static void testDegenerate()
+{
+    Entries entries{};
+
+    // A grid of points, horizontal lines, and vertical lines
+    for (uint32_t i = 0; i < 30; i++)
+    {
+        const double x = double(i % 6) * 10.0;
+        const double y = double(i / 6) * 10.0;
+
+        if (i % 3 == 0)
+            entries.emplace_back(i, WGRectD{ x, y, 0, 0 });
+        else if (i % 3 == 1)
+            entries.emplace_back(i, WGRectD{ x, y, 5, 0 });
+        else
+            entries.emplace_back(i, WGRectD{ x, y, 0, 5 });
+    }
+
+    // Everything in one place
+    for (uint32_t i = 30; i < 50; i++)
+        entries.emplace_back(i, WGRectD{ 100, 100, 0, 0 });
+
+    const Entries original = entries;
+
+    SVGBoundsIndex index{};
+    index.build(entries, {});
+
+    std::vector<uint32_t> got{};
+
+    // A point query, right on a point
+    index.query(WGRectD{ 100, 100, 0, 0 }, got);
+    CHECK(got.size() == 20);
+    CHECK(got == bruteForce(original, {}, WGRectD{ 100, 100, 0, 0 }));
+
+    // Only sharing an edge counts as touching
+    index.query(WGRectD{ 5, 0, 5, 5 }, got);
+    CHECK(got == bruteForce(original, {}, WGRectD{ 5, 0, 5, 5 }));
+    CHECK(std::find(got.begin(), got.end(), 1u) != got.end());
+
+    // Between them all
+    index.query(WGRectD{ 1, 1, 2, 2 }, got);
+    CHECK(got.empty());
+
+    // Everything, once each
+    index.query(WGRectD{ -1, -1, 200, 200 }, got);
+    CHECK(got.size() == original.size());
+    CHECK(std::adjacent_find(got.begin(), got.end()) == got.end());
+}
+
+static void testRebuild()
+{
+    Entries first{};
+    for (uint32_t i = 0; i < 40; i++)
+        first.emplace_back(i, WGRectD{ double(i) * 10.0, 0, 5, 5 });
+
+    SVGBoundsIndex index{};
+    index.build(first, { 100 });
+
+    // Built again from something else, nothing of the first is left
+    Entries second{};
+    for (uint32_t i = 0; i < 12; i++)
+        second.emplace_back(i + 200, WGRectD{ 0, double(i) * 10.0, 5, 5 });
+    const Entries original = second;
+
+    index.build(second, {});
+
+    std::vector<uint32_t> got{};
+    index.query(WGRectD{ 0, 0, 1000, 1000 }, got);
+    CHECK(got == bruteForce(original, {}, WGRectD{ 0, 0, 1000, 1000 }));
+    CHECK(got.size() == 12 && got.front() == 200);
+
+    index.clear();
+    CHECK(index.empty());
+    index.query(WGRectD{ 0, 0, 1000, 1000 }, got);
+    CHECK(got.empty());
+}
+
+int main()
+{
+    testAgainstBruteForce();
+    testEmpty();
+    testDegenerate();
+    testRebuild();
+
+    return unitTestReport("test_boundsindex");
+}
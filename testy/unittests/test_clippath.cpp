@@ -0,0 +1,133 @@
+//
+// test_clippath
+//
+// A clipPath clips the same whether it comes down to a rectangle the
+// driver can clip to, or has to be drawn.  Its own transform is
+// applied after its object bounding box units, in the clipped
+// element's user space.  Replayed from a frozen document, it clips
+// the same again.
+//
+// This one draws, so it needs blend2d
+//
+// cl  /EHsc /std:c++20 -I ..\\..\\ -I ..\\..\\svg  test_clippath.cpp blend2d.lib  /link /LIBPATH:"..\\..\\lib\\Release"
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "unittest.h"
+
+#include "svgdocument.h"
+#include "svgrendersession.h"
+
+using namespace waavs;
+
+// One rectangle, or the same rectangle twice, which has to be drawn
+static std::string clipDocument(bool twice)
+{
+    std::string clip = "<rect x=\"0\" y=\"0\" width=\"0.5\" height=\"0.5\"/>";
+    if (twice)
+        clip += clip;
+
+    return
+        "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\" viewBox=\"0 0 100 100\">"
+        "<defs><clipPath id=\"c\" clipPathUnits=\"objectBoundingBox\" transform=\"translate(10,0)\">" + clip + "</clipPath></defs>"
+        "<rect x=\"10\" y=\"10\" width=\"40\" height=\"40\" fill=\"red\" clip-path=\"url(#c)\"/>"
+        "</svg>";
+}
+
+static std::shared_ptr<SVGDocument> loadDocument(const std::string& src)
+{
+    return SVGDocument::createFromChunk(ByteSpan((const unsigned char*)src.data(), src.size()), 100, 100, 96);
+}
+
+// The largest difference in any one channel
+static int maxDifference(const Surface& a, const Surface& b)
+{
+    if (a.width() != b.width() || a.height() != b.height())
+        return 256;
+
+    int worst = 0;
+    for (int y = 0; y < int(a.height()); y++)
+    {
+        const uint8_t* ra = (const uint8_t*)a.rowPointer(y);
+        const uint8_t* rb = (const uint8_t*)b.rowPointer(y);
+
+        for (size_t i = 0; i < a.width() * 4; i++)
+            worst = std::max(worst, std::abs(int(ra[i]) - int(rb[i])));
+    }
+
+    return worst;
+}
+
+static uint32_t pixelAt(const Surface& s, int x, int y)
+{
+    return ((const uint32_t*)s.rowPointer(y))[x];
+}
+
+static void drawDirect(SVGDocument& doc, Surface& target, const WGMatrix3x3& sceneToTarget)
+{
+    SVGB2DDriver ctx{};
+    ctx.attach(target, 1);
+    ctx.renew();
+    ctx.transform(sceneToTarget);
+
+    doc.draw(&ctx, &doc);
+
+    ctx.detach();
+}
+
+static void testTransformedClip()
+{
+    auto single = loadDocument(clipDocument(false));
+    auto twice = loadDocument(clipDocument(true));
+    CHECK(single != nullptr && twice != nullptr);
+    if (!single || !twice)
+        return;
+
+    // Not at 1:1, so the units and the canvas transform can't be
+    // mistaken for each other
+    const WGMatrix3x3 sceneToTarget = WGMatrix3x3::makeScaling(2.0);
+
+    Surface a(200, 200);
+    Surface b(200, 200);
+    drawDirect(*single, a, sceneToTarget);
+    drawDirect(*twice, b, sceneToTarget);
+
+    // The top left quarter of the box, (10,10,20,20), moved over by
+    // 10, is (20,10,20,20), which is (40,20,40,40) on the canvas
+    CHECK(pixelAt(a, 50, 30) == 0xFFFF0000u);
+    CHECK(pixelAt(a, 30, 30) == 0);
+    CHECK(pixelAt(a, 50, 70) == 0);
+    CHECK(pixelAt(a, 90, 30) == 0);
+
+    CHECK(pixelAt(b, 50, 30) == 0xFFFF0000u);
+    CHECK(maxDifference(a, b) <= 2);
+
+    // The same, replayed
+    auto frozenSingle = freezeDocument(*single);
+    auto frozenTwice = freezeDocument(*twice);
+    CHECK(frozenSingle != nullptr && frozenTwice != nullptr);
+    if (!frozenSingle || !frozenTwice)
+        return;
+
+    SVGRenderSession session{};
+
+    Surface ra(200, 200);
+    Surface rb(200, 200);
+    CHECK(session.renderInto(*frozenSingle, ra, sceneToTarget));
+    CHECK(session.renderInto(*frozenTwice, rb, sceneToTarget));
+
+    CHECK(maxDifference(a, ra) <= 2);
+    CHECK(maxDifference(a, rb) <= 2);
+}
+
+int main()
+{
+    testTransformedClip();
+
+    return unitTestReport("test_clippath");
+}
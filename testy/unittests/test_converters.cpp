@@ -0,0 +1,152 @@
+//
+// test_converters
+//
+// readNumber() has to give the same double the C library does, for
+// ordinary coordinates and for the awkward cases: long mantissas,
+// extreme exponents, units that start with 'e', and signed zeros.
+//
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "unittest.h"
+
+#include "converters.h"
+
+using namespace waavs;
+
+static bool sameBits(double a, double b)
+{
+    return memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// Parse 'str', and check it matches strtod, and that exactly
+// 'consumed' bytes were used up
+static bool parsesLike(const char* str, size_t consumed)
+{
+    ByteSpan s(str);
+    double value{};
+    if (!readNumber(s, value))
+        return false;
+
+    if (size_t(s.begin() - (const unsigned char*)str) != consumed)
+        return false;
+
+    std::string text(str, consumed);
+    double expected = strtod(text.c_str(), nullptr);
+    if (expected == 0.0)
+        expected = 0.0;
+
+    return sameBits(value, expected);
+}
+
+static void testRoundTrip()
+{
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> coords(-10000.0, 10000.0);
+
+    char buff[64];
+    int mismatches = 0;
+
+    // Written out with full precision, a double reads back exactly
+    for (int i = 0; i < 100000; i++)
+    {
+        uint64_t bits = rng();
+        double d{};
+        memcpy(&d, &bits, sizeof(d));
+        if (!std::isfinite(d))
+            continue;
+
+        snprintf(buff, sizeof(buff), "%.17g", d);
+
+        ByteSpan s(buff);
+        double back{};
+        if (!readNumber(s, back) || !(back == d))
+            mismatches++;
+    }
+    CHECK(mismatches == 0);
+
+    // Typical coordinates, in the precisions they're typically written
+    mismatches = 0;
+    for (int i = 0; i < 100000; i++)
+    {
+        snprintf(buff, sizeof(buff), "%.*f", i % 7, coords(rng));
+        if (!parsesLike(buff, strlen(buff)))
+            mismatches++;
+    }
+    CHECK(mismatches == 0);
+}
+
+static void testEdgeCases()
+{
+    CHECK(parsesLike("0", 1));
+    CHECK(parsesLike("12", 2));
+    CHECK(parsesLike("-12.5", 5));
+    CHECK(parsesLike("+.5", 3));
+    CHECK(parsesLike("5.", 2));
+    CHECK(parsesLike(".25e2", 5));
+    CHECK(parsesLike("1E-3", 4));
+    CHECK(parsesLike("1e+3", 4));
+
+    // Nearest double, not a sum of rounded parts
+    CHECK(parsesLike("0.1", 3));
+    CHECK(parsesLike("0.3", 3));
+    CHECK(parsesLike("9007199254740993", 16));
+    CHECK(parsesLike("2.2250738585072011e-308", 23));
+    CHECK(parsesLike("4.9406564584124654e-324", 23));
+    CHECK(parsesLike("1.7976931348623157e308", 22));
+
+    // More than 19 digits, with and without leading zeros
+    CHECK(parsesLike("123456789012345678901234567890", 30));
+    CHECK(parsesLike("0.000000000000000000000012345", 29));
+    CHECK(parsesLike("3.14159265358979323846264338327950288", 37));
+
+    // Extremes
+    CHECK(parsesLike("1e400", 5));
+    CHECK(parsesLike("1e-400", 6));
+    CHECK(parsesLike("1e99999999999", 13));
+
+    // 'e' without digits is a unit, and left alone
+    CHECK(parsesLike("10em", 2));
+    CHECK(parsesLike("3ex", 1));
+    CHECK(parsesLike("2e", 1));
+    CHECK(parsesLike("2e+", 1));
+
+    // Numbers run into each other in path data
+    CHECK(parsesLike("1.5.5", 3));
+    CHECK(parsesLike("-1-2", 2));
+
+    // Not numbers
+    ByteSpan s{};
+    double v{};
+    s = ByteSpan("-");      CHECK(!readNumber(s, v));
+    s = ByteSpan(".");      CHECK(!readNumber(s, v));
+    s = ByteSpan("+.e5");   CHECK(!readNumber(s, v));
+    s = ByteSpan("abc");    CHECK(!readNumber(s, v));
+    s = ByteSpan("");       CHECK(!readNumber(s, v));
+}
+
+static void testZeros()
+{
+    // A zero is always +0.0
+    const char* zeros[] = { "0", "-0", "+0", "-0.0", "-.0", "-0e10", "-0.00000000000000000000000", "-1e-400" };
+    for (const char* z : zeros)
+    {
+        ByteSpan s(z);
+        double v = 1.0;
+        CHECK(readNumber(s, v));
+        CHECK(sameBits(v, 0.0));
+    }
+}
+
+int main()
+{
+    testRoundTrip();
+    testEdgeCases();
+    testZeros();
+
+    return unitTestReport("test_converters");
+}
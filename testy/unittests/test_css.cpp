@@ -0,0 +1,170 @@
+//
+// test_css
+//
+// Style sheet rules are found through their index buckets, merged
+// lowest specificity first and in source order after that, and an
+// appended sheet behaves as if its rules had been loaded last.
+// Specificity fields saturate rather than carry.
+//
+
+#include <string>
+#include <vector>
+
+#include "unittest.h"
+
+#include "svgcss.h"
+
+using namespace waavs;
+
+static bool valueIs(const XmlAttributeCollection& attrs, const char* name, const char* expected)
+{
+    ByteSpan value{};
+    if (!attrs.getValueBySpan(ByteSpan(name), value))
+        return false;
+    return value == expected;
+}
+
+static CSSMatchSubject subjectOf(const char* tag, const char* id, const char* classes, const XmlAttributeCollection* attrs = nullptr)
+{
+    CSSMatchSubject s{};
+    s.fTag = PSNameTable::INTERN(tag);
+    s.fId = ByteSpan(id);
+    s.fClasses = ByteSpan(classes);
+    s.fAttributes = attrs;
+    return s;
+}
+
+static void testSpecificity()
+{
+    CHECK(css_pack_specificity(0, 0, 1) == 0x000001);
+    CHECK(css_pack_specificity(1, 2, 3) == 0x010203);
+
+    // 256 classes don't add up to an id
+    CHECK(css_pack_specificity(0, 256, 0) == 0x00FF00);
+    CHECK(css_pack_specificity(0, 1000, 0) < css_pack_specificity(1, 0, 0));
+    CHECK(css_pack_specificity(300, 300, 300) == 0xFFFFFF);
+
+    CSSStyleSheet sheet{};
+    sheet.loadFromSpan(ByteSpan("rect { a: 1 } .c { a: 2 } #i { a: 3 } rect.c[x] { a: 4 }"));
+    CHECK(sheet.size() == 4);
+
+    const auto& rules = sheet.rules();
+    CHECK(rules[0].specificity() == 0x000001);
+    CHECK(rules[1].specificity() == 0x000100);
+    CHECK(rules[2].specificity() == 0x010000);
+    CHECK(rules[3].specificity() == 0x000201);
+
+    // A long run of classes saturates
+    std::string many{};
+    for (int i = 0; i < 300; i++)
+        many += ".k";
+    many += " { a: 5 }";
+
+    CSSStyleSheet big{};
+    big.loadFromSpan(ByteSpan(many.c_str()));
+    CHECK(big.size() == 1);
+    CHECK(big.rules()[0].specificity() == 0x00FF00);
+}
+
+static void testMatchOrder()
+{
+    CSSStyleSheet sheet{};
+    sheet.loadFromSpan(ByteSpan(
+        "#i { fill: id; }"
+        ".c { fill: class; stroke: class; }"
+        "rect { fill: tag; stroke: tag; opacity: tag; }"
+        "* { fill: any; stroke: any; opacity: any; color: any; }"
+        ".c { stroke: later-class; }"
+        "circle { fill: circle; }"));
+
+    XmlAttributeCollection attrs{};
+    CSSMatchSubject subject = subjectOf("rect", "i", "c");
+
+    std::vector<const CSSSelector*> matched{};
+    CHECK(sheet.collectMatches(subject, matched) == 5);
+
+    // lowest specificity first, then source order
+    for (size_t i = 1; i < matched.size(); i++)
+    {
+        const bool ordered = matched[i - 1]->specificity() < matched[i]->specificity() ||
+            (matched[i - 1]->specificity() == matched[i]->specificity() && matched[i - 1]->order() < matched[i]->order());
+        CHECK(ordered);
+    }
+
+    CHECK(sheet.applyMatches(subject, attrs) == 5);
+    CHECK(valueIs(attrs, "fill", "id"));
+    CHECK(valueIs(attrs, "stroke", "later-class"));
+    CHECK(valueIs(attrs, "opacity", "tag"));
+    CHECK(valueIs(attrs, "color", "any"));
+
+    // Only the universal rule reaches an unrelated element
+    XmlAttributeCollection other{};
+    CHECK(sheet.applyMatches(subjectOf("path", "", ""), other) == 1);
+    CHECK(valueIs(other, "fill", "any"));
+
+    // A repeated class word doesn't match its rules twice
+    CHECK(sheet.collectMatches(subjectOf("g", "", "c c"), matched) == 3);
+}
+
+static void testAttributeRules()
+{
+    CSSStyleSheet sheet{};
+    sheet.loadFromSpan(ByteSpan(
+        "[data-x] { fill: has; }"
+        "[data-x=\"two\"] { stroke: equals; }"
+        "[data-y~=b] { color: includes; }"));
+
+    XmlAttributeCollection elemAttrs{};
+    elemAttrs.addValueBySpan(ByteSpan("data-x"), ByteSpan("two"));
+    elemAttrs.addValueBySpan(ByteSpan("data-y"), ByteSpan("a b c"));
+
+    XmlAttributeCollection attrs{};
+    CHECK(sheet.applyMatches(subjectOf("rect", "", "", &elemAttrs), attrs) == 3);
+    CHECK(valueIs(attrs, "fill", "has"));
+    CHECK(valueIs(attrs, "stroke", "equals"));
+    CHECK(valueIs(attrs, "color", "includes"));
+
+    XmlAttributeCollection none{};
+    CHECK(sheet.applyMatches(subjectOf("rect", "", ""), none) == 0);
+}
+
+static void testAppendSheet()
+{
+    CSSStyleSheet first{};
+    first.loadFromSpan(ByteSpan(".c { fill: first; } rect { stroke: first; }"));
+
+    CSSStyleSheet second{};
+    second.loadFromSpan(ByteSpan(".c { fill: second; } #i { stroke: second; }"));
+
+    CSSStyleSheet merged{};
+    merged.appendSheet(first);
+    merged.appendSheet(second);
+
+    CSSStyleSheet together{};
+    together.loadFromSpan(ByteSpan(".c { fill: first; } rect { stroke: first; } .c { fill: second; } #i { stroke: second; }"));
+
+    CHECK(merged.size() == together.size());
+    for (size_t i = 0; i < merged.size() && i < together.size(); i++)
+    {
+        CHECK(merged.rules()[i].order() == uint32_t(i));
+        CHECK(merged.rules()[i].specificity() == together.rules()[i].specificity());
+    }
+
+    XmlAttributeCollection a{};
+    XmlAttributeCollection b{};
+    merged.applyMatches(subjectOf("rect", "i", "c"), a);
+    together.applyMatches(subjectOf("rect", "i", "c"), b);
+
+    CHECK(valueIs(a, "fill", "second") && valueIs(b, "fill", "second"));
+    CHECK(valueIs(a, "stroke", "second") && valueIs(b, "stroke", "second"));
+}
+
+int main()
+{
+    testSpecificity();
+    testMatchOrder();
+    testAttributeRules();
+    testAppendSheet();
+
+    return unitTestReport("test_css");
+}
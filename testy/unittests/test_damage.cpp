@@ -0,0 +1,170 @@
+//
+// test_damage
+//
+// Changing an attribute of an element that's been drawn reports where
+// it was as damaged, and nothing else.  Redrawing just that part of
+// the canvas comes out the same as drawing the whole thing again, with
+// the change showing.  A sibling that shared the element's style is
+// left as it was.
+//
+// This one draws, so it needs blend2d
+//
+// cl  /EHsc /std:c++20 -I ..\\..\\ -I ..\\..\\svg  test_damage.cpp blend2d.lib  /link /LIBPATH:"..\\..\\lib\\Release"
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "unittest.h"
+
+#include "svgdocument.h"
+#include "svgdamage.h"
+
+using namespace waavs;
+
+static const char* kSvg =
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\" viewBox=\"0 0 100 100\">"
+    "<rect id=\"a\" x=\"10\" y=\"10\" width=\"30\" height=\"30\" fill=\"red\"/>"
+    "<rect id=\"b\" x=\"60\" y=\"60\" width=\"30\" height=\"30\" fill=\"red\"/>"
+    "</svg>";
+
+static std::shared_ptr<SVGDocument> loadDocument()
+{
+    return SVGDocument::createFromChunk(ByteSpan((const unsigned char*)kSvg, strlen(kSvg)), 100, 100, 96);
+}
+
+static std::shared_ptr<SVGGraphicsElement> elementById(SVGDocument& doc, const char* id)
+{
+    return std::dynamic_pointer_cast<SVGGraphicsElement>(doc.getElementById(ByteSpan(id)));
+}
+
+// The largest difference in any one channel
+static int maxDifference(const Surface& a, const Surface& b)
+{
+    if (a.width() != b.width() || a.height() != b.height())
+        return 256;
+
+    int worst = 0;
+    for (int y = 0; y < int(a.height()); y++)
+    {
+        const uint8_t* ra = (const uint8_t*)a.rowPointer(y);
+        const uint8_t* rb = (const uint8_t*)b.rowPointer(y);
+
+        for (size_t i = 0; i < a.width() * 4; i++)
+            worst = std::max(worst, std::abs(int(ra[i]) - int(rb[i])));
+    }
+
+    return worst;
+}
+
+static uint32_t pixelAt(const Surface& s, int x, int y)
+{
+    return ((const uint32_t*)s.rowPointer(y))[x];
+}
+
+static void drawAll(SVGDocument& doc, SVGB2DDriver& ctx)
+{
+    ctx.renew();
+    doc.draw(&ctx, &doc);
+    ctx.flush();
+}
+
+// The same as SVGCachedView does, clear and draw one part of the canvas
+static void redrawRect(SVGDocument& doc, SVGB2DDriver& ctx, const WGRectI& r)
+{
+    ctx.setCullRect(r);
+    ctx.initState();
+    ctx.blendMode(BL_COMP_OP_SRC_OVER);
+
+    ctx.push();
+    ctx.transform(WGMatrix3x3::makeIdentity());
+    ctx.clipRect(WGRectD(r.x, r.y, r.w, r.h));
+    ctx.clear();
+
+    doc.draw(&ctx, &doc);
+
+    ctx.noClip();
+    ctx.pop();
+    ctx.flush();
+
+    ctx.clearCullRect();
+}
+
+static void testDamageAndRepaint()
+{
+    auto doc = loadDocument();
+    CHECK(doc != nullptr);
+    if (!doc)
+        return;
+
+    Surface canvas(100, 100);
+    SVGB2DDriver ctx{};
+    ctx.attach(canvas, 1);
+    ctx.trackDamage(true);
+
+    drawAll(*doc, ctx);
+
+    SVGDamageRegion damage{};
+    doc->takeDamage(damage);
+    damage.clear();
+
+    auto a = elementById(*doc, "a");
+    auto b = elementById(*doc, "b");
+    CHECK(a && b);
+    if (!a || !b)
+        return;
+
+    CHECK(pixelAt(canvas, 75, 75) == 0xFFFF0000u);
+
+    // Nothing changed, nothing damaged
+    doc->update(doc.get());
+    doc->takeDamage(damage);
+    CHECK(damage.empty());
+
+    b->changeAttribute(svgattr::fill(), ByteSpan("blue"), doc.get());
+    doc->update(doc.get());
+    doc->takeDamage(damage);
+
+    // Where 'b' was, and not where 'a' is
+    CHECK(!damage.isFull());
+    CHECK(damage.rects().size() == 1);
+    if (damage.isFull() || damage.rects().size() != 1)
+        return;
+
+    const WGRectD r = damage.rects()[0];
+    CHECK(damage.covers(WGRectD{ 60, 60, 30, 30 }));
+    CHECK(r.x > 40.0 && r.y > 40.0);
+
+    WGRectI px{};
+    CHECK(SVGDamageRegion::pixelRect(r, 100, 100, px));
+    redrawRect(*doc, ctx, px);
+
+    CHECK(pixelAt(canvas, 75, 75) == 0xFF0000FFu);
+    CHECK(pixelAt(canvas, 25, 25) == 0xFFFF0000u);
+
+    // Where it landed this time is reported too, and it's the same place
+    doc->takeDamage(damage);
+    CHECK(!damage.isFull());
+    for (const WGRectD& d : damage.rects())
+        CHECK(d.x > 40.0 && d.y > 40.0);
+
+    ctx.detach();
+
+    // The same as drawing it all again
+    Surface fresh(100, 100);
+    SVGB2DDriver freshCtx{};
+    freshCtx.attach(fresh, 1);
+    drawAll(*doc, freshCtx);
+    freshCtx.detach();
+
+    CHECK(maxDifference(canvas, fresh) == 0);
+}
+
+int main()
+{
+    testDamageAndRepaint();
+
+    return unitTestReport("test_damage");
+}
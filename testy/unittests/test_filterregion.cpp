@@ -0,0 +1,299 @@
+//
+// test_filterregion
+//
+// FilterRegionAnalysis, on programs put together by hand, without
+// running them.  A blur needs its input, and reaches, as far as its
+// radius, an offset moves things by exactly its offset, and flood, or
+// arithmetic compositing with k4, fill the whole of their subregion.
+// A displacement map's map steers, but doesn't spread, what's drawn.
+// Programs with primitives that place things by the whole filter
+// region aren't cropped at all.
+//
+// Nothing is drawn, but the filter headers bring in blend2d, so
+// this one needs blend2d too
+//
+// cl  /EHsc /std:c++20 -I ..\\..\\ -I ..\\..\\svg  test_filterregion.cpp blend2d.lib  /link /LIBPATH:"..\\..\\lib\\Release"
+//
+
+#include "unittest.h"
+
+#include "filter_region_analysis.h"
+
+using namespace waavs;
+
+// Writes the program ABI, one primitive at a time
+struct ProgramWriter
+{
+    FilterProgramStream fProgram{};
+
+    void op(FilterOpId id, InternedKey in1, InternedKey in2 = nullptr, InternedKey out = nullptr, const WGRectD* subr = nullptr)
+    {
+        uint8_t flags = 0;
+        if (in2) flags |= FOPF_HAS_IN2;
+        if (out) flags |= FOPF_HAS_OUT;
+        if (subr) flags |= FOPF_HAS_SUBR;
+
+        fProgram.ops.push_back(packOp(id, flags));
+
+        emit_u32(fProgram, FILTER_COLOR_INTERPOLATION_SRGB);
+        emit_key(fProgram, in1);
+        if (in2)
+            emit_key(fProgram, in2);
+        if (out)
+            emit_key(fProgram, out);
+
+        if (subr)
+        {
+            const double v[4] = { subr->x, subr->y, subr->w, subr->h };
+            for (double d : v)
+            {
+                SVGNumberOrPercent n{};
+                n.fValue = d;
+                n.fIsSet = true;
+                emit_u64(fProgram, packNumberOrPercent(n));
+            }
+        }
+    }
+
+    void blur(InternedKey in, float stdDev)
+    {
+        op(FOP_GAUSSIAN_BLUR, in);
+        emit_f32(fProgram, stdDev);
+        emit_f32(fProgram, stdDev);
+    }
+
+    void offset(InternedKey in, float dx, float dy)
+    {
+        op(FOP_OFFSET, in);
+        emit_f32(fProgram, dx);
+        emit_f32(fProgram, dy);
+    }
+
+    void flood(InternedKey out, const WGRectD* subr = nullptr)
+    {
+        op(FOP_FLOOD, nullptr, nullptr, out, subr);
+        emit_ColorSRGB(fProgram, ColorSRGB{ 1.0f, 0.0f, 0.0f, 1.0f });
+    }
+
+    void arithmetic(InternedKey in1, InternedKey in2, float k4)
+    {
+        op(FOP_COMPOSITE, in1, in2);
+        emit_u32(fProgram, FILTER_COMPOSITE_ARITHMETIC);
+        emit_f32(fProgram, 0.0f);
+        emit_f32(fProgram, 1.0f);
+        emit_f32(fProgram, 1.0f);
+        emit_f32(fProgram, k4);
+    }
+
+    void displacement(InternedKey in1, InternedKey map, float scale)
+    {
+        op(FOP_DISPLACEMENT_MAP, in1, map);
+        emit_f32(fProgram, scale);
+        emit_u32(fProgram, FILTER_CHANNEL_R);
+        emit_u32(fProgram, FILTER_CHANNEL_G);
+    }
+
+    void turbulence()
+    {
+        op(FOP_TURBULENCE, nullptr);
+        emit_u32(fProgram, FILTER_TURBULENCE_TURBULENCE);
+        emit_f32(fProgram, 0.05f);
+        emit_f32(fProgram, 0.05f);
+        emit_u32(fProgram, 2);
+        emit_f32(fProgram, 0.0f);
+        emit_u32(fProgram, 0);
+    }
+
+    void tile(InternedKey in)
+    {
+        op(FOP_TILE, in);
+    }
+
+    const FilterProgramStream& finish()
+    {
+        fProgram.ops.push_back(packOp(FOP_END));
+        return fProgram;
+    }
+};
+
+// A 100 x 100 filter region, one user unit to the pixel
+static const WGRectI kFull{ 0, 0, 100, 100 };
+static const WGRectI kSource{ 40, 40, 10, 10 };
+
+static FilterRunState runState()
+{
+    FilterRunState run{};
+    run.primitiveUnits = SpaceUnitsKind::SVG_SPACE_USER;
+    run.filterRectUS = WGRectD{ 0, 0, 100, 100 };
+    run.objectBBoxUS = WGRectD{ 10, 10, 80, 80 };
+    return run;
+}
+
+static FilterSpace filterSpace()
+{
+    FilterSpace space{};
+    space.filterRectUS = WGRectD{ 0, 0, 100, 100 };
+    space.filterRectPX = kFull;
+    space.filterExtentUS = space.filterRectUS;
+    return space;
+}
+
+static bool sameRect(const WGRectI& a, const WGRectI& b)
+{
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+static InternedKey key(const char* name)
+{
+    return PSNameTable::INTERN(name);
+}
+
+static void testBlurHalo()
+{
+    ProgramWriter w{};
+    w.blur(filter::SourceGraphic(), 2.0f);
+    const FilterProgramStream& program = w.finish();
+
+    const int s = FilterRegionAnalysis::gaussSpread(2.0);
+    CHECK(s > 0);
+
+    // All of it visible
+    FilterRegionAnalysis a{};
+    CHECK(a.analyze(program, runState(), filterSpace(), kFull));
+    CHECK(sameRect(a.sourceNeeded(), kFull));
+
+    // The source, spread by the blur, and a ring around that
+    const WGRectI work = a.workingRect(kSource);
+    CHECK(sameRect(work, WGRectI{ kSource.x - s - 1, kSource.y - s - 1, kSource.w + 2 * s + 2, kSource.h + 2 * s + 2 }));
+
+    // Only a corner visible; that, and what the blur reaches into it
+    CHECK(a.analyze(program, runState(), filterSpace(), WGRectI{ 0, 0, 50, 50 }));
+    CHECK(sameRect(a.sourceNeeded(), WGRectI{ 0, 0, 50 + s, 50 + s }));
+
+    // Nothing it makes reaches the visible corner
+    CHECK(a.analyze(program, runState(), filterSpace(), WGRectI{ 0, 0, 20, 20 }));
+    CHECK(!wg_rectI_is_valid(a.workingRect(kSource)));
+}
+
+static void testOffsetShift()
+{
+    ProgramWriter w{};
+    w.offset(filter::SourceGraphic(), 20.0f, -10.0f);
+    const FilterProgramStream& program = w.finish();
+
+    FilterRegionAnalysis a{};
+    CHECK(a.analyze(program, runState(), filterSpace(), kFull));
+
+    // The result is exactly the source, moved
+    const WGRectI work = a.workingRect(kSource);
+    CHECK(sameRect(a.fNodes[a.fLastNode].fExtent, WGRectI{ 60, 30, 10, 10 }));
+    CHECK(sameRect(work, WGRectI{ 39, 29, 32, 22 }));
+
+    // The left half is visible, which is read from further left, and up
+    CHECK(a.analyze(program, runState(), filterSpace(), WGRectI{ 0, 0, 50, 100 }));
+    CHECK(sameRect(a.sourceNeeded(), WGRectI{ 0, 10, 30, 90 }));
+
+    // Where the source is, isn't moved to anywhere visible
+    CHECK(!wg_rectI_is_valid(a.workingRect(kSource)));
+}
+
+static void testGenerators()
+{
+    // A flood fills its subregion, whatever the source
+    {
+        const WGRectD subr{ 20, 20, 30, 30 };
+
+        ProgramWriter w{};
+        w.flood(nullptr, &subr);
+        const FilterProgramStream& program = w.finish();
+
+        FilterRegionAnalysis a{};
+        CHECK(a.analyze(program, runState(), filterSpace(), kFull));
+        CHECK(!wg_rectI_is_valid(a.sourceNeeded()));
+        CHECK(sameRect(a.workingRect(WGRectI{}), WGRectI{ 19, 19, 32, 32 }));
+    }
+
+    // Arithmetic with k4 adds something everywhere
+    {
+        ProgramWriter w{};
+        w.arithmetic(filter::SourceGraphic(), filter::SourceGraphic(), 0.5f);
+
+        FilterRegionAnalysis a{};
+        CHECK(a.analyze(w.finish(), runState(), filterSpace(), kFull));
+        CHECK(sameRect(a.workingRect(kSource), kFull));
+    }
+
+    // Without it, only where its inputs were
+    {
+        ProgramWriter w{};
+        w.arithmetic(filter::SourceGraphic(), filter::SourceGraphic(), 0.0f);
+
+        FilterRegionAnalysis a{};
+        CHECK(a.analyze(w.finish(), runState(), filterSpace(), kFull));
+        CHECK(sameRect(a.workingRect(kSource), WGRectI{ 39, 39, 12, 12 }));
+    }
+}
+
+static void testDisplacementMap()
+{
+    // The map covers one corner, the source is in the middle
+    const WGRectD corner{ 0, 0, 20, 20 };
+
+    ProgramWriter w{};
+    w.flood(key("map"), &corner);
+    w.displacement(filter::SourceGraphic(), key("map"), 4.0f);
+    const FilterProgramStream& program = w.finish();
+
+    FilterRegionAnalysis a{};
+    CHECK(a.analyze(program, runState(), filterSpace(), kFull));
+    a.workingRect(kSource);
+
+    // Up to half the scale, and a pixel for sampling between them
+    const int halo = 3;
+    const WGRectI displaced{ kSource.x - halo, kSource.y - halo, kSource.w + 2 * halo, kSource.h + 2 * halo };
+
+    // The map's corner doesn't make the result reach there
+    CHECK(sameRect(a.fNodes[a.fLastNode].fExtent, displaced));
+
+    // Though the map itself is still needed where the result is
+    CHECK(sameRect(a.fNodes[a.fKeyNodes[key("map")]].fNeeded, kFull));
+}
+
+static void testUncroppable()
+{
+    FilterRegionAnalysis a{};
+
+    {
+        ProgramWriter w{};
+        w.turbulence();
+        CHECK(!a.analyze(w.finish(), runState(), filterSpace(), kFull));
+    }
+
+    // Anywhere in the program
+    {
+        ProgramWriter w{};
+        w.blur(filter::SourceGraphic(), 2.0f);
+        w.tile(nullptr);
+        w.offset(nullptr, 5.0f, 5.0f);
+        CHECK(!a.analyze(w.finish(), runState(), filterSpace(), kFull));
+    }
+
+    // And the next program starts afresh
+    {
+        ProgramWriter w{};
+        w.offset(filter::SourceGraphic(), 5.0f, 5.0f);
+        CHECK(a.analyze(w.finish(), runState(), filterSpace(), kFull));
+        CHECK(wg_rectI_is_valid(a.workingRect(kSource)));
+    }
+}
+
+int main()
+{
+    testBlurHalo();
+    testOffsetShift();
+    testGenerators();
+    testDisplacementMap();
+    testUncroppable();
+
+    return unitTestReport("test_filterregion");
+}
@@ -0,0 +1,105 @@
+//
+// test_namescope
+//
+// Names interned while a document is current land in its own
+// scope, well known names keep their global atoms, and a scope
+// stays alive for as long as the arena its nodes came from.
+//
+
+#include <cstring>
+#include <memory>
+
+#include "unittest.h"
+
+#include "nametable.h"
+#include "nodearena.h"
+
+using namespace waavs;
+
+struct NamedThing
+{
+    InternedKey fName{ nullptr };
+};
+
+static void testScopedInterning()
+{
+    auto scope = std::make_shared<PSNameScope>();
+
+    InternedKey local{};
+    {
+        PSNameScopeGuard guard(scope.get());
+
+        local = PSNameScope::INTERN("test-namescope-only-name");
+        CHECK(local != nullptr);
+        CHECK(strcmp(local, "test-namescope-only-name") == 0);
+
+        // Same name, same atom
+        CHECK(PSNameScope::INTERN("test-namescope-only-name") == local);
+        CHECK(PSNameScope::LOOKUP("test-namescope-only-name") == local);
+
+        // Well known names are shared with the global table
+        CHECK(PSNameScope::INTERN("fill") == PSNameTable::INTERN("fill"));
+    }
+
+    CHECK(scope->size() == 1);
+
+    // The global table never saw it
+    CHECK(PSNameTable::FIND("test-namescope-only-name") == nullptr);
+    CHECK(PSNameScope::LOOKUP("test-namescope-only-name") == nullptr);
+}
+
+static void testGuardsNest()
+{
+    PSNameScope outer{};
+    PSNameScope inner{};
+
+    CHECK(PSNameScope::current() == nullptr);
+    {
+        PSNameScopeGuard g1(&outer);
+        CHECK(PSNameScope::current() == &outer);
+        {
+            PSNameScopeGuard g2(&inner);
+            CHECK(PSNameScope::current() == &inner);
+        }
+        CHECK(PSNameScope::current() == &outer);
+    }
+    CHECK(PSNameScope::current() == nullptr);
+}
+
+static void testArenaKeepsScopeAlive()
+{
+    auto scope = std::make_shared<PSNameScope>();
+    auto arena = std::make_shared<NodeArena>(scope);
+
+    std::shared_ptr<NamedThing> node{};
+    {
+        PSNameScopeGuard nameGuard(scope.get());
+        NodeArenaGuard arenaGuard(arena.get());
+
+        node = makeNode<NamedThing>();
+        node->fName = PSNameScope::INTERN("test-namescope-node-name");
+    }
+
+    CHECK(arena->nameScope() == scope.get());
+
+    // The document lets go of its scope, and its arena, before its nodes
+    std::weak_ptr<PSNameScope> watch = scope;
+    scope.reset();
+    arena.reset();
+
+    CHECK(!watch.expired());
+    CHECK(strcmp(node->fName, "test-namescope-node-name") == 0);
+
+    // The last node takes the arena, and the names, with it
+    node.reset();
+    CHECK(watch.expired());
+}
+
+int main()
+{
+    testScopedInterning();
+    testGuardsNest();
+    testArenaKeepsScopeAlive();
+
+    return unitTestReport("test_namescope");
+}
@@ -0,0 +1,168 @@
+//
+// test_nodearena
+//
+// Nodes made while an arena is current come from it, aligned, and
+// distinct.  Oversized requests get blocks of their own, and many
+// threads allocating at once get non-overlapping memory.  The arena
+// lasts as long as any node made from it.
+//
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "unittest.h"
+
+#include "nodearena.h"
+
+using namespace waavs;
+
+struct alignas(32) Wide
+{
+    uint8_t fBytes[48]{};
+};
+
+static bool isAligned(const void* p, size_t align)
+{
+    return ((uintptr_t)p & (align - 1)) == 0;
+}
+
+static void testMakeNode()
+{
+    auto owner = std::make_shared<NodeArena>();
+    NodeArena& arena = *owner;
+
+    // With no current arena, it's the regular heap
+    auto heapNode = makeNode<int>(7);
+    CHECK(*heapNode == 7);
+    CHECK(arena.bytesAllocated() == 0);
+
+    std::vector<std::shared_ptr<Wide>> nodes{};
+    {
+        NodeArenaGuard guard(&arena);
+        CHECK(NodeArena::current() == &arena);
+
+        for (int i = 0; i < 1000; i++)
+        {
+            nodes.push_back(makeNode<Wide>());
+            memset(nodes.back()->fBytes, i & 0xff, sizeof(Wide::fBytes));
+        }
+    }
+    CHECK(NodeArena::current() == nullptr);
+
+    bool aligned = true;
+    bool intact = true;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        aligned = aligned && isAligned(nodes[i].get(), alignof(Wide));
+        intact = intact && nodes[i]->fBytes[0] == (i & 0xff) && nodes[i]->fBytes[47] == (i & 0xff);
+    }
+    CHECK(aligned);
+    CHECK(intact);
+
+    CHECK(arena.bytesAllocated() >= nodes.size() * sizeof(Wide));
+    CHECK(arena.bytesReserved() >= arena.bytesAllocated());
+
+    nodes.clear();
+}
+
+static void testNodesKeepArena()
+{
+    auto owner = std::make_shared<NodeArena>();
+    std::weak_ptr<NodeArena> watch = owner;
+
+    std::shared_ptr<Wide> node{};
+    {
+        NodeArenaGuard guard(owner.get());
+        node = makeNode<Wide>();
+    }
+    memset(node->fBytes, 0x5a, sizeof(Wide::fBytes));
+
+    CHECK(owner->bytesAllocated() >= sizeof(Wide));
+
+    // The owner lets go first, the node still has its memory
+    owner.reset();
+    CHECK(!watch.expired());
+    CHECK(node->fBytes[0] == 0x5a && node->fBytes[47] == 0x5a);
+
+    node.reset();
+    CHECK(watch.expired());
+
+    // An arena nobody owns can't be shared, so it's the heap
+    NodeArena loose{};
+    {
+        NodeArenaGuard guard(&loose);
+        node = makeNode<Wide>();
+    }
+    CHECK(node != nullptr);
+    CHECK(loose.bytesAllocated() == 0);
+}
+
+static void testOversized()
+{
+    NodeArena arena{};
+
+    void* small1 = arena.allocate(16);
+    void* big = arena.allocate(NodeArena::kMaxBlockSize * 2, 64);
+    void* small2 = arena.allocate(16);
+
+    CHECK(isAligned(big, 64));
+    memset(big, 0xab, NodeArena::kMaxBlockSize * 2);
+
+    // The big one didn't disturb the regular block
+    CHECK((uint8_t*)small2 == (uint8_t*)small1 + 16);
+    CHECK(arena.bytesReserved() >= NodeArena::kMaxBlockSize * 2 + NodeArena::kMinBlockSize);
+}
+
+static void testThreads()
+{
+    NodeArena arena{};
+
+    static constexpr int kThreads = 8;
+    static constexpr int kPerThread = 20000;
+
+    std::vector<std::vector<uint32_t*>> results(kThreads);
+    std::vector<std::thread> threads{};
+
+    for (int t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&arena, &results, t]() {
+            for (int i = 0; i < kPerThread; i++)
+            {
+                auto p = static_cast<uint32_t*>(arena.allocate(sizeof(uint32_t) * 3, alignof(uint32_t)));
+                p[0] = uint32_t(t);
+                p[1] = uint32_t(i);
+                p[2] = uint32_t(t ^ i);
+                results[t].push_back(p);
+            }
+        });
+    }
+
+    for (auto& th : threads)
+        th.join();
+
+    // Nobody wrote over anyone else
+    bool intact = true;
+    for (int t = 0; t < kThreads; t++)
+    {
+        for (int i = 0; i < kPerThread; i++)
+        {
+            const uint32_t* p = results[t][i];
+            intact = intact && p[0] == uint32_t(t) && p[1] == uint32_t(i) && p[2] == uint32_t(t ^ i);
+        }
+    }
+    CHECK(intact);
+    CHECK(arena.bytesAllocated() == size_t(kThreads) * kPerThread * sizeof(uint32_t) * 3);
+}
+
+int main()
+{
+    testMakeNode();
+    testNodesKeepArena();
+    testOversized();
+    testThreads();
+
+    return unitTestReport("test_nodearena");
+}
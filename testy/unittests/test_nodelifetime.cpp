@@ -0,0 +1,72 @@
+//
+// test_nodelifetime
+//
+// A node found in a document, and kept after the document is gone,
+// still has its memory.  Its arena, and the names it was made with,
+// go when the last such node does.
+//
+// This one builds documents, so it needs blend2d
+//
+// cl  /EHsc /std:c++20 -I ..\\..\\ -I ..\\..\\svg  test_nodelifetime.cpp blend2d.lib  /link /LIBPATH:"..\\..\\lib\\Release"
+//
+
+#include <cstring>
+#include <memory>
+
+#include "unittest.h"
+
+#include "svgdocument.h"
+
+using namespace waavs;
+
+static const char* kSvg =
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\">"
+    "<g id=\"group\"><rect id=\"box\" x=\"10\" y=\"10\" width=\"50\" height=\"50\" fill=\"green\"/></g>"
+    "</svg>";
+
+static void testKeptNode()
+{
+    auto doc = SVGDocument::createFromChunk(ByteSpan((const unsigned char*)kSvg, strlen(kSvg)), 100, 100, 96);
+    CHECK(doc != nullptr);
+    if (!doc)
+        return;
+
+    std::weak_ptr<NodeArena> arena = doc->sharedNodeArena();
+    std::weak_ptr<PSNameScope> names = doc->sharedNameScope();
+
+    auto box = std::dynamic_pointer_cast<SVGGraphicsElement>(doc->getElementById(ByteSpan("box")));
+    auto group = doc->findNodeByHref(ByteSpan("#group"));
+    CHECK(box != nullptr && group != nullptr);
+    if (!box || !group)
+        return;
+
+    // Nodes really came from the arena
+    CHECK(doc->nodeArena()->bytesAllocated() > 0);
+
+    doc.reset();
+
+    // Kept alive by the nodes alone
+    CHECK(!arena.expired());
+    CHECK(!names.expired());
+
+    CHECK(box->nameAtom() == svgtag::tag_rect());
+    CHECK(group->nameAtom() == svgtag::tag_g());
+
+    auto fill = box->getVisualProperty(svgattr::fill());
+    CHECK(fill != nullptr && fill->isSet() && fill->name() == svgattr::fill());
+
+    box.reset();
+    CHECK(!arena.expired());
+
+    // The group held the box too, so this is the last of them
+    group.reset();
+    CHECK(arena.expired());
+    CHECK(names.expired());
+}
+
+int main()
+{
+    testKeptNode();
+
+    return unitTestReport("test_nodelifetime");
+}
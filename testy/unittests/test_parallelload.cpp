@@ -0,0 +1,138 @@
+//
+// test_parallelload
+//
+// A document built with several load threads has to come out the
+// same as one built on a single thread: the same elements, in the
+// same order, with the same attributes, ids, entities and style rules.
+//
+// This one builds documents, so it needs blend2d
+//
+// cl  /EHsc /std:c++20 -I ..\\..\\ -I ..\\..\\svg  test_parallelload.cpp blend2d.lib  /link /LIBPATH:"..\\..\\lib\\Release"
+//
+
+#include <cstring>
+#include <string>
+
+#include "unittest.h"
+
+#include "svgdocument.h"
+
+using namespace waavs;
+
+// makeLayeredSvg()
+//
+// A map-like document, a DOCTYPE with an entity, and a number of
+// large layers under the root, some with ids, references between
+// them, and a <style> of their own.
+static std::string makeLayeredSvg(int layers, int shapesPerLayer)
+{
+    std::string s;
+    s += "<?xml version=\"1.0\"?>\n";
+    s += "<!DOCTYPE svg [ <!ENTITY ink \"#336699\"> ]>\n";
+    s += "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1000\" height=\"1000\" viewBox=\"0 0 1000 1000\">\n";
+    s += "<style>.a { fill: red; }</style>\n";
+
+    for (int l = 0; l < layers; l++)
+    {
+        s += "<g id=\"layer" + std::to_string(l) + "\" class=\"a\">\n";
+
+        if (l % 2)
+            s += "<style>#r" + std::to_string(l) + "_0 { stroke: blue; stroke-width: 2; }</style>\n";
+
+        for (int i = 0; i < shapesPerLayer; i++)
+        {
+            const std::string id = "r" + std::to_string(l) + "_" + std::to_string(i);
+            s += "<rect id=\"" + id + "\" x=\"" + std::to_string(i % 100) + "\" y=\"" + std::to_string(l * 10)
+                + "\" width=\"5\" height=\"5\" fill=\"&ink;\" transform=\"translate(1 2)\"/>\n";
+            if (i % 50 == 0)
+                s += "<use href=\"#r" + std::to_string((l + 1) % layers) + "_0\"/>\n";
+        }
+
+        s += "</g>\n";
+    }
+
+    s += "</svg>\n";
+    return s;
+}
+
+static bool sameAttributes(const XmlAttributeCollection& a, const XmlAttributeCollection& b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    auto ib = b.values().begin();
+    for (const auto& kv : a.values())
+    {
+        const auto other = *ib;
+        if (strcmp(kv.first, other.first) != 0 || kv.second != other.second)
+            return false;
+        ++ib;
+    }
+
+    return true;
+}
+
+static bool sameTree(const SVGGraphicsElement* a, const SVGGraphicsElement* b, size_t& count)
+{
+    count++;
+
+    if (strcmp(a->nameAtom(), b->nameAtom()) != 0)
+        return false;
+    if (!sameAttributes(a->fAttributes, b->fAttributes))
+        return false;
+    if (a->fChildren.size() != b->fChildren.size())
+        return false;
+
+    for (size_t i = 0; i < a->fChildren.size(); i++)
+    {
+        auto ca = dynamic_cast<const SVGGraphicsElement*>(a->fChildren[i].get());
+        auto cb = dynamic_cast<const SVGGraphicsElement*>(b->fChildren[i].get());
+
+        if ((ca == nullptr) != (cb == nullptr))
+            return false;
+        if (ca && !sameTree(ca, cb, count))
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    const std::string src = makeLayeredSvg(8, 400);
+    const ByteSpan span((const unsigned char*)src.data(), src.size());
+
+    auto serial = SVGDocument::createFromChunk(span, 1000, 1000, 96, 1);
+    auto parallel = SVGDocument::createFromChunk(span, 1000, 1000, 96, 4);
+
+    CHECK(serial != nullptr);
+    CHECK(parallel != nullptr);
+    if (!serial || !parallel)
+        return unitTestReport("test_parallelload");
+
+    size_t nodes = 0;
+    CHECK(sameTree(serial.get(), parallel.get(), nodes));
+    CHECK(nodes > 8 * 400);
+
+    CHECK(serial->fDefinitions.size() == parallel->fDefinitions.size());
+    CHECK(serial->fEntities.size() == 1);
+    CHECK(parallel->fEntities.size() == 1);
+
+    // Style rules from the layers, in document order
+    CHECK(serial->styleSheet().size() == parallel->styleSheet().size());
+    const auto& sr = serial->styleSheet().rules();
+    const auto& pr = parallel->styleSheet().rules();
+    for (size_t i = 0; i < sr.size() && i < pr.size(); i++)
+        CHECK(sr[i].order() == pr[i].order() && sr[i].specificity() == pr[i].specificity());
+
+    // The same ids lead to equivalent nodes
+    for (auto& def : serial->fDefinitions)
+    {
+        auto other = parallel->getElementById(def.first);
+        CHECK(other != nullptr);
+        if (other)
+            CHECK(strcmp(def.second->nameAtom(), other->nameAtom()) == 0);
+    }
+
+    return unitTestReport("test_parallelload");
+}
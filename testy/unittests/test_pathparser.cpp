@@ -0,0 +1,160 @@
+//
+// test_pathparser
+//
+// parsePathProgram() reads path data in a single fused loop.  It has
+// to produce exactly the program the general purpose segment chain 
+// does (SVGSegmentIterator -> PathSegmentNormalizer -> 
+// PathProgramBuilder), which is kept here as the reference.
+//
+
+// The reference chain asserts on the malformed sequences it skips
+// in a release build, and those are among the cases compared here
+#ifndef NDEBUG
+#define NDEBUG
+#endif
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "unittest.h"
+
+#include "pathattribute_parser.h"
+
+using namespace waavs;
+
+// parseBySegment()
+//
+// The reference, one segment at a time
+static bool parseBySegment(const ByteSpan& inSpan, PathProgram& outProg) noexcept
+{
+    PathProgramBuilder builder;
+    PathSegmentNormalizer normalizer(builder);
+
+    SVGSegmentIterator iter(inSpan);
+    PathSegment seg{};
+
+    while (readNextSegmentCommand(iter, seg)) {
+        normalizer.consume(seg);
+    }
+
+    builder.end();
+    outProg = std::move(builder.prog);
+    return true;
+}
+
+static bool sameProgram(const char* d)
+{
+    PathProgram fused{};
+    PathProgram reference{};
+
+    parsePathProgram(ByteSpan(d), fused);
+    parseBySegment(ByteSpan(d), reference);
+
+    return fused.ops == reference.ops && fused.args == reference.args;
+}
+
+static void testFixed()
+{
+    CHECK(sameProgram(""));
+    CHECK(sameProgram("M10 10 L20 20 Z"));
+    CHECK(sameProgram("m10,10 l10-10h5v5z"));
+    CHECK(sameProgram("M0 0 10 10 20 0"));                     // implicit lineto
+    CHECK(sameProgram("m1 1 2 2 3 3z m4 4"));
+    CHECK(sameProgram("M0,0C1,2,3,4,5,6S7,8,9,10"));
+    CHECK(sameProgram("M0 0c1 2 3 4 5 6s7 8 9 10"));
+    CHECK(sameProgram("M0 0Q1 2 3 4T5 6t7 8"));
+    CHECK(sameProgram("M0 0A10 20 30 0 1 40 50"));
+    CHECK(sameProgram("M0 0a10 20 30 1050 60"));               // packed flags
+    CHECK(sameProgram("M1-2.5.5-.5e1 3"));                     // run together numbers
+    CHECK(sameProgram("L10 10 M0 0 L5 5"));                    // nothing before a moveto
+    CHECK(sameProgram("Z M0 0 Z Z"));                          // closing what isn't open
+    CHECK(sameProgram("M0 0 L10 10 X 20 20"));                 // stops at a bad command
+    CHECK(sameProgram("M0 0 L10"));                            // missing argument
+    CHECK(sameProgram("   \n\t M 0 , 0   L   1 ,  1   \n  "));
+}
+
+static void appendNumber(std::string& d, std::mt19937& rng)
+{
+    char buff[32];
+    std::uniform_real_distribution<float> v(-500.0f, 500.0f);
+
+    switch (rng() % 4)
+    {
+    case 0: snprintf(buff, sizeof(buff), "%d", int(rng() % 1000) - 500); break;
+    case 1: snprintf(buff, sizeof(buff), "%.3f", v(rng)); break;
+    case 2: snprintf(buff, sizeof(buff), "%.2e", v(rng)); break;
+    default: snprintf(buff, sizeof(buff), ".%u", unsigned(rng() % 1000)); break;
+    }
+
+    // Sometimes let a number run straight into the previous one
+    if (!d.empty() && (rng() % 3) && (buff[0] == '-' || buff[0] == '.'))
+        ;
+    else
+        d += (rng() % 2) ? " " : ",";
+
+    d += buff;
+}
+
+static std::string randomPath(std::mt19937& rng)
+{
+    static const char kCommands[] = "MmLlHhVvCcSsQqTtAaZz";
+    static const int kArgs[] = { 2,2, 2,2, 1,1, 1,1, 6,6, 4,4, 4,4, 2,2, 7,7, 0,0 };
+
+    std::string d = "M0 0";
+    const int segments = 1 + int(rng() % 40);
+
+    for (int i = 0; i < segments; i++)
+    {
+        const int c = int(rng() % 20);
+        d += kCommands[c];
+
+        // Commands repeat their arguments
+        const int repeats = kArgs[c] ? 1 + int(rng() % 3) : 0;
+        for (int r = 0; r < repeats; r++)
+        {
+            for (int a = 0; a < kArgs[c]; a++)
+            {
+                // arc flags
+                if ((c == 16 || c == 17) && (a == 3 || a == 4))
+                {
+                    d += " ";
+                    d += (rng() % 2) ? "1" : "0";
+                }
+                else
+                {
+                    appendNumber(d, rng);
+                }
+            }
+        }
+    }
+
+    return d;
+}
+
+static void testRandom()
+{
+    std::mt19937 rng(2024);
+
+    int mismatches = 0;
+    for (int i = 0; i < 20000; i++)
+    {
+        std::string d = randomPath(rng);
+        if (!sameProgram(d.c_str()))
+        {
+            if (mismatches == 0)
+                printf("first mismatch: %s\n", d.c_str());
+            mismatches++;
+        }
+    }
+
+    CHECK(mismatches == 0);
+}
+
+int main()
+{
+    testFixed();
+    testRandom();
+
+    return unitTestReport("test_pathparser");
+}
@@ -0,0 +1,131 @@
+//
+// test_renderindex
+//
+// A container with enough render nodes indexes them by where they
+// drew, once it's been drawn.  Bound for a <use>, it drops the index
+// and doesn't make another, but bound again outside of one, as many
+// times as it likes, it indexes again.  Drawn through the index, the
+// picture is the same.
+//
+// This one draws, so it needs blend2d
+//
+// cl  /EHsc /std:c++20 -I ..\\..\\ -I ..\\..\\svg  test_renderindex.cpp blend2d.lib  /link /LIBPATH:"..\\..\\lib\\Release"
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "unittest.h"
+
+#include "svgdocument.h"
+
+using namespace waavs;
+
+// A group of twenty squares, in a row
+static std::string groupDocument()
+{
+    std::string src =
+        "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"200\" height=\"20\" viewBox=\"0 0 200 20\">"
+        "<g id=\"row\">";
+
+    for (int i = 0; i < 20; i++)
+        src += "<rect x=\"" + std::to_string(i * 10) + "\" y=\"5\" width=\"8\" height=\"8\" fill=\"blue\"/>";
+
+    src += "</g></svg>";
+    return src;
+}
+
+// The largest difference in any one channel
+static int maxDifference(const Surface& a, const Surface& b)
+{
+    if (a.width() != b.width() || a.height() != b.height())
+        return 256;
+
+    int worst = 0;
+    for (int y = 0; y < int(a.height()); y++)
+    {
+        const uint8_t* ra = (const uint8_t*)a.rowPointer(y);
+        const uint8_t* rb = (const uint8_t*)b.rowPointer(y);
+
+        for (size_t i = 0; i < a.width() * 4; i++)
+            worst = std::max(worst, std::abs(int(ra[i]) - int(rb[i])));
+    }
+
+    return worst;
+}
+
+static void drawAll(SVGDocument& doc, SVGB2DDriver& ctx)
+{
+    ctx.renew();
+    doc.draw(&ctx, &doc);
+    ctx.flush();
+}
+
+static void testRebinding()
+{
+    const std::string src = groupDocument();
+    auto doc = SVGDocument::createFromChunk(ByteSpan((const unsigned char*)src.data(), src.size()), 200, 20, 96);
+    CHECK(doc != nullptr);
+    if (!doc)
+        return;
+
+    auto row = std::dynamic_pointer_cast<SVGGraphicsElement>(doc->getElementById(ByteSpan("row")));
+    CHECK(row != nullptr);
+    if (!row)
+        return;
+
+    Surface first(200, 20);
+    Surface target(200, 20);
+    SVGB2DDriver ctx{};
+
+    ctx.attach(first, 1);
+    drawAll(*doc, ctx);
+    ctx.detach();
+
+    // Learned on the first draw
+    CHECK(row->fRenderNodeIndex != nullptr);
+
+    // Bound again, for no particular reason, and drawn
+    ctx.attach(target, 1);
+    row->setNeedsBinding(true);
+    drawAll(*doc, ctx);
+    CHECK(row->fRenderNodeIndex != nullptr);
+
+    // Drawn through the index, nothing's missing
+    drawAll(*doc, ctx);
+    CHECK(maxDifference(first, target) == 0);
+
+    // Bound the way a <use> does it
+    row->setNeedsBinding(true);
+    ctx.renew();
+    ctx.suspendCulling();
+    row->draw(&ctx, doc.get());
+    ctx.resumeCulling();
+
+    CHECK(row->fBoundForUse);
+    CHECK(row->fRenderNodeIndex == nullptr);
+
+    // Still bound for the <use>, so what it learns isn't kept
+    drawAll(*doc, ctx);
+    CHECK(row->fRenderNodeIndex == nullptr);
+
+    // Bound outside of one, it indexes again
+    row->setNeedsBinding(true);
+    drawAll(*doc, ctx);
+    CHECK(!row->fBoundForUse);
+    CHECK(row->fRenderNodeIndex != nullptr);
+
+    drawAll(*doc, ctx);
+    CHECK(maxDifference(first, target) == 0);
+
+    ctx.detach();
+}
+
+int main()
+{
+    testRebinding();
+
+    return unitTestReport("test_renderindex");
+}
@@ -0,0 +1,280 @@
+//
+// test_rendersession
+//
+// A frozen document, replayed by a render session, draws the same
+// pixels as the document does itself, at any scale.  Filters, masks
+// and clip paths are recorded as effects, and worked out at the
+// scale they're replayed at, not the one the document was frozen at.
+// Several sessions can replay the same frozen document at once.
+// Drawn a tile at a time, with elements culled by tile and filters
+// shared between tiles, it comes out the same as drawn whole.  The
+// background asked for is under it all.
+//
+// This one draws, so it needs blend2d
+//
+// cl  /EHsc /std:c++20 -I ..\\..\\ -I ..\\..\\svg  test_rendersession.cpp blend2d.lib  /link /LIBPATH:"..\\..\\lib\\Release"
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "unittest.h"
+
+#include "svgdocument.h"
+#include "svgrendersession.h"
+#include "svgtiledrenderer.h"
+
+using namespace waavs;
+
+static const char* kSvg =
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\" viewBox=\"0 0 100 100\">"
+    "<defs>"
+    "<filter id=\"blur\" x=\"-20%\" y=\"-20%\" width=\"140%\" height=\"140%\"><feGaussianBlur stdDeviation=\"2\"/></filter>"
+    "<mask id=\"fade\"><rect x=\"0\" y=\"0\" width=\"100\" height=\"100\" fill=\"white\"/><circle cx=\"70\" cy=\"30\" r=\"10\" fill=\"black\"/></mask>"
+    "<clipPath id=\"round\"><circle cx=\"30\" cy=\"70\" r=\"20\"/></clipPath>"
+    "</defs>"
+    "<rect x=\"10\" y=\"10\" width=\"30\" height=\"30\" fill=\"red\" filter=\"url(#blur)\"/>"
+    "<rect x=\"50\" y=\"10\" width=\"40\" height=\"40\" fill=\"blue\" mask=\"url(#fade)\"/>"
+    "<rect x=\"10\" y=\"50\" width=\"40\" height=\"40\" fill=\"green\" clip-path=\"url(#round)\"/>"
+    "<g opacity=\"0.5\"><rect x=\"55\" y=\"55\" width=\"30\" height=\"30\" fill=\"black\"/></g>"
+    "</svg>";
+
+static std::shared_ptr<SVGDocument> loadDocument()
+{
+    return SVGDocument::createFromChunk(ByteSpan((const unsigned char*)kSvg, strlen(kSvg)), 100, 100, 96);
+}
+
+// The largest difference in any one channel
+static int maxDifference(const Surface& a, const Surface& b)
+{
+    if (a.width() != b.width() || a.height() != b.height())
+        return 256;
+
+    int worst = 0;
+    for (int y = 0; y < int(a.height()); y++)
+    {
+        const uint8_t* ra = (const uint8_t*)a.rowPointer(y);
+        const uint8_t* rb = (const uint8_t*)b.rowPointer(y);
+
+        for (size_t i = 0; i < a.width() * 4; i++)
+            worst = std::max(worst, std::abs(int(ra[i]) - int(rb[i])));
+    }
+
+    return worst;
+}
+
+static void drawDirect(SVGDocument& doc, Surface& target, const WGMatrix3x3& sceneToTarget)
+{
+    SVGB2DDriver ctx{};
+    ctx.attach(target, 1);
+    ctx.renew();
+    ctx.transform(sceneToTarget);
+
+    doc.draw(&ctx, &doc);
+
+    ctx.detach();
+}
+
+static void testRecordsEffects()
+{
+    auto doc = loadDocument();
+    CHECK(doc != nullptr);
+    if (!doc)
+        return;
+
+    auto frozen = freezeDocument(*doc);
+    CHECK(frozen && frozen->fList);
+    if (!frozen || !frozen->fList)
+        return;
+
+    // Nothing was drawn into pixels while freezing
+    size_t images = 0;
+    size_t effects = 0;
+    size_t groups = 0;
+    size_t bounded = 0;
+    for (const SVGDisplayOp& op : frozen->fList->fOps)
+    {
+        if (op.fCode == SVG_DL_IMAGE || op.fCode == SVG_DL_SCALE_IMAGE)
+            images++;
+        else if (op.fCode == SVG_DL_BEGIN_EFFECT)
+            effects++;
+        else if (op.fCode == SVG_DL_BEGIN_GROUP)
+            groups++;
+        else if (op.fCode == SVG_DL_BEGIN_CULL && frozen->fList->fCulls[op.fIndex].fHasBounds)
+            bounded++;
+    }
+
+    CHECK(images == 0);
+    CHECK(effects == 3);
+    CHECK(groups == 1);
+
+    // The four shapes, and the group, at least
+    CHECK(bounded >= 5);
+}
+
+static void testMatchesDirect(double scale)
+{
+    auto doc = loadDocument();
+    CHECK(doc != nullptr);
+    if (!doc)
+        return;
+
+    const int size = int(100 * scale);
+    const WGMatrix3x3 sceneToTarget = WGMatrix3x3::makeScaling(scale);
+
+    Surface direct(size, size);
+    drawDirect(*doc, direct, sceneToTarget);
+
+    // Frozen at 1:1, whatever it's replayed at
+    auto frozen = freezeDocument(*doc);
+    CHECK(frozen != nullptr);
+    if (!frozen)
+        return;
+
+    Surface replayed(size, size);
+    SVGRenderSession session{};
+    CHECK(session.renderInto(*frozen, replayed, sceneToTarget));
+
+    CHECK(maxDifference(direct, replayed) <= 2);
+}
+
+static void testConcurrentSessions()
+{
+    auto doc = loadDocument();
+    CHECK(doc != nullptr);
+    if (!doc)
+        return;
+
+    auto frozen = freezeDocument(*doc);
+    CHECK(frozen != nullptr);
+    if (!frozen)
+        return;
+
+    const WGMatrix3x3 sceneToTarget = WGMatrix3x3::makeScaling(2.0);
+
+    const int kThreads = 4;
+    Surface results[kThreads];
+    for (int t = 0; t < kThreads; t++)
+        results[t].reset(200, 200);
+
+    std::thread threads[kThreads];
+    for (int t = 0; t < kThreads; t++)
+    {
+        threads[t] = std::thread([&, t]() {
+            SVGRenderSession session{};
+            for (int round = 0; round < 4; round++)
+                session.renderInto(*frozen, results[t], sceneToTarget);
+            });
+    }
+
+    for (auto& th : threads)
+        th.join();
+
+    for (int t = 1; t < kThreads; t++)
+        CHECK(maxDifference(results[0], results[t]) == 0);
+}
+
+static void testTiledMatchesWhole()
+{
+    auto doc = loadDocument();
+    CHECK(doc != nullptr);
+    if (!doc)
+        return;
+
+    auto frozen = freezeDocument(*doc);
+    CHECK(frozen != nullptr);
+    if (!frozen)
+        return;
+
+    const WGMatrix3x3 sceneToTarget = WGMatrix3x3::makeScaling(2.0);
+
+    Surface whole(200, 200);
+    SVGRenderSession session{};
+    CHECK(session.renderInto(*frozen, whole, sceneToTarget));
+
+    // Small tiles, so the filter, mask and clip all span several
+    SVGTileRenderOptions opts{};
+    opts.fTileSize = 24;
+    opts.fTransform = sceneToTarget;
+
+    Surface tiled(200, 200);
+    CHECK(renderFrozenTiled(*frozen, tiled, opts));
+
+    CHECK(maxDifference(whole, tiled) <= 2);
+
+    // A tile nothing reaches stays empty
+    Surface corner(10, 10);
+    CHECK(session.renderTile(*frozen, corner, 190, 0, sceneToTarget));
+
+    int drawn = 0;
+    for (int y = 0; y < 10; y++)
+    {
+        const uint32_t* row = (const uint32_t*)corner.rowPointer(y);
+        for (int x = 0; x < 10; x++)
+            drawn += (row[x] != 0) ? 1 : 0;
+    }
+    CHECK(drawn == 0);
+}
+
+static uint32_t pixelAt(const Surface& s, int x, int y)
+{
+    return ((const uint32_t*)s.rowPointer(y))[x];
+}
+
+static void testBackground()
+{
+    auto doc = loadDocument();
+    CHECK(doc != nullptr);
+    if (!doc)
+        return;
+
+    auto frozen = freezeDocument(*doc);
+    CHECK(frozen != nullptr);
+    if (!frozen)
+        return;
+
+    const WGMatrix3x3 sceneToTarget = WGMatrix3x3::makeScaling(2.0);
+    const BLRgba32 white(0xFFFFFFFF);
+
+    // Nothing is drawn in the top right corner, so it's the background
+    Surface whole(200, 200);
+    SVGRenderSession session{};
+    CHECK(session.renderInto(*frozen, whole, sceneToTarget, white));
+    CHECK(pixelAt(whole, 199, 0) == 0xFFFFFFFFu);
+
+    SVGTileRenderOptions opts{};
+    opts.fTileSize = 24;
+    opts.fTransform = sceneToTarget;
+    opts.fBackground = white;
+
+    Surface tiled(200, 200);
+    CHECK(renderFrozenTiled(*frozen, tiled, opts));
+    CHECK(pixelAt(tiled, 199, 0) == 0xFFFFFFFFu);
+    CHECK(maxDifference(whole, tiled) <= 2);
+
+    Surface corner(10, 10);
+    CHECK(session.renderTile(*frozen, corner, 190, 0, sceneToTarget, white));
+
+    int background = 0;
+    for (int y = 0; y < 10; y++)
+    {
+        for (int x = 0; x < 10; x++)
+            background += (pixelAt(corner, x, y) == 0xFFFFFFFFu) ? 1 : 0;
+    }
+    CHECK(background == 100);
+}
+
+int main()
+{
+    testRecordsEffects();
+    testMatchesDirect(1.0);
+    testMatchesDirect(3.0);
+    testConcurrentSessions();
+    testTiledMatchesWhole();
+    testBackground();
+
+    return unitTestReport("test_rendersession");
+}
@@ -0,0 +1,151 @@
+//
+// test_smallmap
+//
+// SmallFlatMap keeps its first entries inline, and switches to heap
+// arrays with a hash index once there are more.  Lookups, order and
+// replacement have to behave the same on either side of that switch.
+//
+
+#include <string>
+
+#include "unittest.h"
+
+#include "smallmap.h"
+
+using namespace waavs;
+
+static const char* kNames[] = {
+    "a0", "a1", "a2", "a3", "a4", "a5", "a6", "a7",
+    "a8", "a9", "a10", "a11", "a12", "a13", "a14", "a15",
+    "a16", "a17", "a18", "a19",
+};
+static constexpr int kNameCount = int(sizeof(kNames) / sizeof(kNames[0]));
+
+using PtrMap = SmallFlatMap<const char*, int, 8>;
+
+static bool inOrder(const PtrMap& m, int count)
+{
+    int i = 0;
+    for (const auto& kv : m)
+    {
+        if (kv.first != kNames[i] || kv.second != i * 10)
+            return false;
+        i++;
+    }
+    return i == count;
+}
+
+static void testInlineToSpill()
+{
+    PtrMap m{};
+
+    for (int i = 0; i < 8; i++)
+        m.set(kNames[i], i * 10);
+
+    // Exactly at the inline capacity, nothing is on the heap
+    CHECK(m.size() == 8);
+    CHECK(!m.spilled());
+    CHECK(inOrder(m, 8));
+
+    // One more spills
+    m.set(kNames[8], 80);
+    CHECK(m.spilled());
+    CHECK(m.size() == 9);
+    CHECK(inOrder(m, 9));
+
+    for (int i = 9; i < kNameCount; i++)
+        m.set(kNames[i], i * 10);
+
+    CHECK(m.size() == size_t(kNameCount));
+    CHECK(inOrder(m, kNameCount));
+
+    // Every key, before and after the switch, is found
+    for (int i = 0; i < kNameCount; i++)
+    {
+        const int* v = m.find(kNames[i]);
+        CHECK(v != nullptr && *v == i * 10);
+    }
+
+    const char* missing = "not-there";
+    CHECK(m.find(missing) == nullptr);
+    CHECK(!m.contains(missing));
+
+    // Replacing doesn't add
+    m.set(kNames[3], 333);
+    m.set(kNames[15], 1515);
+    CHECK(m.size() == size_t(kNameCount));
+    CHECK(*m.find(kNames[3]) == 333);
+    CHECK(*m.find(kNames[15]) == 1515);
+}
+
+static void testInlineReplace()
+{
+    PtrMap m{};
+    m.set(kNames[0], 1);
+    m.set(kNames[1], 2);
+    m.set(kNames[0], 3);
+
+    CHECK(m.size() == 2);
+    CHECK(!m.spilled());
+    CHECK(*m.find(kNames[0]) == 3);
+    CHECK(m.indexOf(kNames[1]) == 1);
+    CHECK(m.indexOf(kNames[2]) == 2);
+}
+
+static void testCopyMoveClear()
+{
+    PtrMap m{};
+    for (int i = 0; i < 12; i++)
+        m.set(kNames[i], i * 10);
+
+    PtrMap copy(m);
+    CHECK(copy.spilled());
+    CHECK(inOrder(copy, 12));
+
+    // The copy has its own index
+    copy.set(kNames[12], 120);
+    CHECK(copy.size() == 13);
+    CHECK(m.size() == 12);
+    CHECK(m.find(kNames[12]) == nullptr);
+
+    PtrMap moved(std::move(copy));
+    CHECK(moved.size() == 13);
+    CHECK(inOrder(moved, 13));
+    CHECK(copy.size() == 0);
+
+    moved.clear();
+    CHECK(moved.empty());
+    CHECK(!moved.spilled());
+
+    // Usable again, inline
+    moved.set(kNames[0], 0);
+    CHECK(moved.size() == 1);
+    CHECK(!moved.spilled());
+    CHECK(*moved.find(kNames[0]) == 0);
+}
+
+static void testNonPointerKeys()
+{
+    SmallFlatMap<std::string, int, 4> m{};
+
+    for (int i = 0; i < 10; i++)
+        m.set(kNames[i], i);
+
+    CHECK(m.spilled());
+    for (int i = 0; i < 10; i++)
+    {
+        const int* v = m.find(kNames[i]);
+        CHECK(v != nullptr && *v == i);
+    }
+    CHECK(m.find("a10") == nullptr);
+}
+
+int main()
+{
+    testInlineToSpill();
+    testInlineReplace();
+    testCopyMoveClear();
+    testNonPointerKeys();
+
+    return unitTestReport("test_smallmap");
+}
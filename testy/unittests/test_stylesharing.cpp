@@ -0,0 +1,117 @@
+//
+// test_stylesharing
+//
+// Siblings with the same style share one map of visual properties.
+// Changing, adding, or taking away a property of one of them gives
+// that one a map of its own first, so the others keep theirs, and
+// draw the way they did.
+//
+// This one builds documents, so it needs blend2d
+//
+// cl  /EHsc /std:c++20 -I ..\\..\\ -I ..\\..\\svg  test_stylesharing.cpp blend2d.lib  /link /LIBPATH:"..\\..\\lib\\Release"
+//
+
+#include <cstring>
+#include <memory>
+
+#include "unittest.h"
+
+#include "svgdocument.h"
+
+using namespace waavs;
+
+static const char* kSvg =
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"20\" viewBox=\"0 0 100 20\">"
+    "<rect id=\"a\" x=\"0\" y=\"0\" width=\"20\" height=\"20\" fill=\"red\" stroke=\"none\"/>"
+    "<rect id=\"b\" x=\"25\" y=\"0\" width=\"20\" height=\"20\" fill=\"red\" stroke=\"none\"/>"
+    "<rect id=\"c\" x=\"50\" y=\"0\" width=\"20\" height=\"20\" fill=\"red\" stroke=\"none\"/>"
+    "<rect id=\"d\" x=\"75\" y=\"0\" width=\"20\" height=\"20\" fill=\"lime\" stroke=\"none\"/>"
+    "</svg>";
+
+static std::shared_ptr<SVGGraphicsElement> elementById(SVGDocument& doc, const char* id)
+{
+    return std::dynamic_pointer_cast<SVGGraphicsElement>(doc.getElementById(ByteSpan(id)));
+}
+
+static uint32_t pixelAt(const Surface& s, int x, int y)
+{
+    return ((const uint32_t*)s.rowPointer(y))[x];
+}
+
+static void drawAll(SVGDocument& doc, Surface& canvas)
+{
+    SVGB2DDriver ctx{};
+    ctx.attach(canvas, 1);
+    ctx.renew();
+    doc.draw(&ctx, &doc);
+    ctx.detach();
+}
+
+static void testSplitOnWrite()
+{
+    auto doc = SVGDocument::createFromChunk(ByteSpan((const unsigned char*)kSvg, strlen(kSvg)), 100, 20, 96);
+    CHECK(doc != nullptr);
+    if (!doc)
+        return;
+
+    auto a = elementById(*doc, "a");
+    auto b = elementById(*doc, "b");
+    auto c = elementById(*doc, "c");
+    auto d = elementById(*doc, "d");
+    CHECK(a && b && c && d);
+    if (!a || !b || !c || !d)
+        return;
+
+    // The same style, the same map, and another style, another map
+    const SVGVisualPropertyMap* shared = a->fVisualProperties.get();
+    CHECK(shared != nullptr);
+    CHECK(b->fVisualProperties.get() == shared);
+    CHECK(c->fVisualProperties.get() == shared);
+    CHECK(d->fVisualProperties.get() != shared);
+
+    const std::shared_ptr<SVGVisualProperty> redFill = a->getVisualProperty(svgattr::fill());
+    CHECK(redFill != nullptr);
+
+    // Changed
+    b->changeAttribute(svgattr::fill(), ByteSpan("blue"), doc.get());
+
+    CHECK(b->fVisualProperties.get() != shared);
+    CHECK(b->getVisualProperty(svgattr::fill()) != redFill);
+    CHECK(a->fVisualProperties.get() == shared);
+    CHECK(c->fVisualProperties.get() == shared);
+    CHECK(a->getVisualProperty(svgattr::fill()) == redFill);
+    CHECK(c->getVisualProperty(svgattr::fill()) == redFill);
+
+    // Taken away
+    a->removeVisualProperty(svgattr::fill());
+
+    CHECK(a->fVisualProperties.get() != shared);
+    CHECK(a->getVisualProperty(svgattr::fill()) == nullptr);
+    CHECK(c->fVisualProperties.get() == shared);
+    CHECK(c->getVisualProperty(svgattr::fill()) == redFill);
+
+    // Added, to the last one with it
+    c->addVisualProperty(svgattr::fill(), b->getVisualProperty(svgattr::fill()));
+    CHECK(c->getVisualProperty(svgattr::fill()) == b->getVisualProperty(svgattr::fill()));
+    CHECK(a->getVisualProperty(svgattr::fill()) == nullptr);
+
+    // None of that reached the other style
+    CHECK(d->getVisualProperty(svgattr::fill()) != nullptr);
+    CHECK(d->getVisualProperty(svgattr::fill()) != redFill);
+
+    // Drawn, each the way it was left
+    Surface canvas(100, 20);
+    drawAll(*doc, canvas);
+
+    CHECK(pixelAt(canvas, 35, 10) == 0xFF0000FFu);
+    CHECK(pixelAt(canvas, 60, 10) == 0xFF0000FFu);
+    CHECK(pixelAt(canvas, 85, 10) == 0xFF00FF00u);
+    CHECK(pixelAt(canvas, 10, 10) != 0xFFFF0000u);
+}
+
+int main()
+{
+    testSplitOnWrite();
+
+    return unitTestReport("test_stylesharing");
+}
@@ -0,0 +1,160 @@
+//
+// test_surfacepool
+//
+// A surface let go of is handed out again, for any size in the same
+// bucket, but never while something still holds it.  Over its limit,
+// the pool lets go of what was used longest ago first, and leaves
+// alone what's in use.
+//
+// Nothing is drawn, but surface.h brings in blend2d, so this one
+// needs blend2d too
+//
+// cl  /EHsc /std:c++20 -I ..\\..\\ -I ..\\..\\svg  test_surfacepool.cpp blend2d.lib  /link /LIBPATH:"..\\..\\lib\\Release"
+//
+
+#include "unittest.h"
+
+#include "surfacepool.h"
+
+using namespace waavs;
+
+static const size_t kBucketBytes = size_t(SurfacePool::kGranularity) * SurfacePool::kGranularity * Surface::kBytesPerPixel;
+
+static bool pooled(const SurfacePool& pool, const uint8_t* data)
+{
+    for (const auto& e : pool.fEntries)
+    {
+        if (e.fBacking.data() == data)
+            return true;
+    }
+
+    return false;
+}
+
+static void testReuse()
+{
+    SurfacePool pool{};
+
+    Surface a{};
+    CHECK(pool.acquire(100, 50, a));
+    CHECK(a.width() == 100 && a.height() == 50);
+    const uint8_t* memory = a.data();
+
+    a = {};
+
+    // Another size, in the same bucket
+    Surface b{};
+    CHECK(pool.acquire(90, 60, b));
+    CHECK(b.width() == 90 && b.height() == 60);
+    CHECK(b.data() == memory);
+    CHECK(pool.fHits == 1 && pool.fMisses == 1);
+
+    // Another bucket altogether
+    Surface c{};
+    CHECK(pool.acquire(200, 200, c));
+    CHECK(c.data() != memory);
+    CHECK(pool.fMisses == 2);
+    CHECK(pool.fEntries.size() == 2);
+
+    CHECK(!pool.acquire(0, 10, c));
+}
+
+static void testShared()
+{
+    SurfacePool pool{};
+
+    Surface a{};
+    CHECK(pool.acquire(64, 64, a));
+
+    // Still held, so not handed out again
+    Surface b{};
+    CHECK(pool.acquire(64, 64, b));
+    CHECK(b.data() != a.data());
+
+    // Let go of, but a copy still holds it
+    const uint8_t* memory = a.data();
+    Surface copy = a;
+    a = {};
+    b = {};
+
+    Surface c{};
+    CHECK(pool.acquire(64, 64, c));
+    CHECK(c.data() != memory);
+
+    // Only now is it free
+    copy = {};
+    c = {};
+
+    size_t handedOut = 0;
+    Surface d{};
+    Surface e{};
+    CHECK(pool.acquire(64, 64, d));
+    CHECK(pool.acquire(64, 64, e));
+    if (d.data() == memory || e.data() == memory)
+        handedOut++;
+    CHECK(handedOut == 1);
+    CHECK(pool.fEntries.size() == 2);
+}
+
+static void testLeastRecentlyUsed()
+{
+    SurfacePool pool(3 * kBucketBytes);
+
+    // Three of the smallest, all at once
+    Surface s[3]{};
+    const uint8_t* memory[3]{};
+    for (int i = 0; i < 3; i++)
+    {
+        CHECK(pool.acquire(64, 64, s[i]));
+        memory[i] = s[i].data();
+    }
+    CHECK(pool.pooledBytes() == 3 * kBucketBytes);
+
+    for (auto& surface : s)
+        surface = {};
+
+    // Using the first again makes the second the oldest, then the third
+    Surface again{};
+    CHECK(pool.acquire(64, 64, again));
+    CHECK(again.data() == memory[0]);
+    again = {};
+
+    // Twice the size needs two of them gone
+    Surface big{};
+    CHECK(pool.acquire(64, 128, big));
+    CHECK(pool.pooledBytes() == 3 * kBucketBytes);
+    CHECK(pool.fEntries.size() == 2);
+    CHECK(pooled(pool, memory[0]));
+    CHECK(pooled(pool, big.data()));
+
+    // What's in use stays, however long ago it was acquired
+    Surface held{};
+    CHECK(pool.acquire(64, 64, held));
+    CHECK(held.data() == memory[0]);
+    big = {};
+
+    pool.setMaxBytes(0);
+    CHECK(pooled(pool, memory[0]));
+    CHECK(pool.fEntries.size() == 1);
+    CHECK(pool.pooledBytes() == kBucketBytes);
+
+    // Too big for the pool, but still a surface
+    Surface outside{};
+    CHECK(pool.acquire(64, 64, outside));
+    CHECK(outside.width() == 64 && outside.data() != memory[0]);
+    CHECK(pool.pooledBytes() == kBucketBytes);
+
+    held = {};
+    pool.trim();
+    CHECK(pool.fEntries.empty());
+    CHECK(pool.pooledBytes() == 0);
+}
+
+int main()
+{
+    testReuse();
+    testShared();
+    testLeastRecentlyUsed();
+
+    return unitTestReport("test_surfacepool");
+}
@@ -0,0 +1,152 @@
+//
+// test_svgbinary
+//
+// An .svgb image holds the same path programs parsing the source
+// would give, and open() refuses an image that has been damaged in
+// any way that would have later code read out of bounds.
+//
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "unittest.h"
+
+#include "svgbinary.h"
+
+using namespace waavs;
+
+static const char* kSvg =
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\">\n"
+    "  <path id=\"a\" d=\"M10 10 L90 10 L90 90 Z\"/>\n"
+    "  <g><path d=\"m5,5 c1,2,3,4,5,6 s7,8,9,10 q1 2 3 4 t5 6 a10 20 30 1 0 40 50z\" fill=\"red\"/></g>\n"
+    "  <path d=\"M0 0 H50 V50\"></path>\n"
+    "  <rect x=\"1\" y=\"2\" width=\"3\" height=\"4\"/>\n"
+    "</svg>\n";
+
+// The image, in 8 byte aligned memory, as open() wants
+struct AlignedImage
+{
+    std::vector<uint64_t> fWords{};
+    size_t fSize{ 0 };
+
+    explicit AlignedImage(const std::vector<uint8_t>& bytes)
+        : fWords((bytes.size() + 7) / 8)
+        , fSize(bytes.size())
+    {
+        memcpy(fWords.data(), bytes.data(), bytes.size());
+    }
+
+    uint8_t* data() { return (uint8_t*)fWords.data(); }
+    ByteSpan span() { return ByteSpan(data(), fSize); }
+    SVGBHeader& header() { return *(SVGBHeader*)data(); }
+    SVGBPathRecord* paths() { return (SVGBPathRecord*)(data() + header().fPathsOffset); }
+    XmlElementRecord* elements() { return (XmlElementRecord*)(data() + header().fElementsOffset); }
+    uint8_t* ops() { return data() + header().fOpsOffset; }
+};
+
+static void testRoundTrip(const std::vector<uint8_t>& bytes)
+{
+    AlignedImage img(bytes);
+    SVGBImage view{};
+
+    CHECK(view.open(img.span()));
+    CHECK(view.elementCount() > 0);
+    CHECK(img.header().fPathCount == 3);
+
+    // Every precompiled program is what the parser makes of the text
+    for (size_t i = 0; i < img.header().fPathCount; i++)
+    {
+        const SVGBPathRecord& rec = img.paths()[i];
+        ByteSpan d(img.data() + rec.fDataOffset, rec.fDataLength);
+
+        PathProgram fromImage{};
+        PathProgram parsed{};
+        CHECK(view.findPathProgram(d, fromImage));
+        parsePathProgram(d, parsed);
+
+        CHECK(fromImage.ops == parsed.ops);
+        CHECK(fromImage.args == parsed.args);
+    }
+
+    // Same text, somewhere else, isn't found
+    PathProgram prog{};
+    CHECK(!view.findPathProgram(ByteSpan("M10 10 L90 10 L90 90 Z"), prog));
+}
+
+// Damage a copy of the image, and check it's refused
+template <typename Damage>
+static bool refused(const std::vector<uint8_t>& bytes, Damage damage)
+{
+    AlignedImage img(bytes);
+    damage(img);
+
+    SVGBImage view{};
+    const bool opened = view.open(img.span());
+    return !opened && !view.isOpen();
+}
+
+static void testTampered(const std::vector<uint8_t>& bytes)
+{
+    // One more argument than the ops call for
+    CHECK(refused(bytes, [](AlignedImage& img) { img.paths()[0].fArgsCount += 1; }));
+
+    // One fewer
+    CHECK(refused(bytes, [](AlignedImage& img) { img.paths()[1].fArgsCount -= 1; }));
+
+    // An op that takes more arguments than were recorded
+    CHECK(refused(bytes, [](AlignedImage& img) {
+        const SVGBPathRecord& rec = img.paths()[0];
+        img.ops()[rec.fOpsStart + 1] = OP_ARCTO;
+    }));
+
+    // An op that doesn't exist
+    CHECK(refused(bytes, [](AlignedImage& img) {
+        const SVGBPathRecord& rec = img.paths()[2];
+        img.ops()[rec.fOpsStart] = 200;
+    }));
+
+    // A program that doesn't end
+    CHECK(refused(bytes, [](AlignedImage& img) {
+        const SVGBPathRecord& rec = img.paths()[2];
+        img.ops()[rec.fOpsStart + rec.fOpsCount - 1] = OP_CLOSE;
+    }));
+
+    // Ops past the end of the ops section
+    CHECK(refused(bytes, [](AlignedImage& img) { img.paths()[2].fOpsStart = uint32_t(img.header().fOpsCount); }));
+    CHECK(refused(bytes, [](AlignedImage& img) { img.paths()[0].fArgsStart = 0xfffffff0u; }));
+
+    // Path data outside the source
+    CHECK(refused(bytes, [](AlignedImage& img) { img.paths()[1].fDataLength = uint32_t(img.header().fSourceSize); }));
+
+    // Paths out of order
+    CHECK(refused(bytes, [](AlignedImage& img) { std::swap(img.paths()[0], img.paths()[1]); }));
+
+    // Elements of no kind the scanner makes
+    CHECK(refused(bytes, [](AlignedImage& img) { img.elements()[1].fKind = XML_ELEMENT_TYPE_INVALID; }));
+    CHECK(refused(bytes, [](AlignedImage& img) { img.elements()[2].fKind = XML_ELEMENT_TYPE_ENTITY + 1; }));
+    CHECK(refused(bytes, [](AlignedImage& img) { img.elements()[0].fKind = 0xffffffffu; }));
+
+    // Element name or data outside their sections
+    CHECK(refused(bytes, [](AlignedImage& img) { img.elements()[1].fNameOffset = 0xffffff00u; }));
+    CHECK(refused(bytes, [](AlignedImage& img) { img.elements()[1].fDataLength = 0x7fffffffu; }));
+
+    // Sections that run past the end of the image
+    CHECK(refused(bytes, [](AlignedImage& img) { img.header().fArgsCount += 1000; }));
+    CHECK(refused(bytes, [](AlignedImage& img) { img.fSize = img.header().fOpsOffset; }));
+
+    // Not an image at all
+    CHECK(refused(bytes, [](AlignedImage& img) { img.data()[0] = 'X'; }));
+    CHECK(refused(bytes, [](AlignedImage& img) { img.header().fVersion = 99; }));
+}
+
+int main()
+{
+    std::vector<uint8_t> bytes{};
+    CHECK(svgb_compile(ByteSpan(kSvg), bytes));
+
+    testRoundTrip(bytes);
+    testTampered(bytes);
+
+    return unitTestReport("test_svgbinary");
+}
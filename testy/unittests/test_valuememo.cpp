@@ -0,0 +1,151 @@
+//
+// test_valuememo
+//
+// Memo tables find what was put in them by the bytes of the key,
+// not where the key lives, keep within their capacity, and can be
+// used from several threads at once.
+//
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "unittest.h"
+
+#include "svgvaluememo.h"
+
+using namespace waavs;
+
+static void testFindByBytes()
+{
+    SVGMemoTable<int> table(64);
+
+    const unsigned char* source = (const unsigned char*)"fill:red fill:red";
+    ByteSpan first(source, 8);
+    ByteSpan second(source + 9, 8);
+
+    int v = 0;
+    CHECK(!table.find(first, v));
+
+    table.insert(first, 42);
+
+    // The same bytes, somewhere else
+    CHECK(table.find(second, v) && v == 42);
+
+    SVGMemoStats st = table.stats();
+    CHECK(st.fHits == 1);
+    CHECK(st.fMisses == 1);
+    CHECK(st.fEntries == 1);
+
+    table.clear();
+    st = table.stats();
+    CHECK(st.fHits == 0 && st.fMisses == 0 && st.fEntries == 0);
+    CHECK(!table.find(first, v));
+}
+
+static void testCapacity()
+{
+    std::vector<std::string> keys{};
+    for (int i = 0; i < 2000; i++)
+        keys.push_back("key-" + std::to_string(i));
+
+    SVGMemoTable<int> table(256);
+    for (int i = 0; i < int(keys.size()); i++)
+        table.insert(ByteSpan(keys[i].c_str()), i);
+
+    CHECK(table.stats().fEntries <= 256);
+
+    // Whatever is still there is right
+    int found = 0;
+    for (int i = 0; i < int(keys.size()); i++)
+    {
+        int v = -1;
+        if (table.find(ByteSpan(keys[i].c_str()), v))
+        {
+            found++;
+            CHECK(v == i);
+        }
+    }
+    CHECK(found > 0);
+
+    // Turned off, nothing goes in
+    table.setCapacity(0);
+    CHECK(table.stats().fEntries == 0);
+    table.insert(ByteSpan(keys[0].c_str()), 0);
+    CHECK(table.stats().fEntries == 0);
+}
+
+static void testConcurrent()
+{
+    std::vector<std::string> keys{};
+    for (int i = 0; i < 500; i++)
+        keys.push_back("translate(" + std::to_string(i) + ")");
+
+    SVGMemoTable<int> table(4096);
+
+    const int kThreads = 8;
+    std::vector<int> wrong(kThreads, 0);
+    std::vector<std::thread> threads{};
+
+    for (int t = 0; t < kThreads; t++)
+    {
+        threads.emplace_back([&, t]() {
+            for (int round = 0; round < 20; round++)
+            {
+                for (int i = 0; i < int(keys.size()); i++)
+                {
+                    ByteSpan key(keys[i].c_str());
+                    int v = -1;
+                    if (table.find(key, v))
+                    {
+                        if (v != i)
+                            wrong[t]++;
+                    }
+                    else
+                    {
+                        table.insert(key, i);
+                    }
+                }
+            }
+            });
+    }
+
+    for (auto& th : threads)
+        th.join();
+
+    int totalWrong = 0;
+    for (int w : wrong)
+        totalWrong += w;
+
+    CHECK(totalWrong == 0);
+
+    SVGMemoStats st = table.stats();
+    CHECK(st.fEntries == keys.size());
+    CHECK(st.fHits + st.fMisses == size_t(kThreads) * 20 * keys.size());
+}
+
+static void testCurrent()
+{
+    SVGValueMemo memo{};
+
+    CHECK(SVGValueMemo::current() == nullptr);
+    {
+        SVGValueMemoGuard guard(&memo);
+        CHECK(SVGValueMemo::current() == &memo);
+
+        std::thread other([]() { CHECK(SVGValueMemo::current() == nullptr); });
+        other.join();
+    }
+    CHECK(SVGValueMemo::current() == nullptr);
+}
+
+int main()
+{
+    testFindByBytes();
+    testCapacity();
+    testConcurrent();
+    testCurrent();
+
+    return unitTestReport("test_valuememo");
+}
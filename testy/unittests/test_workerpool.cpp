@@ -0,0 +1,88 @@
+//
+// test_workerpool
+//
+// parallelFor() runs every index exactly once, whatever the thread
+// count, and still finishes when it's called from one of the pool's
+// own threads.
+//
+
+#include <atomic>
+#include <vector>
+
+#include "unittest.h"
+
+#include "workerpool.h"
+
+using namespace waavs;
+
+static bool eachOnce(const std::vector<std::atomic<int>>& hits)
+{
+    for (const auto& h : hits)
+    {
+        if (h.load() != 1)
+            return false;
+    }
+    return true;
+}
+
+static void testEveryIndexOnce()
+{
+    WorkerPool pool(3);
+    CHECK(pool.threadCount() == 3);
+
+    const size_t threadCounts[] = { 0, 1, 2, 4, 64 };
+    for (size_t threads : threadCounts)
+    {
+        std::vector<std::atomic<int>> hits(1000);
+        pool.parallelFor(hits.size(), threads, [&](size_t i) { hits[i].fetch_add(1); });
+        CHECK(eachOnce(hits));
+    }
+
+    // Nothing to do is fine
+    int calls = 0;
+    pool.parallelFor(0, 0, [&](size_t) { calls++; });
+    CHECK(calls == 0);
+}
+
+static void testNoThreads()
+{
+    WorkerPool pool(0);
+
+    std::vector<std::atomic<int>> hits(50);
+    pool.parallelFor(hits.size(), 0, [&](size_t i) { hits[i].fetch_add(1); });
+    CHECK(eachOnce(hits));
+}
+
+static void testNested()
+{
+    WorkerPool pool(2);
+
+    // Every pool thread ends up waiting on an inner loop
+    std::vector<std::atomic<int>> hits(8 * 100);
+    pool.parallelFor(8, 0, [&](size_t outer) {
+        pool.parallelFor(100, 0, [&](size_t inner) { hits[outer * 100 + inner].fetch_add(1); });
+        });
+    CHECK(eachOnce(hits));
+}
+
+static void testReuse()
+{
+    // The same threads serve many short calls
+    WorkerPool& pool = WorkerPool::shared();
+
+    std::atomic<size_t> total{ 0 };
+    for (int round = 0; round < 200; round++)
+        pool.parallelFor(16, 0, [&](size_t i) { total.fetch_add(i); });
+
+    CHECK(total.load() == 200 * (15 * 16 / 2));
+}
+
+int main()
+{
+    testEveryIndexOnce();
+    testNoThreads();
+    testNested();
+    testReuse();
+
+    return unitTestReport("test_workerpool");
+}
@@ -0,0 +1,234 @@
+//
+// test_xmlstream
+//
+// However a document is cut into chunks, XmlStreamPull gives the same
+// elements as scanning it whole.  A construct spread over many chunks
+// is only searched through once, and input that can't be completed,
+// or that can't be XML, is an error well before the end arrives.
+//
+
+#include <string>
+#include <vector>
+
+#include "unittest.h"
+
+#include "xmlstream.h"
+
+using namespace waavs;
+
+static const char* kXml =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<!DOCTYPE svg [ <!ENTITY e \"x>y\"> ]>\n"
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"10\" height=\"10\">\n"
+    "  <!-- a comment, with -- and > in it -->\n"
+    "  <g id='a' title=\"1 &gt; 0\"><rect x=\"1\" y=\"2\"/></g>\n"
+    "  <text>some text, then more</text>\n"
+    "  <style><![CDATA[ rect > g { fill: red; } ]] ]]></style>\n"
+    "  <?pi some data?>\n"
+    "</svg>\n";
+
+struct Pulled
+{
+    uint32_t fKind{ 0 };
+    const char* fName{ nullptr };
+    std::string fData{};
+
+    bool operator==(const Pulled& o) const
+    {
+        return fKind == o.fKind && fName == o.fName && fData == o.fData;
+    }
+};
+
+static Pulled pulled(const XmlElement& elem)
+{
+    return Pulled{ elem.kind(), elem.fQNameAtom, std::string((const char*)elem.fData.data(), elem.fData.size()) };
+}
+
+// The whole document, in one span
+static std::vector<Pulled> scanWhole(const std::string& src)
+{
+    std::vector<Pulled> out{};
+
+    XmlIterator iter{ ByteSpan((const unsigned char*)src.data(), src.size()) };
+    XmlElement elem{};
+    while (nextXmlElement(iter, elem))
+        out.push_back(pulled(elem));
+
+    return out;
+}
+
+// Fed in the given pieces, pulling as much as possible after each one
+static bool pullInPieces(const std::string& src, const std::vector<size_t>& cuts, std::vector<Pulled>& out)
+{
+    XmlStreamPull pull{};
+    size_t from = 0;
+
+    for (size_t i = 0; i <= cuts.size(); i++)
+    {
+        const size_t to = i < cuts.size() ? cuts[i] : src.size();
+        if (!pull.feed(ByteSpan((const unsigned char*)src.data() + from, to - from)))
+            return false;
+        from = to;
+
+        XmlStreamStatus st;
+        while ((st = pull.next()) == XML_STREAM_ELEMENT)
+            out.push_back(pulled(*pull));
+
+        if (st != XML_STREAM_NEED_MORE)
+            return false;
+    }
+
+    pull.finish();
+
+    XmlStreamStatus st;
+    while ((st = pull.next()) == XML_STREAM_ELEMENT)
+        out.push_back(pulled(*pull));
+
+    return st == XML_STREAM_END;
+}
+
+static void testEverySplit()
+{
+    const std::string src = kXml;
+    const std::vector<Pulled> whole = scanWhole(src);
+    CHECK(whole.size() > 10);
+
+    // Cut once, everywhere
+    size_t same = 0;
+    for (size_t at = 0; at <= src.size(); at++)
+    {
+        std::vector<Pulled> got{};
+        if (pullInPieces(src, { at }, got) && got == whole)
+            same++;
+    }
+    CHECK(same == src.size() + 1);
+
+    // Cut twice, everywhere
+    size_t sameTwice = 0;
+    size_t tries = 0;
+    for (size_t a = 0; a <= src.size(); a += 3)
+    {
+        for (size_t b = a; b <= src.size(); b += 5)
+        {
+            tries++;
+            std::vector<Pulled> got{};
+            if (pullInPieces(src, { a, b }, got) && got == whole)
+                sameTwice++;
+        }
+    }
+    CHECK(sameTwice == tries);
+
+    // A byte at a time
+    std::vector<size_t> cuts{};
+    for (size_t at = 1; at < src.size(); at++)
+        cuts.push_back(at);
+
+    std::vector<Pulled> got{};
+    CHECK(pullInPieces(src, cuts, got));
+    CHECK(got == whole);
+}
+
+static void testLongConstruct()
+{
+    // A large CDATA section full of markup like characters, in small chunks
+    std::string body{};
+    while (body.size() < 256 * 1024)
+        body += "<a> b > c <d/> ";
+
+    const std::string src = "<style><![CDATA[" + body + "]]></style>";
+
+    XmlStreamPull pull{};
+    std::vector<Pulled> got{};
+    size_t stalledBehind = 0;
+
+    for (size_t at = 0; at < src.size(); at += 61)
+    {
+        const size_t n = std::min<size_t>(61, src.size() - at);
+        CHECK(pull.feed(ByteSpan((const unsigned char*)src.data() + at, n)));
+
+        XmlStreamStatus st;
+        while ((st = pull.next()) == XML_STREAM_ELEMENT)
+            got.push_back(pulled(*pull));
+
+        // What's been fed is searched once, not from the start again
+        if (st == XML_STREAM_NEED_MORE && pull.fSearchFrom + 2 < pull.pendingSize())
+            stalledBehind++;
+    }
+    CHECK(stalledBehind == 0);
+
+    pull.finish();
+    while (pull.next() == XML_STREAM_ELEMENT)
+        got.push_back(pulled(*pull));
+
+    CHECK(got.size() == 3);
+    CHECK(got.size() == 3 && got[1].fKind == XML_ELEMENT_TYPE_CDATA && got[1].fData == body);
+}
+
+static void testMalformed()
+{
+    // Can't be a tag, whatever comes after
+    {
+        XmlStreamPull pull{};
+        const std::string src = "<svg><1rect/>";
+        CHECK(pull.feed(ByteSpan((const unsigned char*)src.data(), src.size())));
+        CHECK(pull.next() == XML_STREAM_ELEMENT);
+        CHECK(pull.next() == XML_STREAM_ERROR);
+        CHECK(pull.failed());
+
+        // And stays that way
+        CHECK(!pull.feed(ByteSpan("<rect/>")));
+        CHECK(pull.next() == XML_STREAM_ERROR);
+    }
+
+    // Cut off before anything tells it apart
+    {
+        XmlStreamPull pull{};
+        CHECK(pull.feed(ByteSpan("<svg><")));
+        CHECK(pull.next() == XML_STREAM_ELEMENT);
+        CHECK(pull.next() == XML_STREAM_NEED_MORE);
+        CHECK(pull.feed(ByteSpan("=")));
+        CHECK(pull.next() == XML_STREAM_ERROR);
+    }
+
+    // Never closed, with a bounded window
+    {
+        XmlStreamPull pull(false, 64 * 1024);
+        CHECK(pull.feed(ByteSpan("<svg><rect x=\"")));
+        CHECK(pull.next() == XML_STREAM_ELEMENT);
+
+        const std::string junk(1000, 'x');
+        bool dropped = false;
+        XmlStreamStatus st = XML_STREAM_NEED_MORE;
+        for (int i = 0; i < 100 && st == XML_STREAM_NEED_MORE; i++)
+        {
+            if (!pull.feed(ByteSpan((const unsigned char*)junk.data(), junk.size())))
+                dropped = true;
+            st = pull.next();
+        }
+        CHECK(dropped);
+        CHECK(st == XML_STREAM_ERROR);
+        CHECK(pull.windowSize() <= 64 * 1024);
+    }
+
+    // Bounded unless asked otherwise
+    XmlStreamPull pull{};
+    CHECK(pull.fMaxWindowSize == XmlStreamPull::kDefaultMaxWindowSize);
+    CHECK(pull.fMaxWindowSize > 0);
+
+    // Cut off at the end
+    XmlStreamPull cut{};
+    CHECK(cut.feed(ByteSpan("<svg><rect x='1'")));
+    CHECK(cut.next() == XML_STREAM_ELEMENT);
+    CHECK(cut.next() == XML_STREAM_NEED_MORE);
+    cut.finish();
+    CHECK(cut.next() == XML_STREAM_ERROR);
+}
+
+int main()
+{
+    testEverySplit();
+    testLongConstruct();
+    testMalformed();
+
+    return unitTestReport("test_xmlstream");
+}
@@ -0,0 +1,95 @@
+//
+// test_zerocopyload
+//
+// Documents created from shared or borrowed memory refer straight
+// into it, rather than into a copy, and a shared owner is kept
+// alive for as long as the document is.
+//
+// This one builds documents, so it needs blend2d
+//
+// cl  /EHsc /std:c++20 -I ..\\..\\ -I ..\\..\\svg  test_zerocopyload.cpp blend2d.lib  /link /LIBPATH:"..\\..\\lib\\Release"
+//
+
+#include <memory>
+#include <string>
+
+#include "unittest.h"
+
+#include "svgdocument.h"
+
+using namespace waavs;
+
+static const char* kSvg =
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\">"
+    "<rect id=\"box\" x=\"10\" y=\"10\" width=\"50\" height=\"50\" fill=\"green\"/>"
+    "</svg>";
+
+static bool within(const ByteSpan& inner, const unsigned char* start, size_t size)
+{
+    return inner.begin() >= start && inner.end() <= start + size;
+}
+
+static ByteSpan boxFill(SVGDocument& doc)
+{
+    auto node = std::dynamic_pointer_cast<SVGGraphicsElement>(doc.getElementById("box"));
+    return node ? node->getAttribute(svgattr::fill()) : ByteSpan{};
+}
+
+int main()
+{
+    const size_t size = strlen(kSvg);
+
+    // Copied, the spans refer to the document's own memory
+    {
+        std::string src(kSvg);
+        auto doc = SVGDocument::createFromChunk(ByteSpan((const unsigned char*)src.data(), size), 100, 100, 96);
+        CHECK(doc != nullptr);
+
+        if (doc)
+        {
+            ByteSpan fill = boxFill(*doc);
+            CHECK(fill == "green");
+            CHECK(!within(fill, (const unsigned char*)src.data(), size));
+        }
+    }
+
+    // Borrowed, the spans refer to the caller's memory
+    {
+        std::string src(kSvg);
+        auto doc = SVGDocument::createFromBorrowedChunk(ByteSpan((const unsigned char*)src.data(), size), 100, 100, 96);
+        CHECK(doc != nullptr);
+
+        if (doc)
+        {
+            ByteSpan fill = boxFill(*doc);
+            CHECK(fill == "green");
+            CHECK(within(fill, (const unsigned char*)src.data(), size));
+            CHECK(doc->fSourceMem.size() == 0);
+        }
+    }
+
+    // Shared, the document keeps the owner alive
+    {
+        auto owner = std::make_shared<std::string>(kSvg);
+        const unsigned char* mem = (const unsigned char*)owner->data();
+
+        std::weak_ptr<std::string> watch = owner;
+        auto doc = SVGDocument::createFromSharedChunk(owner, ByteSpan(mem, size), 100, 100, 96);
+        owner.reset();
+
+        CHECK(doc != nullptr);
+        CHECK(!watch.expired());
+
+        if (doc)
+        {
+            ByteSpan fill = boxFill(*doc);
+            CHECK(fill == "green");
+            CHECK(within(fill, mem, size));
+        }
+
+        doc.reset();
+        CHECK(watch.expired());
+    }
+
+    return unitTestReport("test_zerocopyload");
+}
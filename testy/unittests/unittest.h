@@ -0,0 +1,31 @@
+#pragma once
+
+//
+// unittest.h
+//
+// Just enough to write small self checking programs.  Each test
+// program is a main() that runs a handful of CHECK()s, prints the
+// ones that fail, and returns non-zero if any did.
+//
+
+#include <cstdio>
+
+namespace waavs {
+    static int gUnitTestFailures = 0;
+    static int gUnitTestChecks = 0;
+
+    static inline int unitTestReport(const char* name)
+    {
+        printf("%s: %d checks, %d failed\n", name, gUnitTestChecks, gUnitTestFailures);
+        return gUnitTestFailures == 0 ? 0 : 1;
+    }
+}
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        waavs::gUnitTestChecks++;                                           \
+        if (!(cond)) {                                                      \
+            waavs::gUnitTestFailures++;                                     \
+            printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+        }                                                                   \
+    } while (0)
@@ -9,6 +9,8 @@
 #include "svgatoms.h"
 #include "pixel_effects.h"
 #include "svgfactory.h"
+#include "svgtiledrenderer.h"
+#include "svgbatchrenderer.h"
 
 using namespace waavs;
 
@@ -18,12 +20,15 @@ struct WaavsFxOptions
     const char* outputFile = "output.png";
     const char* filterFile = nullptr;
     const char* resultName = nullptr;
+    const char* svgbFile = nullptr;
+    const char* batchFile = nullptr;
 
     SVGLengthValue width{};
     SVGLengthValue height{};
     
     double dpi = 96.0;
     int threadCount = 4;
+    int tileSize = 0;           // 0 == draw the whole canvas at once
 
 
     bool fitSvgToCanvas = true;
@@ -81,6 +86,9 @@ static const InternedKey kArgDpi = PSNameTable::INTERN("--dpi");
 static const InternedKey kArgThreads = PSNameTable::INTERN("--threads");
 static const InternedKey kArgResult = PSNameTable::INTERN("--result");
 static const InternedKey kArgBg = PSNameTable::INTERN("--bg");
+static const InternedKey kArgSaveSvgb = PSNameTable::INTERN("--save-svgb");
+static const InternedKey kArgTileSize = PSNameTable::INTERN("--tile-size");
+static const InternedKey kArgBatch = PSNameTable::INTERN("--batch");
 
 static const InternedKey kArgNoFit = PSNameTable::INTERN("--no-fit");
 static const InternedKey kArgVerbose = PSNameTable::INTERN("--verbose");
@@ -189,6 +197,10 @@ static void printUsage() noexcept
         "      --threads <count>    Thread count, default 4\n"
         "      --result <name>      Named filter output to save\n"
         "      --bg <AARRGGBB>      Background color, default transparent\n"
+        "      --save-svgb <file>   Save the precompiled SVG input, for faster loading\n"
+        "      --tile-size <n>      Draw SVG input in n x n tiles, one per thread\n"
+        "      --batch <file>       Render each 'input output [width height]' line of file,\n"
+        "                           one document per thread\n"
         "      --no-fit             Do not fit SVG input to canvas\n"
         "      --verbose            Print diagnostic information\n"
         "      --help               Show this help\n"
@@ -294,6 +306,31 @@ static bool parseCommandLine(int argc, char** argv, WaavsFxOptions& opt) noexcep
                 return false;
             }
         }
+        else if (arg == kArgSaveSvgb)
+        {
+            if (!requireArgValue(argc, argv, i))
+                return false;
+
+            opt.svgbFile = argv[++i];
+        }
+        else if (arg == kArgTileSize)
+        {
+            if (!requireArgValue(argc, argv, i))
+                return false;
+
+            if (!parseCliInt(argv[++i], opt.tileSize) || opt.tileSize < 0)
+            {
+                printf("Invalid tile size: %s\n", argv[i]);
+                return false;
+            }
+        }
+        else if (arg == kArgBatch)
+        {
+            if (!requireArgValue(argc, argv, i))
+                return false;
+
+            opt.batchFile = argv[++i];
+        }
         else if (arg == kArgNoFit)
         {
             opt.fitSvgToCanvas = false;
@@ -323,7 +360,7 @@ static bool parseCommandLine(int argc, char** argv, WaavsFxOptions& opt) noexcep
         }
     }
 
-    if (!opt.inputFile && !opt.showHelp)
+    if (!opt.inputFile && !opt.batchFile && !opt.showHelp)
     {
         printf("Missing input file\n");
         return false;
@@ -407,12 +444,47 @@ static SVGDocumentHandle createDocumentFromFile(
 
     ByteSpan mappedSpan;
     mappedSpan.resetFromSize(mapped->data(), mapped->size());
-    auto doc = SVGFactory::createFromChunk(mappedSpan, canWidth, canHeight, dpi);
+    auto doc = SVGFactory::createFromSharedChunk(mapped, mappedSpan, canWidth, canHeight, dpi);
 
     return doc;
 }
 
 
+// ------------------------------
+// saveSvgbImage
+//
+// Write the precompiled image of a document, which loads
+// as an SVG input later on, without any scanning.
+//
+static bool saveSvgbImage(const SVGDocument& doc, const char* filename)
+{
+    std::vector<uint8_t> image;
+    if (!doc.writeBinaryImage(image))
+    {
+        printf("Could not compile SVG image: %s\n", filename);
+        return false;
+    }
+
+    FILE* f = fopen(filename, "wb");
+    if (!f)
+    {
+        printf("Could not create: %s\n", filename);
+        return false;
+    }
+
+    size_t written = fwrite(image.data(), 1, image.size(), f);
+    fclose(f);
+
+    if (written != image.size())
+    {
+        printf("Failed to write: %s\n", filename);
+        return false;
+    }
+
+    return true;
+}
+
+
 static bool renderSvgInput(WaavsFxJob& job, const char* filename)
 {
     auto parseSize = resolveOutputSize(job, 1920, 1080);
@@ -426,6 +498,9 @@ static bool renderSvgInput(WaavsFxJob& job, const char* filename)
     if (!doc)
         return false;
 
+    if (job.options.svgbFile && !saveSvgbImage(*doc, job.options.svgbFile))
+        return false;
+
     WGRectD sceneFrame = doc->objectBoundingBox();
 
     auto outputSize = resolveOutputSize(
@@ -445,10 +520,7 @@ static bool renderSvgInput(WaavsFxJob& job, const char* filename)
 
     Surface img(outputSize.width, outputSize.height);
 
-    SVGB2DDriver ctx;
-    ctx.attach(img, job.options.threadCount);
-    ctx.background(BLRgba32(job.options.background));
-    ctx.renew();
+    WGMatrix3x3 tform = WGMatrix3x3::makeIdentity();
 
     if (job.options.fitSvgToCanvas)
     {
@@ -459,7 +531,6 @@ static bool renderSvgInput(WaavsFxJob& job, const char* filename)
             (double)outputSize.height
         };
 
-        WGMatrix3x3 tform{};
         PreserveAspectRatio par{};
 
         computeViewBoxToViewport(
@@ -467,12 +538,41 @@ static bool renderSvgInput(WaavsFxJob& job, const char* filename)
             sceneFrame,
             par,
             tform);
+    }
+
+    if (job.options.tileSize > 0)
+    {
+        SVGTileRenderOptions tiling{};
+        tiling.fTileSize = job.options.tileSize;
+        tiling.fThreadCount = size_t(job.options.threadCount);
+        tiling.fBackground = BLRgba32(job.options.background);
+        tiling.fTransform = tform;
+
+        renderDocumentTiled(*doc, img, tiling);
+    }
+    else
+    {
+        SVGB2DDriver ctx;
+        ctx.attach(img, job.options.threadCount);
+        ctx.background(BLRgba32(job.options.background));
+        ctx.renew();
 
         ctx.transform(tform);
+
+        doc->draw(&ctx, doc.get());
+        ctx.detach();
     }
 
-    doc->draw(&ctx, doc.get());
-    ctx.detach();
+    if (job.options.verbose)
+    {
+        auto printMemo = [](const char* name, const SVGMemoStats& st) {
+            printf("%-10s memo: %zu hits, %zu misses, %zu entries\n", name, st.fHits, st.fMisses, st.fEntries);
+            };
+
+        printMemo("style", doc->valueMemo().styleStats());
+        printMemo("transform", doc->valueMemo().transformStats());
+        printMemo("color", doc->valueMemo().colorStats());
+    }
 
     job.source = img;
     job.sourceSvg = doc;
@@ -484,14 +584,15 @@ static bool renderSvgInput(WaavsFxJob& job, const char* filename)
 // looksLikeSvg
 // 
 // A simple heuristic to determine whether the input file 
-// is an SVG based on the extension.
+// is an SVG based on the extension.  A precompiled .svgb
+// image counts as an SVG.
 //
 static INLINE bool looksLikeSvg(const char* filename) noexcept
 {
     if (!filename)
         return false;
 
-    return bspan_ends_with(filename, ".svg");
+    return bspan_ends_with(filename, ".svg") || bspan_ends_with(filename, ".svgb");
 }
 
 // ------------------------------
@@ -609,6 +710,136 @@ static int runWaavsFx(const WaavsFxOptions& opt)
     return 0;
 }
 
+// ------------------------------
+// loadBatchList
+//
+// Each line of the list is 'input output [width height]'.
+// Blank lines, and lines starting with '#', are skipped.  Without
+// a width and height, --width and --height are used, or else the
+// document's own size.
+//
+static bool loadBatchList(const WaavsFxOptions& opt, std::vector<SVGBatchItem>& items)
+{
+    auto mapped = MappedFile::create_shared(opt.batchFile);
+    if (!mapped)
+    {
+        printf("Batch file not found: %s\n", opt.batchFile);
+        return false;
+    }
+
+    const int defaultW = resolveOutputLength(opt.width, 0.0, opt.dpi, 0);
+    const int defaultH = resolveOutputLength(opt.height, 0.0, opt.dpi, 0);
+
+    ByteSpan src;
+    src.resetFromSize(mapped->data(), mapped->size());
+
+    int lineNum = 0;
+    while (src)
+    {
+        ByteSpan line = chunk_trim(chunk_token_char(src, '\n'), chrWspChars);
+        ++lineNum;
+
+        if (!line || *line == '#')
+            continue;
+
+        ByteSpan fields[4]{};
+        int nFields = 0;
+        while (line && nFields < 4)
+        {
+            line = chunk_ltrim(line, chrWspChars);
+            if (!line)
+                break;
+
+            fields[nFields++] = chunk_token(line, chrWspChars);
+        }
+
+        if (nFields != 2 && nFields != 4)
+        {
+            printf("Batch line %d: expected 'input output [width height]'\n", lineNum);
+            return false;
+        }
+
+        SVGBatchItem item{};
+        item.fWidth = defaultW;
+        item.fHeight = defaultH;
+
+        if (nFields == 4)
+        {
+            int64_t w = 0, h = 0;
+            if (!parse64i(fields[2], w) || !parse64i(fields[3], h) || w < 0 || h < 0)
+            {
+                printf("Batch line %d: invalid size\n", lineNum);
+                return false;
+            }
+
+            item.fWidth = (int)w;
+            item.fHeight = (int)h;
+        }
+
+        std::string input((const char*)fields[0].data(), fields[0].size());
+        item.fOutputFile.assign((const char*)fields[1].data(), fields[1].size());
+
+        auto inputMap = MappedFile::create_shared(input);
+        if (!inputMap)
+        {
+            printf("Batch line %d: file not found: %s\n", lineNum, input.c_str());
+            return false;
+        }
+
+        item.fSource.resetFromSize(inputMap->data(), inputMap->size());
+        item.fSourceOwner = inputMap;
+
+        items.push_back(std::move(item));
+    }
+
+    return true;
+}
+
+// ------------------------------
+// runBatch
+//
+static int runBatch(const WaavsFxOptions& opt)
+{
+    std::vector<SVGBatchItem> items;
+    if (!loadBatchList(opt, items))
+        return 1;
+
+    SVGBatchOptions batchOpts{};
+    batchOpts.fThreadCount = size_t(opt.threadCount);
+    batchOpts.fDpi = opt.dpi;
+    batchOpts.fBackground = BLRgba32(opt.background);
+    batchOpts.fFitToCanvas = opt.fitSvgToCanvas;
+
+    std::vector<SVGBatchResult> results;
+
+    StopWatch sw{};
+    size_t succeeded = renderBatch(items, results, batchOpts);
+    double elapsed = sw.millis();
+
+    double parseMs = 0, renderMs = 0, encodeMs = 0;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const SVGBatchResult& r = results[i];
+
+        parseMs += r.fParseMillis;
+        renderMs += r.fRenderMillis;
+        encodeMs += r.fEncodeMillis;
+
+        if (!r.fSuccess)
+            printf("FAILED: %s (%s)\n", items[i].fOutputFile.c_str(), r.fError ? r.fError : "unknown");
+        else if (opt.verbose)
+            printf("%s: %d x %d, parse %.2f ms, render %.2f ms, encode %.2f ms, thread %zu\n",
+                items[i].fOutputFile.c_str(), r.fWidth, r.fHeight,
+                r.fParseMillis, r.fRenderMillis, r.fEncodeMillis, r.fWorker);
+    }
+
+    printf("%zu of %zu rendered in %.1f ms, %.1f per second\n",
+        succeeded, items.size(), elapsed, elapsed > 0 ? (double(succeeded) * 1000.0 / elapsed) : 0.0);
+    printf("total parse %.1f ms, render %.1f ms, encode %.1f ms\n", parseMs, renderMs, encodeMs);
+
+    return (succeeded == items.size()) ? 0 : 1;
+}
+
 // ------------------------------
 
 int main(int argc, char** argv)
@@ -629,5 +860,8 @@ int main(int argc, char** argv)
         return 0;
     }
 
+    if (opt.batchFile)
+        return runBatch(opt);
+
     return runWaavsFx(opt);
 }